@@ -59,6 +59,9 @@
         #undef LV_MEM_POOL_ALLOC
     #endif
 
+    /*Percent of the pool reserved for small fixed size blocks (objects, styles, event lists). 0: disabled*/
+    #define LV_MEM_CLASS_POOL_PCT 0
+
 #else       /*LV_MEM_CUSTOM*/
     #define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
     #define LV_MEM_CUSTOM_ALLOC   malloc
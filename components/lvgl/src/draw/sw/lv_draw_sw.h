@@ -43,6 +43,20 @@ typedef struct {
     uint32_t has_alpha : 1;
 } lv_draw_sw_layer_ctx_t;
 
+typedef void * (*lv_draw_sw_glyph_cache_alloc_cb_t)(size_t size);
+typedef void (*lv_draw_sw_glyph_cache_free_cb_t)(void * p);
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t uncached;      /*Glyphs that were too large or could not be stored*/
+    uint32_t entries;
+    uint32_t max_entries;
+    uint32_t used_bytes;
+    uint32_t max_bytes;
+} lv_draw_sw_glyph_cache_stats_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -61,6 +75,32 @@ void lv_draw_sw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, con
 void lv_draw_sw_letter(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc, const lv_point_t * pos_p,
                        uint32_t letter);
 
+/**
+ * Keep glyphs converted to 8 bit opacity so redrawing a letter is a copy instead of unpacking its bitmap.
+ * The least recently used glyphs are dropped when `max_bytes` is reached.
+ * @param max_bytes     memory budget for the glyph bitmaps, 0 to disable the cache
+ * @param alloc_cb      allocates the entry table and the glyph bitmaps, e.g. from external RAM
+ * @param free_cb       releases memory from `alloc_cb`
+ * @note Call `lv_draw_sw_glyph_cache_flush()` after freeing a font loaded at run time
+ */
+void lv_draw_sw_glyph_cache_init(uint32_t max_bytes, lv_draw_sw_glyph_cache_alloc_cb_t alloc_cb,
+                                 lv_draw_sw_glyph_cache_free_cb_t free_cb);
+
+/**
+ * Drop every cached glyph. The statistics are kept.
+ */
+void lv_draw_sw_glyph_cache_flush(void);
+
+/**
+ * Temporarily bypass the cache without releasing it, e.g. to compare rendering times.
+ * @param en    false to draw every glyph from the font's bitmap
+ */
+void lv_draw_sw_glyph_cache_set_enabled(bool en);
+
+void lv_draw_sw_glyph_cache_get_stats(lv_draw_sw_glyph_cache_stats_t * stats);
+
+void lv_draw_sw_glyph_cache_reset_stats(void);
+
 void /* LV_ATTRIBUTE_FAST_MEM */ lv_draw_sw_img_decoded(struct _lv_draw_ctx_t * draw_ctx,
                                                         const lv_draw_img_dsc_t * draw_dsc,
                                                         const lv_area_t * coords, const uint8_t * src_buf,
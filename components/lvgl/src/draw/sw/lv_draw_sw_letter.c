@@ -18,10 +18,44 @@
 /*********************
  *      DEFINES
  *********************/
+#define GLYPH_CACHE_NONE            0xFFFF
+#define GLYPH_CACHE_HASH_SIZE       64      /*Must be a power of 2*/
+#define GLYPH_CACHE_AVG_GLYPH_SIZE  96      /*Expected bytes per glyph, sizes the entry table*/
+#define GLYPH_CACHE_MIN_ENTRIES     16
+#define GLYPH_CACHE_MAX_ENTRIES     1024
 
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    const lv_font_t * font;
+    uint8_t * a8;           /*box_w * box_h opacity values, one byte per pixel*/
+    uint32_t letter;
+    uint16_t box_w;
+    uint16_t box_h;
+    uint16_t prev;          /*Towards the most recently used*/
+    uint16_t next;          /*Towards the least recently used, or the next free entry*/
+    uint16_t hash_next;
+} glyph_cache_entry_t;
+
+typedef struct {
+    glyph_cache_entry_t * entries;
+    lv_draw_sw_glyph_cache_alloc_cb_t alloc_cb;
+    lv_draw_sw_glyph_cache_free_cb_t free_cb;
+    uint16_t buckets[GLYPH_CACHE_HASH_SIZE];
+    uint16_t entry_cnt;
+    uint16_t used_cnt;
+    uint16_t head;
+    uint16_t tail;
+    uint16_t free_head;
+    uint32_t max_bytes;
+    uint32_t used_bytes;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t uncached;
+    bool enabled;
+} glyph_cache_t;
 
 /**********************
  *  STATIC PROTOTYPES
@@ -35,9 +69,12 @@ static void draw_letter_subpx(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_
                               lv_font_glyph_dsc_t * g, const uint8_t * map_p);
 #endif /*LV_DRAW_COMPLEX && LV_USE_FONT_SUBPX*/
 
+static const uint8_t * glyph_cache_get(const lv_font_glyph_dsc_t * g, uint32_t letter);
+
 /**********************
  *  STATIC VARIABLES
  **********************/
+static glyph_cache_t glyph_cache;
 
 /**********************
  *  GLOBAL VARIABLES
@@ -139,6 +176,16 @@ void lv_draw_sw_letter(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc
         return;
     }
 
+    if(!g.resolved_font->subpx) {
+        /*Cached glyphs are already one byte per pixel*/
+        const uint8_t * a8_p = glyph_cache_get(&g, letter);
+        if(a8_p) {
+            g.bpp = 8;
+            draw_letter_normal(draw_ctx, dsc, &gpos, &g, a8_p);
+            return;
+        }
+    }
+
     const uint8_t * map_p = lv_font_get_glyph_bitmap(g.resolved_font, letter);
     if(map_p == NULL) {
         LV_LOG_WARN("lv_draw_letter: character's bitmap not found");
@@ -157,6 +204,82 @@ void lv_draw_sw_letter(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_t * dsc
     }
 }
 
+void lv_draw_sw_glyph_cache_init(uint32_t max_bytes, lv_draw_sw_glyph_cache_alloc_cb_t alloc_cb,
+                                 lv_draw_sw_glyph_cache_free_cb_t free_cb)
+{
+    if(glyph_cache.entries) {
+        lv_draw_sw_glyph_cache_flush();
+        glyph_cache.free_cb(glyph_cache.entries);
+    }
+    lv_memset_00(&glyph_cache, sizeof(glyph_cache));
+
+    if(max_bytes == 0 || alloc_cb == NULL || free_cb == NULL) return;
+
+    uint32_t entry_cnt = LV_CLAMP(GLYPH_CACHE_MIN_ENTRIES, max_bytes / GLYPH_CACHE_AVG_GLYPH_SIZE,
+                                  GLYPH_CACHE_MAX_ENTRIES);
+    glyph_cache.entries = alloc_cb(entry_cnt * sizeof(glyph_cache_entry_t));
+    if(glyph_cache.entries == NULL) {
+        LV_LOG_WARN("lv_draw_sw_glyph_cache_init: couldn't allocate %" LV_PRIu32 " entries", entry_cnt);
+        return;
+    }
+
+    glyph_cache.alloc_cb = alloc_cb;
+    glyph_cache.free_cb = free_cb;
+    glyph_cache.entry_cnt = entry_cnt;
+    glyph_cache.max_bytes = max_bytes;
+    glyph_cache.head = GLYPH_CACHE_NONE;
+    glyph_cache.enabled = true;
+    lv_draw_sw_glyph_cache_flush();
+}
+
+void lv_draw_sw_glyph_cache_flush(void)
+{
+    if(glyph_cache.entries == NULL) return;
+
+    uint32_t i;
+    for(i = glyph_cache.head; i != GLYPH_CACHE_NONE; i = glyph_cache.entries[i].next) {
+        glyph_cache.free_cb(glyph_cache.entries[i].a8);
+    }
+
+    for(i = 0; i < glyph_cache.entry_cnt; i++) {
+        glyph_cache.entries[i].next = i + 1 < glyph_cache.entry_cnt ? i + 1 : GLYPH_CACHE_NONE;
+    }
+    for(i = 0; i < GLYPH_CACHE_HASH_SIZE; i++) {
+        glyph_cache.buckets[i] = GLYPH_CACHE_NONE;
+    }
+
+    glyph_cache.free_head = 0;
+    glyph_cache.head = GLYPH_CACHE_NONE;
+    glyph_cache.tail = GLYPH_CACHE_NONE;
+    glyph_cache.used_cnt = 0;
+    glyph_cache.used_bytes = 0;
+}
+
+void lv_draw_sw_glyph_cache_set_enabled(bool en)
+{
+    glyph_cache.enabled = en && glyph_cache.entries != NULL;
+}
+
+void lv_draw_sw_glyph_cache_get_stats(lv_draw_sw_glyph_cache_stats_t * stats)
+{
+    stats->hits = glyph_cache.hits;
+    stats->misses = glyph_cache.misses;
+    stats->evictions = glyph_cache.evictions;
+    stats->uncached = glyph_cache.uncached;
+    stats->entries = glyph_cache.used_cnt;
+    stats->max_entries = glyph_cache.entry_cnt;
+    stats->used_bytes = glyph_cache.used_bytes;
+    stats->max_bytes = glyph_cache.max_bytes;
+}
+
+void lv_draw_sw_glyph_cache_reset_stats(void)
+{
+    glyph_cache.hits = 0;
+    glyph_cache.misses = 0;
+    glyph_cache.evictions = 0;
+    glyph_cache.uncached = 0;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -285,30 +408,44 @@ static void LV_ATTRIBUTE_FAST_MEM draw_letter_normal(lv_draw_ctx_t * draw_ctx, c
 #if LV_DRAW_COMPLEX
         int32_t mask_p_start = mask_p;
 #endif
-        bitmask = bitmask_init >> col_bit;
-        for(col = col_start; col < col_end; col++) {
-            /*Load the pixel's opacity into the mask*/
-            letter_px = (*map_p & bitmask) >> (col_bit_max - col_bit);
-            if(letter_px) {
-                mask_buf[mask_p] = bpp_opa_table_p[letter_px];
+        if(bpp == 8) {
+            /*One byte per pixel, no unpacking needed*/
+            int32_t w = col_end - col_start;
+            if(opa < LV_OPA_MAX) {
+                for(col = 0; col < w; col++) mask_buf[mask_p + col] = bpp_opa_table_p[map_p[col]];
             }
             else {
-                mask_buf[mask_p] = 0;
+                lv_memcpy_small(mask_buf + mask_p, map_p, w);
             }
+            map_p += w;
+            mask_p += w;
+        }
+        else {
+            bitmask = bitmask_init >> col_bit;
+            for(col = col_start; col < col_end; col++) {
+                /*Load the pixel's opacity into the mask*/
+                letter_px = (*map_p & bitmask) >> (col_bit_max - col_bit);
+                if(letter_px) {
+                    mask_buf[mask_p] = bpp_opa_table_p[letter_px];
+                }
+                else {
+                    mask_buf[mask_p] = 0;
+                }
 
-            /*Go to the next column*/
-            if(col_bit < col_bit_max) {
-                col_bit += bpp;
-                bitmask = bitmask >> bpp;
-            }
-            else {
-                col_bit = 0;
-                bitmask = bitmask_init;
-                map_p++;
-            }
+                /*Go to the next column*/
+                if(col_bit < col_bit_max) {
+                    col_bit += bpp;
+                    bitmask = bitmask >> bpp;
+                }
+                else {
+                    col_bit = 0;
+                    bitmask = bitmask_init;
+                    map_p++;
+                }
 
-            /*Next mask byte*/
-            mask_p++;
+                /*Next mask byte*/
+                mask_p++;
+            }
         }
 
 #if LV_DRAW_COMPLEX
@@ -569,3 +706,147 @@ static void draw_letter_subpx(lv_draw_ctx_t * draw_ctx, const lv_draw_label_dsc_
     lv_mem_buf_release(color_buf);
 }
 #endif /*LV_DRAW_COMPLEX && LV_USE_FONT_SUBPX*/
+
+static uint32_t glyph_cache_hash(const lv_font_t * font, uint32_t letter)
+{
+    uint32_t h = (uint32_t)(uintptr_t)font ^ (letter * 2654435761U);
+    return (h ^ (h >> 16)) & (GLYPH_CACHE_HASH_SIZE - 1);
+}
+
+static void glyph_cache_unlink(uint16_t id)
+{
+    glyph_cache_entry_t * e = &glyph_cache.entries[id];
+    if(e->prev != GLYPH_CACHE_NONE) glyph_cache.entries[e->prev].next = e->next;
+    else glyph_cache.head = e->next;
+    if(e->next != GLYPH_CACHE_NONE) glyph_cache.entries[e->next].prev = e->prev;
+    else glyph_cache.tail = e->prev;
+}
+
+static void glyph_cache_push_front(uint16_t id)
+{
+    glyph_cache_entry_t * e = &glyph_cache.entries[id];
+    e->prev = GLYPH_CACHE_NONE;
+    e->next = glyph_cache.head;
+    if(glyph_cache.head != GLYPH_CACHE_NONE) glyph_cache.entries[glyph_cache.head].prev = id;
+    else glyph_cache.tail = id;
+    glyph_cache.head = id;
+}
+
+static void glyph_cache_evict_tail(void)
+{
+    uint16_t id = glyph_cache.tail;
+    glyph_cache_entry_t * e = &glyph_cache.entries[id];
+
+    uint16_t * link = &glyph_cache.buckets[glyph_cache_hash(e->font, e->letter)];
+    while(*link != id) link = &glyph_cache.entries[*link].hash_next;
+    *link = e->hash_next;
+
+    glyph_cache_unlink(id);
+    glyph_cache.free_cb(e->a8);
+    glyph_cache.used_bytes -= (uint32_t)e->box_w * e->box_h;
+    glyph_cache.used_cnt--;
+    glyph_cache.evictions++;
+
+    e->next = glyph_cache.free_head;
+    glyph_cache.free_head = id;
+}
+
+/**
+ * Convert a packed 1, 2, 4 or 8 bpp glyph bitmap to one opacity byte per pixel.
+ * Rows are not padded in the font so the whole bitmap is one bit stream.
+ */
+static void glyph_cache_decode(uint8_t * a8, const uint8_t * map_p, uint32_t bpp, uint32_t px_cnt)
+{
+    const uint8_t * bpp_opa_table_p;
+    switch(bpp) {
+        case 1:
+            bpp_opa_table_p = _lv_bpp1_opa_table;
+            break;
+        case 2:
+            bpp_opa_table_p = _lv_bpp2_opa_table;
+            break;
+        case 4:
+            bpp_opa_table_p = _lv_bpp4_opa_table;
+            break;
+        default:
+            lv_memcpy(a8, map_p, px_cnt);
+            return;
+    }
+
+    uint32_t px_mask = (1 << bpp) - 1;
+    uint32_t bit = 0;
+    uint32_t i;
+    for(i = 0; i < px_cnt; i++) {
+        a8[i] = bpp_opa_table_p[(map_p[bit >> 3] >> (8 - bpp - (bit & 0x7))) & px_mask];
+        bit += bpp;
+    }
+}
+
+/**
+ * Return the cached 8 bit opacity map of a glyph, adding it on a miss.
+ * NULL if the glyph has to be drawn from the font's bitmap.
+ */
+static const uint8_t * glyph_cache_get(const lv_font_glyph_dsc_t * g, uint32_t letter)
+{
+    if(!glyph_cache.enabled) return NULL;
+
+    uint32_t bpp = g->bpp == 3 ? 4 : g->bpp;
+    if(bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8) return NULL;
+
+    const lv_font_t * font = g->resolved_font;
+    uint32_t hash = glyph_cache_hash(font, letter);
+    uint16_t id;
+    for(id = glyph_cache.buckets[hash]; id != GLYPH_CACHE_NONE; id = glyph_cache.entries[id].hash_next) {
+        glyph_cache_entry_t * e = &glyph_cache.entries[id];
+        if(e->font == font && e->letter == letter && e->box_w == g->box_w && e->box_h == g->box_h) {
+            if(glyph_cache.head != id) {
+                glyph_cache_unlink(id);
+                glyph_cache_push_front(id);
+            }
+            glyph_cache.hits++;
+            return e->a8;
+        }
+    }
+
+    glyph_cache.misses++;
+
+    /*Don't let a few large glyphs push out everything else*/
+    uint32_t size = (uint32_t)g->box_w * g->box_h;
+    if(size > glyph_cache.max_bytes / 4) {
+        glyph_cache.uncached++;
+        return NULL;
+    }
+
+    const uint8_t * map_p = lv_font_get_glyph_bitmap(font, letter);
+    if(map_p == NULL) return NULL;
+
+    while(glyph_cache.tail != GLYPH_CACHE_NONE &&
+          (glyph_cache.free_head == GLYPH_CACHE_NONE || glyph_cache.used_bytes + size > glyph_cache.max_bytes)) {
+        glyph_cache_evict_tail();
+    }
+
+    uint8_t * a8 = glyph_cache.alloc_cb(size);
+    if(a8 == NULL) {
+        glyph_cache.uncached++;
+        return NULL;
+    }
+    glyph_cache_decode(a8, map_p, bpp, size);
+
+    id = glyph_cache.free_head;
+    glyph_cache_entry_t * e = &glyph_cache.entries[id];
+    glyph_cache.free_head = e->next;
+
+    e->font = font;
+    e->letter = letter;
+    e->a8 = a8;
+    e->box_w = g->box_w;
+    e->box_h = g->box_h;
+    e->hash_next = glyph_cache.buckets[hash];
+    glyph_cache.buckets[hash] = id;
+    glyph_cache_push_front(id);
+
+    glyph_cache.used_cnt++;
+    glyph_cache.used_bytes += size;
+
+    return a8;
+}
@@ -157,6 +157,15 @@
         #endif
     #endif
 
+    /*Percent of the pool reserved for small fixed size blocks (objects, styles, event lists). 0: disabled*/
+    #ifndef LV_MEM_CLASS_POOL_PCT
+        #ifdef CONFIG_LV_MEM_CLASS_POOL_PCT
+            #define LV_MEM_CLASS_POOL_PCT CONFIG_LV_MEM_CLASS_POOL_PCT
+        #else
+            #define LV_MEM_CLASS_POOL_PCT 0
+        #endif
+    #endif
+
 #else       /*LV_MEM_CUSTOM*/
     #ifndef LV_MEM_CUSTOM_INCLUDE
         #ifdef CONFIG_LV_MEM_CUSTOM_INCLUDE
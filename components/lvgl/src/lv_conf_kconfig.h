@@ -41,6 +41,15 @@ extern "C" {
 #  define CONFIG_LV_MEM_SIZE (CONFIG_LV_MEM_SIZE_KILOBYTES * 1024U)
 #endif
 
+/*******************
+ * LV_MEM_POOL
+ *******************/
+
+#if defined(ESP_PLATFORM) && defined(CONFIG_LV_MEM_POOL_FROM_HEAP)
+#  define CONFIG_LV_MEM_POOL_INCLUDE "esp_heap_caps.h"
+#  define CONFIG_LV_MEM_POOL_ALLOC(size) heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM, MALLOC_CAP_8BIT)
+#endif
+
 /*------------------
  * MONITOR POSITION
  *-----------------*/
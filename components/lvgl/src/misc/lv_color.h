@@ -428,6 +428,22 @@ static inline uint32_t lv_color_to32(lv_color_t color)
 
 //! @cond Doxygen_Suppress
 
+#if LV_COLOR_DEPTH == 16
+/**
+ * Divide the weighted channel sums of a 565 mix by 255 and pack the result.
+ * `(v + 1 + (v >> 8)) >> 8` equals `LV_UDIV255(v)` for every v below 65535, so it can run on both lanes at once.
+ * @param rb red sum in the upper, blue sum in the lower 16 bits
+ * @param g green sum
+ * @return the packed RGB565 color, not swapped
+ */
+static inline uint16_t LV_ATTRIBUTE_FAST_MEM _lv_color_565_udiv255(uint32_t rb, uint32_t g)
+{
+    rb = ((rb + 0x10001 + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+    g = (g + 1 + (g >> 8)) >> 8;
+    return (uint16_t)(((rb >> 5) & 0xF800) | (g << 5) | (rb & 0x1F));
+}
+#endif
+
 /**
  * Mix two colors with a given ratio.
  * @param c1 the first color to mix (usually the foreground)
@@ -454,6 +470,22 @@ static inline lv_color_t LV_ATTRIBUTE_FAST_MEM lv_color_mix(lv_color_t c1, lv_co
 #if LV_COLOR_16_SWAP == 1
     ret.full = ret.full << 8 | ret.full >> 8;
 #endif
+#elif LV_COLOR_DEPTH == 16
+    /*Bit exact with the per channel formula below, but R and B are mixed together as two 16 bit lanes*/
+    uint32_t fg = c1.full;
+    uint32_t bg = c2.full;
+#if LV_COLOR_16_SWAP == 1
+    fg = ((fg << 8) | (fg >> 8)) & 0xFFFF;
+    bg = ((bg << 8) | (bg >> 8)) & 0xFFFF;
+#endif
+    uint32_t mix_inv = 255 - mix;
+    uint32_t rb = (((fg & 0xF800) << 5) | (fg & 0x1F)) * mix +
+                  (((bg & 0xF800) << 5) | (bg & 0x1F)) * mix_inv + LV_COLOR_MIX_ROUND_OFS * 0x10001;
+    uint32_t g = ((fg >> 5) & 0x3F) * mix + ((bg >> 5) & 0x3F) * mix_inv + LV_COLOR_MIX_ROUND_OFS;
+    ret.full = _lv_color_565_udiv255(rb, g);
+#if LV_COLOR_16_SWAP == 1
+    ret.full = ret.full << 8 | ret.full >> 8;
+#endif
 #elif LV_COLOR_DEPTH != 1
     /*LV_COLOR_DEPTH == 8, 16 or 32*/
     LV_COLOR_SET_R(ret, LV_UDIV255((uint16_t)LV_COLOR_GET_R(c1) * mix + LV_COLOR_GET_R(c2) *
@@ -499,7 +531,19 @@ static inline void LV_ATTRIBUTE_FAST_MEM lv_color_premult(lv_color_t c, uint8_t
 static inline lv_color_t LV_ATTRIBUTE_FAST_MEM lv_color_mix_premult(uint16_t * premult_c1, lv_color_t c2, uint8_t mix)
 {
     lv_color_t ret;
-#if LV_COLOR_DEPTH != 1
+#if LV_COLOR_DEPTH == 16
+    uint32_t bg = c2.full;
+#if LV_COLOR_16_SWAP == 1
+    bg = ((bg << 8) | (bg >> 8)) & 0xFFFF;
+#endif
+    uint32_t rb = (((uint32_t)premult_c1[0] << 16) | premult_c1[2]) +
+                  (((bg & 0xF800) << 5) | (bg & 0x1F)) * mix + LV_COLOR_MIX_ROUND_OFS * 0x10001;
+    uint32_t g = premult_c1[1] + ((bg >> 5) & 0x3F) * mix + LV_COLOR_MIX_ROUND_OFS;
+    ret.full = _lv_color_565_udiv255(rb, g);
+#if LV_COLOR_16_SWAP == 1
+    ret.full = ret.full << 8 | ret.full >> 8;
+#endif
+#elif LV_COLOR_DEPTH != 1
     /*LV_COLOR_DEPTH == 8 or 32*/
     LV_COLOR_SET_R(ret, LV_UDIV255(premult_c1[0] + LV_COLOR_GET_R(c2) * mix + LV_COLOR_MIX_ROUND_OFS));
     LV_COLOR_SET_G(ret, LV_UDIV255(premult_c1[1] + LV_COLOR_GET_G(c2) * mix + LV_COLOR_MIX_ROUND_OFS));
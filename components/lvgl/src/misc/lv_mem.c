@@ -39,15 +39,39 @@
 
 #define ZERO_MEM_SENTINEL  0xa1b2c3d4
 
+#if LV_MEM_CUSTOM == 0 && LV_MEM_CLASS_POOL_PCT > 0
+    #define MEM_USE_CLASSES 1
+#else
+    #define MEM_USE_CLASSES 0
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
+#if MEM_USE_CLASSES
+typedef struct {
+    uint8_t * start;
+    uint8_t * end;
+    uint8_t * bump;         /*Blocks from here to `end` were never handed out*/
+    void * free_list;       /*Released blocks, linked through their first word*/
+    uint32_t used_cnt;
+    uint32_t max_used_cnt;
+    uint32_t fallback_cnt;
+} mem_class_t;
+#endif
 
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 #if LV_MEM_CUSTOM == 0
     static void lv_mem_walker(void * ptr, size_t size, int used, void * user);
+    static size_t mem_class_init(uint8_t * mem);
+#endif
+
+#if MEM_USE_CLASSES
+    static void * mem_class_alloc(size_t size);
+    static mem_class_t * mem_class_find(const void * p);
+    static void mem_class_free(mem_class_t * c, void * p);
 #endif
 
 /**********************
@@ -59,6 +83,14 @@
     static uint32_t max_used;
 #endif
 
+#if MEM_USE_CLASSES
+    /*Sized after the most common allocations on 32 bit targets: style value and event lists,
+     *`_lv_obj_spec_attr_t` (28 bytes) and `lv_obj_t` (36 bytes). Must be multiples of the alignment.*/
+    static const uint16_t mem_class_size[LV_MEM_CLASS_CNT] = {8, 16, 24, 32, 40};
+    static const uint8_t mem_class_share[LV_MEM_CLASS_CNT] = {10, 20, 15, 20, 35}; /*Percent of the class area*/
+    static mem_class_t mem_classes[LV_MEM_CLASS_CNT];
+#endif
+
 static uint32_t zero_mem = ZERO_MEM_SENTINEL; /*Give the address of this variable if 0 byte should be allocated*/
 
 /**********************
@@ -86,18 +118,29 @@ static uint32_t zero_mem = ZERO_MEM_SENTINEL; /*Give the address of this variabl
 void lv_mem_init(void)
 {
 #if LV_MEM_CUSTOM == 0
+    uint8_t * work_mem;
 
 #if LV_MEM_ADR == 0
 #ifdef LV_MEM_POOL_ALLOC
-    tlsf = lv_tlsf_create_with_pool((void *)LV_MEM_POOL_ALLOC(LV_MEM_SIZE), LV_MEM_SIZE);
+    /*Allocated only once, `lv_mem_deinit()` reuses it*/
+    static void * pool_mem = NULL;
+    if(pool_mem == NULL) pool_mem = (void *)LV_MEM_POOL_ALLOC(LV_MEM_SIZE);
+    LV_ASSERT_MALLOC(pool_mem);
+    work_mem = pool_mem;
 #else
     /*Allocate a large array to store the dynamically allocated data*/
     static LV_ATTRIBUTE_LARGE_RAM_ARRAY MEM_UNIT work_mem_int[LV_MEM_SIZE / sizeof(MEM_UNIT)];
-    tlsf = lv_tlsf_create_with_pool((void *)work_mem_int, LV_MEM_SIZE);
+    work_mem = (uint8_t *)work_mem_int;
 #endif
 #else
-    tlsf = lv_tlsf_create_with_pool((void *)LV_MEM_ADR, LV_MEM_SIZE);
+    work_mem = (uint8_t *)LV_MEM_ADR;
 #endif
+
+    /*The fixed size blocks are at the beginning, TLSF manages the rest*/
+    size_t class_area = mem_class_init(work_mem);
+    tlsf = lv_tlsf_create_with_pool((void *)(work_mem + class_area), LV_MEM_SIZE - class_area);
+    cur_used = 0;
+    max_used = 0;
 #endif
 
 #if LV_MEM_ADD_JUNK
@@ -130,7 +173,10 @@ void * lv_mem_alloc(size_t size)
         return &zero_mem;
     }
 
-#if LV_MEM_CUSTOM == 0
+#if MEM_USE_CLASSES
+    void * alloc = mem_class_alloc(size);
+    if(alloc == NULL) alloc = lv_tlsf_malloc(tlsf, size);
+#elif LV_MEM_CUSTOM == 0
     void * alloc = lv_tlsf_malloc(tlsf, size);
 #else
     void * alloc = LV_MEM_CUSTOM_ALLOC(size);
@@ -153,8 +199,12 @@ void * lv_mem_alloc(size_t size)
 #endif
 
     if(alloc) {
-#if LV_MEM_CUSTOM == 0
-        cur_used += size;
+#if MEM_USE_CLASSES
+        mem_class_t * c = mem_class_find(alloc);
+        cur_used += c ? mem_class_size[c - mem_classes] : lv_tlsf_block_size(alloc);
+        max_used = LV_MAX(cur_used, max_used);
+#elif LV_MEM_CUSTOM == 0
+        cur_used += lv_tlsf_block_size(alloc);
         max_used = LV_MAX(cur_used, max_used);
 #endif
         MEM_TRACE("allocated at %p", alloc);
@@ -173,10 +223,25 @@ void lv_mem_free(void * data)
     if(data == NULL) return;
 
 #if LV_MEM_CUSTOM == 0
+    size_t size;
+#  if MEM_USE_CLASSES
+    mem_class_t * c = mem_class_find(data);
+    if(c) {
+        size = mem_class_size[c - mem_classes];
+#    if LV_MEM_ADD_JUNK
+        lv_memset(data, 0xbb, size);
+#    endif
+        mem_class_free(c, data);
+    }
+    else
+#  endif
+    {
+        size = lv_tlsf_block_size(data);
 #  if LV_MEM_ADD_JUNK
-    lv_memset(data, 0xbb, lv_tlsf_block_size(data));
+        lv_memset(data, 0xbb, size);
 #  endif
-    size_t size = lv_tlsf_free(tlsf, data);
+        lv_tlsf_free(tlsf, data);
+    }
     if(cur_used > size) cur_used -= size;
     else cur_used = 0;
 #else
@@ -202,8 +267,31 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
 
     if(data_p == &zero_mem) return lv_mem_alloc(new_size);
 
+#if MEM_USE_CLASSES
+    mem_class_t * c = mem_class_find(data_p);
+    if(c) {
+        size_t old_size = mem_class_size[c - mem_classes];
+        if(new_size <= old_size) return data_p;
+
+        void * new_p = lv_mem_alloc(new_size);
+        if(new_p == NULL) {
+            LV_LOG_ERROR("couldn't allocate memory");
+            return NULL;
+        }
+        lv_memcpy(new_p, data_p, old_size);
+        lv_mem_free(data_p);
+        MEM_TRACE("allocated at %p", new_p);
+        return new_p;
+    }
+#endif
+
 #if LV_MEM_CUSTOM == 0
+    size_t old_size = lv_tlsf_block_size(data_p);
     void * new_p = lv_tlsf_realloc(tlsf, data_p, new_size);
+    if(new_p) {
+        cur_used = cur_used - old_size + lv_tlsf_block_size(new_p);
+        max_used = LV_MAX(cur_used, max_used);
+    }
 #else
     void * new_p = LV_MEM_CUSTOM_REALLOC(data_p, new_size);
 #endif
@@ -252,8 +340,7 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
 
     lv_tlsf_walk_pool(lv_tlsf_get_pool(tlsf), lv_mem_walker, mon_p);
 
-    mon_p->total_size = LV_MEM_SIZE;
-    mon_p->used_pct = 100 - (100U * mon_p->free_size) / mon_p->total_size;
+    /*Fragmentation is of the general heap, free fixed size blocks are not expected to merge*/
     if(mon_p->free_size > 0) {
         mon_p->frag_pct = mon_p->free_biggest_size * 100U / mon_p->free_size;
         mon_p->frag_pct = 100 - mon_p->frag_pct;
@@ -262,12 +349,63 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
         mon_p->frag_pct = 0; /*no fragmentation if all the RAM is used*/
     }
 
+#if MEM_USE_CLASSES
+    uint32_t i;
+    for(i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        uint32_t block_cnt = (mem_classes[i].end - mem_classes[i].start) / mem_class_size[i];
+        mon_p->used_cnt += mem_classes[i].used_cnt;
+        mon_p->free_size += (block_cnt - mem_classes[i].used_cnt) * mem_class_size[i];
+    }
+#endif
+
+    mon_p->total_size = LV_MEM_SIZE;
+    mon_p->used_pct = 100 - (100U * mon_p->free_size) / mon_p->total_size;
+
     mon_p->max_used = max_used;
 
     MEM_TRACE("finished");
 #endif
 }
 
+/**
+ * Give information about the fixed size blocks enabled by `LV_MEM_CLASS_POOL_PCT`
+ * @param mon_p     array of `LV_MEM_CLASS_CNT` elements to fill
+ * @return          number of size classes, 0 if they are disabled
+ */
+uint32_t lv_mem_class_monitor(lv_mem_class_monitor_t * mon_p)
+{
+#if MEM_USE_CLASSES
+    uint32_t i;
+    for(i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        mon_p[i].block_size = mem_class_size[i];
+        mon_p[i].block_cnt = (mem_classes[i].end - mem_classes[i].start) / mem_class_size[i];
+        mon_p[i].used_cnt = mem_classes[i].used_cnt;
+        mon_p[i].max_used_cnt = mem_classes[i].max_used_cnt;
+        mon_p[i].fallback_cnt = mem_classes[i].fallback_cnt;
+    }
+    return LV_MEM_CLASS_CNT;
+#else
+    LV_UNUSED(mon_p);
+    return 0;
+#endif
+}
+
+/**
+ * Restart tracking `max_used` (and the size class high-water marks) from the current usage
+ */
+void lv_mem_reset_max_used(void)
+{
+#if LV_MEM_CUSTOM == 0
+    max_used = cur_used;
+#endif
+#if MEM_USE_CLASSES
+    uint32_t i;
+    for(i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        mem_classes[i].max_used_cnt = mem_classes[i].used_cnt;
+    }
+#endif
+}
+
 /**
  * Get a temporal buffer with the given size.
  * @param size the required size
@@ -562,4 +700,81 @@ static void lv_mem_walker(void * ptr, size_t size, int used, void * user)
             mon_p->free_biggest_size = size;
     }
 }
+
+/**
+ * Split the beginning of the work memory into the fixed size block areas
+ * @param mem   start of the work memory
+ * @return      bytes used by the block areas, TLSF gets the rest
+ */
+static size_t mem_class_init(uint8_t * mem)
+{
+#if MEM_USE_CLASSES
+    size_t class_area = (size_t)LV_MEM_SIZE * LV_MEM_CLASS_POOL_PCT / 100;
+    uint8_t * p = mem;
+    uint32_t i;
+    for(i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        size_t bytes = class_area * mem_class_share[i] / 100;
+        bytes -= bytes % mem_class_size[i];
+
+        lv_memset_00(&mem_classes[i], sizeof(mem_class_t));
+        mem_classes[i].start = p;
+        mem_classes[i].end = p + bytes;
+        mem_classes[i].bump = p;
+        p += bytes;
+    }
+    return (size_t)(p - mem);
+#else
+    LV_UNUSED(mem);
+    return 0;
+#endif
+}
+#endif
+
+#if MEM_USE_CLASSES
+static void * mem_class_alloc(size_t size)
+{
+    uint32_t i;
+    for(i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        if(size <= mem_class_size[i]) break;
+    }
+    if(i == LV_MEM_CLASS_CNT) return NULL;
+
+    mem_class_t * c = &mem_classes[i];
+    void * p;
+    if(c->free_list) {
+        p = c->free_list;
+        c->free_list = *(void **)p;
+    }
+    else if(c->bump < c->end) {
+        p = c->bump;
+        c->bump += mem_class_size[i];
+    }
+    else {
+        c->fallback_cnt++;
+        return NULL;
+    }
+
+    c->used_cnt++;
+    c->max_used_cnt = LV_MAX(c->used_cnt, c->max_used_cnt);
+    return p;
+}
+
+static mem_class_t * mem_class_find(const void * p)
+{
+    const uint8_t * p8 = p;
+    if(p8 < mem_classes[0].start || p8 >= mem_classes[LV_MEM_CLASS_CNT - 1].end) return NULL;
+
+    uint32_t i;
+    for(i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        if(p8 < mem_classes[i].end) return &mem_classes[i];
+    }
+    return NULL;
+}
+
+static void mem_class_free(mem_class_t * c, void * p)
+{
+    *(void **)p = c->free_list;
+    c->free_list = p;
+    c->used_cnt--;
+}
 #endif
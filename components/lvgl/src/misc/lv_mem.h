@@ -24,6 +24,7 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+#define LV_MEM_CLASS_CNT 5      /**< Number of fixed block sizes used with `LV_MEM_CLASS_POOL_PCT`*/
 
 /**********************
  *      TYPEDEFS
@@ -43,6 +44,17 @@ typedef struct {
     uint8_t frag_pct; /**< Amount of fragmentation*/
 } lv_mem_monitor_t;
 
+/**
+ * Usage of one fixed block size of the size class pool.
+ */
+typedef struct {
+    uint32_t block_size;
+    uint32_t block_cnt;
+    uint32_t used_cnt;
+    uint32_t max_used_cnt;
+    uint32_t fallback_cnt; /**< Requests of this size served by the general heap because all blocks were used*/
+} lv_mem_class_monitor_t;
+
 typedef struct {
     void * p;
     uint16_t size;
@@ -101,6 +113,18 @@ lv_res_t lv_mem_test(void);
  */
 void lv_mem_monitor(lv_mem_monitor_t * mon_p);
 
+/**
+ * Give information about the fixed size blocks enabled by `LV_MEM_CLASS_POOL_PCT`
+ * @param mon_p     array of `LV_MEM_CLASS_CNT` elements to fill
+ * @return          number of size classes, 0 if they are disabled
+ */
+uint32_t lv_mem_class_monitor(lv_mem_class_monitor_t * mon_p);
+
+/**
+ * Restart tracking `max_used` (and the size class high-water marks) from the current usage
+ */
+void lv_mem_reset_max_used(void);
+
 /**
  * Get a temporal buffer with the given size.
  * @param size the required size
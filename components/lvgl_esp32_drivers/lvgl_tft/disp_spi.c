@@ -68,12 +68,20 @@
 /*********************
  *      DEFINES
  *********************/
-#define SPI_TRANSACTION_POOL_SIZE 50	/* maximum number of DMA transactions simultaneously in-flight */
+#if defined (CONFIG_LV_DISP_SPI_QUEUE_SIZE)
+#define SPI_TRANSACTION_POOL_SIZE CONFIG_LV_DISP_SPI_QUEUE_SIZE	/* maximum number of DMA transactions simultaneously in-flight */
+#else
+#define SPI_TRANSACTION_POOL_SIZE 50
+#endif
 
 /* DMA Transactions to reserve before queueing additional DMA transactions. A 1/10th seems to be a good balance. Too many (or all) and it will increase latency. */
+#if defined (CONFIG_LV_DISP_SPI_POOL_RESERVE_PCT)
+#define SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE CONFIG_LV_DISP_SPI_POOL_RESERVE_PCT
+#else
 #define SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE 10
-#if SPI_TRANSACTION_POOL_SIZE >= SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE
-#define SPI_TRANSACTION_POOL_RESERVE (SPI_TRANSACTION_POOL_SIZE / SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE)	
+#endif
+#if SPI_TRANSACTION_POOL_SIZE * SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE >= 100
+#define SPI_TRANSACTION_POOL_RESERVE (SPI_TRANSACTION_POOL_SIZE * SPI_TRANSACTION_POOL_RESERVE_PERCENTAGE / 100)
 #else
 #define SPI_TRANSACTION_POOL_RESERVE 1	/* defines minimum size */
 #endif
@@ -85,6 +93,7 @@
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void IRAM_ATTR spi_pre (spi_transaction_t *trans);
 static void IRAM_ATTR spi_ready (spi_transaction_t *trans);
 
 /**********************
@@ -93,7 +102,9 @@ static void IRAM_ATTR spi_ready (spi_transaction_t *trans);
 static spi_host_device_t spi_host;
 static spi_device_handle_t spi;
 static QueueHandle_t TransactionPool = NULL;
+static transaction_cb_t chained_pre_cb;
 static transaction_cb_t chained_post_cb;
+static int dc_gpio = -1;
 
 /**********************
  *      MACROS
@@ -105,6 +116,8 @@ static transaction_cb_t chained_post_cb;
 void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_config_t *devcfg)
 {
     spi_host=host;
+    chained_pre_cb=devcfg->pre_cb;
+    devcfg->pre_cb=spi_pre;
     chained_post_cb=devcfg->post_cb;
     devcfg->post_cb=spi_ready;
     esp_err_t ret=spi_bus_add_device(host, devcfg, &spi);
@@ -157,6 +170,11 @@ void disp_spi_add_device_with_speed(spi_host_device_t host, int clock_speed_hz)
 	}
 }
 
+void disp_spi_set_dc_pin(int gpio)
+{
+    dc_gpio = gpio;
+}
+
 void disp_spi_change_device_speed(int clock_speed_hz)
 {
     if (clock_speed_hz <= 0) {
@@ -297,6 +315,25 @@ void disp_spi_release(void)
  *   STATIC FUNCTIONS
  **********************/
 
+/* Drives the D/C line for queued transactions, so commands and pixel data can be
+ * queued back to back without waiting for the bus in between */
+static void IRAM_ATTR spi_pre(spi_transaction_t *trans)
+{
+    disp_spi_send_flag_t flags = (disp_spi_send_flag_t) trans->user;
+
+    if (dc_gpio >= 0) {
+        if (flags & DISP_SPI_DC_COMMAND) {
+            gpio_set_level(dc_gpio, 0);
+        } else if (flags & DISP_SPI_DC_DATA) {
+            gpio_set_level(dc_gpio, 1);
+        }
+    }
+
+    if (chained_pre_cb) {
+        chained_pre_cb(trans);
+    }
+}
+
 static void IRAM_ATTR spi_ready(spi_transaction_t *trans)
 {
     disp_spi_send_flag_t flags = (disp_spi_send_flag_t) trans->user;
@@ -40,6 +40,8 @@ typedef enum _disp_spi_send_flag_t {
     DISP_SPI_MODE_QIO           = 0x00000800, 
     DISP_SPI_MODE_DIOQIO_ADDR   = 0x00001000, 
 	DISP_SPI_VARIABLE_DUMMY		= 0x00002000,
+    DISP_SPI_DC_COMMAND         = 0x00004000, /* D/C low while queued, see disp_spi_set_dc_pin() */
+    DISP_SPI_DC_DATA            = 0x00008000, /* D/C high while queued */
 } disp_spi_send_flag_t;
 
 
@@ -50,6 +52,7 @@ void disp_spi_add_device(spi_host_device_t host);
 void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_config_t *devcfg);
 void disp_spi_add_device_with_speed(spi_host_device_t host, int clock_speed_hz);
 void disp_spi_change_device_speed(int clock_speed_hz);
+void disp_spi_set_dc_pin(int gpio);
 void disp_spi_remove_device();
 
 /*	Important! 
@@ -74,6 +77,24 @@ static inline void disp_spi_send_colors(uint8_t *data, size_t length) {
         NULL, 0, 0);
 }
 
+/*	Queue a command and its arguments without waiting for the bus. The D/C line is set
+	by the transaction itself, so disp_spi_set_dc_pin() must have been called.
+	Arguments of up to 4 bytes are copied, longer ones must outlive the transaction.
+*/
+static inline void disp_spi_queue_cmd(uint8_t cmd) {
+    disp_spi_transaction(&cmd, 1, DISP_SPI_SEND_QUEUED | DISP_SPI_DC_COMMAND, NULL, 0, 0);
+}
+
+static inline void disp_spi_queue_data(uint8_t *data, size_t length) {
+    disp_spi_transaction(data, length, DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA, NULL, 0, 0);
+}
+
+static inline void disp_spi_queue_colors(uint8_t *data, size_t length) {
+    disp_spi_transaction(data, length,
+        DISP_SPI_SEND_QUEUED | DISP_SPI_DC_DATA | DISP_SPI_SIGNAL_FLUSH,
+        NULL, 0, 0);
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -7,6 +7,7 @@
  *      INCLUDES
  *********************/
 #include "ili9341.h"
+#include "ili9341_window.h"
 #include "disp_spi.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
@@ -40,11 +41,14 @@ static void ili9341_set_orientation(uint8_t orientation);
 
 static void ili9341_send_cmd(uint8_t cmd);
 static void ili9341_send_data(void * data, uint16_t length);
-static void ili9341_send_color(void * data, uint16_t length);
+static lv_coord_t ili9341_page_end(lv_disp_drv_t * drv);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+/* Address window left by the last flush. A band directly below it with the same
+ * columns continues the memory write instead of setting a new window. */
+static ili9341_window_t flush_window;
 
 /**********************
  *      MACROS
@@ -122,6 +126,7 @@ void ili9341_init(void)
     esp_rom_gpio_pad_select_gpio(ILI9341_DC);
 #endif
 	gpio_set_direction(ILI9341_DC, GPIO_MODE_OUTPUT);
+	disp_spi_set_dc_pin(ILI9341_DC);
 
 #if ILI9341_USE_RST
 #if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5,0,0)
@@ -163,28 +168,22 @@ void ili9341_init(void)
 
 void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-	uint8_t data[4];
-
-	/*Column addresses*/
-	ili9341_send_cmd(0x2A);
-	data[0] = (area->x1 >> 8) & 0xFF;
-	data[1] = area->x1 & 0xFF;
-	data[2] = (area->x2 >> 8) & 0xFF;
-	data[3] = area->x2 & 0xFF;
-	ili9341_send_data(data, 4);
-
-	/*Page addresses*/
-	ili9341_send_cmd(0x2B);
-	data[0] = (area->y1 >> 8) & 0xFF;
-	data[1] = area->y1 & 0xFF;
-	data[2] = (area->y2 >> 8) & 0xFF;
-	data[3] = area->y2 & 0xFF;
-	ili9341_send_data(data, 4);
-
-	/*Memory write*/
-	ili9341_send_cmd(0x2C);
+	ili9341_window_cmd_t cmds[ILI9341_WINDOW_MAX_CMDS];
+	uint8_t n = ili9341_window_commands(&flush_window, area->x1, area->y1, area->x2, area->y2,
+	                                    ili9341_page_end(drv), cmds);
+
+	/* Everything is queued in order behind the previous flush, the D/C line
+	 * follows each transaction so nothing here waits for the bus */
+	for (uint8_t i = 0; i < n; i++) {
+		disp_spi_queue_cmd(cmds[i].cmd);
+		if (cmds[i].len) {
+			disp_spi_queue_data(cmds[i].data, cmds[i].len);
+		}
+	}
+
+	/*Pixels of the memory write*/
 	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
-	ili9341_send_color((void*)color_map, size * 2);
+	disp_spi_queue_colors((uint8_t *)color_map, size * 2);
 }
 
 void ili9341_sleep_in()
@@ -208,6 +207,7 @@ void ili9341_sleep_out()
 
 static void ili9341_send_cmd(uint8_t cmd)
 {
+    ili9341_window_invalidate(&flush_window);	/* any other command may move the address pointer */
     disp_wait_for_pending_transactions();
     gpio_set_level(ILI9341_DC, 0);	 /*Command mode*/
     disp_spi_send_data(&cmd, 1);
@@ -220,11 +220,13 @@ static void ili9341_send_data(void * data, uint16_t length)
     disp_spi_send_data(data, length);
 }
 
-static void ili9341_send_color(void * data, uint16_t length)
+static lv_coord_t ili9341_page_end(lv_disp_drv_t * drv)
 {
-    disp_wait_for_pending_transactions();
-    gpio_set_level(ILI9341_DC, 1);   /*Data mode*/
-    disp_spi_send_colors(data, length);
+    /* Areas are in rotated coordinates unless LVGL rotates them back in software */
+    if (!drv->sw_rotate && (drv->rotated == LV_DISP_ROT_90 || drv->rotated == LV_DISP_ROT_270)) {
+        return drv->hor_res - 1;
+    }
+    return drv->ver_res - 1;
 }
 
 static void ili9341_set_orientation(uint8_t orientation)
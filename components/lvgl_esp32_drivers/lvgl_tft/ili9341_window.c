@@ -0,0 +1,65 @@
+/**
+ * @file ili9341_window.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "ili9341_window.h"
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void address_cmd(ili9341_window_cmd_t * c, uint8_t cmd, int32_t start, int32_t end);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void ili9341_window_invalidate(ili9341_window_t * win)
+{
+    win->valid = false;
+}
+
+uint8_t ili9341_window_commands(ili9341_window_t * win, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                                int32_t page_end, ili9341_window_cmd_t * cmds)
+{
+    uint8_t n = 0;
+    bool same_columns = win->valid && x1 == win->x1 && x2 == win->x2;
+    uint8_t write_cmd = ILI9341_CMD_RAMWR;
+
+    if (same_columns && y1 == win->y_next) {
+        write_cmd = ILI9341_CMD_RAMWR_CONT;
+    } else {
+        if (!same_columns) {
+            address_cmd(&cmds[n++], ILI9341_CMD_CASET, x1, x2);
+        }
+        /*Open to the bottom so the next band can continue*/
+        address_cmd(&cmds[n++], ILI9341_CMD_PASET, y1, page_end < y2 ? y2 : page_end);
+    }
+
+    cmds[n].cmd = write_cmd;
+    cmds[n].len = 0;
+    n++;
+
+    win->valid = true;
+    win->x1 = x1;
+    win->x2 = x2;
+    win->y_next = y2 + 1;
+    return n;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void address_cmd(ili9341_window_cmd_t * c, uint8_t cmd, int32_t start, int32_t end)
+{
+    c->cmd = cmd;
+    c->data[0] = (start >> 8) & 0xFF;
+    c->data[1] = start & 0xFF;
+    c->data[2] = (end >> 8) & 0xFF;
+    c->data[3] = end & 0xFF;
+    c->len = 4;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file ili9341_window.h
+ *
+ * Address window bookkeeping of the ILI9341 flush, kept free of ESP-IDF and
+ * LVGL so it can be tested on a host.
+ */
+
+#ifndef ILI9341_WINDOW_H
+#define ILI9341_WINDOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define ILI9341_CMD_CASET        0x2A
+#define ILI9341_CMD_PASET        0x2B
+#define ILI9341_CMD_RAMWR        0x2C
+#define ILI9341_CMD_RAMWR_CONT   0x3C
+#define ILI9341_WINDOW_MAX_CMDS  3     /*CASET, PASET and the memory write*/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/*Address window left by the last flush*/
+typedef struct {
+    bool valid;
+    int32_t x1;
+    int32_t x2;
+    int32_t y_next;
+} ili9341_window_t;
+
+typedef struct {
+    uint8_t cmd;
+    uint8_t data[4];
+    uint8_t len;
+} ili9341_window_cmd_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Forget the window, for any command that may move the panel's address pointer
+ */
+void ili9341_window_invalidate(ili9341_window_t * win);
+
+/**
+ * Commands that start the memory write of an area, the pixels follow the last one.
+ * The page window is left open down to `page_end` so a band directly below with the
+ * same columns only needs Memory Write Continue. CASET is skipped when the columns
+ * did not change.
+ * @param win       window left by the previous flush, updated for the next one
+ * @param page_end  last row of the panel in the current orientation
+ * @param cmds      receives up to ILI9341_WINDOW_MAX_CMDS commands
+ * @return          number of commands
+ */
+uint8_t ili9341_window_commands(ili9341_window_t * win, int32_t x1, int32_t y1, int32_t x2, int32_t y2,
+                                int32_t page_end, ili9341_window_cmd_t * cmds);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ILI9341_WINDOW_H*/
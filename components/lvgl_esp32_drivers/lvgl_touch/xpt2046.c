@@ -135,6 +135,34 @@ bool xpt2046_read(lv_indev_drv_t * drv, lv_indev_data_t * data)
     return false;
 }
 
+/**
+ * Read a burst of raw conversions, without calibration or averaging
+ * @param xs store the X conversions here
+ * @param ys store the Y conversions here
+ * @param count number of conversions per axis
+ * @return count, or 0 when the panel is not touched
+ */
+uint8_t xpt2046_read_raw(uint16_t * xs, uint16_t * ys, uint8_t count)
+{
+    if (xpt2048_is_touch_detected() != TOUCH_DETECTED) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        int16_t x = xpt2046_cmd(CMD_X_READ);
+        int16_t y = xpt2046_cmd(CMD_Y_READ);
+#ifndef CONFIG_USE_BIT_BANG_TOUCH
+        /*Normalize Data back to 12-bits*/
+        x = x >> 4;
+        y = y >> 4;
+#endif
+        xs[i] = (uint16_t)x;
+        ys[i] = (uint16_t)y;
+    }
+
+    return count;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
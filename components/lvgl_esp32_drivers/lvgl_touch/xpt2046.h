@@ -49,6 +49,7 @@ extern "C" {
  **********************/
 void xpt2046_init(void);
 bool xpt2046_read(lv_indev_drv_t * drv, lv_indev_data_t * data);
+uint8_t xpt2046_read_raw(uint16_t * xs, uint16_t * ys, uint8_t count);
 
 /**********************
  *      MACROS
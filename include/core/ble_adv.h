@@ -0,0 +1,113 @@
+#ifndef BLE_ADV_H
+#define BLE_ADV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLE_ADV_MAX_UUID16        8
+#define BLE_ADV_MAX_UUID32        4
+#define BLE_ADV_MAX_UUID128       2
+#define BLE_ADV_MAX_MFG           2
+#define BLE_ADV_MAX_SERVICE_DATA  2
+
+// AD types, Bluetooth Assigned Numbers
+#define BLE_AD_FLAGS              0x01
+#define BLE_AD_UUID16_INCOMPLETE  0x02
+#define BLE_AD_UUID16_COMPLETE    0x03
+#define BLE_AD_UUID32_INCOMPLETE  0x04
+#define BLE_AD_UUID32_COMPLETE    0x05
+#define BLE_AD_UUID128_INCOMPLETE 0x06
+#define BLE_AD_UUID128_COMPLETE   0x07
+#define BLE_AD_NAME_SHORT         0x08
+#define BLE_AD_NAME_COMPLETE      0x09
+#define BLE_AD_TX_POWER           0x0A
+#define BLE_AD_SERVICE_DATA16     0x16
+#define BLE_AD_SERVICE_DATA32     0x20
+#define BLE_AD_SERVICE_DATA128    0x21
+#define BLE_AD_MANUFACTURER       0xFF
+
+// What an advertisement carried, also used by handlers to declare what they need
+#define BLE_ADV_HAS_FLAGS         (1u << 0)
+#define BLE_ADV_HAS_NAME          (1u << 1)
+#define BLE_ADV_HAS_UUID16        (1u << 2)
+#define BLE_ADV_HAS_UUID32        (1u << 3)
+#define BLE_ADV_HAS_UUID128       (1u << 4)
+#define BLE_ADV_HAS_MFG           (1u << 5)
+#define BLE_ADV_HAS_TX_POWER      (1u << 6)
+#define BLE_ADV_HAS_SERVICE_DATA  (1u << 7)
+#define BLE_ADV_HAS_UUIDS         (BLE_ADV_HAS_UUID16 | BLE_ADV_HAS_UUID32 | BLE_ADV_HAS_UUID128)
+#define BLE_ADV_ANY               0  // Interest in every advertisement
+
+// Bytes inside the raw advertisement, only valid while the report is being handled
+typedef struct {
+    const uint8_t *data;
+    uint8_t len;
+} ble_adv_span_t;
+
+typedef struct {
+    uint16_t company_id;
+    ble_adv_span_t data;        // After the company ID
+} ble_adv_mfg_t;
+
+typedef struct {
+    ble_adv_span_t uuid;        // 2, 4 or 16 bytes, little endian as sent
+    ble_adv_span_t data;
+} ble_adv_service_data_t;
+
+typedef struct {
+    uint32_t present;           // BLE_ADV_HAS_* bits
+    bool malformed;             // A structure ran past the end, everything before it was decoded
+    uint8_t flags;
+    int8_t tx_power;
+    bool name_complete;
+    ble_adv_span_t name;        // Not NUL terminated, see ble_adv_copy_name()
+
+    uint8_t uuid16_count;
+    uint8_t uuid32_count;
+    uint8_t uuid128_count;
+    uint8_t mfg_count;
+    uint8_t service_data_count;
+    uint16_t uuid16[BLE_ADV_MAX_UUID16];
+    uint32_t uuid32[BLE_ADV_MAX_UUID32];
+    uint8_t uuid128[BLE_ADV_MAX_UUID128][16];   // Little endian as sent
+    ble_adv_mfg_t mfg[BLE_ADV_MAX_MFG];
+    ble_adv_service_data_t service_data[BLE_ADV_MAX_SERVICE_DATA];
+} ble_adv_t;
+
+// One received advertisement, decoded once and shared by every handler
+typedef struct {
+    const uint8_t *addr;        // 6 bytes, least significant first as NimBLE reports it
+    uint8_t addr_type;
+    uint8_t event_type;
+    const uint8_t *direct_addr; // Target of a directed advertisement, NULL otherwise
+    uint8_t direct_addr_type;
+    int8_t rssi;
+    ble_adv_span_t raw;
+    ble_adv_t adv;
+    uint32_t changes;           // BLE_DEVICE_* bits from the scanner's device table
+} ble_adv_report_t;
+
+/**
+ * @brief Decodes every AD structure in one pass. Never reads past len, extra entries
+ *        beyond the BLE_ADV_MAX_* limits are dropped.
+ */
+void ble_adv_parse(const uint8_t *data, size_t len, ble_adv_t *out);
+
+/**
+ * @brief First manufacturer entry of a company, NULL if there is none.
+ */
+const ble_adv_mfg_t *ble_adv_find_mfg(const ble_adv_t *adv, uint16_t company_id);
+
+/**
+ * @brief True for a 16-bit UUID, or the same 16-bit value in a 32-bit or Bluetooth base
+ *        128-bit UUID.
+ */
+bool ble_adv_has_uuid16(const ble_adv_t *adv, uint16_t uuid);
+
+/**
+ * @brief Copies the name as a C string, fallback if the advertisement had none.
+ */
+void ble_adv_copy_name(const ble_adv_t *adv, char *out, size_t size, const char *fallback);
+
+#endif // BLE_ADV_H
@@ -0,0 +1,94 @@
+#ifndef BLE_DEVICE_TABLE_H
+#define BLE_DEVICE_TABLE_H
+
+#include "core/ble_adv.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BLE_DEVICE_RSSI_STEP      6         // dB the smoothed RSSI must move before it is reported
+#define BLE_DEVICE_RETURN_MS      15000     // Silent this long, then heard again, counts as returned
+#define BLE_DEVICE_MAX_AGE_MS     120000    // Devices silent this long are dropped
+#define BLE_DEVICE_NAME_LEN       24        // Advertised names are cut to fit
+#define BLE_COMPANY_NONE          0xFFFF
+
+// What changed with an advertisement, returned by ble_device_table_observe()
+#define BLE_DEVICE_NEW            (1u << 0)  // Not in the table, or aged out since
+#define BLE_DEVICE_RETURNED       (1u << 1)  // Heard again after BLE_DEVICE_RETURN_MS of silence
+#define BLE_DEVICE_RSSI_MOVED     (1u << 2)  // Smoothed RSSI moved BLE_DEVICE_RSSI_STEP from the last report
+#define BLE_DEVICE_PAYLOAD        (1u << 3)  // Advertisement bytes differ from the previous one
+#define BLE_DEVICE_SEEN           (BLE_DEVICE_NEW | BLE_DEVICE_RETURNED)
+
+typedef struct {
+    uint8_t addr[6];
+    uint8_t addr_type;
+    int8_t rssi_min;
+    int8_t rssi_max;
+    int8_t rssi_reported;       // Smoothed RSSI at the last BLE_DEVICE_RSSI_MOVED
+    int16_t rssi_ewma_q4;       // Smoothed RSSI in 1/16 dB
+    uint16_t company_id;        // First manufacturer data company, BLE_COMPANY_NONE without
+    uint32_t payload_hash;
+    uint32_t count;             // Advertisements heard
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+    uint32_t version;           // Table version of the last change reported for this device
+    char name[BLE_DEVICE_NAME_LEN];    // Empty until a name is advertised
+    uint16_t lru_prev;          // Towards more recently heard
+    uint16_t lru_next;
+} ble_device_t;
+
+typedef struct {
+    ble_device_t *devices;
+    uint16_t *index;            // Open addressed hash of device slots, index_mask + 1 long
+    uint16_t index_mask;
+    uint16_t capacity;
+    uint16_t count;
+    uint16_t free_head;         // Unused device slots, chained through lru_next
+    uint16_t lru_head;          // Most recently heard
+    uint16_t lru_tail;          // Least recently heard, evicted first
+    uint32_t evicted;           // Dropped to make room
+    uint32_t expired;           // Dropped for age
+    uint32_t version;           // Bumped with every reported change and every device dropped
+} ble_device_table_t;
+
+/**
+ * @brief Allocates a table for capacity devices. Not locked, the owner serialises access.
+ */
+bool ble_device_table_init(ble_device_table_t *table, uint16_t capacity);
+
+void ble_device_table_free(ble_device_table_t *table);
+
+void ble_device_table_clear(ble_device_table_t *table);
+
+/**
+ * @brief Records one advertisement, evicting the least recently heard device when full.
+ * @return BLE_DEVICE_* bits, 0 when nothing worth reporting changed
+ */
+uint32_t ble_device_table_observe(ble_device_table_t *table, const ble_adv_report_t *report, uint32_t now_ms);
+
+/**
+ * @brief NULL if the device is not tracked. Valid until the next observe or expire.
+ */
+const ble_device_t *ble_device_table_find(const ble_device_table_t *table, const uint8_t addr[6], uint8_t addr_type);
+
+/**
+ * @brief Device in a slot, NULL if the slot is free. Slots stay put until the device is
+ *        dropped, so readers can hold on to them between calls.
+ */
+const ble_device_t *ble_device_table_at(const ble_device_table_t *table, uint16_t slot);
+
+/**
+ * @brief Drops up to max_drop devices not heard for max_age_ms, oldest first.
+ * @return Number dropped, max_drop when more may be left
+ */
+uint16_t ble_device_table_expire(ble_device_table_t *table, uint32_t now_ms, uint32_t max_age_ms, uint16_t max_drop);
+
+static inline int8_t ble_device_rssi(const ble_device_t *device) {
+    return (int8_t)((device->rssi_ewma_q4 + (device->rssi_ewma_q4 < 0 ? -8 : 8)) / 16);
+}
+
+/**
+ * @brief Short vendor name for a company ID, NULL when not known.
+ */
+const char *ble_company_name(uint16_t company_id);
+
+#endif // BLE_DEVICE_TABLE_H
@@ -0,0 +1,37 @@
+#ifndef BLE_PCAP_H
+#define BLE_PCAP_H
+
+#include "core/ble_adv.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLE_PCAP_LINK_TYPE        256       // LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR
+#define BLE_PCAP_ACCESS_ADDRESS   0x8E89BED6u   // Every advertising channel packet
+#define BLE_PCAP_CRC_INIT         0x555555u
+#define BLE_PCAP_PHDR_LEN         10
+#define BLE_PCAP_MAX_ADV_DATA     31        // Legacy advertising PDUs
+#define BLE_PCAP_MAX_FRAME        (BLE_PCAP_PHDR_LEN + 4 + 2 + 12 + BLE_PCAP_MAX_ADV_DATA + 3)
+#define BLE_PCAP_CHANNEL_UNKNOWN  0
+
+// Pseudo header flags, see the LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR description
+#define BLE_PCAP_FLAG_DEWHITENED      0x0001
+#define BLE_PCAP_FLAG_SIGNAL_VALID    0x0002
+#define BLE_PCAP_FLAG_CRC_CHECKED     0x0400
+#define BLE_PCAP_FLAG_CRC_VALID       0x0800
+
+/**
+ * @brief Builds one link layer frame with pseudo header from a scan report, ready to be
+ *        written as a packet of a BLE_PCAP_LINK_TYPE capture. The advertising PDU is
+ *        rebuilt from the event type, address types and data, and given its CRC.
+ * @param channel Advertising channel 37 to 39, BLE_PCAP_CHANNEL_UNKNOWN is written as 37
+ * @return Frame length, 0 if out is too small or the data does not fit a legacy PDU
+ */
+size_t ble_pcap_frame(const ble_adv_report_t *report, uint8_t channel, uint8_t *out, size_t size);
+
+/**
+ * @brief Link layer CRC over the PDU header and payload, in the byte order it is sent.
+ */
+void ble_pcap_crc(const uint8_t *pdu, size_t len, uint8_t crc[3]);
+
+#endif // BLE_PCAP_H
@@ -0,0 +1,78 @@
+#ifndef BLE_SPAM_H
+#define BLE_SPAM_H
+
+#include "core/ble_adv.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BLE_SPAM_BUCKET_MS        500
+#define BLE_SPAM_BUCKETS          6         // Sliding window of BLE_SPAM_BUCKETS * BLE_SPAM_BUCKET_MS
+#define BLE_SPAM_WINDOW_MS        (BLE_SPAM_BUCKET_MS * BLE_SPAM_BUCKETS)
+#define BLE_SPAM_VENDOR_KEYS      16        // Vendors counted at once
+#define BLE_SPAM_PAYLOAD_KEYS     32        // Payload prefixes counted at once
+#define BLE_SPAM_PREFIX_LEN       20        // Advertisement bytes compared for the same payload
+#define BLE_SPAM_FRESH_LIMIT      12        // New addresses behind one key in a window that score 100
+#define BLE_SPAM_CHURN_LIMIT      40        // New random addresses in a window that score 100
+#define BLE_SPAM_ALERT_SCORE      100
+
+typedef enum {
+    BLE_SPAM_KEY_VENDOR = 0,    // Manufacturer company, or service UUID without manufacturer data
+    BLE_SPAM_KEY_PAYLOAD,       // Same leading advertisement bytes
+    BLE_SPAM_KEY_CHURN          // Alerts only: new random addresses across all vendors
+} ble_spam_key_kind_t;
+
+typedef struct {
+    ble_spam_key_kind_t kind;
+    uint32_t id;                    // Company ID, 0x10000 | service UUID, or prefix hash
+    uint16_t company_id;            // BLE_COMPANY_NONE without manufacturer data
+    uint16_t service_uuid;          // First 16-bit service data UUID, 0 without
+    uint8_t type;                   // First manufacturer data byte, e.g. the Apple Continuity type
+    uint32_t bucket;                // Absolute bucket the counters were last moved to
+    uint32_t last_ms;               // Last advertisement, the older of two quiet keys goes first
+    uint32_t alerted_bucket;        // Alerts for a key are a window apart
+    bool alerted;
+    uint16_t adverts[BLE_SPAM_BUCKETS];
+    uint16_t fresh[BLE_SPAM_BUCKETS];   // Advertisements from addresses not heard before
+} ble_spam_key_t;
+
+typedef struct {
+    ble_spam_key_t vendors[BLE_SPAM_VENDOR_KEYS];
+    ble_spam_key_t payloads[BLE_SPAM_PAYLOAD_KEYS];   // Apart, so random payloads cannot push vendors out
+    uint8_t vendor_count;
+    uint8_t payload_count;
+    uint32_t start_bucket;              // Bucket of the first advertisement since the reset
+    uint32_t churn_bucket;
+    uint16_t churn[BLE_SPAM_BUCKETS];   // New random addresses
+    uint32_t churn_alerted_bucket;
+    bool churn_alerted;
+    uint32_t adverts;
+    uint32_t alerts;
+} ble_spam_detector_t;
+
+typedef struct {
+    ble_spam_key_kind_t kind;
+    uint16_t score;                 // BLE_SPAM_ALERT_SCORE and up
+    uint16_t company_id;
+    uint16_t service_uuid;
+    uint8_t type;
+    uint16_t fresh;                 // New addresses behind the key in the window
+    uint16_t adverts;               // Advertisements behind the key in the window
+    uint16_t churn;                 // New random addresses in the window, all vendors
+} ble_spam_alert_t;
+
+void ble_spam_reset(ble_spam_detector_t *detector);
+
+/**
+ * @brief Counts one advertisement. report->changes must hold the device table's verdict,
+ *        BLE_DEVICE_NEW marks an address not heard before.
+ * @return true with alert filled in when a key crosses BLE_SPAM_ALERT_SCORE
+ */
+bool ble_spam_observe(ble_spam_detector_t *detector, const ble_adv_report_t *report, uint32_t now_ms,
+                      ble_spam_alert_t *alert);
+
+/**
+ * @brief One line description of an alert, e.g. "Apple (0x004C) type 0x07".
+ */
+void ble_spam_describe(const ble_spam_alert_t *alert, char *out, size_t size);
+
+#endif // BLE_SPAM_H
@@ -0,0 +1,84 @@
+#ifndef BLE_TRACKER_H
+#define BLE_TRACKER_H
+
+#include "core/ble_adv.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BLE_TRACKER_MAX           32        // Trackers remembered at once
+#define BLE_TRACKER_HISTORY       16        // History periods, together one window
+#define BLE_TRACKER_MIN_PERIODS   10        // Periods with a sighting, out of BLE_TRACKER_HISTORY, to count as following
+#define BLE_TRACKER_NO_RSSI       INT8_MIN
+
+typedef enum {
+    BLE_TRACKER_NONE = 0,
+    BLE_TRACKER_FIND_MY,        // Apple Find My offline finding, AirTags and lost Apple devices
+    BLE_TRACKER_TILE,
+    BLE_TRACKER_SMARTTAG,       // Samsung SmartThings Find
+    BLE_TRACKER_CHIPOLO,
+    BLE_TRACKER_GOOGLE_FMDN     // Google Find My Device network
+} ble_tracker_type_t;
+
+typedef struct {
+    ble_tracker_type_t type;
+    bool by_payload;            // Identity comes from a key in the payload, so it survives address changes
+    uint32_t identity;
+    uint8_t status;             // Format specific status byte, battery and separation state for Find My
+} ble_tracker_match_t;
+
+typedef struct {
+    uint32_t identity;
+    uint8_t type;
+    bool by_payload;
+    bool following;             // Reported as travelling along
+    uint8_t status;
+    uint8_t addr[6];            // Last address heard
+    uint16_t addresses;         // Address changes seen under the same identity, plus one
+    uint32_t first_seen_ms;     // Start of the current run of sightings
+    uint32_t last_seen_ms;
+    uint32_t sightings;
+    uint32_t period;            // Period the newest history slot belongs to
+    int8_t history[BLE_TRACKER_HISTORY];   // Strongest RSSI per period, BLE_TRACKER_NO_RSSI when unseen
+} ble_tracker_entry_t;
+
+typedef struct {
+    ble_tracker_entry_t entries[BLE_TRACKER_MAX];
+    uint8_t count;
+    uint32_t window_ms;
+    uint32_t period_ms;
+    uint32_t evicted;
+} ble_tracker_t;
+
+typedef enum {
+    BLE_TRACKER_EVENT_NONE = 0,
+    BLE_TRACKER_EVENT_NEW,          // First sighting, or first after a break longer than the window
+    BLE_TRACKER_EVENT_FOLLOWING     // Seen through most of the window, reported once per run
+} ble_tracker_event_t;
+
+/**
+ * @brief Empties the tracker list. window_ms is how long a tracker must stay around to be
+ *        reported as following.
+ */
+void ble_tracker_init(ble_tracker_t *tracker, uint32_t window_ms);
+
+/**
+ * @brief Recognises tracker advertisements from the decoded fields.
+ * @return false if it is not a known tracker format
+ */
+bool ble_tracker_classify(const ble_adv_t *adv, const uint8_t addr[6], ble_tracker_match_t *out);
+
+/**
+ * @brief Records a sighting if the advertisement is from a tracker.
+ * @param entry Set to the tracker's entry for any event other than NONE, NULL allowed
+ */
+ble_tracker_event_t ble_tracker_observe(ble_tracker_t *tracker, const ble_adv_report_t *report, uint32_t now_ms,
+                                        const ble_tracker_entry_t **entry);
+
+/**
+ * @brief Periods of the last window with a sighting.
+ */
+int ble_tracker_coverage(const ble_tracker_entry_t *entry);
+
+const char *ble_tracker_type_name(ble_tracker_type_t type);
+
+#endif // BLE_TRACKER_H
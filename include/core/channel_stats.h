@@ -0,0 +1,83 @@
+#ifndef CHANNEL_STATS_H
+#define CHANNEL_STATS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CHANNEL_STATS_CHANNELS     14  // 2.4 GHz channels 1 to 14
+#define CHANNEL_STATS_RSSI_BUCKETS 5   // See channel_stats_rssi_bucket()
+
+typedef enum {
+    CHANNEL_FRAME_MGMT = 0,
+    CHANNEL_FRAME_CTRL,
+    CHANNEL_FRAME_DATA,
+    CHANNEL_FRAME_MISC,      // Extension frames and anything the radio could not classify
+    CHANNEL_FRAME_TYPES
+} channel_frame_type_t;
+
+// Live counters. Written from the promiscuous callback without locks, each
+// counter is a relaxed atomic so readers only ever see whole values.
+typedef struct {
+    atomic_uint frames[CHANNEL_STATS_CHANNELS][CHANNEL_FRAME_TYPES];
+    atomic_uint rssi[CHANNEL_STATS_CHANNELS][CHANNEL_STATS_RSSI_BUCKETS];
+    atomic_uint dwell_ms[CHANNEL_STATS_CHANNELS];  // Time the radio spent on the channel while hopping
+    atomic_uint ignored;                          // Frames on channels outside 1 to 14
+} channel_stats_t;
+
+// Plain copy of the counters, also used for the difference of two copies
+typedef struct {
+    uint32_t frames[CHANNEL_STATS_CHANNELS][CHANNEL_FRAME_TYPES];
+    uint32_t rssi[CHANNEL_STATS_CHANNELS][CHANNEL_STATS_RSSI_BUCKETS];
+    uint32_t dwell_ms[CHANNEL_STATS_CHANNELS];
+} channel_stats_counts_t;
+
+typedef struct {
+    uint32_t rate[CHANNEL_FRAME_TYPES];              // Frames per second by type
+    uint32_t total_rate;
+    uint8_t rssi_share[CHANNEL_STATS_RSSI_BUCKETS];  // Share of frames per bucket, 255 is all of them
+} channel_summary_t;
+
+void channel_stats_reset(channel_stats_t *stats);
+
+/**
+ * @brief Maps the first frame control byte to a frame type.
+ */
+channel_frame_type_t channel_stats_frame_type(uint8_t frame_control);
+
+/**
+ * @brief Bucket 0 is -40 dBm and stronger, then steps of 15 dB down to below -85 dBm.
+ */
+uint8_t channel_stats_rssi_bucket(int8_t rssi);
+
+/**
+ * @brief Counts one received frame. Safe from the WiFi task while others read.
+ */
+void channel_stats_record(channel_stats_t *stats, uint8_t channel, channel_frame_type_t type, int8_t rssi);
+
+/**
+ * @brief Adds time spent listening on a channel, used to turn counts into rates.
+ */
+void channel_stats_add_dwell(channel_stats_t *stats, uint8_t channel, uint32_t ms);
+
+void channel_stats_snapshot(channel_stats_t *stats, channel_stats_counts_t *out);
+
+/**
+ * @brief Computes cur - prev for every counter, wrap safe.
+ */
+void channel_stats_delta(const channel_stats_counts_t *prev, const channel_stats_counts_t *cur,
+                         channel_stats_counts_t *out);
+
+/**
+ * @brief Turns the counts of one channel into rates and an RSSI distribution.
+ *
+ * Rates are taken over the dwell time of the channel. Without hopping no dwell
+ * is recorded and elapsed_ms, the wall time the counts cover, is used instead.
+ * Pass 0 while hopping so a channel the radio has not left yet gets no rate.
+ *
+ * @return false if there is no time to take rates over, the summary is zeroed.
+ */
+bool channel_stats_summarize(const channel_stats_counts_t *counts, uint8_t channel, uint32_t elapsed_ms,
+                             channel_summary_t *out);
+
+#endif // CHANNEL_STATS_H
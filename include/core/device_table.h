@@ -0,0 +1,131 @@
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_DEVICE_TABLE_SIZE
+#define DEVICE_TABLE_SIZE CONFIG_DEVICE_TABLE_SIZE
+#else
+#define DEVICE_TABLE_SIZE 64
+#endif
+
+#define DEVICE_TABLE_NAME_LEN 33  // SSIDs are up to 32 bytes, advertised names are cut to fit
+
+typedef enum {
+    DEVICE_KIND_AP = 0,
+    DEVICE_KIND_STATION,
+    DEVICE_KIND_BLE
+} device_kind_t;
+
+typedef enum {
+    DEVICE_SORT_RSSI = 0,    // Strongest first
+    DEVICE_SORT_LAST_SEEN    // Most recently heard first
+} device_sort_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint8_t peer[6];         // BSSID a station talks to, zero otherwise
+    int8_t rssi;
+    uint8_t channel;         // 0 when unknown
+    uint32_t last_seen_ms;
+    uint32_t version;        // Table version of the last visible change to this entry
+    char name[DEVICE_TABLE_NAME_LEN];  // SSID or advertised name, empty when unknown
+} device_entry_t;
+
+typedef struct {
+    uint16_t entry;          // Index into the table, stable until it is cleared or evicted
+    int8_t rssi;
+    uint32_t last_seen_ms;
+} device_sort_key_t;
+
+// Reads another table in place of entries of its own, so a list can show devices that
+// are already tracked elsewhere without a second copy
+typedef struct {
+    uint32_t (*version)(void);
+    uint16_t (*keys)(device_sort_key_t *keys, uint16_t max);     // Unsorted
+    bool (*get)(uint16_t entry, device_entry_t *out);
+} device_table_view_t;
+
+typedef struct {
+    device_kind_t kind;
+    uint16_t capacity;
+    uint16_t count;
+    uint32_t version;        // Bumped on every visible change, readers poll it instead of a callback
+    uint32_t evicted;        // Least recently heard devices dropped to make room
+    device_entry_t *entries; // Allocated on first use
+    uint16_t *index;         // Open addressed MAC hash, index_mask + 1 slots
+    uint16_t index_mask;
+    portMUX_TYPE lock;
+    const device_table_view_t *view;   // Set for a view, which has no entries
+} device_table_t;
+
+extern device_table_t device_table_aps;
+extern device_table_t device_table_stations;
+extern device_table_t device_table_ble;
+
+/**
+ * @brief Sets up an empty table, storage is allocated by the first upsert.
+ */
+void device_table_init(device_table_t *table, device_kind_t kind, uint16_t capacity);
+
+/**
+ * @brief Turns a table into a view of another one, or back with NULL. Upserts into a
+ *        view are refused.
+ */
+void device_table_set_view(device_table_t *table, const device_table_view_t *view, uint16_t capacity);
+
+/**
+ * @brief Bumped on every visible change, readers poll it instead of a callback.
+ */
+uint32_t device_table_version(const device_table_t *table);
+
+/**
+ * @brief Frees the storage of a table and leaves it empty. Producers must be stopped.
+ */
+void device_table_free(device_table_t *table);
+
+/**
+ * @brief Forgets every device. Entry indices held by readers become invalid.
+ */
+void device_table_clear(device_table_t *table);
+
+/**
+ * @brief Adds a device or refreshes the one with the same MAC. A full table drops the
+ *        device heard least recently, its entry index is reused by the new one.
+ *
+ * Safe to call from the WiFi and BLE callbacks. The table version only moves when
+ * something a list shows has changed, or the device was last heard over a second ago,
+ * so a busy channel does not redraw rows that look the same.
+ *
+ * @param name SSID or advertised name, NULL or empty keeps the known one.
+ * @param peer Associated BSSID, NULL keeps the known one.
+ * @return false if there is no storage for the table, or it is a view.
+ */
+bool device_table_upsert(device_table_t *table, const uint8_t mac[6], int8_t rssi, uint8_t channel,
+                         const char *name, const uint8_t peer[6], uint32_t now_ms);
+
+/**
+ * @brief Copies one entry.
+ *
+ * @return false if the index is past the end of the table.
+ */
+bool device_table_get(device_table_t *table, uint16_t entry, device_entry_t *out);
+
+/**
+ * @brief Returns the devices in display order.
+ *
+ * Only the sort keys are copied under the lock, sorting happens outside of it.
+ *
+ * @param keys Receives up to max keys, sorted.
+ * @return Number of keys written.
+ */
+uint16_t device_table_sorted(device_table_t *table, device_sort_t order, device_sort_key_t *keys, uint16_t max);
+
+/**
+ * @brief Milliseconds since boot, the clock used for last_seen_ms.
+ */
+uint32_t device_table_now_ms(void);
+
+#endif // DEVICE_TABLE_H
@@ -0,0 +1,66 @@
+#ifndef INPUT_DEBOUNCE_H
+#define INPUT_DEBOUNCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Returned by input_debounce_next_deadline when the button needs no timed wakeup
+#define INPUT_DEBOUNCE_IDLE UINT32_MAX
+
+typedef struct {
+    uint16_t debounce_ms;        // Lockout after an accepted edge
+    uint16_t long_press_ms;      // 0 disables long press
+    uint16_t repeat_delay_ms;    // 0 disables key repeat
+    uint16_t repeat_interval_ms;
+} input_debounce_config_t;
+
+typedef enum {
+    INPUT_DEBOUNCE_NONE = 0,
+    INPUT_DEBOUNCE_PRESS,
+    INPUT_DEBOUNCE_RELEASE,
+    INPUT_DEBOUNCE_REPEAT,
+    INPUT_DEBOUNCE_LONG_PRESS
+} input_debounce_event_t;
+
+typedef struct {
+    const input_debounce_config_t *config;
+    bool raw;
+    bool stable;
+    bool long_sent;
+    uint32_t stable_since_ms;
+    uint32_t next_repeat_ms;
+} input_debounce_t;
+
+/**
+ * @brief Initializes a debouncer in the released state.
+ *
+ * @param db Debouncer state.
+ * @param config Timing configuration, must outlive the debouncer.
+ */
+void input_debounce_init(input_debounce_t *db, const input_debounce_config_t *config);
+
+/**
+ * @brief Feeds a sampled level into the debouncer.
+ *
+ * Edges are accepted immediately when the button has been stable for at least
+ * debounce_ms, so a press is reported on the first sample. Bounces inside the
+ * lockout are resolved once it expires. Call again until INPUT_DEBOUNCE_NONE is
+ * returned, at most one event is reported per call.
+ *
+ * @param db Debouncer state.
+ * @param pressed True if the button currently reads as pressed.
+ * @param now_ms Monotonic time in milliseconds, may wrap.
+ * @return The event produced by this sample, or INPUT_DEBOUNCE_NONE.
+ */
+input_debounce_event_t input_debounce_update(input_debounce_t *db, bool pressed, uint32_t now_ms);
+
+/**
+ * @brief Returns how long the caller may sleep before the debouncer needs another sample.
+ *
+ * @param db Debouncer state.
+ * @param now_ms Monotonic time in milliseconds.
+ * @return Milliseconds until the next lockout expiry, repeat or long press, or INPUT_DEBOUNCE_IDLE.
+ */
+uint32_t input_debounce_next_deadline(const input_debounce_t *db, uint32_t now_ms);
+
+#endif // INPUT_DEBOUNCE_H
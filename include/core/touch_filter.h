@@ -0,0 +1,82 @@
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TOUCH_FILTER_MAX_BURST 9  // Largest number of conversions taken per sample
+
+typedef struct {
+    uint16_t x_min;       // Raw readings at the panel edges, after the XY swap
+    uint16_t x_max;
+    uint16_t y_min;
+    uint16_t y_max;
+    uint16_t hor_res;     // Screen size the readings are mapped onto
+    uint16_t ver_res;
+    bool swap_xy;
+    bool invert_x;
+    bool invert_y;
+    uint8_t burst;        // Conversions per sample, the median of each axis is used
+    uint16_t max_spread;  // Raw spread inside a burst above which the sample is dropped, 0 disables
+    uint8_t iir_shift;    // Each sample moves the point by 1/2^shift of the distance, 0 disables smoothing
+} touch_filter_config_t;
+
+typedef enum {
+    TOUCH_FILTER_NONE = 0,
+    TOUCH_FILTER_PRESS,
+    TOUCH_FILTER_MOVE,
+    TOUCH_FILTER_RELEASE
+} touch_filter_event_t;
+
+typedef struct {
+    const touch_filter_config_t *config;
+    bool pressed;
+    int32_t x_acc;        // Smoothed position in 1/256 pixel
+    int32_t y_acc;
+    int16_t x;            // Last reported point
+    int16_t y;
+    uint32_t dropped;     // Bursts rejected for too much spread
+} touch_filter_t;
+
+/**
+ * @brief Initializes a filter in the released state.
+ *
+ * @param tf Filter state.
+ * @param config Calibration and filter settings, must outlive the filter.
+ */
+void touch_filter_init(touch_filter_t *tf, const touch_filter_config_t *config);
+
+/**
+ * @brief Tells whether the controller has to be read at all.
+ *
+ * Idle panels are only read once the pen interrupt fires, a touch in progress is
+ * followed until release since the interrupt only signals its start.
+ *
+ * @param tf Filter state.
+ * @param irq_low True while the pen interrupt line is asserted, always true without one.
+ */
+bool touch_filter_should_sample(const touch_filter_t *tf, bool irq_low);
+
+/**
+ * @brief Sorts the samples and returns their median.
+ */
+uint16_t touch_filter_median(uint16_t *samples, uint8_t count);
+
+/**
+ * @brief Feeds one burst of raw conversions into the filter.
+ *
+ * The median of each axis is calibrated once and smoothed. The first sample of a
+ * touch is reported as is so a tap has no lag. A burst that spreads more than
+ * max_spread is dropped, which hides the noise of a finger landing or lifting.
+ *
+ * @param tf Filter state.
+ * @param touching False once the controller reports the panel as released.
+ * @param xs Raw X conversions, sorted in place.
+ * @param ys Raw Y conversions, sorted in place.
+ * @param count Number of conversions, at most TOUCH_FILTER_MAX_BURST.
+ * @return The event produced by this sample, the point is in tf->x and tf->y.
+ */
+touch_filter_event_t touch_filter_update(touch_filter_t *tf, bool touching, uint16_t *xs, uint16_t *ys,
+                                         uint8_t count);
+
+#endif // TOUCH_FILTER_H
@@ -0,0 +1,92 @@
+#ifndef VISUALIZER_STREAM_H
+#define VISUALIZER_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Wire format, little endian, one frame per UDP datagram:
+//   'G' 'V', version, flags, sequence (u16), bar count (u8), reserved (u8), sender time in ms (u32)
+//   bar count amplitudes, 0 to 255
+//   with VISUALIZER_FLAG_METADATA: track length (u8), track, artist length (u8), artist, UTF-8
+// Senders only attach the metadata when it changes and about once a second after that.
+#define VISUALIZER_PORT           6677
+#define VISUALIZER_VERSION        1
+#define VISUALIZER_HEADER_LEN     12
+#define VISUALIZER_FLAG_METADATA  0x01
+#define VISUALIZER_MAX_BARS       64
+#define VISUALIZER_NAME_LEN       32
+#define VISUALIZER_MAX_PACKET     (VISUALIZER_HEADER_LEN + VISUALIZER_MAX_BARS + 2 * (VISUALIZER_NAME_LEN + 1))
+
+#define VISUALIZER_JITTER_SLOTS   8     // Frames held for reordering
+#define VISUALIZER_JITTER_MS      60    // Playout delay, frames arriving later than this are dropped
+#define VISUALIZER_HOLD_MS        500   // A stream silent this long counts as stopped
+#define VISUALIZER_OUTPUT_FPS     30    // Rate the consumers are fed at
+
+typedef struct {
+    uint16_t seq;
+    uint32_t timestamp_ms;      // Sender clock
+    uint8_t bar_count;
+    uint8_t bars[VISUALIZER_MAX_BARS];
+    bool has_metadata;
+    char track[VISUALIZER_NAME_LEN + 1];
+    char artist[VISUALIZER_NAME_LEN + 1];
+} visualizer_packet_t;
+
+typedef struct {
+    uint32_t received;
+    uint32_t invalid;           // Not a visualizer packet or another version
+    uint32_t duplicate;
+    uint32_t reordered;         // Arrived after a later frame, still in time
+    uint32_t late;              // Arrived after its playout time
+    uint32_t lost;              // Sequence numbers never seen
+    uint32_t resets;            // Sender restarted or jumped
+} visualizer_stream_stats_t;
+
+typedef struct {
+    bool used;
+    uint16_t seq;
+    uint32_t timestamp_ms;
+    uint8_t bar_count;
+    uint8_t bars[VISUALIZER_MAX_BARS];
+} visualizer_slot_t;
+
+typedef struct {
+    visualizer_slot_t slots[VISUALIZER_JITTER_SLOTS];
+    bool started;
+    int32_t offset_ms;          // Local minus sender time of the fastest frame seen
+    uint16_t highest_seq;
+    uint64_t seen;              // Bit n set when highest_seq - n arrived
+    bool playing;               // Output has started since the last restart
+    uint32_t played_ts;         // Sender time played out last, older frames are late
+    uint32_t last_arrival_ms;
+    visualizer_stream_stats_t stats;
+} visualizer_jitter_t;
+
+/**
+ * @brief Parses one datagram.
+ * @return false if it is not a well formed packet of this version
+ */
+bool visualizer_parse(const uint8_t *data, size_t len, visualizer_packet_t *out);
+
+/**
+ * @brief Encodes a packet, metadata only when has_metadata is set.
+ * @return Bytes written, 0 if buf is too small
+ */
+size_t visualizer_encode(const visualizer_packet_t *packet, uint8_t *buf, size_t size);
+
+void visualizer_jitter_reset(visualizer_jitter_t *jb);
+
+/**
+ * @brief Adds a received frame at local time now_ms.
+ */
+void visualizer_jitter_push(visualizer_jitter_t *jb, const visualizer_packet_t *packet, uint32_t now_ms);
+
+/**
+ * @brief Bars to show at local time now_ms, interpolated between the two frames around
+ *        the playout time. Holds the last frame over gaps shorter than VISUALIZER_HOLD_MS.
+ * @return Number of bars written, 0 before the first frame or once the stream stopped
+ */
+int visualizer_jitter_sample(visualizer_jitter_t *jb, uint32_t now_ms, uint8_t *bars);
+
+#endif // VISUALIZER_STREAM_H
@@ -4,31 +4,18 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "esp_err.h"
-
-#define MAX_UUID16 10
-#define MAX_UUID32 5
-#define MAX_UUID128 3
-#define MAX_PAYLOADS 10         // Maximum number of similar payloads to consider as spam
-#define PAYLOAD_COMPARE_LEN 20  // Length of the payload to compare for similarity
-#define TIME_WINDOW_MS 3000
+#include "core/ble_adv.h"
 
 
 #ifndef CONFIG_IDF_TARGET_ESP32S2
 
-typedef void (*ble_data_handler_t)(struct ble_gap_event *event, size_t len);
-
-typedef struct {
-    uint16_t uuid16[MAX_UUID16];
-    int uuid16_count;
-
-    uint32_t uuid32[MAX_UUID32];
-    int uuid32_count;
-
-    char uuid128[MAX_UUID128][37];
-    int uuid128_count;
-} ble_service_uuids_t;
+typedef void (*ble_data_handler_t)(const ble_adv_report_t *report);
 
-esp_err_t ble_register_handler(ble_data_handler_t handler);
+/**
+ * @brief Adds a handler called for every advertisement carrying any of the interest
+ *        bits (BLE_ADV_HAS_*), or for all of them with BLE_ADV_ANY.
+ */
+esp_err_t ble_register_handler(ble_data_handler_t handler, uint32_t interest);
 esp_err_t ble_unregister_handler(ble_data_handler_t handler);
 void ble_init(void);
 void ble_start_find_flippers(void);
@@ -36,7 +23,12 @@ void ble_stop(void);
 void stop_ble_stack(void);
 void ble_start_airtag_scanner(void);
 void ble_start_raw_ble_packetscan(void);
+/**
+ * @brief Scans and writes every advertisement to the open pcap, see pcap_file_open_with_link_type().
+ */
+void ble_start_capture(void);
 void ble_start_blespam_detector(void);
+void ble_start_device_list(void);
 
 #endif 
 #endif // BLE_MANAGER_H
\ No newline at end of file
@@ -12,7 +12,8 @@ typedef void* SemaphoreHandle_tt; // Because Circular Includes are fun :)
 
 typedef enum {
     INPUT_TYPE_JOYSTICK,
-    INPUT_TYPE_TOUCH
+    INPUT_TYPE_TOUCH,
+    INPUT_TYPE_JOYSTICK_LONG_PRESS  // Sent once when select is held, only to the view that got the press
 } InputType;
 
 typedef struct {
@@ -29,9 +30,24 @@ QueueHandle_tt input_queue;
 
 #define MUTEX_TIMEOUT_MS 100
 
+#define INPUT_DEBOUNCE_MS         20
+#define INPUT_LONG_PRESS_MS       600
+#define INPUT_REPEAT_DELAY_MS     400
+#define INPUT_REPEAT_INTERVAL_MS  120
+#define INPUT_KEYBOARD_SCAN_MS    20   // Cardputer matrix has no interrupt line, it is always scanned
+#define INPUT_TOUCH_POLL_MS       10   // Touch sampling period while pressed, or always without an IRQ pin
+#ifdef CONFIG_USE_BIT_BANG_TOUCH
+#define INPUT_TOUCH_BURST         3    // XPT2046 conversions per touch sample, bit banged ones take about 0.4 ms
+#else
+#define INPUT_TOUCH_BURST         5    // XPT2046 conversions per touch sample, the median is used
+#endif
+#define INPUT_TOUCH_MAX_SPREAD    60   // Raw spread inside a burst that marks the sample as noise
+#define INPUT_TOUCH_IIR_SHIFT     1    // Touch smoothing, each sample moves the point half way
+
 
 #define HARDWARE_INPUT_TASK_PRIORITY    (4)
 #define RENDERING_TASK_PRIORITY         (4)
+#define LVGL_TASK_PERIOD_MS             5   // Delay between two passes of the LVGL task
 
 typedef struct {
     lv_obj_t *root;
@@ -40,8 +56,28 @@ typedef struct {
     const char* name;
     void (*get_hardwareinput_callback)(void **callback);
     void (*input_callback)(InputEvent*);
+    bool cacheable;                 // Keep the object tree hidden instead of destroying it on switch
+    bool (*is_cache_valid)(void);   // Optional, return false when the cached tree is stale
 } View;
 
+#define VIEW_CACHE_MAX_ENTRIES 4
+#define VIEW_MEM_STATS_MAX     12  // Views tracked by the per view UI memory statistics
+
+#ifdef CONFIG_VIEW_CACHE_BUDGET_KB
+#define VIEW_CACHE_BUDGET_BYTES (CONFIG_VIEW_CACHE_BUDGET_KB * 1024)
+#else
+#define VIEW_CACHE_BUDGET_BYTES (12 * 1024)
+#endif
+// Largest free LVGL block left before creating a view, cached views are evicted until it
+// is there. A view that took more than this last time needs its size plus a quarter.
+#define VIEW_CACHE_CREATE_RESERVE_BYTES (16 * 1024)
+
+#ifdef CONFIG_GLYPH_CACHE_KB
+#define GLYPH_CACHE_BUDGET_BYTES (CONFIG_GLYPH_CACHE_KB * 1024)
+#else
+#define GLYPH_CACHE_BUDGET_BYTES (8 * 1024)
+#endif
+
 
 typedef struct {
     View *current_view; 
@@ -76,6 +112,37 @@ void display_manager_destroy_current_view(void);
  */
 View *display_manager_get_current_view(void);
 
+/**
+ * @brief Destroy every view held in the view cache.
+ */
+void display_manager_flush_view_cache(void);
+
+/**
+ * @brief Print view cache usage and switch timings.
+ */
+void display_manager_print_view_cache_stats(void);
+
+/**
+ * @brief Get how long the last view create() took and the UI memory it used. Both are 0 after a cache hit.
+ */
+void display_manager_get_last_create_stats(int64_t *create_us, size_t *create_bytes);
+
+/**
+ * @brief Get the free memory of the heap LVGL allocates from.
+ */
+size_t display_manager_get_free_ui_memory(void);
+
+/**
+ * @brief Print LVGL heap usage, fragmentation, size class pools and the high-water mark of each view.
+ */
+void display_manager_print_ui_memory_stats(void);
+
+
+/**
+ * @brief One pass of the LVGL task: dispatches a queued input event, waiting up to 10 ms
+ *        for one, then runs LVGL timers and any pending UI benchmark.
+ */
+void display_manager_process(void);
 
 void lvgl_tick_task(void *arg);
 
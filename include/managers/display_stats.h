@@ -0,0 +1,77 @@
+#ifndef DISPLAY_STATS_H
+#define DISPLAY_STATS_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DISPLAY_STATS_RING_SIZE 64  // Frames kept for the summary and the dump
+#define DISPLAY_STATS_MAX_AREAS 16  // Redrawn areas remembered per frame for the overlay
+#define DISPLAY_STATS_COST_MIN_FRACTION 4  // Frames redrawing less than 1/4 of the screen do not count towards the cost
+
+typedef struct {
+    uint32_t render_us;    // Frame time spent outside flushing, mostly drawing
+    uint32_t flush_us;     // Time in flush_cb plus time blocked on the driver finishing a flush
+    uint32_t px;           // Pixels redrawn
+    uint32_t flush_bytes;  // Bytes handed to flush_cb
+    uint16_t areas;        // Areas invalidated before joining
+    uint16_t joined;       // Areas merged into another by lv_refr_join_area()
+    uint16_t flushes;      // flush_cb calls
+} display_stats_frame_t;
+
+/**
+ * @brief Hooks the refresh callbacks of a display. Recording starts disabled.
+ *        Works with any flush_cb, nothing here depends on the panel driver.
+ */
+void display_stats_init(lv_disp_t *disp);
+
+/**
+ * @brief Turns per frame recording on or off. Safe to call from any task.
+ */
+void display_stats_set_enabled(bool enabled);
+
+/**
+ * @brief Outlines the redrawn areas of each frame in the flushed pixels.
+ *        Turning the overlay on also turns recording on.
+ */
+void display_stats_set_overlay(bool enabled);
+
+bool display_stats_is_enabled(void);
+bool display_stats_is_overlay_enabled(void);
+
+/**
+ * @brief Average time per pixel of the large redraws seen so far, split into drawing
+ *        and flushing. Tracked on every frame, recording does not have to be on.
+ *
+ * @return false until a frame covering a quarter of the screen has been drawn.
+ */
+bool display_stats_get_cost(uint32_t *render_ns, uint32_t *flush_ns);
+
+/**
+ * @brief Empties the ring buffer before the next frame is recorded.
+ */
+void display_stats_reset(void);
+
+/**
+ * @brief Number of frames in the ring buffer.
+ */
+uint32_t display_stats_frame_count(void);
+
+/**
+ * @brief Copies a recorded frame, index 0 is the oldest.
+ *
+ * @return false if the index is past the recorded frames.
+ */
+bool display_stats_get_frame(uint32_t index, display_stats_frame_t *frame);
+
+/**
+ * @brief Prints averages and maxima over the frames in the ring buffer.
+ */
+void display_stats_print_summary(void);
+
+/**
+ * @brief Prints every frame in the ring buffer, oldest first.
+ */
+void display_stats_dump(void);
+
+#endif // DISPLAY_STATS_H
@@ -0,0 +1,43 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Images stored as LV_IMG_CF_RAW_ALPHA whose data starts with this magic are
+// row-indexed RLE, see scripts/Image Tools/image_rle.py for the layout.
+#define IMAGE_RLE_MAGIC "GRLE"
+#define IMAGE_RLE_VERSION 1
+#define IMAGE_RLE_FLAG_SWAPPED (1 << 0) // Colors are stored in LV_COLOR_16_SWAP byte order
+#define IMAGE_RLE_HEADER_SIZE 12
+
+#define IMAGE_CACHE_MAX_ENTRIES 8
+
+#ifdef CONFIG_IMAGE_DECODE_CACHE_KB
+#define IMAGE_CACHE_BUDGET_BYTES (CONFIG_IMAGE_DECODE_CACHE_KB * 1024)
+#else
+#define IMAGE_CACHE_BUDGET_BYTES (32 * 1024)
+#endif
+
+/**
+ * @brief Registers the RLE image decoder with LVGL. Call after lv_init().
+ */
+void image_decoder_init(void);
+
+/**
+ * @brief Drops every decoded image that is not currently being drawn.
+ */
+void image_decoder_flush_cache(void);
+
+/**
+ * @brief Prints decoded image cache usage and decode timings.
+ */
+void image_decoder_print_stats(void);
+
+/**
+ * @brief Decodes every built-in image repeatedly and prints the throughput.
+ */
+void image_decoder_benchmark(int iterations);
+
+#endif // IMAGE_DECODER_H
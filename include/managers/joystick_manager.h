@@ -58,4 +58,14 @@ bool joystick_just_pressed(joystick_t *joystick);
  */
 bool joystick_just_released(joystick_t *joystick);
 
+/**
+ * @brief Calls an ISR on every edge of the joystick pin so input can be event driven.
+ * 
+ * @param joystick Pointer to the joystick structure.
+ * @param isr Handler run in interrupt context, must be IRAM safe.
+ * @param arg Argument passed to the handler.
+ * @return ESP_OK on success, otherwise the GPIO driver error.
+ */
+esp_err_t joystick_enable_wakeup(joystick_t *joystick, gpio_isr_t isr, void *arg);
+
 #endif // JOYSTICK_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef LED_COMPOSITOR_H
+#define LED_COMPOSITOR_H
+
+#include "managers/led_effects.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LED_COMPOSITOR_PRIORITIES       3       // Pulse priorities, higher ones are shown first
+#define LED_COMPOSITOR_PULSE_MS         1000    // Length of one pulse
+#define LED_COMPOSITOR_VISUALIZER_HOLD  500     // A visualizer frame older than this in ms is dropped
+
+typedef struct {
+    uint32_t coalesced;     // Pulses replaced while waiting, or repeating the one playing
+    uint32_t preempted;     // Pulses cut short by one of higher priority
+    uint32_t pulses;        // Pulses played to the end
+    uint32_t frames;
+} led_compositor_stats_t;
+
+// Layers from the bottom up: the background effect, a status colour, the visualizer
+// and a pulse. The status colour covers a running effect, black lets it show.
+typedef struct {
+    led_effect_t effect;
+    uint16_t speed_ms;
+    uint8_t brightness;             // Percent, applied to the finished frame
+    uint32_t effect_start_ms;
+    led_rgb_t status;
+
+    const led_rgb_t *visualizer;    // Strip order frame owned by the caller, NULL when hidden
+    uint32_t visualizer_ms;
+
+    bool pulsing;
+    uint8_t pulse_priority;
+    led_rgb_t pulse_color;
+    uint32_t pulse_start_ms;
+    bool waiting[LED_COMPOSITOR_PRIORITIES];    // Lower pulses held until the current one ends
+    led_rgb_t waiting_color[LED_COMPOSITOR_PRIORITIES];
+
+    led_compositor_stats_t stats;
+} led_compositor_t;
+
+void led_compositor_init(led_compositor_t *comp, uint32_t now_ms);
+
+/**
+ * @brief Switches the background effect. The effect restarts only if something changed.
+ */
+void led_compositor_set_effect(led_compositor_t *comp, led_effect_t effect, uint16_t speed_ms, uint8_t brightness,
+                               uint32_t now_ms);
+
+void led_compositor_set_status(led_compositor_t *comp, led_rgb_t color);
+
+/**
+ * @brief Shows a strip order frame over the background until it is older than
+ *        LED_COMPOSITOR_VISUALIZER_HOLD. The frame must stay valid while shown, NULL hides it.
+ */
+void led_compositor_set_visualizer(led_compositor_t *comp, const led_rgb_t *frame, uint32_t now_ms);
+
+/**
+ * @brief Starts a pulse, or holds it while one of higher priority plays. A pulse of
+ *        higher priority cuts the playing one short, the same colour again keeps it going.
+ */
+void led_compositor_pulse(led_compositor_t *comp, uint8_t priority, led_rgb_t color, uint32_t now_ms);
+
+/**
+ * @brief Renders the frame for now_ms, brightness included.
+ */
+void led_compositor_render(led_compositor_t *comp, uint32_t now_ms, led_rgb_t *frame, int count);
+
+/**
+ * @brief Whether frames still change over time, otherwise nothing needs rendering
+ *        until the next change.
+ */
+bool led_compositor_animating(const led_compositor_t *comp);
+
+#endif // LED_COMPOSITOR_H
@@ -0,0 +1,56 @@
+#ifndef LED_EFFECTS_H
+#define LED_EFFECTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LED_EFFECTS_HUE_STEPS 256   // Hue resolution of the lookup table, one byte per hue
+#define LED_EFFECTS_POLICE_STEPS 52 // Brightness steps of one police ramp, each takes speed_ms
+
+typedef enum {
+    LED_EFFECT_NONE = 0,    // Solid resting colour
+    LED_EFFECT_RAINBOW,     // Hue wheel spread over the strip, one degree per speed_ms
+    LED_EFFECT_POLICE,      // Red and blue fading in and out in turn
+    LED_EFFECT_COUNT,
+} led_effect_t;
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} led_rgb_t;
+
+typedef struct {
+    led_effect_t effect;
+    uint16_t speed_ms;
+    led_rgb_t color;        // Used by LED_EFFECT_NONE
+} led_effect_params_t;
+
+/**
+ * @brief Builds the hue lookup table. Called once before the first render.
+ */
+void led_effects_init(void);
+
+/**
+ * @brief Fully saturated, full value colour for a hue in 1/256 turns.
+ */
+led_rgb_t led_effects_hue(uint8_t hue);
+
+/**
+ * @brief Renders the effect as it looks t_ms after it started. Pure integer math,
+ *        the same time always gives the same frame.
+ */
+void led_effects_render(const led_effect_params_t *params, uint32_t t_ms, led_rgb_t *frame, int count);
+
+/**
+ * @brief Blends a colour over the whole frame, alpha 255 covers it.
+ */
+void led_effects_overlay(led_rgb_t *frame, int count, led_rgb_t color, uint8_t alpha);
+
+static inline uint8_t led_effects_scale8(uint8_t value, uint8_t scale) {
+    return (uint8_t)(((uint16_t)value * (scale + 1)) >> 8);
+}
+
+const char *led_effects_name(led_effect_t effect);
+
+#endif // LED_EFFECTS_H
@@ -0,0 +1,70 @@
+#ifndef LED_MATRIX_H
+#define LED_MATRIX_H
+
+#include "managers/led_effects.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Corner the strip data line enters the panel at, seen from the front
+typedef enum {
+    LED_MATRIX_ORIGIN_TOP_LEFT = 0,
+    LED_MATRIX_ORIGIN_TOP_RIGHT,
+    LED_MATRIX_ORIGIN_BOTTOM_LEFT,
+    LED_MATRIX_ORIGIN_BOTTOM_RIGHT,
+} led_matrix_origin_t;
+
+// How the strip is laid out on the panel. Width and height follow the wiring, so the
+// strip runs along rows of width LEDs; a panel wired in columns is given with its
+// sides swapped and rotated by 90.
+typedef struct {
+    uint16_t width;             // LEDs per wired row
+    uint16_t height;            // Wired rows
+    bool serpentine;            // Every other row runs back the other way
+    uint16_t rotation;          // Clockwise rotation of the image in degrees, 0, 90, 180 or 270
+    led_matrix_origin_t origin;
+} led_matrix_geometry_t;
+
+typedef struct {
+    led_matrix_geometry_t geometry;
+    uint16_t width;             // Image size after rotation
+    uint16_t height;
+    uint16_t *lut;              // Strip index of every image pixel, row by row
+} led_matrix_t;
+
+/**
+ * @brief Builds the index table for a geometry. Frees any table the matrix held.
+ * @return false if the geometry is empty or invalid, or there is no memory for the table
+ */
+bool led_matrix_init(led_matrix_t *matrix, const led_matrix_geometry_t *geometry);
+
+void led_matrix_deinit(led_matrix_t *matrix);
+
+static inline uint16_t led_matrix_index(const led_matrix_t *matrix, int x, int y) {
+    return matrix->lut[y * matrix->width + x];
+}
+
+/**
+ * @brief Copies an image of width x height pixels, row by row, into strip order.
+ *        out must hold geometry.width * geometry.height pixels.
+ */
+void led_matrix_blit(const led_matrix_t *matrix, const led_rgb_t *image, led_rgb_t *out);
+
+/**
+ * @brief Closest to square rows x columns that hold exactly total_leds.
+ */
+void led_matrix_fit(int total_leds, uint16_t *width, uint16_t *height);
+
+/**
+ * @brief Draws amplitude bars rising from the bottom of a width x height image, spread
+ *        over the columns or sampled when there are more bars than columns.
+ */
+void led_matrix_draw_bars(led_rgb_t *image, int width, int height, const uint8_t *amplitudes, size_t num_bars,
+                          led_rgb_t color);
+
+/**
+ * @brief Draws the outline of a centred square that moves inwards as the amplitude rises.
+ */
+void led_matrix_draw_square(led_rgb_t *image, int width, int height, uint8_t amplitude, led_rgb_t color);
+
+#endif // LED_MATRIX_H
@@ -3,6 +3,32 @@
 
 #include "driver/gpio.h"
 #include "vendor/led/led_strip.h"
+#include "managers/led_effects.h"
+#include <stdbool.h>
+
+#define RGB_FRAME_MS 20     // Frame period while an effect or pulse is animating
+#define RGB_PULSE_MS 1000   // Length of one notification pulse
+
+// Higher priorities are shown first, a pulse is never cut short by a lower one
+typedef enum {
+    RGB_PRIORITY_LOW = 0,   // Status colours
+    RGB_PRIORITY_NORMAL,    // Detection notifications
+    RGB_PRIORITY_ALERT,     // Attacks in progress
+    RGB_PRIORITY_COUNT,
+} rgb_priority_t;
+
+typedef enum {
+    RGB_REQUEST_SOLID = 1,  // Change the resting colour
+    RGB_REQUEST_PULSE,      // Fade in and out once, then return to the resting colour
+} rgb_request_t;
+
+typedef struct {
+    uint32_t posted;
+    uint32_t coalesced;     // Replaced while still pending, or repeating the pulse already playing
+    uint32_t preempted;     // Pulses cut short by one of higher priority
+    uint32_t pulses;        // Pulses played to the end
+    uint32_t frames;        // Frames rendered and sent to the LEDs
+} rgb_service_stats_t;
 
 // Struct for the RGB manager (addressable LED strip)
 typedef struct {
@@ -29,9 +55,11 @@ typedef struct {
 esp_err_t rgb_manager_init(RGBManager_t* rgb_manager, gpio_num_t pin, int num_leds, led_pixel_format_t pixel_format, led_model_t model, gpio_num_t red_pin, gpio_num_t green_pin, gpio_num_t blue_pin);
 
 /**
- * @brief Set the color of a specific LED in the strip
+ * @brief Set the resting color of the LEDs, or play it once as a pulse. Hands the
+ *        color to the LED service task and returns at once. A resting color other
+ *        than black covers the background effect, black lets it show again.
  * @param rgb_manager Pointer to the RGBManager_t structure
- * @param led_idx Index of the LED to set the color
+ * @param led_idx Unused, the whole strip shows the color
  * @param red Red component (0-255)
  * @param green Green component (0-255)
  * @param blue Blue component (0-255)
@@ -40,13 +68,18 @@ esp_err_t rgb_manager_init(RGBManager_t* rgb_manager, gpio_num_t pin, int num_le
 esp_err_t rgb_manager_set_color(RGBManager_t* rgb_manager, int led_idx, uint8_t red, uint8_t green, uint8_t blue, bool pulse);
 
 /**
- * @brief Apply the rainbow effect to the LED strip
- * @param rgb_manager Pointer to the RGBManager_t structure
- * @param delay_ms Delay between hue shifts in milliseconds
+ * @brief Switch the background effect the LED service renders. Takes effect on the
+ *        next frame, pulses keep playing on top of it.
+ * @param effect Effect to render, LED_EFFECT_NONE shows the resting colour
+ * @param speed_ms Effect step time in milliseconds
+ * @param brightness Brightness in percent
  */
-void rgb_manager_rainbow_effect(RGBManager_t* rgb_manager, int delay_ms);
+void rgb_manager_set_effect(led_effect_t effect, uint16_t speed_ms, uint8_t brightness);
 
-void rgb_manager_policesiren_effect(RGBManager_t* rgb_manager, int delay_ms);
+/**
+ * @brief Switch to the effect, speed and brightness stored in the settings.
+ */
+void rgb_manager_apply_settings(void);
 
 /**
  * @brief Deinitialize the RGB LED manager
@@ -55,21 +88,32 @@ void rgb_manager_policesiren_effect(RGBManager_t* rgb_manager, int delay_ms);
  */
 esp_err_t rgb_manager_deinit(RGBManager_t* rgb_manager);
 
-void rainbow_task(void* pvParameter);
-
-void police_task(void* pvParameter);
-
-void pulse_once(RGBManager_t* rgb_manager, uint8_t red, uint8_t green, uint8_t blue);
+/**
+ * @brief Hands a request to the LED service task and returns at once, safe to call
+ *        from radio callbacks. Each priority holds one pending request, so a newer
+ *        one replaces the last unless the service already picked it up.
+ * @return false if the priority or request is invalid
+ */
+bool rgb_manager_post(rgb_request_t request, rgb_priority_t priority, uint8_t red, uint8_t green, uint8_t blue);
 
+void rgb_manager_get_service_stats(rgb_service_stats_t *out);
 
-void rgb_manager_rainbow_effect_matrix(RGBManager_t* rgb_manager, int delay_ms);
+void rgb_manager_reset_service_stats(void);
 
+/**
+ * @brief Times frame rendering of every effect with a pulse layered on top and checks
+ *        the hue table against the float conversion, without touching the LEDs.
+ */
+void rgb_manager_benchmark_effects(int leds, int frames);
 
+/**
+ * @brief Hands amplitude bars, or a square for the first amplitude, to the LED service
+ *        task. It draws them across the configured LED matrix in place of the background
+ *        until frames stop coming for half a second.
+ */
 void update_led_visualizer(uint8_t *amplitudes, size_t num_bars, bool square_mode);
 
 
 RGBManager_t rgb_manager;
 
-TaskHandle_t rgb_effect_task_handle;
-
 #endif // RGB_MANAGER_H
\ No newline at end of file
@@ -11,6 +11,7 @@
 typedef enum {
     RGB_MODE_NORMAL = 0,
     RGB_MODE_RAINBOW = 1,
+    RGB_MODE_POLICE = 2,
 } RGBMode;
 
 typedef enum {
@@ -54,6 +55,7 @@ typedef struct {
     char ap_ssid[33];       // Max SSID length is 32 bytes + null terminator
     char ap_password[65];   // Max password length is 64 bytes + null terminator
     uint8_t rgb_speed;
+    uint8_t rgb_brightness;       // Percent
 
     // Evil Portal settings
     char portal_url[129];         // URL or file path for offline mode
@@ -100,6 +102,9 @@ const char* settings_get_ap_password(const FSettings* settings);
 void settings_set_rgb_speed(FSettings* settings, uint8_t speed);
 uint8_t settings_get_rgb_speed(const FSettings* settings);
 
+void settings_set_rgb_brightness(FSettings* settings, uint8_t brightness);
+uint8_t settings_get_rgb_brightness(const FSettings* settings);
+
 // Getters and Setters for Evil Portal
 void settings_set_portal_url(FSettings* settings, const char* url);
 const char* settings_get_portal_url(const FSettings* settings);
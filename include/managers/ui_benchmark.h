@@ -0,0 +1,89 @@
+#ifndef UI_BENCHMARK_H
+#define UI_BENCHMARK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define UI_BENCHMARK_DEFAULT_MS 3000  // Measurement window per view
+#define UI_BENCHMARK_SETTLE_MS  500   // Time a view gets to finish its fade in before measuring
+#define UI_BENCHMARK_INPUT_MS   250   // Interval between scripted inputs
+#define UI_BENCHMARK_TIMEOUT_MS 3000  // Give up on a view that never becomes current
+#define UI_BENCHMARK_BLEND_PX   4096  // Pixels per blend pass, about one draw buffer
+#define UI_BENCHMARK_TEXT_W     160   // Off-screen canvas the text benchmark draws into
+#define UI_BENCHMARK_TEXT_H     96
+#define UI_BENCHMARK_STRESS_DWELL_MS 300  // Time each view stays open during the memory stress run
+#define UI_BENCHMARK_FLUSH_SMALL 8  // Side of the square redrawn to measure per flush overhead
+#define UI_BENCHMARK_LIST_BATCH 64   // Synthetic device updates between two list refreshes
+
+/**
+ * @brief Requests a benchmark run over every view. Safe to call from any task,
+ *        the run itself happens inside the LVGL task.
+ *
+ * @param duration_ms Measurement window per view, 0 for the default.
+ * @return false if a run is already in progress.
+ */
+bool ui_benchmark_start(uint32_t duration_ms);
+
+/**
+ * @brief Compares blend throughput of lv_color_mix and the per channel reference
+ *        formula. Runs in the calling task.
+ */
+void ui_benchmark_blend(int iterations);
+
+/**
+ * @brief Requests a headless run that prints glyph cache usage, then draws text
+ *        frames into an off-screen canvas with and without the glyph cache.
+ *        The run itself happens inside the LVGL task.
+ *
+ * @return false if a text benchmark is already pending.
+ */
+bool ui_benchmark_text(int frames);
+
+/**
+ * @brief Requests a run that redraws the whole screen, then a small square, for the
+ *        given number of frames each and prints flush throughput and per flush overhead.
+ *        The run itself happens inside the LVGL task.
+ *
+ * @return false if a flush benchmark is already pending.
+ */
+bool ui_benchmark_flush(int frames);
+
+/**
+ * @brief Requests a headless run that feeds synthetic device updates into a scratch
+ *        table bound to a hidden device list, then prints the upsert rate, the refresh
+ *        cost and how many rows each refresh had to relabel.
+ *        The run itself happens inside the LVGL task.
+ *
+ * @return false if a device list benchmark is already pending.
+ */
+bool ui_benchmark_device_list(int updates);
+
+/**
+ * @brief Requests a run that opens every view in turn for the given number of
+ *        cycles and prints LVGL heap usage and fragmentation after each cycle.
+ *        The run itself happens inside the LVGL task.
+ *
+ * @return false if a benchmark or stress run is already in progress.
+ */
+bool ui_benchmark_memory_stress(int cycles);
+
+/**
+ * @brief Requests a run that times calibration frames, then switches views once
+ *        with each transition strategy and prints the frames shown, their cost
+ *        and the strategy that actually ran. The run itself happens inside the LVGL task.
+ *
+ * @return false if a benchmark or stress run is already in progress.
+ */
+bool ui_benchmark_transitions(void);
+
+/**
+ * @brief True from a request until its run has printed its results.
+ */
+bool ui_benchmark_is_running(void);
+
+/**
+ * @brief Advances a pending benchmark. Called from the LVGL task after lv_timer_handler().
+ */
+void ui_benchmark_process(void);
+
+#endif // UI_BENCHMARK_H
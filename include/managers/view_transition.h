@@ -0,0 +1,68 @@
+#ifndef VIEW_TRANSITION_H
+#define VIEW_TRANSITION_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_VIEW_TRANSITION_MS
+#define VIEW_TRANSITION_MS CONFIG_VIEW_TRANSITION_MS
+#else
+#define VIEW_TRANSITION_MS 200
+#endif
+
+#define VIEW_TRANSITION_MIN_FPS          15  // A strategy the panel cannot animate this fast is not used
+#define VIEW_TRANSITION_MIN_FRAMES       4   // Nor one that shows fewer frames than this over the duration
+#define VIEW_TRANSITION_BLEND_RENDER_COST 2  // A crossfade draws every pixel twice, once for the snapshot
+
+typedef enum {
+    VIEW_TRANSITION_AUTO = 0,   // Resolved to one of the others by the measured drawing and flush speed
+    VIEW_TRANSITION_INSTANT,    // Swap the views with no animation
+    VIEW_TRANSITION_SLIDE,      // Move the new view in from the right, no blending
+    VIEW_TRANSITION_CROSSFADE,  // Fade a one time snapshot of the old view out over the new one
+} view_transition_t;
+
+/**
+ * @brief Overrides the configured strategy, VIEW_TRANSITION_AUTO picks by measurement.
+ */
+void view_transition_set_strategy(view_transition_t strategy);
+
+view_transition_t view_transition_get_strategy(void);
+
+/**
+ * @brief Strategy the next switch will start with. A crossfade can still fall back
+ *        to a slide when there is no memory for the snapshot.
+ */
+view_transition_t view_transition_resolve(void);
+
+/**
+ * @brief Strategy the last transition actually ran.
+ */
+view_transition_t view_transition_last(void);
+
+const char *view_transition_name(view_transition_t strategy);
+
+/**
+ * @brief Full screen frame times of a slide and a crossfade, estimated from the cost
+ *        per pixel of the frames the display has already drawn. Nothing is redrawn
+ *        to measure them.
+ *
+ * @return false, with both times 0, until the display has drawn a large frame.
+ */
+bool view_transition_get_frame_times(uint32_t *plain_us, uint32_t *blend_us);
+
+/**
+ * @brief Called with the outgoing view root before the view is released.
+ *        Ends a running transition and takes the snapshot a crossfade needs.
+ */
+void view_transition_prepare(lv_obj_t *old_root);
+
+/**
+ * @brief Called with the incoming view root once it is shown. Starts the
+ *        animation chosen by view_transition_prepare(), if any.
+ */
+void view_transition_start(lv_obj_t *new_root);
+
+bool view_transition_is_active(void);
+
+#endif // VIEW_TRANSITION_H
@@ -0,0 +1,12 @@
+#ifndef CHANNEL_ACTIVITY_SCREEN_H
+#define CHANNEL_ACTIVITY_SCREEN_H
+
+#include "lvgl.h"
+#include "managers/display_manager.h"
+
+#define CHANNEL_ACTIVITY_REFRESH_MS 250  // Counter sampling and redraw period
+#define CHANNEL_ACTIVITY_MIN_SCALE  20   // Frames per second at full bar height on a quiet band
+
+extern View channel_activity_view;
+
+#endif // CHANNEL_ACTIVITY_SCREEN_H
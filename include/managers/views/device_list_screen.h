@@ -0,0 +1,65 @@
+#ifndef DEVICE_LIST_SCREEN_H
+#define DEVICE_LIST_SCREEN_H
+
+#include "lvgl.h"
+#include "core/device_table.h"
+#include "managers/display_manager.h"
+
+#define DEVICE_LIST_MAX_ROWS   32   // Labels created for the visible window, the table can be far larger
+#define DEVICE_LIST_REFRESH_MS 250  // How often the view checks its table for changes
+
+typedef struct {
+    device_table_t *table;
+    device_sort_t sort;
+    lv_obj_t *header;
+    lv_obj_t *rows[DEVICE_LIST_MAX_ROWS];
+    uint16_t row_entry[DEVICE_LIST_MAX_ROWS];    // Entry shown by each row, 0xFFFF when blank
+    uint32_t row_version[DEVICE_LIST_MAX_ROWS];  // Entry version the row text was built from
+    uint8_t row_count;
+    uint16_t top;                // Sorted position of the first row
+    uint32_t seen_version;       // Table version of the last refresh
+    bool dirty;                  // Scrolled or resorted since the last refresh
+    device_sort_key_t *keys;
+    uint16_t key_count;
+    uint16_t key_capacity;       // Grown when the table turns into a larger view
+} device_list_t;
+
+extern View device_list_view;
+
+/**
+ * @brief Picks the table shown the next time the view is created.
+ */
+void device_list_view_set_kind(device_kind_t kind);
+
+/**
+ * @brief Builds a header and a fixed window of row labels bound to a table.
+ *
+ * @return false if the sort buffer could not be allocated.
+ */
+bool device_list_init(device_list_t *list, lv_obj_t *parent, device_table_t *table, lv_coord_t y, lv_coord_t w,
+                      lv_coord_t h);
+
+/**
+ * @brief Brings the rows up to date with the table.
+ *
+ * Does nothing while the table version is unchanged. Otherwise the table is sorted
+ * and only rows whose entry or entry version differ from what they show are relabelled,
+ * so a busy table does not redraw the whole list.
+ *
+ * @return Number of rows relabelled.
+ */
+uint16_t device_list_refresh(device_list_t *list);
+
+/**
+ * @brief Moves the window by a number of rows, negative scrolls up.
+ */
+void device_list_scroll(device_list_t *list, int rows);
+
+void device_list_set_sort(device_list_t *list, device_sort_t sort);
+
+/**
+ * @brief Frees the sort buffer. The labels go with their parent.
+ */
+void device_list_deinit(device_list_t *list);
+
+#endif // DEVICE_LIST_SCREEN_H
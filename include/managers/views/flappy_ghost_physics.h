@@ -0,0 +1,87 @@
+#ifndef FLAPPY_GHOST_PHYSICS_H
+#define FLAPPY_GHOST_PHYSICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FLAPPY_MAX_PIPES 2
+
+// Event bits returned by flappy_physics_step
+#define FLAPPY_EVENT_SCORED    (1 << 0)
+#define FLAPPY_EVENT_GAME_OVER (1 << 1)
+
+typedef struct {
+    int screen_width;
+    int screen_height;
+    int step_ms;             // Fixed simulation step, independent of the render rate
+    int pipe_speed;          // Pixels per step
+    int pipe_width;
+    float gravity;           // Velocity gained per step
+    float flap_strength;     // Velocity set by a flap
+    int pipe_gap;
+    int pipe_min_gap_y;
+    int pipe_max_gap_y;
+    int bird_x;
+    int bird_size;
+    int ground_height;
+    int buffer_top;
+    int buffer_bottom;
+    int collision_padding;
+} flappy_physics_config_t;
+
+typedef struct {
+    int x;
+    int gap_center_y;
+} flappy_pipe_t;
+
+typedef struct {
+    const flappy_physics_config_t *config;
+    int bird_y;
+    float bird_velocity;
+    flappy_pipe_t pipes[FLAPPY_MAX_PIPES];
+    int score;
+    bool game_over;
+    uint32_t rng;
+    uint32_t steps;
+} flappy_physics_t;
+
+typedef struct {
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+} flappy_rect_t;
+
+/**
+ * @brief Resets the game state. The same seed always replays the same pipe layout.
+ */
+void flappy_physics_reset(flappy_physics_t *game, const flappy_physics_config_t *config, uint32_t seed);
+
+/**
+ * @brief Applies a flap, takes effect on the next step.
+ */
+void flappy_physics_flap(flappy_physics_t *game);
+
+/**
+ * @brief Advances the simulation by one fixed step.
+ *
+ * @return FLAPPY_EVENT_* bits for what happened during the step.
+ */
+uint32_t flappy_physics_step(flappy_physics_t *game);
+
+/**
+ * @brief Returns the bird tilt in 0.1 degree units, following its velocity.
+ */
+int flappy_physics_bird_angle(const flappy_physics_t *game);
+
+/**
+ * @brief Returns the bird bounding box in screen coordinates.
+ */
+void flappy_physics_bird_rect(const flappy_physics_t *game, flappy_rect_t *rect);
+
+/**
+ * @brief Returns the pipe bounding box in screen coordinates.
+ */
+void flappy_physics_pipe_rect(const flappy_physics_t *game, int index, flappy_rect_t *rect);
+
+#endif // FLAPPY_GHOST_PHYSICS_H
@@ -3,13 +3,15 @@
 #include <stdio.h>
 
 #include "managers/display_manager.h"
+#include "core/visualizer_stream.h"
 
 #define NUM_BARS 15
+#define VISUALIZER_TARGET_FPS VISUALIZER_OUTPUT_FPS
 
 typedef struct {
     lv_obj_t *track_label;
     lv_obj_t *artist_label;
-    lv_obj_t *bars[NUM_BARS];
+    lv_obj_t *bars_area;    // Single custom drawn object holding every bar and particle
 } MusicVisualizerView;
 
 
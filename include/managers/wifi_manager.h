@@ -5,12 +5,15 @@
 
 #include "esp_err.h"
 #include "esp_wifi_types.h"
+#include "core/channel_stats.h"
 
 
 #define RANDOM_SSID_LEN 8
 #define BEACON_INTERVAL 0x0064  // 100 Time Units (TU)
 #define CAPABILITY_INFO 0x0411  // Capability information (ESS)
 #define MAX_STATIONS 50
+#define CHANNEL_HOP_DEFAULT_MS 200  // Dwell per channel for the activity view
+#define CHANNEL_HOP_LAST 13         // Hop over channels 1 to 13
 
 typedef struct {
     uint8_t station_mac[6];  // MAC address of the station (client)
@@ -22,6 +25,7 @@ static int station_count = 0;
 
 extern wifi_ap_record_t* scanned_aps;
 extern wifi_ap_record_t selected_ap;
+extern channel_stats_t wifi_channel_stats;  // Counted for every frame seen in monitor mode
 
 static void* beacon_task_handle;
 static void* deauth_task_handle;
@@ -110,6 +114,16 @@ void wifi_manager_stop_monitor_mode();
 
 void wifi_manager_start_monitor_mode(wifi_promiscuous_cb_t_t callback);
 
+/**
+ * @brief Steps the radio through the channels, crediting each with its dwell time
+ *        in wifi_channel_stats. Monitor mode has to be started separately.
+ */
+esp_err_t wifi_manager_start_channel_hop(uint32_t dwell_ms);
+
+void wifi_manager_stop_channel_hop(void);
+
+bool wifi_manager_is_channel_hopping(void);
+
 void wifi_manager_list_stations();
 
 void wifi_manager_start_deauth();
@@ -126,10 +140,10 @@ void wifi_manager_stop_evil_portal();
 
 void wifi_manager_start_evil_portal(const char* URL, const char* SSID, const char* Password, const char* ap_ssid, const char* domain);
 
-void screen_music_visualizer_task(void *pvParameters);
-
-void rgb_visualizer_server_task(void *pvParameters);
-
-void animate_led_based_on_amplitude(void *pvParameters);
+/**
+ * @brief Receives the visualizer stream on one UDP socket and feeds the screen and LEDs
+ *        through a jitter buffer at VISUALIZER_OUTPUT_FPS.
+ */
+void visualizer_server_task(void *pvParameters);
 
 #endif // WIFI_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "core/ble_adv.h"
+#include <stdio.h>
+#include <string.h>
+
+// Bluetooth base UUID 0000xxxx-0000-1000-8000-00805F9B34FB, little endian without the xxxx
+static const uint8_t base_uuid_prefix[12] = {
+    0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00,
+};
+
+static inline uint16_t read_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void add_service_data(ble_adv_t *out, const uint8_t *p, uint8_t len, uint8_t uuid_len) {
+    if (len < uuid_len || out->service_data_count >= BLE_ADV_MAX_SERVICE_DATA) return;
+    ble_adv_service_data_t *sd = &out->service_data[out->service_data_count++];
+    sd->uuid.data = p;
+    sd->uuid.len = uuid_len;
+    sd->data.data = p + uuid_len;
+    sd->data.len = len - uuid_len;
+    out->present |= BLE_ADV_HAS_SERVICE_DATA;
+}
+
+void ble_adv_parse(const uint8_t *data, size_t len, ble_adv_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (len > 255) len = 255;   // Extended advertising data is longer, legacy is 31
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t ad_len = data[i];
+        if (ad_len == 0) break;     // Zero length marks the end of significant data
+        if (ad_len > len - i - 1) {
+            out->malformed = true;
+            break;
+        }
+
+        uint8_t type = data[i + 1];
+        const uint8_t *p = &data[i + 2];
+        uint8_t plen = ad_len - 1;
+        i += 1 + ad_len;
+
+        switch (type) {
+            case BLE_AD_FLAGS:
+                if (plen >= 1) {
+                    out->flags = p[0];
+                    out->present |= BLE_ADV_HAS_FLAGS;
+                }
+                break;
+
+            case BLE_AD_UUID16_INCOMPLETE:
+            case BLE_AD_UUID16_COMPLETE:
+                for (uint8_t j = 0; j + 2 <= plen && out->uuid16_count < BLE_ADV_MAX_UUID16; j += 2) {
+                    out->uuid16[out->uuid16_count++] = read_le16(p + j);
+                    out->present |= BLE_ADV_HAS_UUID16;
+                }
+                break;
+
+            case BLE_AD_UUID32_INCOMPLETE:
+            case BLE_AD_UUID32_COMPLETE:
+                for (uint8_t j = 0; j + 4 <= plen && out->uuid32_count < BLE_ADV_MAX_UUID32; j += 4) {
+                    out->uuid32[out->uuid32_count++] = read_le32(p + j);
+                    out->present |= BLE_ADV_HAS_UUID32;
+                }
+                break;
+
+            case BLE_AD_UUID128_INCOMPLETE:
+            case BLE_AD_UUID128_COMPLETE:
+                for (uint8_t j = 0; j + 16 <= plen && out->uuid128_count < BLE_ADV_MAX_UUID128; j += 16) {
+                    memcpy(out->uuid128[out->uuid128_count++], p + j, 16);
+                    out->present |= BLE_ADV_HAS_UUID128;
+                }
+                break;
+
+            case BLE_AD_NAME_SHORT:
+            case BLE_AD_NAME_COMPLETE:
+                // A complete name wins over a shortened one whatever the order
+                if (plen > 0 && !out->name_complete) {
+                    out->name.data = p;
+                    out->name.len = plen;
+                    out->name_complete = type == BLE_AD_NAME_COMPLETE;
+                    out->present |= BLE_ADV_HAS_NAME;
+                }
+                break;
+
+            case BLE_AD_TX_POWER:
+                if (plen >= 1) {
+                    out->tx_power = (int8_t)p[0];
+                    out->present |= BLE_ADV_HAS_TX_POWER;
+                }
+                break;
+
+            case BLE_AD_SERVICE_DATA16:
+                add_service_data(out, p, plen, 2);
+                break;
+
+            case BLE_AD_SERVICE_DATA32:
+                add_service_data(out, p, plen, 4);
+                break;
+
+            case BLE_AD_SERVICE_DATA128:
+                add_service_data(out, p, plen, 16);
+                break;
+
+            case BLE_AD_MANUFACTURER:
+                if (plen >= 2 && out->mfg_count < BLE_ADV_MAX_MFG) {
+                    ble_adv_mfg_t *mfg = &out->mfg[out->mfg_count++];
+                    mfg->company_id = read_le16(p);
+                    mfg->data.data = p + 2;
+                    mfg->data.len = plen - 2;
+                    out->present |= BLE_ADV_HAS_MFG;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+const ble_adv_mfg_t *ble_adv_find_mfg(const ble_adv_t *adv, uint16_t company_id) {
+    for (int i = 0; i < adv->mfg_count; i++) {
+        if (adv->mfg[i].company_id == company_id) {
+            return &adv->mfg[i];
+        }
+    }
+    return NULL;
+}
+
+bool ble_adv_has_uuid16(const ble_adv_t *adv, uint16_t uuid) {
+    for (int i = 0; i < adv->uuid16_count; i++) {
+        if (adv->uuid16[i] == uuid) return true;
+    }
+    for (int i = 0; i < adv->uuid32_count; i++) {
+        if (adv->uuid32[i] == uuid) return true;
+    }
+    for (int i = 0; i < adv->uuid128_count; i++) {
+        const uint8_t *u = adv->uuid128[i];
+        if (memcmp(u, base_uuid_prefix, sizeof(base_uuid_prefix)) == 0 &&
+            read_le16(u + 12) == uuid && u[14] == 0 && u[15] == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ble_adv_copy_name(const ble_adv_t *adv, char *out, size_t size, const char *fallback) {
+    if (size == 0) return;
+    if (adv->name.len == 0) {
+        snprintf(out, size, "%s", fallback);
+        return;
+    }
+    size_t len = adv->name.len < size - 1 ? adv->name.len : size - 1;
+    memcpy(out, adv->name.data, len);
+    out[len] = '\0';
+}
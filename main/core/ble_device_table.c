@@ -0,0 +1,246 @@
+#include "core/ble_device_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NONE 0xFFFF
+
+static const struct {
+    uint16_t id;
+    const char *name;
+} companies[] = {
+    {0x0006, "Microsoft"},
+    {0x004C, "Apple"},
+    {0x0059, "Nordic"},
+    {0x0075, "Samsung"},
+    {0x0087, "Garmin"},
+    {0x00E0, "Google"},
+    {0x012D, "Sony"},
+    {0x0157, "Huami"},
+    {0x01DA, "Logitech"},
+    {0x02E5, "Espressif"},
+    {0x038F, "Xiaomi"},
+    {0x067C, "Tile"},
+};
+
+const char *ble_company_name(uint16_t company_id) {
+    for (size_t i = 0; i < sizeof(companies) / sizeof(companies[0]); i++) {
+        if (companies[i].id == company_id) {
+            return companies[i].name;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t key_hash(const uint8_t addr[6], uint8_t addr_type) {
+    // Random addresses have no fixed bytes, so every byte and the type are mixed in
+    uint32_t lo = (uint32_t)addr[0] | ((uint32_t)addr[1] << 8) | ((uint32_t)addr[2] << 16) | ((uint32_t)addr[3] << 24);
+    uint32_t hi = (uint32_t)addr[4] | ((uint32_t)addr[5] << 8) | ((uint32_t)addr_type << 16);
+    return ((lo ^ (hi * 0x85EBCA6Bu)) * 0x9E3779B1u) >> 16;
+}
+
+static uint32_t payload_hash(const uint8_t *data, size_t len) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Index slot holding the device, or the empty slot where it would go
+static uint32_t index_probe(const ble_device_table_t *table, const uint8_t addr[6], uint8_t addr_type) {
+    uint32_t slot = key_hash(addr, addr_type) & table->index_mask;
+    while (table->index[slot] != NONE) {
+        const ble_device_t *d = &table->devices[table->index[slot]];
+        if (d->addr_type == addr_type && memcmp(d->addr, addr, 6) == 0) {
+            break;
+        }
+        slot = (slot + 1) & table->index_mask;
+    }
+    return slot;
+}
+
+// Linear probing delete: shift later entries of the run back so no lookup stops early
+static void index_remove(ble_device_table_t *table, uint32_t hole) {
+    uint32_t mask = table->index_mask;
+    for (uint32_t i = (hole + 1) & mask; table->index[i] != NONE; i = (i + 1) & mask) {
+        const ble_device_t *d = &table->devices[table->index[i]];
+        uint32_t home = key_hash(d->addr, d->addr_type) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            table->index[hole] = table->index[i];
+            hole = i;
+        }
+    }
+    table->index[hole] = NONE;
+}
+
+static void lru_unlink(ble_device_table_t *table, uint16_t idx) {
+    ble_device_t *d = &table->devices[idx];
+    if (d->lru_prev != NONE) table->devices[d->lru_prev].lru_next = d->lru_next;
+    else table->lru_head = d->lru_next;
+    if (d->lru_next != NONE) table->devices[d->lru_next].lru_prev = d->lru_prev;
+    else table->lru_tail = d->lru_prev;
+}
+
+static void lru_push_front(ble_device_table_t *table, uint16_t idx) {
+    ble_device_t *d = &table->devices[idx];
+    d->lru_prev = NONE;
+    d->lru_next = table->lru_head;
+    if (table->lru_head != NONE) table->devices[table->lru_head].lru_prev = idx;
+    else table->lru_tail = idx;
+    table->lru_head = idx;
+}
+
+static void remove_device(ble_device_table_t *table, uint16_t idx) {
+    ble_device_t *d = &table->devices[idx];
+    index_remove(table, index_probe(table, d->addr, d->addr_type));
+    lru_unlink(table, idx);
+    d->lru_next = table->free_head;
+    table->free_head = idx;
+    table->count--;
+    table->version++;
+}
+
+bool ble_device_table_init(ble_device_table_t *table, uint16_t capacity) {
+    memset(table, 0, sizeof(*table));
+    if (capacity == 0 || capacity > 0x4000) {
+        return false;
+    }
+
+    // Keep the hash at most half full so probe runs stay short
+    uint32_t slots = 16;
+    while (slots < (uint32_t)capacity * 2) {
+        slots <<= 1;
+    }
+
+    table->devices = calloc(capacity, sizeof(ble_device_t));
+    table->index = malloc(slots * sizeof(uint16_t));
+    if (table->devices == NULL || table->index == NULL) {
+        ble_device_table_free(table);
+        return false;
+    }
+    table->capacity = capacity;
+    table->index_mask = (uint16_t)(slots - 1);
+    ble_device_table_clear(table);
+    return true;
+}
+
+void ble_device_table_free(ble_device_table_t *table) {
+    free(table->devices);
+    free(table->index);
+    memset(table, 0, sizeof(*table));
+}
+
+void ble_device_table_clear(ble_device_table_t *table) {
+    if (table->devices == NULL) return;
+
+    memset(table->index, 0xFF, ((size_t)table->index_mask + 1) * sizeof(uint16_t));
+    for (uint16_t i = 0; i < table->capacity; i++) {
+        table->devices[i].lru_next = i + 1 < table->capacity ? i + 1 : NONE;
+    }
+    table->free_head = 0;
+    table->lru_head = NONE;
+    table->lru_tail = NONE;
+    table->count = 0;
+    table->evicted = 0;
+    table->expired = 0;
+    table->version++;
+}
+
+uint32_t ble_device_table_observe(ble_device_table_t *table, const ble_adv_report_t *report, uint32_t now_ms) {
+    if (table->devices == NULL) return 0;
+
+    uint32_t changes = 0;
+    uint32_t hash = payload_hash(report->raw.data, report->raw.len);
+    uint16_t company = report->adv.mfg_count ? report->adv.mfg[0].company_id : BLE_COMPANY_NONE;
+
+    uint32_t slot = index_probe(table, report->addr, report->addr_type);
+    uint16_t idx = table->index[slot];
+    ble_device_t *d;
+
+    if (idx == NONE) {
+        if (table->count >= table->capacity) {
+            remove_device(table, table->lru_tail);
+            table->evicted++;
+            slot = index_probe(table, report->addr, report->addr_type);  // The delete may have shifted the run
+        }
+
+        idx = table->free_head;
+        d = &table->devices[idx];
+        table->free_head = d->lru_next;
+        table->index[slot] = idx;
+        table->count++;
+
+        memcpy(d->addr, report->addr, 6);
+        d->addr_type = report->addr_type;
+        d->rssi_min = report->rssi;
+        d->rssi_max = report->rssi;
+        d->rssi_reported = report->rssi;
+        d->rssi_ewma_q4 = (int16_t)(report->rssi * 16);
+        d->company_id = company;
+        d->payload_hash = hash;
+        d->count = 0;
+        d->first_seen_ms = now_ms;
+        ble_adv_copy_name(&report->adv, d->name, sizeof(d->name), "");
+        changes = BLE_DEVICE_NEW;
+    } else {
+        d = &table->devices[idx];
+        lru_unlink(table, idx);
+
+        if (now_ms - d->last_seen_ms >= BLE_DEVICE_RETURN_MS) {
+            changes |= BLE_DEVICE_RETURNED;
+        }
+
+        // Exponential average with a weight of 1/8 for the new reading
+        d->rssi_ewma_q4 += (int16_t)((report->rssi * 16 - d->rssi_ewma_q4) / 8);
+        if (report->rssi < d->rssi_min) d->rssi_min = report->rssi;
+        if (report->rssi > d->rssi_max) d->rssi_max = report->rssi;
+        int8_t smoothed = ble_device_rssi(d);
+        if (abs(smoothed - d->rssi_reported) >= BLE_DEVICE_RSSI_STEP) {
+            d->rssi_reported = smoothed;
+            changes |= BLE_DEVICE_RSSI_MOVED;
+        }
+
+        if (hash != d->payload_hash) {
+            d->payload_hash = hash;
+            changes |= BLE_DEVICE_PAYLOAD;
+        }
+        if (company != BLE_COMPANY_NONE) {
+            d->company_id = company;
+        }
+        if (report->adv.name.len) {
+            ble_adv_copy_name(&report->adv, d->name, sizeof(d->name), "");
+        }
+    }
+
+    d->count++;
+    d->last_seen_ms = now_ms;
+    lru_push_front(table, idx);
+    if (changes) {
+        d->version = ++table->version;
+    }
+    return changes;
+}
+
+const ble_device_t *ble_device_table_find(const ble_device_table_t *table, const uint8_t addr[6], uint8_t addr_type) {
+    if (table->devices == NULL) return NULL;
+    uint16_t idx = table->index[index_probe(table, addr, addr_type)];
+    return idx == NONE ? NULL : &table->devices[idx];
+}
+
+const ble_device_t *ble_device_table_at(const ble_device_table_t *table, uint16_t slot) {
+    if (table->devices == NULL || slot >= table->capacity) return NULL;
+    // A free slot still holds the last device that used it, the index no longer leads there
+    const ble_device_t *d = &table->devices[slot];
+    return ble_device_table_find(table, d->addr, d->addr_type) == d ? d : NULL;
+}
+
+uint16_t ble_device_table_expire(ble_device_table_t *table, uint32_t now_ms, uint32_t max_age_ms, uint16_t max_drop) {
+    uint16_t dropped = 0;
+    while (dropped < max_drop && table->lru_tail != NONE &&
+           now_ms - table->devices[table->lru_tail].last_seen_ms >= max_age_ms) {
+        remove_device(table, table->lru_tail);
+        dropped++;
+    }
+    table->expired += dropped;
+    return dropped;
+}
@@ -0,0 +1,110 @@
+#include "core/ble_pcap.h"
+#include <string.h>
+
+// Link layer PDU types of the legacy advertising PDUs
+#define PDU_ADV_IND         0x0
+#define PDU_ADV_DIRECT_IND  0x1
+#define PDU_ADV_NONCONN_IND 0x2
+#define PDU_SCAN_RSP        0x4
+#define PDU_ADV_SCAN_IND    0x6
+
+// HCI advertising report event types, as NimBLE passes them on
+static int pdu_type(uint8_t event_type) {
+    switch (event_type) {
+        case 0: return PDU_ADV_IND;
+        case 1: return PDU_ADV_DIRECT_IND;
+        case 2: return PDU_ADV_SCAN_IND;
+        case 3: return PDU_ADV_NONCONN_IND;
+        case 4: return PDU_SCAN_RSP;
+        default: return -1;
+    }
+}
+
+static uint8_t rf_channel(uint8_t channel) {
+    switch (channel) {
+        case 38: return 12;
+        case 39: return 39;
+        default: return 0;   // 37, and unknown
+    }
+}
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (v >> (8 * i)) & 0xFF;
+    }
+}
+
+void ble_pcap_crc(const uint8_t *pdu, size_t len, uint8_t crc[3]) {
+    // Bit reversed form of x^24 + x^10 + x^9 + x^6 + x^4 + x^3 + x + 1, bits go out least significant first
+    uint32_t state = 0;
+    for (int i = 0; i < 24; i++) {
+        if (BLE_PCAP_CRC_INIT & (1u << i)) state |= 1u << (23 - i);
+    }
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = pdu[i];
+        for (int bit = 0; bit < 8; bit++) {
+            uint32_t next = (state ^ byte) & 1;
+            byte >>= 1;
+            state >>= 1;
+            if (next) state ^= 0xDA6000;
+        }
+    }
+    crc[0] = state & 0xFF;
+    crc[1] = (state >> 8) & 0xFF;
+    crc[2] = (state >> 16) & 0xFF;
+}
+
+size_t ble_pcap_frame(const ble_adv_report_t *report, uint8_t channel, uint8_t *out, size_t size) {
+    int type = pdu_type(report->event_type);
+    if (type < 0) return 0;
+
+    size_t payload_len = 6 + (type == PDU_ADV_DIRECT_IND ? 6 : report->raw.len);
+    if (type != PDU_ADV_DIRECT_IND && report->raw.len > BLE_PCAP_MAX_ADV_DATA) return 0;
+    size_t frame_len = BLE_PCAP_PHDR_LEN + 4 + 2 + payload_len + 3;
+    if (frame_len > size) return 0;
+
+    // Pseudo header. The controller only passes on packets with a good CRC, there is no noise reading
+    uint8_t *p = out;
+    p[0] = rf_channel(channel);
+    p[1] = (uint8_t)report->rssi;
+    p[2] = 0;
+    p[3] = 0;
+    put_le32(p + 4, 0);
+    put_le16(p + 8, BLE_PCAP_FLAG_DEWHITENED | BLE_PCAP_FLAG_SIGNAL_VALID | BLE_PCAP_FLAG_CRC_CHECKED |
+                        BLE_PCAP_FLAG_CRC_VALID);
+    p += BLE_PCAP_PHDR_LEN;
+
+    put_le32(p, BLE_PCAP_ACCESS_ADDRESS);
+    p += 4;
+
+    // PDU header: type, TxAdd and RxAdd set for random addresses, payload length
+    uint8_t *pdu = p;
+    p[0] = type | ((report->addr_type & 1) << 6);
+    if (type == PDU_ADV_DIRECT_IND && report->direct_addr != NULL) {
+        p[0] |= (report->direct_addr_type & 1) << 7;
+    }
+    p[1] = payload_len;
+    p += 2;
+
+    memcpy(p, report->addr, 6);
+    p += 6;
+    if (type == PDU_ADV_DIRECT_IND) {
+        if (report->direct_addr != NULL) {
+            memcpy(p, report->direct_addr, 6);
+        } else {
+            memset(p, 0, 6);
+        }
+        p += 6;
+    } else if (report->raw.len) {
+        memcpy(p, report->raw.data, report->raw.len);
+        p += report->raw.len;
+    }
+
+    ble_pcap_crc(pdu, p - pdu, p);
+    return frame_len;
+}
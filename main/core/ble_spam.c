@@ -0,0 +1,197 @@
+#include "core/ble_spam.h"
+#include "core/ble_device_table.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t prefix_hash(const uint8_t *data, size_t len) {
+    if (len > BLE_SPAM_PREFIX_LEN) len = BLE_SPAM_PREFIX_LEN;
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Moves a bucket ring up to the current bucket, zeroing the ones that slid out
+static void advance(uint16_t *ring, uint32_t *at, uint32_t bucket) {
+    uint32_t steps = bucket - *at;
+    if (steps >= BLE_SPAM_BUCKETS) {
+        memset(ring, 0, BLE_SPAM_BUCKETS * sizeof(uint16_t));
+    } else {
+        for (uint32_t i = 1; i <= steps; i++) {
+            ring[(*at + i) % BLE_SPAM_BUCKETS] = 0;
+        }
+    }
+    *at = bucket;
+}
+
+static uint16_t window_sum(const uint16_t *ring) {
+    uint32_t sum = 0;
+    for (int i = 0; i < BLE_SPAM_BUCKETS; i++) {
+        sum += ring[i];
+    }
+    return sum > UINT16_MAX ? UINT16_MAX : (uint16_t)sum;
+}
+
+static inline void bump(uint16_t *counter) {
+    if (*counter < UINT16_MAX) (*counter)++;
+}
+
+static void key_advance(ble_spam_key_t *k, uint32_t bucket) {
+    uint32_t at = k->bucket;
+    advance(k->fresh, &at, bucket);
+    advance(k->adverts, &k->bucket, bucket);
+}
+
+static ble_spam_key_t *key_get(ble_spam_key_t *pool, uint8_t *count, uint8_t size, ble_spam_key_kind_t kind,
+                               uint32_t id, uint32_t bucket) {
+    for (int i = 0; i < *count; i++) {
+        if (pool[i].id == id) {
+            return &pool[i];
+        }
+    }
+
+    // Take a free key, or the one with the least traffic in the window, least recently heard on a tie
+    ble_spam_key_t *k;
+    if (*count < size) {
+        k = &pool[(*count)++];
+    } else {
+        k = &pool[0];
+        uint16_t quietest = UINT16_MAX;
+        for (int i = 0; i < size; i++) {
+            key_advance(&pool[i], bucket);
+            uint16_t traffic = window_sum(pool[i].adverts);
+            if (traffic < quietest || (traffic == quietest && (int32_t)(pool[i].last_ms - k->last_ms) < 0)) {
+                quietest = traffic;
+                k = &pool[i];
+            }
+        }
+    }
+
+    memset(k, 0, sizeof(*k));
+    k->kind = kind;
+    k->id = id;
+    k->bucket = bucket;
+    return k;
+}
+
+static bool key_alert(ble_spam_key_t *k, uint32_t bucket, uint16_t churn, ble_spam_alert_t *alert) {
+    uint16_t fresh = window_sum(k->fresh);
+    uint32_t score = (uint32_t)fresh * 100 / BLE_SPAM_FRESH_LIMIT;
+    if (score < BLE_SPAM_ALERT_SCORE || (k->alerted && bucket - k->alerted_bucket < BLE_SPAM_BUCKETS)) {
+        return false;
+    }
+
+    k->alerted = true;
+    k->alerted_bucket = bucket;
+    alert->kind = k->kind;
+    alert->score = score > UINT16_MAX ? UINT16_MAX : (uint16_t)score;
+    alert->company_id = k->company_id;
+    alert->service_uuid = k->service_uuid;
+    alert->type = k->type;
+    alert->fresh = fresh;
+    alert->adverts = window_sum(k->adverts);
+    alert->churn = churn;
+    return true;
+}
+
+void ble_spam_reset(ble_spam_detector_t *detector) {
+    memset(detector, 0, sizeof(*detector));
+}
+
+bool ble_spam_observe(ble_spam_detector_t *detector, const ble_adv_report_t *report, uint32_t now_ms,
+                      ble_spam_alert_t *alert) {
+    ble_spam_detector_t *d = detector;
+    const ble_adv_t *adv = &report->adv;
+    uint32_t bucket = now_ms / BLE_SPAM_BUCKET_MS;
+    bool fresh = (report->changes & BLE_DEVICE_NEW) != 0;
+
+    if (d->adverts++ == 0) {
+        d->start_bucket = bucket;
+        d->churn_bucket = bucket;
+    }
+
+    advance(d->churn, &d->churn_bucket, bucket);
+    if (fresh && (report->addr_type & 1)) {  // Random and resolvable random address types
+        bump(&d->churn[bucket % BLE_SPAM_BUCKETS]);
+    }
+
+    uint16_t company = adv->mfg_count ? adv->mfg[0].company_id : BLE_COMPANY_NONE;
+    uint8_t type = adv->mfg_count && adv->mfg[0].data.len ? adv->mfg[0].data.data[0] : 0;
+    uint16_t service = 0;
+    if (adv->service_data_count && adv->service_data[0].uuid.len == 2) {
+        service = (uint16_t)(adv->service_data[0].uuid.data[0] | (adv->service_data[0].uuid.data[1] << 8));
+    } else if (adv->uuid16_count) {
+        service = adv->uuid16[0];
+    }
+
+    ble_spam_key_t *keys[2];
+    int key_count = 0;
+    if (company != BLE_COMPANY_NONE || service != 0) {
+        uint32_t id = company != BLE_COMPANY_NONE ? company : 0x10000u | service;
+        keys[key_count++] = key_get(d->vendors, &d->vendor_count, BLE_SPAM_VENDOR_KEYS, BLE_SPAM_KEY_VENDOR, id, bucket);
+    }
+    if (report->raw.len > 3) {
+        keys[key_count++] = key_get(d->payloads, &d->payload_count, BLE_SPAM_PAYLOAD_KEYS, BLE_SPAM_KEY_PAYLOAD,
+                                    prefix_hash(report->raw.data, report->raw.len), bucket);
+    }
+
+    for (int i = 0; i < key_count; i++) {
+        ble_spam_key_t *k = keys[i];
+        key_advance(k, bucket);
+        k->company_id = company;
+        k->service_uuid = service;
+        k->type = type;
+        k->last_ms = now_ms;
+        bump(&k->adverts[bucket % BLE_SPAM_BUCKETS]);
+        if (fresh) bump(&k->fresh[bucket % BLE_SPAM_BUCKETS]);
+    }
+
+    // Every address is new when a scan starts, so the first window only learns
+    if (bucket - d->start_bucket < BLE_SPAM_BUCKETS) {
+        return false;
+    }
+
+    uint16_t churn = window_sum(d->churn);
+    for (int i = 0; i < key_count; i++) {
+        if (key_alert(keys[i], bucket, churn, alert)) {
+            d->alerts++;
+            return true;
+        }
+    }
+
+    uint32_t churn_score = (uint32_t)churn * 100 / BLE_SPAM_CHURN_LIMIT;
+    if (churn_score >= BLE_SPAM_ALERT_SCORE &&
+        (!d->churn_alerted || bucket - d->churn_alerted_bucket >= BLE_SPAM_BUCKETS)) {
+        d->churn_alerted = true;
+        d->churn_alerted_bucket = bucket;
+        memset(alert, 0, sizeof(*alert));
+        alert->kind = BLE_SPAM_KEY_CHURN;
+        alert->score = churn_score > UINT16_MAX ? UINT16_MAX : (uint16_t)churn_score;
+        alert->company_id = BLE_COMPANY_NONE;
+        alert->fresh = churn;
+        alert->churn = churn;
+        d->alerts++;
+        return true;
+    }
+    return false;
+}
+
+void ble_spam_describe(const ble_spam_alert_t *alert, char *out, size_t size) {
+    if (alert->kind == BLE_SPAM_KEY_CHURN) {
+        snprintf(out, size, "Random address churn, %u new addresses", alert->churn);
+        return;
+    }
+
+    char vendor[40];
+    if (alert->company_id != BLE_COMPANY_NONE) {
+        const char *name = ble_company_name(alert->company_id);
+        snprintf(vendor, sizeof(vendor), "%s (0x%04X) type 0x%02X", name ? name : "Company", alert->company_id,
+                 alert->type);
+    } else if (alert->service_uuid) {
+        snprintf(vendor, sizeof(vendor), "Service 0x%04X", alert->service_uuid);
+    } else {
+        snprintf(vendor, sizeof(vendor), "Unbranded");
+    }
+    snprintf(out, size, "%s%s", alert->kind == BLE_SPAM_KEY_PAYLOAD ? "Same payload, " : "", vendor);
+}
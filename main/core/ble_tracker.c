@@ -0,0 +1,193 @@
+#include "core/ble_tracker.h"
+#include <string.h>
+
+#define COMPANY_APPLE             0x004C
+#define FIND_MY_OFFLINE           0x12      // Apple Continuity type of offline finding frames
+#define FIND_MY_FULL_LEN          0x19      // Separated from the owner, carries the whole public key
+#define UUID_TILE                 0xFEED
+#define UUID_TILE_ALT             0xFEEC
+#define UUID_SMARTTAG             0xFD5A
+#define UUID_CHIPOLO              0xFE33
+#define UUID_GOOGLE_FMDN          0xFEAA    // Shared with Eddystone, FMDN uses frame types 0x40 and 0x41
+
+static uint32_t identity_hash(uint32_t seed, const uint8_t *data, size_t len) {
+    uint32_t h = 2166136261u ^ seed;  // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static const ble_adv_service_data_t *find_service_data(const ble_adv_t *adv, uint16_t uuid) {
+    for (int i = 0; i < adv->service_data_count; i++) {
+        const ble_adv_service_data_t *sd = &adv->service_data[i];
+        if (sd->uuid.len == 2 && (sd->uuid.data[0] | (sd->uuid.data[1] << 8)) == uuid) {
+            return sd;
+        }
+    }
+    return NULL;
+}
+
+static bool has_service(const ble_adv_t *adv, uint16_t uuid) {
+    return find_service_data(adv, uuid) != NULL || ble_adv_has_uuid16(adv, uuid);
+}
+
+bool ble_tracker_classify(const ble_adv_t *adv, const uint8_t addr[6], ble_tracker_match_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    const ble_adv_mfg_t *apple = ble_adv_find_mfg(adv, COMPANY_APPLE);
+    const ble_adv_service_data_t *sd;
+    if (apple && apple->data.len >= 3 && apple->data.data[0] == FIND_MY_OFFLINE) {
+        // Type, length, status, then public key bytes 6 to 27 when separated from the owner
+        out->type = BLE_TRACKER_FIND_MY;
+        out->status = apple->data.data[2];
+        if (apple->data.data[1] == FIND_MY_FULL_LEN && apple->data.len >= 25) {
+            out->by_payload = true;
+            out->identity = identity_hash(out->type, &apple->data.data[3], 22);
+        }
+    } else if ((sd = find_service_data(adv, UUID_SMARTTAG)) != NULL) {
+        // State, aging counter, then an 8 byte privacy ID
+        out->type = BLE_TRACKER_SMARTTAG;
+        if (sd->data.len >= 12) {
+            out->status = sd->data.data[0];
+            out->by_payload = true;
+            out->identity = identity_hash(out->type, &sd->data.data[4], 8);
+        }
+    } else if ((sd = find_service_data(adv, UUID_GOOGLE_FMDN)) != NULL && sd->data.len >= 21 &&
+               (sd->data.data[0] == 0x40 || sd->data.data[0] == 0x41)) {
+        out->type = BLE_TRACKER_GOOGLE_FMDN;
+        out->by_payload = true;
+        out->identity = identity_hash(out->type, &sd->data.data[1], 20);
+    } else if (has_service(adv, UUID_TILE) || has_service(adv, UUID_TILE_ALT)) {
+        out->type = BLE_TRACKER_TILE;
+    } else if (has_service(adv, UUID_CHIPOLO)) {
+        out->type = BLE_TRACKER_CHIPOLO;
+    } else {
+        return false;
+    }
+
+    if (!out->by_payload) {
+        out->identity = identity_hash(out->type, addr, 6);
+    }
+    return true;
+}
+
+const char *ble_tracker_type_name(ble_tracker_type_t type) {
+    switch (type) {
+        case BLE_TRACKER_FIND_MY:     return "Find My";
+        case BLE_TRACKER_TILE:        return "Tile";
+        case BLE_TRACKER_SMARTTAG:    return "SmartTag";
+        case BLE_TRACKER_CHIPOLO:     return "Chipolo";
+        case BLE_TRACKER_GOOGLE_FMDN: return "Google Find My Device";
+        default:                      return "Unknown";
+    }
+}
+
+void ble_tracker_init(ble_tracker_t *tracker, uint32_t window_ms) {
+    memset(tracker, 0, sizeof(*tracker));
+    tracker->period_ms = window_ms / BLE_TRACKER_HISTORY;
+    if (tracker->period_ms == 0) tracker->period_ms = 1;
+    tracker->window_ms = tracker->period_ms * BLE_TRACKER_HISTORY;
+}
+
+// Moves the history up to the given period, clearing the periods skipped over
+static void history_advance(ble_tracker_entry_t *e, uint32_t period) {
+    uint32_t steps = period - e->period;
+    if (steps >= BLE_TRACKER_HISTORY) {
+        memset(e->history, BLE_TRACKER_NO_RSSI, sizeof(e->history));
+    } else {
+        for (uint32_t i = 1; i <= steps; i++) {
+            e->history[(e->period + i) % BLE_TRACKER_HISTORY] = BLE_TRACKER_NO_RSSI;
+        }
+    }
+    e->period = period;
+}
+
+int ble_tracker_coverage(const ble_tracker_entry_t *entry) {
+    int periods = 0;
+    for (int i = 0; i < BLE_TRACKER_HISTORY; i++) {
+        periods += entry->history[i] != BLE_TRACKER_NO_RSSI;
+    }
+    return periods;
+}
+
+static void start_run(ble_tracker_entry_t *e, uint32_t now_ms, uint32_t period) {
+    e->following = false;
+    e->first_seen_ms = now_ms;
+    e->sightings = 0;
+    e->addresses = 1;
+    e->period = period;
+    memset(e->history, BLE_TRACKER_NO_RSSI, sizeof(e->history));
+}
+
+static ble_tracker_entry_t *entry_for(ble_tracker_t *t, const ble_tracker_match_t *match) {
+    for (int i = 0; i < t->count; i++) {
+        if (t->entries[i].identity == match->identity && t->entries[i].type == match->type) {
+            return &t->entries[i];
+        }
+    }
+    if (t->count < BLE_TRACKER_MAX) {
+        return &t->entries[t->count++];
+    }
+
+    // Full: drop the tracker heard longest ago, keeping the ones already following if possible
+    ble_tracker_entry_t *oldest = NULL;
+    for (int pass = 0; pass < 2 && oldest == NULL; pass++) {
+        for (int i = 0; i < BLE_TRACKER_MAX; i++) {
+            ble_tracker_entry_t *e = &t->entries[i];
+            if (pass == 0 && e->following) continue;
+            if (oldest == NULL || (int32_t)(e->last_seen_ms - oldest->last_seen_ms) < 0) {
+                oldest = e;
+            }
+        }
+    }
+    t->evicted++;
+    return oldest;
+}
+
+ble_tracker_event_t ble_tracker_observe(ble_tracker_t *tracker, const ble_adv_report_t *report, uint32_t now_ms,
+                                        const ble_tracker_entry_t **entry) {
+    ble_tracker_match_t match;
+    if (!ble_tracker_classify(&report->adv, report->addr, &match)) {
+        return BLE_TRACKER_EVENT_NONE;
+    }
+
+    ble_tracker_t *t = tracker;
+    uint32_t period = now_ms / t->period_ms;
+    ble_tracker_event_t event = BLE_TRACKER_EVENT_NONE;
+    ble_tracker_entry_t *e = entry_for(t, &match);
+
+    if (e->identity != match.identity || e->type != match.type || e->sightings == 0) {
+        memset(e, 0, sizeof(*e));
+        e->identity = match.identity;
+        e->type = match.type;
+        e->by_payload = match.by_payload;
+        memcpy(e->addr, report->addr, 6);
+        start_run(e, now_ms, period);
+        event = BLE_TRACKER_EVENT_NEW;
+    } else if (now_ms - e->last_seen_ms > t->window_ms) {
+        // Gone for longer than a window, a tag met again later is not one that followed along
+        start_run(e, now_ms, period);
+        memcpy(e->addr, report->addr, 6);
+        event = BLE_TRACKER_EVENT_NEW;
+    } else if (memcmp(e->addr, report->addr, 6) != 0) {
+        memcpy(e->addr, report->addr, 6);
+        if (e->addresses < UINT16_MAX) e->addresses++;
+    }
+
+    history_advance(e, period);
+    int8_t *slot = &e->history[period % BLE_TRACKER_HISTORY];
+    if (report->rssi > *slot) *slot = report->rssi;
+    e->status = match.status;
+    e->last_seen_ms = now_ms;
+    e->sightings++;
+
+    if (!e->following && now_ms - e->first_seen_ms >= t->window_ms &&
+        ble_tracker_coverage(e) >= BLE_TRACKER_MIN_PERIODS) {
+        e->following = true;
+        event = BLE_TRACKER_EVENT_FOLLOWING;
+    }
+
+    if (entry) *entry = e;
+    return event;
+}
@@ -0,0 +1,110 @@
+#include "core/channel_stats.h"
+#include <string.h>
+
+void channel_stats_reset(channel_stats_t *stats) {
+    for (int ch = 0; ch < CHANNEL_STATS_CHANNELS; ch++) {
+        for (int t = 0; t < CHANNEL_FRAME_TYPES; t++) {
+            atomic_store_explicit(&stats->frames[ch][t], 0, memory_order_relaxed);
+        }
+        for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+            atomic_store_explicit(&stats->rssi[ch][b], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&stats->dwell_ms[ch], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&stats->ignored, 0, memory_order_relaxed);
+}
+
+channel_frame_type_t channel_stats_frame_type(uint8_t frame_control) {
+    switch ((frame_control >> 2) & 0x03) {
+        case 0:
+            return CHANNEL_FRAME_MGMT;
+        case 1:
+            return CHANNEL_FRAME_CTRL;
+        case 2:
+            return CHANNEL_FRAME_DATA;
+        default:
+            return CHANNEL_FRAME_MISC;
+    }
+}
+
+uint8_t channel_stats_rssi_bucket(int8_t rssi) {
+    if (rssi >= -40) return 0;
+    if (rssi >= -55) return 1;
+    if (rssi >= -70) return 2;
+    if (rssi >= -85) return 3;
+    return 4;
+}
+
+void channel_stats_record(channel_stats_t *stats, uint8_t channel, channel_frame_type_t type, int8_t rssi) {
+    if (channel < 1 || channel > CHANNEL_STATS_CHANNELS || type >= CHANNEL_FRAME_TYPES) {
+        atomic_fetch_add_explicit(&stats->ignored, 1, memory_order_relaxed);
+        return;
+    }
+
+    atomic_fetch_add_explicit(&stats->frames[channel - 1][type], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->rssi[channel - 1][channel_stats_rssi_bucket(rssi)], 1, memory_order_relaxed);
+}
+
+void channel_stats_add_dwell(channel_stats_t *stats, uint8_t channel, uint32_t ms) {
+    if (channel >= 1 && channel <= CHANNEL_STATS_CHANNELS) {
+        atomic_fetch_add_explicit(&stats->dwell_ms[channel - 1], ms, memory_order_relaxed);
+    }
+}
+
+void channel_stats_snapshot(channel_stats_t *stats, channel_stats_counts_t *out) {
+    // Counters keep moving while they are copied, a frame may land in the next snapshot
+    for (int ch = 0; ch < CHANNEL_STATS_CHANNELS; ch++) {
+        for (int t = 0; t < CHANNEL_FRAME_TYPES; t++) {
+            out->frames[ch][t] = atomic_load_explicit(&stats->frames[ch][t], memory_order_relaxed);
+        }
+        for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+            out->rssi[ch][b] = atomic_load_explicit(&stats->rssi[ch][b], memory_order_relaxed);
+        }
+        out->dwell_ms[ch] = atomic_load_explicit(&stats->dwell_ms[ch], memory_order_relaxed);
+    }
+}
+
+void channel_stats_delta(const channel_stats_counts_t *prev, const channel_stats_counts_t *cur,
+                         channel_stats_counts_t *out) {
+    for (int ch = 0; ch < CHANNEL_STATS_CHANNELS; ch++) {
+        for (int t = 0; t < CHANNEL_FRAME_TYPES; t++) {
+            out->frames[ch][t] = cur->frames[ch][t] - prev->frames[ch][t];
+        }
+        for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+            out->rssi[ch][b] = cur->rssi[ch][b] - prev->rssi[ch][b];
+        }
+        out->dwell_ms[ch] = cur->dwell_ms[ch] - prev->dwell_ms[ch];
+    }
+}
+
+bool channel_stats_summarize(const channel_stats_counts_t *counts, uint8_t channel, uint32_t elapsed_ms,
+                             channel_summary_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (channel < 1 || channel > CHANNEL_STATS_CHANNELS) {
+        return false;
+    }
+
+    int ch = channel - 1;
+    uint32_t window_ms = counts->dwell_ms[ch] ? counts->dwell_ms[ch] : elapsed_ms;
+    if (window_ms == 0) {
+        return false;
+    }
+
+    uint32_t total = 0;
+    for (int t = 0; t < CHANNEL_FRAME_TYPES; t++) {
+        out->rate[t] = (uint32_t)((uint64_t)counts->frames[ch][t] * 1000 / window_ms);
+        out->total_rate += out->rate[t];
+        total += counts->frames[ch][t];
+    }
+
+    uint32_t rssi_total = 0;
+    for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+        rssi_total += counts->rssi[ch][b];
+    }
+    if (total && rssi_total) {
+        for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+            out->rssi_share[b] = (uint8_t)((uint64_t)counts->rssi[ch][b] * 255 / rssi_total);
+        }
+    }
+    return true;
+}
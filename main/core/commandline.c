@@ -12,11 +12,18 @@
 #include "managers/dial_manager.h"
 #include "core/callbacks.h"
 #include <esp_timer.h>
+#include "core/visualizer_stream.h"
 #include "vendor/pcap.h"
 #include <sys/socket.h>
 #include <netdb.h>
 #include <managers/gps_manager.h>
 #include "vendor/printer.h"
+#ifdef CONFIG_WITH_SCREEN
+#include "managers/display_manager.h"
+#include "managers/image_decoder.h"
+#include "managers/ui_benchmark.h"
+#include "managers/display_stats.h"
+#endif
 
 static Command *command_list_head = NULL;
 
@@ -153,6 +160,61 @@ void handle_sta_scan(int argc, char **argv)
     printf("Started Station Scan...");
 }
 
+static void print_channel_stats(void)
+{
+    channel_stats_counts_t counts;
+    channel_stats_snapshot(&wifi_channel_stats, &counts);
+
+    printf("%3s %7s %7s %7s %6s %7s %7s  %s\n", "Ch", "Mgmt", "Ctrl", "Data", "Misc", "Dwell s", "Frame/s",
+           "RSSI % >-40 >-55 >-70 >-85 rest");
+    for (uint8_t ch = 1; ch <= CHANNEL_STATS_CHANNELS; ch++) {
+        const uint32_t *f = counts.frames[ch - 1];
+        uint32_t dwell_ms = counts.dwell_ms[ch - 1];
+        if (f[0] + f[1] + f[2] + f[3] == 0 && dwell_ms == 0) {
+            continue;
+        }
+
+        // The counters are cumulative, only hopping gives them a time base for a rate
+        channel_summary_t sum;
+        channel_stats_summarize(&counts, ch, dwell_ms ? 0 : 1, &sum);
+        char rate[12] = "-";
+        if (dwell_ms) {
+            snprintf(rate, sizeof(rate), "%lu", (unsigned long)sum.total_rate);
+        }
+
+        printf("%3u %7lu %7lu %7lu %6lu %7lu %7s  %11u %4u %4u %4u %4u\n", ch, (unsigned long)f[0],
+               (unsigned long)f[1], (unsigned long)f[2], (unsigned long)f[3], (unsigned long)(dwell_ms / 1000), rate,
+               sum.rssi_share[0] * 100 / 255, sum.rssi_share[1] * 100 / 255, sum.rssi_share[2] * 100 / 255,
+               sum.rssi_share[3] * 100 / 255, sum.rssi_share[4] * 100 / 255);
+    }
+}
+
+void handle_channel_stats(int argc, char **argv)
+{
+    if (argc < 2) {
+        print_channel_stats();
+        return;
+    }
+
+    if (strcmp(argv[1], "start") == 0) {
+        uint32_t dwell_ms = argc > 2 ? (uint32_t)atoi(argv[2]) : CHANNEL_HOP_DEFAULT_MS;
+        wifi_manager_start_monitor_mode(NULL);
+        if (wifi_manager_start_channel_hop(dwell_ms) == ESP_OK) {
+            printf("Hopping channels 1-%d every %lu ms.\n", CHANNEL_HOP_LAST, (unsigned long)dwell_ms);
+        } else {
+            printf("Failed to start channel hopping.\n");
+        }
+    } else if (strcmp(argv[1], "stop") == 0) {
+        wifi_manager_stop_monitor_mode();
+        printf("Channel hopping stopped.\n");
+    } else if (strcmp(argv[1], "reset") == 0) {
+        channel_stats_reset(&wifi_channel_stats);
+        printf("Channel stats cleared.\n");
+    } else {
+        printf("Usage: chanstats [start [dwell_ms]|stop|reset]\n");
+    }
+}
+
 
 void handle_attack_cmd(int argc, char **argv)
 {
@@ -252,11 +314,7 @@ void handle_wifi_connection(int argc, char** argv) {
 
     if (VisualizerHandle == NULL)
     {
-#ifdef WITH_SCREEN
-    xTaskCreate(screen_music_visualizer_task, "udp_server", 4096, NULL, 5, &VisualizerHandle);
-#else
-    xTaskCreate(animate_led_based_on_amplitude, "udp_server", 4096, NULL, 5, &VisualizerHandle);
-#endif
+        xTaskCreate(visualizer_server_task, "udp_server", 4096, NULL, 5, &VisualizerHandle);
     }
 }
 
@@ -289,6 +347,12 @@ void handle_ble_scan_cmd(int argc, char**argv)
         return;
     }
 
+    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
+        printf("Listing BLE Devices...\n");
+        ble_start_device_list();
+        return;
+    }
+
     if (argc > 1 && strcmp(argv[1], "-s") == 0) {
         printf("Stopping BLE Scan...\n");
         ble_stop();
@@ -514,6 +578,10 @@ void handle_tp_link_test(int argc, char **argv)
     }
 }
 
+#ifndef CONFIG_IDF_TARGET_ESP32S2
+static bool ble_capture_active = false;
+#endif
+
 void handle_capture_scan(int argc, char** argv)
 {
     if (argc != 2) {
@@ -614,8 +682,30 @@ void handle_capture_scan(int argc, char** argv)
         wifi_manager_start_monitor_mode(wifi_wps_detection_callback);
     }
 
+#ifndef CONFIG_IDF_TARGET_ESP32S2
+    if (strcmp(capturetype, "-ble") == 0)
+    {
+        int err = pcap_file_open_with_link_type("blescan", PCAP_LINK_TYPE_BLUETOOTH_LE_LL_WITH_PHDR);
+
+        if (err != ESP_OK)
+        {
+            printf("Error: pcap failed to open\n");
+            return;
+        }
+        ble_capture_active = true;
+        ble_start_capture();
+    }
+#endif
+
     if (strcmp(capturetype, "-stop") == 0)
     {
+#ifndef CONFIG_IDF_TARGET_ESP32S2
+        if (ble_capture_active)
+        {
+            ble_stop();
+            ble_capture_active = false;
+        }
+#endif
         wifi_manager_stop_monitor_mode();
         pcap_file_close();
     }
@@ -690,6 +780,194 @@ void handle_crash(int argc, char **argv)
     *ptr = 42;
 }
 
+#ifdef CONFIG_WITH_SCREEN
+void handle_view_cache(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+        display_manager_flush_view_cache();
+        printf("View cache flushed.\n");
+        return;
+    }
+
+    display_manager_print_view_cache_stats();
+}
+
+void handle_image_cache(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+        image_decoder_flush_cache();
+        printf("Image cache flushed.\n");
+        return;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        int iterations = argc > 2 ? atoi(argv[2]) : 20;
+        image_decoder_benchmark(iterations);
+        return;
+    }
+
+    image_decoder_print_stats();
+}
+
+void handle_ui_benchmark(int argc, char **argv)
+{
+    uint32_t duration_ms = argc > 1 ? (uint32_t)atoi(argv[1]) : 0;
+
+    if (!ui_benchmark_start(duration_ms)) {
+        printf("UI benchmark already running.\n");
+        return;
+    }
+
+    printf("UI benchmark started, results follow as each view finishes.\n");
+}
+
+void handle_blend_benchmark(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+    ui_benchmark_blend(iterations);
+}
+
+void handle_ui_memory(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-s") == 0) {
+        int cycles = argc > 2 ? atoi(argv[2]) : 20;
+        if (!ui_benchmark_memory_stress(cycles)) {
+            printf("A UI benchmark is already running.\n");
+            return;
+        }
+        printf("UI memory stress started, one line follows per cycle.\n");
+        return;
+    }
+
+    display_manager_print_ui_memory_stats();
+}
+
+void handle_text_benchmark(int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 100;
+
+    if (!ui_benchmark_text(frames)) {
+        printf("Text benchmark already pending.\n");
+    }
+}
+
+void handle_flush_benchmark(int argc, char **argv)
+{
+    int frames = argc > 1 ? atoi(argv[1]) : 30;
+
+    if (!ui_benchmark_flush(frames)) {
+        printf("Flush benchmark already pending.\n");
+    }
+}
+
+void handle_list_benchmark(int argc, char **argv)
+{
+    int updates = argc > 1 ? atoi(argv[1]) : 10000;
+
+    if (!ui_benchmark_device_list(updates)) {
+        printf("Device list benchmark already pending.\n");
+    }
+}
+
+void handle_transition_benchmark(int argc, char **argv)
+{
+    if (!ui_benchmark_transitions()) {
+        printf("A UI benchmark is already running.\n");
+    }
+}
+
+void handle_display_stats(int argc, char **argv)
+{
+    if (argc < 2) {
+        display_stats_print_summary();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0) {
+        display_stats_set_enabled(true);
+        printf("Display stats recording.\n");
+    } else if (strcmp(argv[1], "off") == 0) {
+        display_stats_set_enabled(false);
+        printf("Display stats stopped.\n");
+    } else if (strcmp(argv[1], "overlay") == 0) {
+        bool enable = !display_stats_is_overlay_enabled();
+        display_stats_set_overlay(enable);
+        printf("Redraw overlay %s.\n", enable ? "on" : "off");
+    } else if (strcmp(argv[1], "dump") == 0) {
+        display_stats_dump();
+    } else if (strcmp(argv[1], "reset") == 0) {
+        display_stats_reset();
+        printf("Display stats cleared.\n");
+    } else {
+        printf("Usage: dispstats [on|off|overlay|dump|reset]\n");
+    }
+}
+#endif
+
+void handle_led_benchmark(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "render") == 0) {
+        int leds = argc > 2 ? atoi(argv[2]) : 256;
+        int frames = argc > 3 ? atoi(argv[3]) : 200;
+        rgb_manager_benchmark_effects(leds > 0 ? leds : 1, frames > 0 ? frames : 1);
+        return;
+    }
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    if (argc > 1 && strcmp(argv[1], "encode") == 0) {
+        int leds = argc > 2 ? atoi(argv[2]) : 256;
+        int rounds = argc > 3 ? atoi(argv[3]) : 100;
+        if (leds <= 0) leds = 1;
+        if (rounds <= 0) rounds = 1;
+
+        uint32_t lut_us = 0, bitwise_us = 0;
+        esp_err_t err = led_strip_spi_check_encoder(leds, rounds, &lut_us, &bitwise_us);
+        if (err != ESP_OK) {
+            printf("SPI encoder check failed: %s\n", esp_err_to_name(err));
+            return;
+        }
+        printf("SPI encoder matches for all 256 byte values\n");
+        printf("%d LEDs x %d rounds: table %lu us, bitwise %lu us\n", leds, rounds,
+               (unsigned long)lut_us, (unsigned long)bitwise_us);
+        return;
+    }
+#endif
+
+    int posts = argc > 1 ? atoi(argv[1]) : 1000;
+    if (posts <= 0) posts = 1;
+
+    static const uint8_t colors[][3] = {{255, 165, 0}, {255, 0, 0}, {0, 0, 255}, {0, 255, 0}};
+    rgb_manager_reset_service_stats();
+
+    // Posts in a tight loop the way a busy radio callback would, none of them may wait
+    int64_t total_us = 0;
+    uint32_t max_us = 0;
+    for (int i = 0; i < posts; i++) {
+        const uint8_t *c = colors[i % 4];
+        rgb_request_t request = i % 8 == 7 ? RGB_REQUEST_SOLID : RGB_REQUEST_PULSE;
+        rgb_priority_t priority = (rgb_priority_t)(i % 16 == 15 ? RGB_PRIORITY_ALERT : (i / 4) % 2);
+
+        int64_t start = esp_timer_get_time();
+        rgb_manager_post(request, priority, c[0], c[1], c[2]);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+
+        total_us += us;
+        if (us > max_us) max_us = us;
+    }
+
+    // The service runs below the serial task, give it time to pick the last requests up
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    rgb_service_stats_t stats;
+    rgb_manager_get_service_stats(&stats);
+    printf("LED posts: %d, %lu us avg, %lu us max\n", posts, (unsigned long)(total_us / posts),
+           (unsigned long)max_us);
+    printf("Posted %lu, coalesced %lu, preempted %lu, pulses finished %lu, frames %lu\n",
+           (unsigned long)stats.posted, (unsigned long)stats.coalesced, (unsigned long)stats.preempted,
+           (unsigned long)stats.pulses, (unsigned long)stats.frames);
+    rgb_manager_set_color(&rgb_manager, 0, 0, 0, 0, false);
+}
+
 void handle_help(int argc, char **argv) {
     printf("\n Ghost ESP Commands:\n\n");
 
@@ -707,6 +985,24 @@ void handle_help(int argc, char **argv) {
     printf("    Description: Start scanning for Wi-Fi stations.\n");
     printf("    Usage: scansta\n\n");
 
+    printf("chanstats\n");
+    printf("    Description: Show frame counts, frame types and RSSI spread per Wi-Fi channel.\n");
+    printf("    Usage: chanstats [start [dwell_ms]|stop|reset]\n");
+    printf("    Arguments:\n");
+    printf("        start  : Enter monitor mode and hop channels, dwelling dwell_ms on each (default 200)\n");
+    printf("        stop   : Leave monitor mode\n");
+    printf("        reset  : Clear the counters (no argument prints them)\n\n");
+
+    printf("ledbench\n");
+    printf("    Description: Flood the LED service with pulse and colour requests and time how long posting takes,\n");
+    printf("                 or time effect rendering and SPI encoding without touching the LEDs.\n");
+    printf("    Usage: ledbench [posts] | ledbench render [leds] [frames] | ledbench encode [leds] [rounds]\n");
+    printf("    Arguments:\n");
+    printf("        posts   : Requests to post (default 1000)\n");
+    printf("        leds    : LEDs per rendered or encoded frame (default 256)\n");
+    printf("        frames  : Frames rendered per effect (default 200)\n");
+    printf("        rounds  : Frames encoded per SPI encoder, after checking both agree (default 100)\n\n");
+
     printf("stopscan\n");
     printf("    Description: Stop any ongoing Wi-Fi scan.\n");
     printf("    Usage: stopscan\n\n");
@@ -770,21 +1066,25 @@ void handle_help(int argc, char **argv) {
     printf("    Arguments:\n");
     printf("        -f   : Start 'Find the Flippers' mode\n");
     printf("        -ds  : Start BLE spam detector\n");
-    printf("        -a   : Start AirTag scanner\n");
+    printf("        -a   : Start AirTag and tracker scanner, warns about trackers that follow you\n");
     printf("        -r   : Scan for raw BLE packets\n");
+    printf("        -l   : Fill the live BLE device list\n");
     printf("        -s   : Stop BLE scanning\n\n");
 #endif
 
     printf("capture\n");
-    printf("    Description: Start a WiFi Capture (Requires SD Card or Flipper)\n");
+    printf("    Description: Start a WiFi or BLE Capture (Requires SD Card or Flipper)\n");
     printf("    Usage: capture [OPTION]\n");
     printf("    Arguments:\n");
     printf("        -probe   : Start Capturing Probe Packets\n");
     printf("        -beacon  : Start Capturing Beacon Packets\n");
     printf("        -deauth   : Start Capturing Deauth Packets\n");
     printf("        -raw   :   Start Capturing Raw Packets\n");
-    printf("        -wps   :   Start Capturing WPS Packets and there Auth Type");
-    printf("        -pwn   :   Start Capturing Pwnagotchi Packets");
+    printf("        -wps   :   Start Capturing WPS Packets and there Auth Type\n");
+    printf("        -pwn   :   Start Capturing Pwnagotchi Packets\n");
+#ifndef CONFIG_IDF_TARGET_ESP32S2
+    printf("        -ble   :   Start Capturing BLE Advertisements\n");
+#endif
     printf("        -stop   : Stops the active capture\n\n");
 
 
@@ -797,6 +1097,70 @@ void handle_help(int argc, char **argv) {
     printf("    Usage: dialconnect\n");
 
 
+#ifdef CONFIG_WITH_SCREEN
+    printf("viewcache\n");
+    printf("    Description: Show view cache usage and the last view switch time.\n");
+    printf("    Usage: viewcache [-c]\n");
+    printf("    Arguments:\n");
+    printf("        -c  : Destroy all cached views\n\n");
+
+    printf("imgcache\n");
+    printf("    Description: Show decoded image cache usage, or benchmark image decoding.\n");
+    printf("    Usage: imgcache [-c] [-b <iterations>]\n");
+    printf("    Arguments:\n");
+    printf("        -c  : Free all cached decoded images\n");
+    printf("        -b  : Decode every built-in image <iterations> times (default 20)\n\n");
+
+    printf("uibench\n");
+    printf("    Description: Open every view in turn and report create time, frame time, redrawn area and UI memory.\n");
+    printf("    Usage: uibench [duration_ms]\n");
+    printf("    Arguments:\n");
+    printf("        duration_ms  : Measurement time per view (default 3000)\n\n");
+
+    printf("blendbench\n");
+    printf("    Description: Compare blend speed of the RGB565 color mix against the per channel formula.\n");
+    printf("    Usage: blendbench [iterations]\n");
+    printf("    Arguments:\n");
+    printf("        iterations  : Passes over a 4096 pixel buffer per kernel (default 50)\n\n");
+
+    printf("uimem\n");
+    printf("    Description: Show LVGL heap usage, fragmentation, size class pools and the peak usage of each view.\n");
+    printf("    Usage: uimem [-s <cycles>]\n");
+    printf("    Arguments:\n");
+    printf("        -s  : Open every view in turn <cycles> times and report fragmentation after each (default 20)\n\n");
+
+    printf("textbench\n");
+    printf("    Description: Show glyph cache hit rate and compare text drawing with and without the cache.\n");
+    printf("    Usage: textbench [frames]\n");
+    printf("    Arguments:\n");
+    printf("        frames  : Text frames drawn per mode (default 100)\n\n");
+
+    printf("flushbench\n");
+    printf("    Description: Measure display flush throughput and the fixed cost of each flush.\n");
+    printf("    Usage: flushbench [frames]\n");
+    printf("    Arguments:\n");
+    printf("        frames  : Full screen and small area redraws per pass, at most 64 (default 30)\n\n");
+
+    printf("listbench\n");
+    printf("    Description: Feed synthetic device updates into a hidden device list and time its refreshes.\n");
+    printf("    Usage: listbench [updates]\n");
+    printf("    Arguments:\n");
+    printf("        updates : Synthetic device updates to feed (default 10000)\n\n");
+
+    printf("transbench\n");
+    printf("    Description: Switch views once per transition and report the frames shown, with the frame times auto picks from.\n");
+    printf("    Usage: transbench\n\n");
+
+    printf("dispstats\n");
+    printf("    Description: Record render and flush time, redrawn areas and flushed bytes of the last 64 frames.\n");
+    printf("    Usage: dispstats [on|off|overlay|dump|reset]\n");
+    printf("    Arguments:\n");
+    printf("        on/off   : Start or stop recording (no argument prints the summary)\n");
+    printf("        overlay  : Toggle outlines around redrawn areas on screen\n");
+    printf("        dump     : Print every recorded frame\n");
+    printf("        reset    : Clear the recorded frames\n\n");
+#endif
+
     printf("powerprinter\n");
     printf("    Description: Print Custom Text to a Printer on your LAN (Requires You to Run Connect First)\n");
     printf("    Usage: powerprinter <Printer IP> <Text> <FontSize> <alignment>\n");
@@ -807,6 +1171,8 @@ void register_commands() {
     register_command("help", handle_help);
     register_command("scanap", cmd_wifi_scan_start);
     register_command("scansta", handle_sta_scan);
+    register_command("chanstats", handle_channel_stats);
+    register_command("ledbench", handle_led_benchmark);
     register_command("stopscan", cmd_wifi_scan_stop);
     register_command("attack", handle_attack_cmd);
     register_command("list", handle_list);
@@ -824,6 +1190,18 @@ void register_commands() {
     register_command("stop", handle_stop_flipper);
     register_command("reboot", handle_reboot);
     register_command("startwd", handle_startwd);
+#ifdef CONFIG_WITH_SCREEN
+    register_command("viewcache", handle_view_cache);
+    register_command("imgcache", handle_image_cache);
+    register_command("uibench", handle_ui_benchmark);
+    register_command("blendbench", handle_blend_benchmark);
+    register_command("textbench", handle_text_benchmark);
+    register_command("uimem", handle_ui_memory);
+    register_command("flushbench", handle_flush_benchmark);
+    register_command("listbench", handle_list_benchmark);
+    register_command("transbench", handle_transition_benchmark);
+    register_command("dispstats", handle_display_stats);
+#endif
 #ifdef DEBUG
     register_command("crash", handle_crash); // For Debugging
 #endif
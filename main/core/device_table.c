@@ -0,0 +1,267 @@
+#include "core/device_table.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DEVICE_TABLE_EMPTY_SLOT 0xFFFF
+#define DEVICE_TABLE_SEEN_STEP_MS 1000  // last_seen_ms changes finer than this do not bump the version
+
+device_table_t device_table_aps = {
+    .kind = DEVICE_KIND_AP, .capacity = DEVICE_TABLE_SIZE, .lock = portMUX_INITIALIZER_UNLOCKED};
+device_table_t device_table_stations = {
+    .kind = DEVICE_KIND_STATION, .capacity = DEVICE_TABLE_SIZE, .lock = portMUX_INITIALIZER_UNLOCKED};
+device_table_t device_table_ble = {
+    .kind = DEVICE_KIND_BLE, .capacity = DEVICE_TABLE_SIZE, .lock = portMUX_INITIALIZER_UNLOCKED};
+
+static uint16_t index_slots(uint16_t capacity) {
+    // Keep the hash at most half full so probes stay short
+    uint32_t slots = 16;
+    while (slots < (uint32_t)capacity * 2) {
+        slots <<= 1;
+    }
+    return (uint16_t)(slots > 0x8000 ? 0x8000 : slots);
+}
+
+static uint32_t mac_hash(const uint8_t mac[6]) {
+    // The low bytes are the device specific part, the OUI is shared by many devices
+    uint32_t v = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5];
+    v ^= (uint32_t)mac[0] << 7 ^ (uint32_t)mac[1] << 13;
+    return (v * 2654435761u) >> 16;
+}
+
+uint32_t device_table_now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void device_table_init(device_table_t *table, device_kind_t kind, uint16_t capacity) {
+    memset(table, 0, sizeof(*table));
+    table->kind = kind;
+    table->capacity = capacity;
+    portMUX_INITIALIZE(&table->lock);
+}
+
+void device_table_set_view(device_table_t *table, const device_table_view_t *view, uint16_t capacity) {
+    taskENTER_CRITICAL(&table->lock);
+    table->view = view;
+    table->capacity = capacity;
+    table->version++;
+    taskEXIT_CRITICAL(&table->lock);
+}
+
+uint32_t device_table_version(const device_table_t *table) {
+    return table->view ? table->view->version() + table->version : table->version;
+}
+
+void device_table_free(device_table_t *table) {
+    taskENTER_CRITICAL(&table->lock);
+    device_entry_t *entries = table->entries;
+    uint16_t *index = table->index;
+    table->entries = NULL;
+    table->index = NULL;
+    table->count = 0;
+    table->version++;
+    taskEXIT_CRITICAL(&table->lock);
+
+    free(entries);
+    free(index);
+}
+
+void device_table_clear(device_table_t *table) {
+    taskENTER_CRITICAL(&table->lock);
+    if (table->index) {
+        memset(table->index, 0xFF, ((size_t)table->index_mask + 1) * sizeof(uint16_t));
+    }
+    table->count = 0;
+    table->evicted = 0;
+    table->version++;
+    taskEXIT_CRITICAL(&table->lock);
+}
+
+static bool ensure_storage(device_table_t *table) {
+    if (table->entries) {
+        return true;
+    }
+
+    // Allocate outside the critical section, the loser of a race frees its copy
+    uint16_t slots = index_slots(table->capacity);
+    size_t bytes = (size_t)table->capacity * sizeof(device_entry_t);
+#ifdef CONFIG_SPIRAM
+    device_entry_t *entries = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (entries == NULL) entries = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#else
+    device_entry_t *entries = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#endif
+    uint16_t *index = malloc(slots * sizeof(uint16_t));
+    if (entries == NULL || index == NULL) {
+        free(entries);
+        free(index);
+        return false;
+    }
+    memset(index, 0xFF, slots * sizeof(uint16_t));
+
+    taskENTER_CRITICAL(&table->lock);
+    bool installed = table->entries == NULL;
+    if (installed) {
+        table->entries = entries;
+        table->index = index;
+        table->index_mask = slots - 1;
+    }
+    taskEXIT_CRITICAL(&table->lock);
+
+    if (!installed) {
+        free(entries);
+        free(index);
+    }
+    return true;
+}
+
+static void unindex(device_table_t *table, uint32_t slot) {
+    // Shift the rest of the probe run back so later lookups do not stop at the hole
+    uint32_t hole = slot;
+    for (uint32_t next = (slot + 1) & table->index_mask; table->index[next] != DEVICE_TABLE_EMPTY_SLOT;
+         next = (next + 1) & table->index_mask) {
+        uint32_t home = mac_hash(table->entries[table->index[next]].mac) & table->index_mask;
+        if (((next - home) & table->index_mask) >= ((next - hole) & table->index_mask)) {
+            table->index[hole] = table->index[next];
+            hole = next;
+        }
+    }
+    table->index[hole] = DEVICE_TABLE_EMPTY_SLOT;
+}
+
+static uint16_t evict_oldest(device_table_t *table) {
+    uint16_t oldest = 0;
+    for (uint16_t i = 1; i < table->count; i++) {
+        if ((int32_t)(table->entries[i].last_seen_ms - table->entries[oldest].last_seen_ms) < 0) {
+            oldest = i;
+        }
+    }
+
+    uint32_t slot = mac_hash(table->entries[oldest].mac) & table->index_mask;
+    while (table->index[slot] != oldest) {
+        slot = (slot + 1) & table->index_mask;
+    }
+    unindex(table, slot);
+    table->evicted++;
+    return oldest;
+}
+
+bool device_table_upsert(device_table_t *table, const uint8_t mac[6], int8_t rssi, uint8_t channel,
+                         const char *name, const uint8_t peer[6], uint32_t now_ms) {
+    if (table->view || !ensure_storage(table)) {
+        return false;
+    }
+
+    taskENTER_CRITICAL(&table->lock);
+    if (table->entries == NULL) {
+        taskEXIT_CRITICAL(&table->lock);
+        return false;
+    }
+
+    uint32_t slot = mac_hash(mac) & table->index_mask;
+    device_entry_t *e = NULL;
+    while (table->index[slot] != DEVICE_TABLE_EMPTY_SLOT) {
+        device_entry_t *candidate = &table->entries[table->index[slot]];
+        if (memcmp(candidate->mac, mac, 6) == 0) {
+            e = candidate;
+            break;
+        }
+        slot = (slot + 1) & table->index_mask;
+    }
+
+    if (e == NULL) {
+        // A full table makes room by reusing the entry of the device heard least recently
+        uint16_t entry;
+        if (table->count >= table->capacity) {
+            entry = evict_oldest(table);
+            slot = mac_hash(mac) & table->index_mask;
+            while (table->index[slot] != DEVICE_TABLE_EMPTY_SLOT) {
+                slot = (slot + 1) & table->index_mask;
+            }
+        } else {
+            entry = table->count++;
+        }
+        table->index[slot] = entry;
+        e = &table->entries[entry];
+        memset(e, 0, sizeof(*e));
+        memcpy(e->mac, mac, 6);
+        e->rssi = rssi;
+        e->channel = channel;
+        e->last_seen_ms = now_ms;
+        e->version = ++table->version;
+    } else {
+        bool changed = e->rssi != rssi || (channel && e->channel != channel) ||
+                       now_ms - e->last_seen_ms >= DEVICE_TABLE_SEEN_STEP_MS;
+        e->rssi = rssi;
+        if (channel) e->channel = channel;
+        if (changed) {
+            e->last_seen_ms = now_ms;
+            e->version = ++table->version;
+        }
+    }
+
+    if (name && name[0] && strncmp(e->name, name, DEVICE_TABLE_NAME_LEN - 1) != 0) {
+        strncpy(e->name, name, DEVICE_TABLE_NAME_LEN - 1);
+        e->name[DEVICE_TABLE_NAME_LEN - 1] = '\0';
+        e->version = ++table->version;
+    }
+    if (peer && memcmp(e->peer, peer, 6) != 0) {
+        memcpy(e->peer, peer, 6);
+        e->version = ++table->version;
+    }
+
+    taskEXIT_CRITICAL(&table->lock);
+    return true;
+}
+
+bool device_table_get(device_table_t *table, uint16_t entry, device_entry_t *out) {
+    if (table->view) {
+        return table->view->get(entry, out);
+    }
+
+    bool ok = false;
+    taskENTER_CRITICAL(&table->lock);
+    if (table->entries && entry < table->count) {
+        *out = table->entries[entry];
+        ok = true;
+    }
+    taskEXIT_CRITICAL(&table->lock);
+    return ok;
+}
+
+static int compare_rssi(const void *a, const void *b) {
+    const device_sort_key_t *ka = a, *kb = b;
+    if (ka->rssi != kb->rssi) return kb->rssi - ka->rssi;
+    return ka->entry - kb->entry;
+}
+
+static int compare_last_seen(const void *a, const void *b) {
+    const device_sort_key_t *ka = a, *kb = b;
+    if (ka->last_seen_ms != kb->last_seen_ms) return ka->last_seen_ms < kb->last_seen_ms ? 1 : -1;
+    return ka->entry - kb->entry;
+}
+
+uint16_t device_table_sorted(device_table_t *table, device_sort_t order, device_sort_key_t *keys, uint16_t max) {
+    uint16_t n = 0;
+    if (table->view) {
+        n = table->view->keys(keys, max);
+        qsort(keys, n, sizeof(*keys), order == DEVICE_SORT_LAST_SEEN ? compare_last_seen : compare_rssi);
+        return n;
+    }
+
+    taskENTER_CRITICAL(&table->lock);
+    if (table->entries) {
+        n = table->count < max ? table->count : max;
+        for (uint16_t i = 0; i < n; i++) {
+            keys[i].entry = i;
+            keys[i].rssi = table->entries[i].rssi;
+            keys[i].last_seen_ms = table->entries[i].last_seen_ms;
+        }
+    }
+    taskEXIT_CRITICAL(&table->lock);
+
+    qsort(keys, n, sizeof(*keys), order == DEVICE_SORT_LAST_SEEN ? compare_last_seen : compare_rssi);
+    return n;
+}
@@ -0,0 +1,91 @@
+#include "core/input_debounce.h"
+#include <stddef.h>
+
+static uint32_t elapsed_ms(uint32_t since_ms, uint32_t now_ms) {
+    return now_ms - since_ms;
+}
+
+static uint32_t remaining_ms(uint32_t deadline_ms, uint32_t now_ms) {
+    int32_t diff = (int32_t)(deadline_ms - now_ms);
+    return diff > 0 ? (uint32_t)diff : 0;
+}
+
+void input_debounce_init(input_debounce_t *db, const input_debounce_config_t *config) {
+    db->config = config;
+    db->raw = false;
+    db->stable = false;
+    db->long_sent = false;
+    // Start with the lockout already expired so the very first press is not delayed
+    db->stable_since_ms = 0 - (uint32_t)config->debounce_ms;
+    db->next_repeat_ms = 0;
+}
+
+input_debounce_event_t input_debounce_update(input_debounce_t *db, bool pressed, uint32_t now_ms) {
+    const input_debounce_config_t *cfg = db->config;
+
+    db->raw = pressed;
+
+    if (db->raw != db->stable) {
+        if (elapsed_ms(db->stable_since_ms, now_ms) < cfg->debounce_ms) {
+            return INPUT_DEBOUNCE_NONE; // Still bouncing from the previous edge
+        }
+
+        db->stable = db->raw;
+        db->stable_since_ms = now_ms;
+
+        if (!db->stable) {
+            return INPUT_DEBOUNCE_RELEASE;
+        }
+
+        db->long_sent = false;
+        db->next_repeat_ms = now_ms + cfg->repeat_delay_ms;
+        return INPUT_DEBOUNCE_PRESS;
+    }
+
+    if (!db->stable) {
+        return INPUT_DEBOUNCE_NONE;
+    }
+
+    if (cfg->long_press_ms && !db->long_sent &&
+        elapsed_ms(db->stable_since_ms, now_ms) >= cfg->long_press_ms) {
+        db->long_sent = true;
+        return INPUT_DEBOUNCE_LONG_PRESS;
+    }
+
+    if (cfg->repeat_delay_ms && remaining_ms(db->next_repeat_ms, now_ms) == 0) {
+        uint32_t interval = cfg->repeat_interval_ms ? cfg->repeat_interval_ms : cfg->repeat_delay_ms;
+        db->next_repeat_ms += interval;
+
+        // Do not burst missed repeats after a long stall, resync to now instead
+        if (remaining_ms(db->next_repeat_ms, now_ms) == 0) {
+            db->next_repeat_ms = now_ms + interval;
+        }
+        return INPUT_DEBOUNCE_REPEAT;
+    }
+
+    return INPUT_DEBOUNCE_NONE;
+}
+
+uint32_t input_debounce_next_deadline(const input_debounce_t *db, uint32_t now_ms) {
+    const input_debounce_config_t *cfg = db->config;
+    uint32_t wait = INPUT_DEBOUNCE_IDLE;
+
+    if (db->raw != db->stable) {
+        uint32_t lockout = remaining_ms(db->stable_since_ms + cfg->debounce_ms, now_ms);
+        if (lockout < wait) wait = lockout;
+    }
+
+    if (db->stable) {
+        if (cfg->long_press_ms && !db->long_sent) {
+            uint32_t long_wait = remaining_ms(db->stable_since_ms + cfg->long_press_ms, now_ms);
+            if (long_wait < wait) wait = long_wait;
+        }
+
+        if (cfg->repeat_delay_ms) {
+            uint32_t repeat_wait = remaining_ms(db->next_repeat_ms, now_ms);
+            if (repeat_wait < wait) wait = repeat_wait;
+        }
+    }
+
+    return wait;
+}
@@ -0,0 +1,103 @@
+#include "core/touch_filter.h"
+#include <stddef.h>
+
+static int16_t map_axis(uint16_t raw, uint16_t min, uint16_t max, uint16_t res, bool invert) {
+    if (max <= min || res == 0) {
+        return 0;
+    }
+
+    if (raw < min) raw = min;
+    if (raw > max) raw = max;
+
+    int32_t v = (int32_t)(raw - min) * res / (max - min);
+    if (v > res - 1) v = res - 1;
+    return (int16_t)(invert ? res - 1 - v : v);
+}
+
+void touch_filter_init(touch_filter_t *tf, const touch_filter_config_t *config) {
+    tf->config = config;
+    tf->pressed = false;
+    tf->x_acc = 0;
+    tf->y_acc = 0;
+    tf->x = 0;
+    tf->y = 0;
+    tf->dropped = 0;
+}
+
+bool touch_filter_should_sample(const touch_filter_t *tf, bool irq_low) {
+    return tf->pressed || irq_low;
+}
+
+uint16_t touch_filter_median(uint16_t *samples, uint8_t count) {
+    if (count == 0) {
+        return 0;
+    }
+
+    // Bursts are a handful of samples, insertion sort is all it needs
+    for (uint8_t i = 1; i < count; i++) {
+        uint16_t v = samples[i];
+        uint8_t j = i;
+        while (j > 0 && samples[j - 1] > v) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = v;
+    }
+    return samples[count / 2];
+}
+
+touch_filter_event_t touch_filter_update(touch_filter_t *tf, bool touching, uint16_t *xs, uint16_t *ys,
+                                         uint8_t count) {
+    const touch_filter_config_t *cfg = tf->config;
+
+    if (!touching || count == 0) {
+        if (!tf->pressed) {
+            return TOUCH_FILTER_NONE;
+        }
+        tf->pressed = false;
+        return TOUCH_FILTER_RELEASE;
+    }
+
+    if (count > TOUCH_FILTER_MAX_BURST) count = TOUCH_FILTER_MAX_BURST;
+    uint16_t raw_x = touch_filter_median(xs, count);
+    uint16_t raw_y = touch_filter_median(ys, count);
+
+    if (cfg->max_spread && (xs[count - 1] - xs[0] > cfg->max_spread || ys[count - 1] - ys[0] > cfg->max_spread)) {
+        tf->dropped++;
+        return TOUCH_FILTER_NONE;
+    }
+
+    if (cfg->swap_xy) {
+        uint16_t tmp = raw_x;
+        raw_x = raw_y;
+        raw_y = tmp;
+    }
+
+    int32_t x = map_axis(raw_x, cfg->x_min, cfg->x_max, cfg->hor_res, cfg->invert_x);
+    int32_t y = map_axis(raw_y, cfg->y_min, cfg->y_max, cfg->ver_res, cfg->invert_y);
+
+    if (!tf->pressed || cfg->iir_shift == 0) {
+        tf->x_acc = x << 8;
+        tf->y_acc = y << 8;
+    } else {
+        tf->x_acc += ((x << 8) - tf->x_acc) >> cfg->iir_shift;
+        tf->y_acc += ((y << 8) - tf->y_acc) >> cfg->iir_shift;
+    }
+
+    int16_t out_x = (int16_t)((tf->x_acc + 128) >> 8);
+    int16_t out_y = (int16_t)((tf->y_acc + 128) >> 8);
+
+    if (!tf->pressed) {
+        tf->pressed = true;
+        tf->x = out_x;
+        tf->y = out_y;
+        return TOUCH_FILTER_PRESS;
+    }
+
+    if (out_x == tf->x && out_y == tf->y) {
+        return TOUCH_FILTER_NONE;
+    }
+    tf->x = out_x;
+    tf->y = out_y;
+    return TOUCH_FILTER_MOVE;
+}
@@ -0,0 +1,214 @@
+#include "core/visualizer_stream.h"
+#include <string.h>
+
+#define RESET_SEQ_GAP 1000  // A sequence jump this large means the sender restarted
+
+static inline int16_t seq_diff(uint16_t a, uint16_t b) {
+    return (int16_t)(uint16_t)(a - b);
+}
+
+static inline int32_t ts_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+static bool parse_name(const uint8_t **p, const uint8_t *end, char *out) {
+    if (*p >= end) return false;
+    size_t len = **p;
+    (*p)++;
+    if (len > (size_t)(end - *p)) return false;
+
+    size_t keep = len < VISUALIZER_NAME_LEN ? len : VISUALIZER_NAME_LEN;
+    memcpy(out, *p, keep);
+    out[keep] = '\0';
+    *p += len;
+    return true;
+}
+
+bool visualizer_parse(const uint8_t *data, size_t len, visualizer_packet_t *out) {
+    if (len < VISUALIZER_HEADER_LEN || data[0] != 'G' || data[1] != 'V' || data[2] != VISUALIZER_VERSION) {
+        return false;
+    }
+
+    uint8_t flags = data[3];
+    out->seq = (uint16_t)(data[4] | data[5] << 8);
+    out->bar_count = data[6];
+    out->timestamp_ms = (uint32_t)data[8] | (uint32_t)data[9] << 8 | (uint32_t)data[10] << 16 | (uint32_t)data[11] << 24;
+    if (out->bar_count == 0 || out->bar_count > VISUALIZER_MAX_BARS || len < VISUALIZER_HEADER_LEN + (size_t)out->bar_count) {
+        return false;
+    }
+    memcpy(out->bars, data + VISUALIZER_HEADER_LEN, out->bar_count);
+
+    out->has_metadata = flags & VISUALIZER_FLAG_METADATA;
+    if (out->has_metadata) {
+        const uint8_t *p = data + VISUALIZER_HEADER_LEN + out->bar_count;
+        const uint8_t *end = data + len;
+        if (!parse_name(&p, end, out->track) || !parse_name(&p, end, out->artist)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t visualizer_encode(const visualizer_packet_t *packet, uint8_t *buf, size_t size) {
+    size_t track_len = packet->has_metadata ? strnlen(packet->track, VISUALIZER_NAME_LEN) : 0;
+    size_t artist_len = packet->has_metadata ? strnlen(packet->artist, VISUALIZER_NAME_LEN) : 0;
+    size_t len = VISUALIZER_HEADER_LEN + packet->bar_count;
+    if (packet->has_metadata) {
+        len += 2 + track_len + artist_len;
+    }
+    if (len > size || packet->bar_count > VISUALIZER_MAX_BARS) {
+        return 0;
+    }
+
+    buf[0] = 'G';
+    buf[1] = 'V';
+    buf[2] = VISUALIZER_VERSION;
+    buf[3] = packet->has_metadata ? VISUALIZER_FLAG_METADATA : 0;
+    buf[4] = (uint8_t)packet->seq;
+    buf[5] = (uint8_t)(packet->seq >> 8);
+    buf[6] = packet->bar_count;
+    buf[7] = 0;
+    for (int i = 0; i < 4; i++) {
+        buf[8 + i] = (uint8_t)(packet->timestamp_ms >> (8 * i));
+    }
+    uint8_t *p = buf + VISUALIZER_HEADER_LEN;
+    memcpy(p, packet->bars, packet->bar_count);
+    p += packet->bar_count;
+
+    if (packet->has_metadata) {
+        *p++ = (uint8_t)track_len;
+        memcpy(p, packet->track, track_len);
+        p += track_len;
+        *p++ = (uint8_t)artist_len;
+        memcpy(p, packet->artist, artist_len);
+    }
+    return len;
+}
+
+void visualizer_jitter_reset(visualizer_jitter_t *jb) {
+    memset(jb, 0, sizeof(*jb));
+}
+
+static void restart(visualizer_jitter_t *jb, const visualizer_packet_t *packet, uint32_t now_ms) {
+    memset(jb->slots, 0, sizeof(jb->slots));
+    jb->started = true;
+    jb->offset_ms = ts_diff(now_ms, packet->timestamp_ms);
+    jb->highest_seq = packet->seq - 1;
+    jb->seen = 0;
+    jb->playing = false;
+}
+
+void visualizer_jitter_push(visualizer_jitter_t *jb, const visualizer_packet_t *packet, uint32_t now_ms) {
+    jb->stats.received++;
+
+    int16_t ahead = seq_diff(packet->seq, jb->highest_seq);
+    if (!jb->started) {
+        restart(jb, packet, now_ms);
+        ahead = 1;
+    } else if (ahead > RESET_SEQ_GAP || ahead < -RESET_SEQ_GAP) {
+        jb->stats.resets++;
+        restart(jb, packet, now_ms);
+        ahead = 1;
+    }
+    jb->last_arrival_ms = now_ms;
+
+    // The fastest frame sets the clock offset, creeping up keeps a slow sender clock in range
+    int32_t delay = ts_diff(now_ms, packet->timestamp_ms);
+    if (delay < jb->offset_ms) {
+        jb->offset_ms = delay;
+    } else if (delay > jb->offset_ms) {
+        jb->offset_ms++;
+    }
+
+    if (ahead > 0) {
+        jb->stats.lost += ahead - 1;
+        jb->highest_seq = packet->seq;
+        jb->seen = (ahead < 64 ? jb->seen << ahead : 0) | 1;
+    } else {
+        int back = -ahead;
+        if (back >= 64) {
+            jb->stats.late++;
+            return;
+        }
+        if (jb->seen & (1ull << back)) {
+            jb->stats.duplicate++;
+            return;
+        }
+        // It was counted lost when a later frame overtook it
+        jb->seen |= 1ull << back;
+        jb->stats.reordered++;
+        if (jb->stats.lost > 0) jb->stats.lost--;
+    }
+
+    if (jb->playing && ts_diff(packet->timestamp_ms, jb->played_ts) <= 0) {
+        jb->stats.late++;
+        return;
+    }
+
+    // A free slot, or else the oldest frame gives way
+    visualizer_slot_t *slot = NULL;
+    for (int i = 0; i < VISUALIZER_JITTER_SLOTS; i++) {
+        visualizer_slot_t *s = &jb->slots[i];
+        if (!s->used) {
+            slot = s;
+            break;
+        }
+        if (slot == NULL || ts_diff(s->timestamp_ms, slot->timestamp_ms) < 0) {
+            slot = s;
+        }
+    }
+
+    slot->used = true;
+    slot->seq = packet->seq;
+    slot->timestamp_ms = packet->timestamp_ms;
+    slot->bar_count = packet->bar_count;
+    memcpy(slot->bars, packet->bars, packet->bar_count);
+}
+
+int visualizer_jitter_sample(visualizer_jitter_t *jb, uint32_t now_ms, uint8_t *bars) {
+    if (!jb->started || now_ms - jb->last_arrival_ms > VISUALIZER_HOLD_MS) {
+        return 0;
+    }
+
+    uint32_t target = now_ms - (uint32_t)jb->offset_ms - VISUALIZER_JITTER_MS;
+    visualizer_slot_t *before = NULL;
+    visualizer_slot_t *after = NULL;
+    for (int i = 0; i < VISUALIZER_JITTER_SLOTS; i++) {
+        visualizer_slot_t *s = &jb->slots[i];
+        if (!s->used) continue;
+        if (ts_diff(s->timestamp_ms, target) <= 0) {
+            if (before == NULL || ts_diff(s->timestamp_ms, before->timestamp_ms) > 0) before = s;
+        } else if (after == NULL || ts_diff(s->timestamp_ms, after->timestamp_ms) < 0) {
+            after = s;
+        }
+    }
+    if (before == NULL) {
+        // Still filling up
+        return 0;
+    }
+
+    // Frames older than the one playing are never needed again
+    for (int i = 0; i < VISUALIZER_JITTER_SLOTS; i++) {
+        visualizer_slot_t *s = &jb->slots[i];
+        if (s->used && ts_diff(s->timestamp_ms, before->timestamp_ms) < 0) {
+            s->used = false;
+        }
+    }
+    jb->played_ts = target;
+    jb->playing = true;
+
+    int count = before->bar_count;
+    if (after == NULL || after->bar_count != count) {
+        memcpy(bars, before->bars, count);
+        return count;
+    }
+
+    uint32_t span = (uint32_t)ts_diff(after->timestamp_ms, before->timestamp_ms);
+    uint32_t pos = (uint32_t)ts_diff(target, before->timestamp_ms);
+    for (int i = 0; i < count; i++) {
+        int from = before->bars[i];
+        int to = after->bars[i];
+        bars[i] = (uint8_t)(from + (to - from) * (int32_t)pos / (int32_t)span);
+    }
+    return count;
+}
@@ -76,17 +76,10 @@ void app_main(void) {
 
 #ifdef CONFIG_LED_DATA_PIN
   rgb_manager_init(&rgb_manager, CONFIG_LED_DATA_PIN, CONFIG_NUM_LEDS, LED_ORDER, LED_MODEL_WS2812, GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC);
-  
-  if (settings_get_rgb_mode(&G_Settings) == 1)
-  {
-    xTaskCreate(rainbow_task, "Rainbow Task", 8192, &rgb_manager, 1, &rgb_effect_task_handle);
-  }
+  rgb_manager_apply_settings();
 #endif
 #ifdef CONFIG_RED_RGB_PIN && CONFIG_GREEN_RGB_PIN && CONFIG_BLUE_RGB_PIN
   rgb_manager_init(&rgb_manager, GPIO_NUM_NC, 1, LED_PIXEL_FORMAT_GRB, LED_MODEL_WS2812, CONFIG_RED_RGB_PIN, CONFIG_GREEN_RGB_PIN, CONFIG_BLUE_RGB_PIN);
-  if (settings_get_rgb_mode(&G_Settings) == 1)
-  {
-  xTaskCreate(rainbow_task, "Rainbow Task", 8192, &rgb_manager, 1, &rgb_effect_task_handle);
-  }
+  rgb_manager_apply_settings();
 #endif
 }
\ No newline at end of file
@@ -596,11 +596,22 @@ static esp_err_t api_settings_handler(httpd_req_t* req) {
         printf("Error: 'rgb_mode' is not a boolean.\n");
     }
 
+    // Numeric mode also reaches the effects beyond rainbow
+    cJSON* rgb_mode_index = cJSON_GetObjectItem(root, "rgb_mode");
+    if (cJSON_IsNumber(rgb_mode_index)) {
+        settings_set_rgb_mode(settings, (RGBMode)rgb_mode_index->valueint);
+    }
+
     cJSON* rgb_speed = cJSON_GetObjectItem(root, "rgb_speed");
     if (rgb_speed) {
         settings_set_rgb_speed(settings, rgb_speed->valueint);
     }
 
+    cJSON* rgb_brightness = cJSON_GetObjectItem(root, "rgb_brightness");
+    if (cJSON_IsNumber(rgb_brightness)) {
+        settings_set_rgb_brightness(settings, (uint8_t)rgb_brightness->valueint);
+    }
+
     cJSON* channel_delay = cJSON_GetObjectItem(root, "channel_delay");
     if (channel_delay) {
         settings_set_channel_delay(settings, (float)channel_delay->valuedouble);
@@ -691,6 +702,7 @@ static esp_err_t api_settings_get_handler(httpd_req_t* req) {
     cJSON_AddStringToObject(root, "ap_password", settings_get_ap_password(settings));
     cJSON_AddNumberToObject(root, "rgb_mode", settings_get_rgb_mode(settings));
     cJSON_AddNumberToObject(root, "rgb_speed", settings_get_rgb_speed(settings));
+    cJSON_AddNumberToObject(root, "rgb_brightness", settings_get_rgb_brightness(settings));
     cJSON_AddNumberToObject(root, "channel_delay", settings_get_channel_delay(settings));
 
     
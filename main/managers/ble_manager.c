@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include "esp_log.h"
 #include "nvs_flash.h"
 #ifndef CONFIG_IDF_TARGET_ESP32S2
@@ -8,6 +9,8 @@
 #include "host/ble_hs.h"
 #include "nimble/nimble_port.h"
 #include "nimble/nimble_port_freertos.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "host/ble_gap.h"
 #include "managers/ble_manager.h"
 #include "esp_random.h"
@@ -15,32 +18,109 @@
 #include <managers/rgb_manager.h>
 #include <managers/settings_manager.h>
 #include "managers/views/terminal_screen.h"
+#include "core/device_table.h"
+#include "core/ble_adv.h"
+#include "core/ble_device_table.h"
+#include "core/ble_spam.h"
+#include "core/ble_tracker.h"
+#include "core/ble_pcap.h"
+#include "vendor/pcap.h"
 
 
-#define MAX_DEVICES 30
 #define MAX_HANDLERS 10
 #define MAX_PACKET_SIZE 31
+#define BLE_PCAP_QUEUE_LEN        32      // Frames waiting for the writer, about 2.5 KB
+#define BLE_PCAP_WRITER_STACK     4096    // Flushing goes through FATFS
+#define BLE_PCAP_WRITER_PRIORITY  3       // Below the NimBLE host task
+#define BLE_PCAP_DRAIN_MS         1000
+#define BLE_DEVICE_EXPIRE_BATCH   32      // Aged out per advertisement, the rest go with the next ones
+#define BLE_DEVICE_KEYS_BATCH     128     // Slots walked per hold of the lock when the list reads keys
+
+// One captured advertisement on its way from the NimBLE host task to the pcap writer,
+// a zero length asks the writer to finish
+typedef struct {
+    struct timeval ts;
+    uint8_t len;
+    uint8_t frame[BLE_PCAP_MAX_FRAME];
+} ble_pcap_item_t;
 
 static const char *TAG_BLE = "BLE_MANAGER";
 static int airTagCount = 0;
 static bool ble_initialized = false;
+// The one table of BLE devices. Written by the NimBLE host task, the device list reads it
+// through device_table_ble, so every access takes the lock. The table can hold thousands
+// of devices, so this is a mutex rather than a critical section and nobody holds it for
+// more than a bounded batch of work.
+static ble_device_table_t ble_devices;
+static SemaphoreHandle_t ble_devices_lock = NULL;
+static uint32_t last_expire_ms = 0;
+static QueueHandle_t pcap_queue = NULL;
+static SemaphoreHandle_t pcap_drained = NULL;
+static TaskHandle_t pcap_writer = NULL;
+static uint32_t pcap_dropped = 0;
 
 typedef struct {
     ble_data_handler_t handler;
+    uint32_t interest;      // BLE_ADV_HAS_* bits, BLE_ADV_ANY for every advertisement
 } ble_handler_t;
 
 
 static ble_handler_t *handlers = NULL;
 static int handler_count = 0;
-static int spam_counter = 0;
-static uint16_t *last_company_id = NULL;
-static TickType_t last_detection_time = 0;  
+static ble_spam_detector_t spam_detector;
+static ble_tracker_t trackers;
+
+
+static uint32_t ble_view_version(void) {
+    return ble_devices.version;
+}
+
+static uint16_t ble_view_keys(device_sort_key_t *keys, uint16_t max) {
+    // The lock is dropped between batches so advertisements keep flowing, a device that
+    // changes meanwhile is caught on the next version
+    uint16_t n = 0;
+    for (uint32_t start = 0; start < ble_devices.capacity && n < max; start += BLE_DEVICE_KEYS_BATCH) {
+        uint32_t end = start + BLE_DEVICE_KEYS_BATCH;
+        if (end > ble_devices.capacity) end = ble_devices.capacity;
+        xSemaphoreTake(ble_devices_lock, portMAX_DELAY);
+        for (uint32_t slot = start; slot < end && n < max; slot++) {
+            const ble_device_t *d = ble_device_table_at(&ble_devices, (uint16_t)slot);
+            if (d != NULL) {
+                keys[n++] = (device_sort_key_t){.entry = (uint16_t)slot, .rssi = ble_device_rssi(d),
+                                                .last_seen_ms = d->last_seen_ms};
+            }
+        }
+        xSemaphoreGive(ble_devices_lock);
+    }
+    return n;
+}
+
+static bool ble_view_get(uint16_t entry, device_entry_t *out) {
+    xSemaphoreTake(ble_devices_lock, portMAX_DELAY);
+    const ble_device_t *d = ble_device_table_at(&ble_devices, entry);
+    if (d != NULL) {
+        memset(out, 0, sizeof(*out));
+        memcpy(out->mac, d->addr, 6);
+        out->rssi = ble_device_rssi(d);
+        out->last_seen_ms = d->last_seen_ms;
+        out->version = d->version;
+        memcpy(out->name, d->name, sizeof(d->name));
+    }
+    xSemaphoreGive(ble_devices_lock);
+    return d != NULL;
+}
 
+static const device_table_view_t ble_device_view = {
+    .version = ble_view_version,
+    .keys = ble_view_keys,
+    .get = ble_view_get,
+};
 
-static void notify_handlers(struct ble_gap_event *event, int len) {
+static void notify_handlers(const ble_adv_report_t *report) {
     for (int i = 0; i < handler_count; i++) {
-        if (handlers[i].handler) {
-            handlers[i].handler(event, len);
+        uint32_t interest = handlers[i].interest;
+        if (handlers[i].handler && (interest == BLE_ADV_ANY || (report->adv.present & interest))) {
+            handlers[i].handler(report);
         }
     }
 }
@@ -94,299 +174,251 @@ void stop_ble_stack() {
     ESP_LOGI(TAG_BLE, "NimBLE stack and task deinitialized.");
 }
 
-static bool extract_company_id(const uint8_t *payload, size_t length, uint16_t *company_id) {
-    size_t index = 0;
-
-    while (index < length) {
-        uint8_t field_length = payload[index];
+static int ble_gap_event_general(struct ble_gap_event *event, void *arg) {
+    switch (event->type) {
+        case BLE_GAP_EVENT_DISC: {
+            // Decoded once here, the handlers only look at the result
+            ble_adv_report_t report = {
+                .addr = event->disc.addr.val,
+                .addr_type = event->disc.addr.type,
+                .event_type = event->disc.event_type,
+                .rssi = event->disc.rssi,
+                .raw = {event->disc.data, event->disc.length_data},
+            };
+            if (event->disc.event_type == BLE_HCI_ADV_RPT_EVTYPE_DIR_IND) {
+                report.direct_addr = event->disc.direct_addr.val;
+                report.direct_addr_type = event->disc.direct_addr.type;
+            }
+            ble_adv_parse(event->disc.data, event->disc.length_data, &report.adv);
+
+            // The controller passes every advertisement on, the table decides what is news
+            uint32_t now_ms = device_table_now_ms();
+            xSemaphoreTake(ble_devices_lock, portMAX_DELAY);
+            report.changes = ble_device_table_observe(&ble_devices, &report, now_ms);
+            // Aging resumes with the next advertisement until a batch comes back short
+            if (now_ms - last_expire_ms >= 1000 &&
+                ble_device_table_expire(&ble_devices, now_ms, BLE_DEVICE_MAX_AGE_MS, BLE_DEVICE_EXPIRE_BATCH) <
+                    BLE_DEVICE_EXPIRE_BATCH) {
+                last_expire_ms = now_ms;
+            }
+            xSemaphoreGive(ble_devices_lock);
 
-        if (field_length == 0 || index + field_length >= length) {
+            notify_handlers(&report);
             break;
         }
 
-        uint8_t field_type = payload[index + 1];
-
-        if (field_type == 0xFF && field_length >= 3) {
-            *company_id = payload[index + 2] | (payload[index + 3] << 8);
-            return true;
-        }
-
-        index += field_length + 1;
+        default:
+            break;
     }
 
-    return false;
+    return 0;
 }
 
-static void parse_device_name(const uint8_t *data, uint8_t data_len, char *name, size_t name_size) {
-    int index = 0;
-
-    while (index < data_len) {
-        uint8_t length = data[index];
-        if (length == 0) {
-            break;
-        }
-        uint8_t type = data[index + 1];
-
-        
-        if (type == BLE_HS_ADV_TYPE_COMP_NAME) {
-            int name_len = length - 1;
-            if (name_len > name_size - 1) {
-                name_len = name_size - 1;
-            }
-            strncpy(name, (const char *)&data[index + 2], name_len);
-            name[name_len] = '\0'; 
-            return;
-        }
-
-        index += length + 1; 
-    }
 
-    
-    strncpy(name, "Unknown", name_size);
+static void format_mac(const uint8_t *addr, char *out, size_t size) {
+    snprintf(out, size, "%02x:%02x:%02x:%02x:%02x:%02x",
+             addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
 }
 
-static void parse_service_uuids(const uint8_t *data, uint8_t data_len, ble_service_uuids_t *uuids) {
-    int index = 0;
-
-    while (index < data_len) {
-        uint8_t length = data[index];
-        if (length == 0) {
-            break;
-        }
-        uint8_t type = data[index + 1];
+static const struct {
+    uint16_t uuid;
+    const char *colour;
+} flipper_uuids[] = {
+    {0x3082, "White"},
+    {0x3081, "Black"},
+    {0x3083, "Transparent"},
+};
+
+void ble_findtheflippers_callback(const ble_adv_report_t *report) {
+    if (!(report->changes & (BLE_DEVICE_SEEN | BLE_DEVICE_RSSI_MOVED))) {
+        return;
+    }
 
-        // Check for 16-bit UUIDs
-        if ((type == BLE_HS_ADV_TYPE_COMP_UUIDS16 || type == BLE_HS_ADV_TYPE_INCOMP_UUIDS16) && uuids->uuid16_count < MAX_UUID16) {
-            for (int i = 0; i < length - 1; i += 2) {
-                uint16_t uuid16 = data[index + 2 + i] | (data[index + 3 + i] << 8);
-                uuids->uuid16[uuids->uuid16_count++] = uuid16;
-            }
+    for (size_t i = 0; i < sizeof(flipper_uuids) / sizeof(flipper_uuids[0]); i++) {
+        if (!ble_adv_has_uuid16(&report->adv, flipper_uuids[i].uuid)) {
+            continue;
         }
 
-        // Check for 32-bit UUIDs
-        else if ((type == BLE_HS_ADV_TYPE_COMP_UUIDS32 || type == BLE_HS_ADV_TYPE_INCOMP_UUIDS32) && uuids->uuid32_count < MAX_UUID32) {
-            for (int i = 0; i < length - 1; i += 4) {
-                uint32_t uuid32 = data[index + 2 + i] | (data[index + 3 + i] << 8) | (data[index + 4 + i] << 16) | (data[index + 5 + i] << 24);
-                uuids->uuid32[uuids->uuid32_count++] = uuid32;
-            }
-        }
+        char advertisementMac[18];
+        char advertisementName[32];
+        format_mac(report->addr, advertisementMac, sizeof(advertisementMac));
+        ble_adv_copy_name(&report->adv, advertisementName, sizeof(advertisementName), "Unknown");
 
-        // Check for 128-bit UUIDs
-        else if ((type == BLE_HS_ADV_TYPE_COMP_UUIDS128 || type == BLE_HS_ADV_TYPE_INCOMP_UUIDS128) && uuids->uuid128_count < MAX_UUID128) {
-            snprintf(uuids->uuid128[uuids->uuid128_count], sizeof(uuids->uuid128[uuids->uuid128_count]),
-                     "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-                     data[index + 17], data[index + 16], data[index + 15], data[index + 14],
-                     data[index + 13], data[index + 12], data[index + 11], data[index + 10],
-                     data[index + 9], data[index + 8], data[index + 7], data[index + 6],
-                     data[index + 5], data[index + 4], data[index + 3], data[index + 2]);
-            uuids->uuid128_count++;
+        if (!(report->changes & BLE_DEVICE_SEEN)) {
+            printf("%s Flipper %s now at RSSI: %d\n", flipper_uuids[i].colour, advertisementMac, report->rssi);
+            TERMINAL_VIEW_ADD_TEXT("%s Flipper %s now at RSSI: %d\n", flipper_uuids[i].colour, advertisementMac,
+                                   report->rssi);
+            continue;
         }
 
-        index += length + 1;
+        printf("Found %s Flipper Device: MAC: %s, Name: %s, RSSI: %d\n", flipper_uuids[i].colour,
+               advertisementMac, advertisementName, report->rssi);
+        TERMINAL_VIEW_ADD_TEXT("Found %s Flipper Device: MAC: %s, Name: %s, RSSI: %d\n", flipper_uuids[i].colour,
+                               advertisementMac, advertisementName, report->rssi);
+        rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
     }
 }
 
-
-static int ble_gap_event_general(struct ble_gap_event *event, void *arg) {
-    switch (event->type) {
-        case BLE_GAP_EVENT_DISC:
-            notify_handlers(event, event->disc.length_data);
-
-            break;
-
-        default:
-            break;
+void ble_print_raw_packet_callback(const ble_adv_report_t *report) {
+    // Repeats of the same bytes from the same device are left out
+    if (!(report->changes & (BLE_DEVICE_SEEN | BLE_DEVICE_PAYLOAD))) {
+        return;
     }
 
-    return 0;
-}
-
-
-void ble_findtheflippers_callback(struct ble_gap_event *event, size_t len) {
-    int advertisementRssi = event->disc.rssi;
-
-
     char advertisementMac[18];
-    snprintf(advertisementMac, sizeof(advertisementMac), "%02x:%02x:%02x:%02x:%02x:%02x",
-             event->disc.addr.val[0], event->disc.addr.val[1], event->disc.addr.val[2],
-             event->disc.addr.val[3], event->disc.addr.val[4], event->disc.addr.val[5]);
-
+    format_mac(report->addr, advertisementMac, sizeof(advertisementMac));
 
-    char advertisementName[32];
-    parse_device_name(event->disc.data, event->disc.length_data, advertisementName, sizeof(advertisementName));
+    // One write per advertisement, the console is the bottleneck at 115200 baud
+    char hex[MAX_PACKET_SIZE * 3 + 1] = "";
+    size_t len = report->raw.len > MAX_PACKET_SIZE ? MAX_PACKET_SIZE : report->raw.len;
+    for (size_t i = 0; i < len; i++) {
+        snprintf(hex + i * 3, 4, "%02x ", report->raw.data[i]);
+    }
 
+    printf("Received BLE Advertisement from MAC: %s, RSSI: %d\nRaw Advertisement Data (len=%u): %s\n",
+           advertisementMac, report->rssi, report->raw.len, hex);
+}
 
-    ble_service_uuids_t uuids = {0};
-    parse_service_uuids(event->disc.data, event->disc.length_data, &uuids);
+static void ble_pcap_writer_task(void *arg) {
+    ble_pcap_item_t item;
 
-    for (int i = 0; i < uuids.uuid16_count; i++) {
-        if (uuids.uuid16[i] == 0x3082) {
-            printf("Found White Flipper Device: MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found White Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
-        if (uuids.uuid16[i] == 0x3081) {
-            printf("Found Black Flipper Device: MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found Black Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
-        if (uuids.uuid16[i] == 0x3083) {
-            printf("Found Transparent Flipper Device: MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found Transparent Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
+    // Flushes to the SD card or UART block for a while, the NimBLE host task must not
+    while (xQueueReceive(pcap_queue, &item, portMAX_DELAY) == pdTRUE && item.len > 0) {
+        if (pcap_write_packet_to_buffer_at(item.frame, item.len, &item.ts) != ESP_OK) {
+            ESP_LOGE(TAG_BLE, "Failed to write BLE packet to PCAP buffer.");
         }
     }
 
+    pcap_writer = NULL;
+    xSemaphoreGive(pcap_drained);
+    vTaskDelete(NULL);
+}
 
-    for (int i = 0; i < uuids.uuid32_count; i++) {
-        if (uuids.uuid32[i] == 0x3082) {
-            printf("Found White Flipper Device (32-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found White Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
-        if (uuids.uuid32[i] == 0x3081) {
-            printf("Found Black Flipper Device (32-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found Black Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
-        if (uuids.uuid32[i] == 0x3083) {
-            printf("Found Transparent Flipper Device (32-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found Transparent Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
+static bool ble_pcap_writer_start(void) {
+    if (pcap_queue == NULL) {
+        pcap_queue = xQueueCreate(BLE_PCAP_QUEUE_LEN, sizeof(ble_pcap_item_t));
+        pcap_drained = xSemaphoreCreateBinary();
+        if (pcap_queue == NULL || pcap_drained == NULL) {
+            return false;
         }
     }
-
-    
-    for (int i = 0; i < uuids.uuid128_count; i++) {
-        if (strstr(uuids.uuid128[i], "3082") != NULL) {
-            printf("Found White Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found White Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
-        if (strstr(uuids.uuid128[i], "3081") != NULL) {
-            printf("Found Black Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found Black Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
-        if (strstr(uuids.uuid128[i], "3083") != NULL) {
-            printf("Found Transparent Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            TERMINAL_VIEW_ADD_TEXT("Found Transparent Flipper Device (128-bit UUID): MAC: %s, Name: %s, RSSI: %d\n", advertisementMac, advertisementName, advertisementRssi);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 165, 0, true);
-        }
+    if (pcap_writer != NULL) {
+        return true;
     }
-}
-
-void ble_print_raw_packet_callback(struct ble_gap_event *event, size_t len) {
-    
-    int advertisementRssi = event->disc.rssi;
 
-    
-    char advertisementMac[18];
-    snprintf(advertisementMac, sizeof(advertisementMac), "%02x:%02x:%02x:%02x:%02x:%02x",
-             event->disc.addr.val[0], event->disc.addr.val[1], event->disc.addr.val[2],
-             event->disc.addr.val[3], event->disc.addr.val[4], event->disc.addr.val[5]);
+    // Frames a late callback queued after the last stop belong to the old file
+    xQueueReset(pcap_queue);
+    xSemaphoreTake(pcap_drained, 0);
+    pcap_dropped = 0;
+    return xTaskCreate(ble_pcap_writer_task, "ble_pcap", BLE_PCAP_WRITER_STACK, NULL, BLE_PCAP_WRITER_PRIORITY,
+                       &pcap_writer) == pdPASS;
+}
 
-    
-    printf("Received BLE Advertisement from MAC: %s, RSSI: %d\n", advertisementMac, advertisementRssi);
+static void ble_pcap_writer_stop(void) {
+    if (pcap_writer == NULL) {
+        return;
+    }
 
-    
-    printf("Raw Advertisement Data (len=%zu): ", event->disc.length_data);
-    for (size_t i = 0; i < event->disc.length_data; i++) {
-        printf("%02x ", event->disc.data[i]);
+    // Everything queued before the stop reaches the buffer before the file is closed
+    ble_pcap_item_t stop = {.len = 0};
+    if (xQueueSend(pcap_queue, &stop, pdMS_TO_TICKS(BLE_PCAP_DRAIN_MS)) != pdTRUE ||
+        xSemaphoreTake(pcap_drained, pdMS_TO_TICKS(BLE_PCAP_DRAIN_MS)) != pdTRUE) {
+        ESP_LOGE(TAG_BLE, "PCAP writer did not finish, the capture may be cut short.");
+    }
+    if (pcap_dropped) {
+        printf("BLE capture dropped %lu advertisements, the card could not keep up\n", (unsigned long)pcap_dropped);
     }
-    printf("\n");
 }
 
-void detect_ble_spam_callback(struct ble_gap_event *event, size_t length) {
-    if (length < 4) {
+void ble_pcap_capture_callback(const ble_adv_report_t *report) {
+    // Every advertisement, repeats included, a capture keeps the timing and RSSI of each
+    ble_pcap_item_t item;
+    gettimeofday(&item.ts, NULL);
+    item.len = (uint8_t)ble_pcap_frame(report, BLE_PCAP_CHANNEL_UNKNOWN, item.frame, sizeof(item.frame));
+    if (item.len == 0) {
         return;
     }
 
-    TickType_t current_time = xTaskGetTickCount();
-    TickType_t time_elapsed = current_time - last_detection_time;
-
-
-    uint16_t current_company_id;
-    if (!extract_company_id(event->disc.data, length, &current_company_id)) {
-        return; 
+    if (xQueueSend(pcap_queue, &item, 0) != pdTRUE) {
+        pcap_dropped++;
     }
+}
 
-    if (time_elapsed > pdMS_TO_TICKS(TIME_WINDOW_MS)) {
-        spam_counter = 0;
+void detect_ble_spam_callback(const ble_adv_report_t *report) {
+    ble_spam_alert_t alert;
+    if (!ble_spam_observe(&spam_detector, report, device_table_now_ms(), &alert)) {
+        return;
     }
 
-    if (last_company_id != NULL && *last_company_id == current_company_id) {
-        spam_counter++;
-        
-        if (spam_counter > MAX_PAYLOADS) {
-            ESP_LOGW(TAG_BLE, "BLE Spam detected! Company ID: 0x%04X", current_company_id);
-            rgb_manager_set_color(&rgb_manager, 0, 255, 0, 0, true);
-            spam_counter = 0;
-        }
-    } else {
-        if (last_company_id == NULL) {
-            last_company_id = (uint16_t *)malloc(sizeof(uint16_t));
-        }
+    char what[64];
+    ble_spam_describe(&alert, what, sizeof(what));
+    ESP_LOGW(TAG_BLE, "BLE Spam detected! %s: %u new addresses, %u advertisements in %d ms, score %u", what,
+             alert.fresh, alert.adverts, BLE_SPAM_WINDOW_MS, alert.score);
+    TERMINAL_VIEW_ADD_TEXT("BLE Spam detected! %s, score %u\n", what, alert.score);
+    rgb_manager_post(RGB_REQUEST_PULSE, RGB_PRIORITY_ALERT, 255, 0, 0);
+}
 
-        if (last_company_id != NULL) {
-            *last_company_id = current_company_id;
-            spam_counter = 1;               
-        }
-    }
 
-    last_detection_time = current_time;
-}
+void airtag_scanner_callback(const ble_adv_report_t *report) {
+    // Every sighting goes into the history, only news is printed
+    const ble_tracker_entry_t *tag;
+    ble_tracker_event_t event = ble_tracker_observe(&trackers, report, device_table_now_ms(), &tag);
+    if (event == BLE_TRACKER_EVENT_NONE && !(report->changes & BLE_DEVICE_RSSI_MOVED)) {
+        return;
+    }
+    ble_tracker_match_t match;
+    if (event == BLE_TRACKER_EVENT_NONE && !ble_tracker_classify(&report->adv, report->addr, &match)) {
+        return;
+    }
 
+    const uint8_t *payload = report->raw.data;
+    size_t payloadLength = report->raw.len;
 
-void airtag_scanner_callback(struct ble_gap_event *event, size_t len) {
-    if (event->type == BLE_GAP_EVENT_DISC) {
-        if (!event->disc.data || event->disc.length_data < 4) {
-            return; 
-        }
+    char macAddress[18];
+    format_mac(report->addr, macAddress, sizeof(macAddress));
 
-        const uint8_t *payload = event->disc.data;
-        size_t payloadLength = event->disc.length_data;
+    int rssi = report->rssi;
 
-        bool patternFound = false;
-        for (size_t i = 0; i <= payloadLength - 4; i++) {
-            if ((payload[i] == 0x1E && payload[i + 1] == 0xFF && payload[i + 2] == 0x4C && payload[i + 3] == 0x00) ||
-                (payload[i] == 0x4C && payload[i + 1] == 0x00 && payload[i + 2] == 0x12 && payload[i + 3] == 0x19)) {
-                patternFound = true;
-                break;
-            }
-        }
+    if (event == BLE_TRACKER_EVENT_NONE) {
+        printf("%s tracker %s now at %d dBm\n", ble_tracker_type_name(match.type), macAddress, rssi);
+        TERMINAL_VIEW_ADD_TEXT("%s tracker %s now at %d dBm\n", ble_tracker_type_name(match.type), macAddress, rssi);
+        return;
+    }
 
-        if (patternFound) {
-            char macAddress[18];
-            snprintf(macAddress, sizeof(macAddress), "%02x:%02x:%02x:%02x:%02x:%02x",
-                     event->disc.addr.val[0], event->disc.addr.val[1], event->disc.addr.val[2],
-                     event->disc.addr.val[3], event->disc.addr.val[4], event->disc.addr.val[5]);
+    const char *type = ble_tracker_type_name(tag->type);
+    if (event == BLE_TRACKER_EVENT_FOLLOWING) {
+        uint32_t minutes = (tag->last_seen_ms - tag->first_seen_ms) / 60000;
+        ESP_LOGW(TAG_BLE, "%s tracker has been near you for %lu minutes: %lu sightings, %u addresses, now %s",
+                 type, (unsigned long)minutes, (unsigned long)tag->sightings, tag->addresses, macAddress);
+        TERMINAL_VIEW_ADD_TEXT("%s tracker following you for %lu min! MAC: %s, RSSI: %d dBm\n", type,
+                               (unsigned long)minutes, macAddress, rssi);
+        rgb_manager_post(RGB_REQUEST_PULSE, RGB_PRIORITY_ALERT, 255, 0, 0);
+        return;
+    }
 
-            int rssi = event->disc.rssi;
+    airTagCount++;
 
-            printf("AirTag found!\n");
-            printf("Tag: %d\n", airTagCount);
-            printf("MAC Address: %s\n", macAddress);
-            printf("RSSI: %d dBm\n", rssi);
+    printf("%s tracker found!\n", type);
+    printf("Tag: %d\n", airTagCount);
+    printf("MAC Address: %s\n", macAddress);
+    printf("RSSI: %d dBm\n", rssi);
 
-            printf("Payload Data: ");
-            for (size_t i = 0; i < payloadLength; i++) {
-                printf("%02X ", payload[i]);
-            }
-            printf("\n\n");
+    printf("Payload Data: ");
+    for (size_t i = 0; i < payloadLength; i++) {
+        printf("%02X ", payload[i]);
+    }
+    printf("\n\n");
 
-            TERMINAL_VIEW_ADD_TEXT("AirTag found!\n");
-            TERMINAL_VIEW_ADD_TEXT("Tag: %d\n", airTagCount);
-            TERMINAL_VIEW_ADD_TEXT("MAC Address: %s\n", macAddress);
-            TERMINAL_VIEW_ADD_TEXT("RSSI: %d dBm\n", rssi);
+    TERMINAL_VIEW_ADD_TEXT("%s tracker found!\n", type);
+    TERMINAL_VIEW_ADD_TEXT("Tag: %d\n", airTagCount);
+    TERMINAL_VIEW_ADD_TEXT("MAC Address: %s\n", macAddress);
+    TERMINAL_VIEW_ADD_TEXT("RSSI: %d dBm\n", rssi);
 
-            TERMINAL_VIEW_ADD_TEXT("Payload Data: ");
-            for (size_t i = 0; i < payloadLength; i++) {
-                TERMINAL_VIEW_ADD_TEXT("%02X ", payload[i]);
-            }
-            TERMINAL_VIEW_ADD_TEXT("\n\n");
-        }
+    TERMINAL_VIEW_ADD_TEXT("Payload Data: ");
+    for (size_t i = 0; i < payloadLength; i++) {
+        TERMINAL_VIEW_ADD_TEXT("%02X ", payload[i]);
     }
+    TERMINAL_VIEW_ADD_TEXT("\n\n");
 }
 
 void ble_start_scanning(void) {
@@ -394,10 +426,26 @@ void ble_start_scanning(void) {
     {
         ble_init();
     }
+    if (!ble_gap_disc_active()) {
+        if (ble_devices_lock == NULL) {
+            ble_devices_lock = xSemaphoreCreateMutex();
+        }
+        if (ble_devices_lock == NULL ||
+            (ble_devices.devices == NULL && !ble_device_table_init(&ble_devices, CONFIG_BLE_DEVICE_TABLE_SIZE))) {
+            ESP_LOGE(TAG_BLE, "No memory to track %d BLE devices", CONFIG_BLE_DEVICE_TABLE_SIZE);
+            return;
+        }
+        xSemaphoreTake(ble_devices_lock, portMAX_DELAY);
+        ble_device_table_clear(&ble_devices);
+        xSemaphoreGive(ble_devices_lock);
+        device_table_set_view(&device_table_ble, &ble_device_view, ble_devices.capacity);
+    }
+
     struct ble_gap_disc_params disc_params = {0};
     disc_params.itvl = BLE_HCI_SCAN_ITVL_DEF;
     disc_params.window = BLE_HCI_SCAN_WINDOW_DEF;
-    disc_params.filter_duplicates = 1;
+    // Repeats carry the RSSI changes, the device table filters them instead of the controller
+    disc_params.filter_duplicates = 0;
 
     // Start a new BLE scan
     int rc = ble_gap_disc(BLE_OWN_ADDR_PUBLIC, BLE_HS_FOREVER, &disc_params, ble_gap_event_general, NULL);
@@ -410,7 +458,7 @@ void ble_start_scanning(void) {
 }
 
 
-esp_err_t ble_register_handler(ble_data_handler_t handler) {
+esp_err_t ble_register_handler(ble_data_handler_t handler, uint32_t interest) {
     if (handler_count < MAX_HANDLERS) {
         ble_handler_t *new_handlers = realloc(handlers, (handler_count + 1) * sizeof(ble_handler_t));
         if (!new_handlers) {
@@ -420,6 +468,7 @@ esp_err_t ble_register_handler(ble_data_handler_t handler) {
 
         handlers = new_handlers;
         handlers[handler_count].handler = handler;
+        handlers[handler_count].interest = interest;
         handler_count++;
         return ESP_OK;
     }
@@ -463,7 +512,7 @@ if (!ble_initialized) {
 
 void ble_start_find_flippers(void)
 {
-    ble_register_handler(ble_findtheflippers_callback);
+    ble_register_handler(ble_findtheflippers_callback, BLE_ADV_HAS_UUIDS);
     ble_start_scanning();
 }
 
@@ -476,20 +525,20 @@ void ble_deinit(void) {
 }
 
 void ble_stop(void) {
-    if (last_company_id != NULL) {
-        free(last_company_id);
-        last_company_id = NULL;
-    }
     rgb_manager_set_color(&rgb_manager, 0, 0, 0, 0, false);
     ble_unregister_handler(ble_findtheflippers_callback);
     ble_unregister_handler(airtag_scanner_callback);
     ble_unregister_handler(ble_print_raw_packet_callback);
     ble_unregister_handler(detect_ble_spam_callback);
+    ble_unregister_handler(ble_pcap_capture_callback);
+    ble_pcap_writer_stop();
     int rc = ble_gap_disc_cancel();
 
     if (rc == 0) {
         ESP_LOGI(TAG_BLE, "BLE scanning stopped successfully.");
         TERMINAL_VIEW_ADD_TEXT("BLE scanning stopped successfully.");
+        printf("Tracked %u BLE devices, %lu evicted, %lu aged out\n", ble_devices.count,
+               (unsigned long)ble_devices.evicted, (unsigned long)ble_devices.expired);
     } else if (rc == BLE_HS_EALREADY) {
         ESP_LOGW(TAG_BLE, "BLE scanning was not active.");
     } else {
@@ -499,19 +548,37 @@ void ble_stop(void) {
 
 void ble_start_blespam_detector(void)
 {
-    ble_register_handler(detect_ble_spam_callback);
+    ble_spam_reset(&spam_detector);
+    ble_register_handler(detect_ble_spam_callback, BLE_ADV_ANY);
     ble_start_scanning();
 }
 
 void ble_start_raw_ble_packetscan(void)
 {
-    ble_register_handler(ble_print_raw_packet_callback);
+    ble_register_handler(ble_print_raw_packet_callback, BLE_ADV_ANY);
+    ble_start_scanning();
+}
+
+void ble_start_capture(void)
+{
+    if (!ble_pcap_writer_start()) {
+        ESP_LOGE(TAG_BLE, "No memory for the PCAP writer.");
+        return;
+    }
+    ble_register_handler(ble_pcap_capture_callback, BLE_ADV_ANY);
+    ble_start_scanning();
+}
+
+void ble_start_device_list(void)
+{
     ble_start_scanning();
 }
 
 void ble_start_airtag_scanner(void)
 {
-    ble_register_handler(airtag_scanner_callback);
+    airTagCount = 0;
+    ble_tracker_init(&trackers, CONFIG_BLE_TRACKER_WINDOW_MIN * 60000u);
+    ble_register_handler(airtag_scanner_callback, BLE_ADV_HAS_MFG | BLE_ADV_HAS_SERVICE_DATA | BLE_ADV_HAS_UUID16);
     ble_start_scanning();
 }
 
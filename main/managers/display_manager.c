@@ -1,13 +1,24 @@
 #include "managers/display_manager.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include "lvgl_helpers.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "managers/sd_card_manager.h"
 #include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include <string.h>
 #include "managers/views/error_popup.h"
 #include "managers/views/options_screen.h"
 #include "managers/views/main_menu_screen.h"
+#include "core/input_debounce.h"
+#include "core/touch_filter.h"
+#include "managers/image_decoder.h"
+#include "managers/ui_benchmark.h"
+#include "managers/display_stats.h"
+#include "managers/view_transition.h"
+#include "src/draw/sw/lv_draw_sw.h"
 #ifdef CONFIG_USE_CARDPUTER
 #include "vendor/m5/m5gfx_wrapper.h"
 #include "vendor/keyboard_handler.h"
@@ -25,12 +36,10 @@
 #define CONFIG_TFT_HEIGHT 320
 #endif
 
-
-#define LVGL_TASK_PERIOD_MS 5
-
 DisplayManager dm = { .current_view = NULL, .previous_view = NULL };
 
-lv_obj_t *status_bar;
+lv_obj_t *status_bar = NULL;
+lv_obj_t *status_bar_title = NULL;
 lv_obj_t *wifi_label = NULL;
 lv_obj_t *bt_label = NULL;
 lv_obj_t *sd_label = NULL;
@@ -38,8 +47,6 @@ lv_obj_t *battery_label = NULL;
 
 
 
-#define FADE_DURATION_MS 10
-
 #ifdef CONFIG_USE_CARDPUTER
 Keyboard_t gkeyboard;
 
@@ -57,67 +64,298 @@ void m5stack_lvgl_render_callback(lv_disp_drv_t *drv, const lv_area_t *area, lv_
 #endif
 
 
-void fade_out_cb(void *obj, int32_t v) {
-    if (obj)
-    {
-        lv_obj_set_style_opa(obj, v, LV_PART_MAIN);
+typedef struct {
+    View *view;
+    const char *status_title;
+    size_t bytes;
+    uint32_t last_used;
+} ViewCacheEntry;
+
+static ViewCacheEntry view_cache[VIEW_CACHE_MAX_ENTRIES];
+static size_t view_cache_bytes = 0;
+static uint32_t view_cache_clock = 0;
+static uint32_t view_cache_hits = 0;
+static uint32_t view_cache_misses = 0;
+static int64_t last_switch_us = 0;
+static int32_t last_switch_heap_delta = 0;
+static int64_t switch_start_us = 0;
+static size_t switch_start_free = 0;
+static size_t current_view_bytes = 0;
+static int64_t last_create_us = 0;
+
+static const char *status_bar_title_text = NULL;
+
+static View *select_view = NULL;   // View the last select press went to, its long press goes there too
+static int64_t last_tick_us = 0;   // LVGL tick time already passed on with lv_tick_inc
+
+typedef struct {
+    View *view;
+    uint32_t visits;
+    size_t bytes;        // UI memory the view used after its last create
+    uint32_t peak_used;  // Highest LVGL heap usage while the view was active
+    uint8_t frag_pct;    // LVGL heap fragmentation when the view was left
+} ViewMemStats;
+
+static ViewMemStats view_mem_stats[VIEW_MEM_STATS_MAX];
+static ViewMemStats *view_mem_active = NULL;
+
+
+static size_t display_manager_free_ui_memory(void) {
+#if LV_MEM_CUSTOM
+    return heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.free_size;
+#endif
+}
+
+static size_t display_manager_largest_free_ui_block(void) {
+#if LV_MEM_CUSTOM
+    return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.free_biggest_size;
+#endif
+}
+
+static ViewMemStats *view_mem_stats_get(View *view) {
+    ViewMemStats *free_slot = NULL;
+    for (int i = 0; i < VIEW_MEM_STATS_MAX; i++) {
+        if (view_mem_stats[i].view == view) {
+            return &view_mem_stats[i];
+        }
+        if (free_slot == NULL && view_mem_stats[i].view == NULL) {
+            free_slot = &view_mem_stats[i];
+        }
+    }
+
+    if (free_slot) {
+        free_slot->view = view;
+    }
+    return free_slot;
+}
+
+static void view_mem_stats_sample(ViewMemStats *stats) {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    if (mon.max_used > stats->peak_used) {
+        stats->peak_used = mon.max_used;
     }
+    stats->frag_pct = mon.frag_pct;
 }
 
+// Closes the previous view's figures and starts a fresh high-water mark for the next one
+static void view_mem_stats_begin(View *view) {
+    if (view_mem_active) {
+        view_mem_stats_sample(view_mem_active);
+    }
+    lv_mem_reset_max_used();
+
+    view_mem_active = view_mem_stats_get(view);
+    if (view_mem_active) {
+        view_mem_active->visits++;
+    }
+}
 
-void fade_in_cb(void *obj, int32_t v) {
-    if (obj)
-    {
-        lv_obj_set_style_opa(obj, v, LV_PART_MAIN);
+static ViewCacheEntry *view_cache_find(View *view) {
+    for (int i = 0; i < VIEW_CACHE_MAX_ENTRIES; i++) {
+        if (view_cache[i].view == view) {
+            return &view_cache[i];
+        }
     }
+    return NULL;
 }
 
+static void view_cache_drop(ViewCacheEntry *entry, bool destroy) {
+    if (entry == NULL || entry->view == NULL) return;
 
-void display_manager_fade_out(lv_obj_t *obj, lv_anim_ready_cb_t ready_cb, View* view) {
-    lv_anim_t anim;
-    lv_anim_init(&anim);
-    lv_anim_set_var(&anim, obj);
-    lv_anim_set_values(&anim, LV_OPA_COVER, LV_OPA_TRANSP);
-    lv_anim_set_time(&anim, FADE_DURATION_MS);
-    lv_anim_set_exec_cb(&anim, (lv_anim_exec_xcb_t)fade_out_cb);
-    lv_anim_set_ready_cb(&anim, ready_cb);
-    lv_anim_set_user_data(&anim, view);
-    lv_anim_start(&anim);
+    if (destroy && entry->view->destroy) {
+        entry->view->destroy();
+    }
+
+    view_cache_bytes -= entry->bytes;
+    memset(entry, 0, sizeof(*entry));
 }
 
+static ViewCacheEntry *view_cache_lru(void) {
+    ViewCacheEntry *lru = NULL;
+    for (int i = 0; i < VIEW_CACHE_MAX_ENTRIES; i++) {
+        if (view_cache[i].view && (lru == NULL || view_cache[i].last_used < lru->last_used)) {
+            lru = &view_cache[i];
+        }
+    }
+    return lru;
+}
 
-void display_manager_fade_in(lv_obj_t *obj) {
-    lv_anim_t anim;
-    lv_anim_init(&anim);
-    lv_anim_set_var(&anim, obj);
-    lv_anim_set_values(&anim, LV_OPA_TRANSP, LV_OPA_COVER);
-    lv_anim_set_time(&anim, FADE_DURATION_MS);
-    lv_anim_set_exec_cb(&anim, (lv_anim_exec_xcb_t)fade_in_cb);
-    lv_anim_start(&anim);
+/**
+ * @brief Evicts cached views, least recently used first, until a view needing this much fits.
+ *        The cache budget alone does not see how much of a small LVGL heap is left.
+ */
+static void view_cache_make_room(size_t needed) {
+    while (display_manager_largest_free_ui_block() < needed) {
+        ViewCacheEntry *lru = view_cache_lru();
+        if (lru == NULL) break;
+        printf("View cache evicting %s to make room (%u bytes)\n", lru->view->name, (unsigned)lru->bytes);
+        view_cache_drop(lru, true);
+    }
 }
 
+static void view_cache_store(View *view, size_t bytes) {
+    if (bytes > VIEW_CACHE_BUDGET_BYTES) {
+        view->destroy();
+        return;
+    }
+
+    while (view_cache_bytes + bytes > VIEW_CACHE_BUDGET_BYTES) {
+        ViewCacheEntry *lru = view_cache_lru();
+        if (lru == NULL) break;
+        printf("View cache evicting %s (%u bytes)\n", lru->view->name, (unsigned)lru->bytes);
+        view_cache_drop(lru, true);
+    }
+
+    ViewCacheEntry *slot = NULL;
+    for (int i = 0; i < VIEW_CACHE_MAX_ENTRIES; i++) {
+        if (view_cache[i].view == NULL) {
+            slot = &view_cache[i];
+            break;
+        }
+    }
+
+    if (slot == NULL) {
+        slot = view_cache_lru();
+        printf("View cache evicting %s (%u bytes)\n", slot->view->name, (unsigned)slot->bytes);
+        view_cache_drop(slot, true);
+    }
 
-void fade_out_ready_cb(lv_anim_t *anim) {
+    lv_obj_add_flag(view->root, LV_OBJ_FLAG_HIDDEN);
+
+    slot->view = view;
+    slot->status_title = status_bar_title_text;
+    slot->bytes = bytes;
+    slot->last_used = ++view_cache_clock;
+    view_cache_bytes += bytes;
+}
+
+/**
+ * @brief Hides the current view into the cache if it allows it, otherwise destroys it.
+ */
+static void display_manager_release_current_view(void) {
+    View *view = dm.current_view;
+    if (view == NULL) return;
+
+    ViewCacheEntry *entry = view_cache_find(view);
+
+#ifdef CONFIG_VIEW_CACHE
+    if (view->cacheable && view->root) {
+        if (entry) {
+            lv_obj_add_flag(view->root, LV_OBJ_FLAG_HIDDEN);
+            entry->last_used = ++view_cache_clock;
+        } else {
+            // The view still holds roughly what it took to create it
+            view_cache_store(view, current_view_bytes);
+        }
+        dm.current_view = NULL;
+        return;
+    }
+#endif
+
+    view_cache_drop(entry, false);
     display_manager_destroy_current_view();
+}
+
+/**
+ * @brief Shows a view, reusing its cached object tree when possible.
+ */
+static void display_manager_show_view(View *view) {
+    dm.previous_view = dm.current_view;
+    dm.current_view = view;
+
+    if (view->get_hardwareinput_callback) {
+        view->get_hardwareinput_callback((void **)&view->input_callback);
+    }
+
+    // Views that want the status bar bring it back through display_manager_add_status_bar
+    if (status_bar) {
+        lv_obj_add_flag(status_bar, LV_OBJ_FLAG_HIDDEN);
+    }
+    status_bar_title_text = NULL;
+
+    view_mem_stats_begin(view);
+
+    ViewCacheEntry *entry = view_cache_find(view);
+    if (entry && view->root && (view->is_cache_valid == NULL || view->is_cache_valid())) {
+        lv_obj_clear_flag(view->root, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_move_foreground(view->root);
+        entry->last_used = ++view_cache_clock;
+        current_view_bytes = entry->bytes;
+        last_create_us = 0;
+        view_cache_hits++;
 
-    View *new_view = (View *)anim->user_data;
-    if (new_view) {
-        dm.previous_view = dm.current_view;
-        dm.current_view = new_view;
-        
-        if (new_view->get_hardwareinput_callback) {
-            new_view->input_callback(&dm.current_view->input_callback);
+        if (entry->status_title) {
+            display_manager_add_status_bar(entry->status_title);
         }
+    } else {
+        view_cache_drop(entry, true);
+        view_cache_misses++;
+
+        // A view's size varies with what it shows, the options list by menu, so the reserve is a floor
+        size_t needed = view_mem_active ? view_mem_active->bytes + view_mem_active->bytes / 4 : 0;
+        view_cache_make_room(needed > VIEW_CACHE_CREATE_RESERVE_BYTES ? needed : VIEW_CACHE_CREATE_RESERVE_BYTES);
+
+        size_t free_before = display_manager_free_ui_memory();
+        int64_t create_start = esp_timer_get_time();
+        view->create();
+        last_create_us = esp_timer_get_time() - create_start;
+        size_t free_after = display_manager_free_ui_memory();
+
+        current_view_bytes = free_before > free_after ? free_before - free_after : 0;
+    }
+
+    if (view_mem_active) {
+        view_mem_active->bytes = current_view_bytes;
+    }
 
-        new_view->create();
-        display_manager_fade_in(new_view->root);
-        display_manager_fade_in(status_bar);
+    view_transition_start(view->root);
+    if (status_bar && !lv_obj_has_flag(status_bar, LV_OBJ_FLAG_HIDDEN)) {
+        lv_obj_move_foreground(status_bar);
     }
+
+    last_switch_us = esp_timer_get_time() - switch_start_us;
+    last_switch_heap_delta = (int32_t)switch_start_free - (int32_t)display_manager_free_ui_memory();
 }
 
 
+static void switch_view_async_cb(void *data) {
+    if (dm.current_view && dm.current_view->root) {
+        view_transition_prepare(dm.current_view->root);
+    }
+    display_manager_release_current_view();
+    display_manager_show_view((View *)data);
+}
+
+
+static void status_bar_set_icon(lv_obj_t **label, bool visible, const char *symbol, int pos_x) {
+    if (*label == NULL) {
+        if (!visible) return;
+        *label = lv_label_create(status_bar);
+        lv_label_set_text(*label, symbol);
+        lv_obj_align(*label, LV_ALIGN_LEFT_MID, pos_x, 0);
+        lv_obj_set_style_text_color(*label, lv_color_white(), 0);
+    }
+
+    if (visible) {
+        lv_obj_clear_flag(*label, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(*label, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
 
 void update_status_bar(bool wifi_enabled, bool bt_enabled, bool sd_card_mounted, int batteryPercentage) {
+    if (status_bar == NULL) return;
+
     lv_disp_t *disp = lv_disp_get_default();
     int hor_res = lv_disp_get_hor_res(disp);
 
@@ -125,49 +363,13 @@ void update_status_bar(bool wifi_enabled, bool bt_enabled, bool sd_card_mounted,
     int wifi_pos_x = hor_res / 50;
     int bt_pos_x = hor_res / 10;
     int sd_pos_x = hor_res / 6;
-    int battery_pos_x = hor_res - (hor_res / 20) - 5;
 
     // Only render Wi-Fi, Bluetooth, and SD icons if the width is greater than 128
     bool render_icons = (hor_res > 128);
 
-   
-    if (render_icons && wifi_enabled) {
-        if (wifi_label == NULL) {
-            wifi_label = lv_label_create(status_bar);
-            lv_label_set_text(wifi_label, LV_SYMBOL_WIFI);
-            lv_obj_align(wifi_label, LV_ALIGN_LEFT_MID, wifi_pos_x + -5, 0);
-            lv_obj_set_style_text_color(wifi_label, lv_color_white(), 0);
-        }
-    } else if (wifi_label != NULL) {
-        lv_obj_del(wifi_label);
-        wifi_label = NULL;
-    }
-
-    
-    if (render_icons && bt_enabled) {
-        if (bt_label == NULL) {
-            bt_label = lv_label_create(status_bar);
-            lv_label_set_text(bt_label, LV_SYMBOL_BLUETOOTH);
-            lv_obj_align(bt_label, LV_ALIGN_LEFT_MID, bt_pos_x, 0);
-            lv_obj_set_style_text_color(bt_label, lv_color_white(), 0);
-        }
-    } else if (bt_label != NULL) {
-        lv_obj_del(bt_label);
-        bt_label = NULL;
-    }
-
-   
-    if (render_icons && sd_card_mounted) {
-        if (sd_label == NULL) {
-            sd_label = lv_label_create(status_bar);
-            lv_label_set_text(sd_label, LV_SYMBOL_SD_CARD);
-            lv_obj_align(sd_label, LV_ALIGN_LEFT_MID, sd_pos_x, 0);
-            lv_obj_set_style_text_color(sd_label, lv_color_white(), 0);
-        }
-    } else if (sd_label != NULL) {
-        lv_obj_del(sd_label);
-        sd_label = NULL;
-    }
+    status_bar_set_icon(&wifi_label, render_icons && wifi_enabled, LV_SYMBOL_WIFI, wifi_pos_x + -5);
+    status_bar_set_icon(&bt_label, render_icons && bt_enabled, LV_SYMBOL_BLUETOOTH, bt_pos_x);
+    status_bar_set_icon(&sd_label, render_icons && sd_card_mounted, LV_SYMBOL_SD_CARD, sd_pos_x);
 
     
     const char *battery_symbol;
@@ -195,25 +397,34 @@ void update_status_bar(bool wifi_enabled, bool bt_enabled, bool sd_card_mounted,
         lv_obj_set_style_text_color(battery_label, lv_color_white(), 0);
         lv_obj_set_style_text_font(battery_label, render_icons ? &lv_font_montserrat_16 : &lv_font_montserrat_10, 0);
     }
-    else 
-    {
-        lv_obj_del(battery_label); // Fix Battery Not Showing up on other menus
-        battery_label = lv_label_create(status_bar);
-        lv_obj_align(battery_label, LV_ALIGN_RIGHT_MID, -5, 0); 
-        lv_obj_set_style_text_color(battery_label, lv_color_white(), 0);
-        lv_obj_set_style_text_font(battery_label, render_icons ? &lv_font_montserrat_16 : &lv_font_montserrat_10, 0);
-    }
-
 
-    lv_label_set_text_fmt(battery_label, "%s %d%%", battery_symbol, batteryPercentage);
+    char battery_text[24];
+    snprintf(battery_text, sizeof(battery_text), "%s %d%%", battery_symbol, batteryPercentage);
 
-
-    lv_obj_invalidate(status_bar);
+    // Only touch the label when the text changes so an unchanged bar is never redrawn
+    if (strcmp(lv_label_get_text(battery_label), battery_text) != 0) {
+        lv_label_set_text(battery_label, battery_text);
+    }
 }
 
 
 void display_manager_add_status_bar(const char* CurrentMenuName)
 {
+    lv_disp_t *disp = lv_disp_get_default();
+    int hor_res = lv_disp_get_hor_res(disp);
+
+    status_bar_title_text = CurrentMenuName;
+
+    if (status_bar != NULL) {
+        // The bar is persistent, only retitle it and keep it above the new view
+        if (strcmp(lv_label_get_text(status_bar_title), CurrentMenuName) != 0) {
+            lv_label_set_text(status_bar_title, CurrentMenuName);
+        }
+        lv_obj_clear_flag(status_bar, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_move_foreground(status_bar);
+        return;
+    }
+
     status_bar = lv_obj_create(lv_scr_act());
     lv_obj_set_size(status_bar, LV_HOR_RES, 20);
     lv_obj_align(status_bar, LV_ALIGN_TOP_MID, 0, 0);
@@ -227,14 +438,11 @@ void display_manager_add_status_bar(const char* CurrentMenuName)
     lv_obj_set_style_border_color(status_bar, lv_color_white(), LV_PART_MAIN); // Previous color lv_color_hex(0x393939)
     lv_obj_clear_flag(status_bar, LV_OBJ_FLAG_SCROLLABLE);
 
-    lv_disp_t *disp = lv_disp_get_default();
-    int hor_res = lv_disp_get_hor_res(disp);
-
-    lv_obj_t* mainlabel = lv_label_create(status_bar);
-    lv_label_set_text(mainlabel, CurrentMenuName);
-    lv_obj_align(mainlabel, hor_res > 128 ? LV_ALIGN_CENTER : LV_ALIGN_LEFT_MID, hor_res > 128 ? -15 : -5, 0);
-    lv_obj_set_style_text_color(mainlabel, lv_color_white(), 0);
-    lv_obj_set_style_text_font(mainlabel, hor_res > 128 ? &lv_font_montserrat_16 : &lv_font_montserrat_10, 0);
+    status_bar_title = lv_label_create(status_bar);
+    lv_label_set_text(status_bar_title, CurrentMenuName);
+    lv_obj_align(status_bar_title, hor_res > 128 ? LV_ALIGN_CENTER : LV_ALIGN_LEFT_MID, hor_res > 128 ? -15 : -5, 0);
+    lv_obj_set_style_text_color(status_bar_title, lv_color_white(), 0);
+    lv_obj_set_style_text_font(status_bar_title, hor_res > 128 ? &lv_font_montserrat_16 : &lv_font_montserrat_10, 0);
 
     bool HasBluetooth;
 
@@ -247,8 +455,18 @@ void display_manager_add_status_bar(const char* CurrentMenuName)
     update_status_bar(true, HasBluetooth, sd_card_manager.is_initialized, 1000);
 }
 
+static void *glyph_cache_alloc(size_t size) {
+#ifdef CONFIG_SPIRAM
+    void *p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (p != NULL) return p;
+#endif
+    return heap_caps_malloc(size, MALLOC_CAP_8BIT);
+}
+
 void display_manager_init(void) {
     lv_init();
+    image_decoder_init();
+    lv_draw_sw_glyph_cache_init(GLYPH_CACHE_BUDGET_BYTES, glyph_cache_alloc, heap_caps_free);
 #ifdef CONFIG_USE_CARDPUTER
     init_m5gfx_display();
 #else 
@@ -290,6 +508,8 @@ void display_manager_init(void) {
 
 #endif
 
+    display_stats_init(lv_disp_get_default());
+
     dm.mutex = xSemaphoreCreateMutex();
     if (dm.mutex == NULL) {
         printf("Failed to create mutex\n");
@@ -307,6 +527,7 @@ void display_manager_init(void) {
     keyboard_begin(&gkeyboard);
 #endif
 
+    last_tick_us = esp_timer_get_time();
     xTaskCreate(lvgl_tick_task, "LVGL Tick Task", 4096, NULL, RENDERING_TASK_PRIORITY, NULL);
     if (xTaskCreate(hardware_input_task, "RawInput", 2048, NULL, HARDWARE_INPUT_TASK_PRIORITY, NULL) != pdPASS) {
         printf("Failed to create RawInput task\n");
@@ -328,27 +549,14 @@ void display_manager_switch_view(View *view) {
             dm.current_view ? dm.current_view->name : "NULL", 
             view->name);
 
+        switch_start_us = esp_timer_get_time();
+        switch_start_free = display_manager_free_ui_memory();
+
         if (dm.current_view && dm.current_view->root) {
-            if (status_bar)
-            {
-                lv_obj_del(status_bar);
-                wifi_label = NULL;
-                bt_label = NULL;
-                sd_label = NULL;
-                battery_label = NULL;
-                status_bar = NULL;
-            }
-            display_manager_fade_out(dm.current_view->root, fade_out_ready_cb, view);
+            // The swap and its transition run from the LVGL task
+            lv_async_call(switch_view_async_cb, view);
         } else {
-            dm.previous_view = dm.current_view;
-            dm.current_view = view;
-
-            if (view->get_hardwareinput_callback) {
-                view->input_callback(&dm.current_view->input_callback);
-            }
-
-            view->create();
-            display_manager_fade_in(view->root);
+            display_manager_show_view(view);
         }
 
         xSemaphoreGive(dm.mutex);
@@ -367,173 +575,385 @@ void display_manager_destroy_current_view(void) {
     }
 }
 
+void display_manager_flush_view_cache(void) {
+    if (xSemaphoreTake(dm.mutex, pdMS_TO_TICKS(MUTEX_TIMEOUT_MS)) != pdTRUE) {
+        printf("Failed to acquire mutex for flushing view cache\n");
+        return;
+    }
+
+    for (int i = 0; i < VIEW_CACHE_MAX_ENTRIES; i++) {
+        if (view_cache[i].view && view_cache[i].view != dm.current_view) {
+            view_cache_drop(&view_cache[i], true);
+        }
+    }
+
+    xSemaphoreGive(dm.mutex);
+}
+
+void display_manager_print_view_cache_stats(void) {
+    printf("View cache: %u/%u bytes, hits: %lu, misses: %lu\n",
+           (unsigned)view_cache_bytes, (unsigned)VIEW_CACHE_BUDGET_BYTES,
+           (unsigned long)view_cache_hits, (unsigned long)view_cache_misses);
+
+    for (int i = 0; i < VIEW_CACHE_MAX_ENTRIES; i++) {
+        if (view_cache[i].view) {
+            printf("  %-16s %6u bytes%s\n", view_cache[i].view->name, (unsigned)view_cache[i].bytes,
+                   view_cache[i].view == dm.current_view ? " (active)" : "");
+        }
+    }
+
+    printf("Last switch: %lld us, UI memory delta: %ld bytes\n", last_switch_us, (long)last_switch_heap_delta);
+}
+
+void display_manager_get_last_create_stats(int64_t *create_us, size_t *create_bytes) {
+    if (create_us) *create_us = last_create_us;
+    if (create_bytes) *create_bytes = last_create_us ? current_view_bytes : 0;
+}
+
+size_t display_manager_get_free_ui_memory(void) {
+    return display_manager_free_ui_memory();
+}
+
+void display_manager_print_ui_memory_stats(void) {
+#if LV_MEM_CUSTOM
+    printf("LVGL allocates from the system heap (LV_MEM_CUSTOM), %u bytes free\n",
+           (unsigned)heap_caps_get_free_size(MALLOC_CAP_8BIT));
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("UI heap: %lu/%lu bytes used (%u%%), %u%% fragmented, biggest free block %lu, %lu blocks\n",
+           (unsigned long)(mon.total_size - mon.free_size), (unsigned long)mon.total_size, mon.used_pct,
+           mon.frag_pct, (unsigned long)mon.free_biggest_size, (unsigned long)mon.used_cnt);
+
+    lv_mem_class_monitor_t classes[LV_MEM_CLASS_CNT];
+    uint32_t class_cnt = lv_mem_class_monitor(classes);
+    if (class_cnt) {
+        printf("%6s %7s %6s %6s %10s\n", "Size", "Blocks", "Used", "Peak", "Overflows");
+        for (uint32_t i = 0; i < class_cnt; i++) {
+            printf("%6lu %7lu %6lu %6lu %10lu\n", (unsigned long)classes[i].block_size,
+                   (unsigned long)classes[i].block_cnt, (unsigned long)classes[i].used_cnt,
+                   (unsigned long)classes[i].max_used_cnt, (unsigned long)classes[i].fallback_cnt);
+        }
+    }
+
+    if (view_mem_active) {
+        view_mem_stats_sample(view_mem_active);
+    }
+
+    printf("%-16s %7s %8s %8s %7s\n", "View", "Visits", "Size B", "Peak B", "Frag %");
+    for (int i = 0; i < VIEW_MEM_STATS_MAX; i++) {
+        ViewMemStats *stats = &view_mem_stats[i];
+        if (stats->view == NULL) continue;
+        printf("%-16s %7lu %8u %8lu %7u%s\n", stats->view->name, (unsigned long)stats->visits,
+               (unsigned)stats->bytes, (unsigned long)stats->peak_used, stats->frag_pct,
+               stats == view_mem_active ? " (active)" : "");
+    }
+#endif
+}
+
 View *display_manager_get_current_view(void) {
     return dm.current_view;
 }
 
 void display_manager_fill_screen(lv_color_t color)
 {
-    static lv_style_t style;
-    lv_style_init(&style);
-    lv_style_set_bg_color(&style, color); 
-    lv_style_set_bg_opa(&style, LV_OPA_COVER);
+    // Local properties are set in place, adding a style on every view create grew the
+    // screen's style list and leaked the style's values each time
+    lv_obj_set_style_bg_color(lv_scr_act(), color, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_opa(lv_scr_act(), LV_OPA_COVER, LV_PART_MAIN | LV_STATE_DEFAULT);
     lv_obj_set_scrollbar_mode(lv_scr_act(), LV_SCROLLBAR_MODE_OFF);
-    lv_obj_add_style(lv_scr_act(), &style, LV_PART_MAIN | LV_STATE_DEFAULT);
 }
 
-void hardware_input_task(void *pvParameters) {
-    const TickType_t tick_interval = pdMS_TO_TICKS(10);
+#if defined(CONFIG_USE_TOUCHSCREEN) && defined(CONFIG_LV_TOUCH_CONTROLLER_XPT2046) && \
+    (defined(CONFIG_LV_TOUCH_DETECT_IRQ) || defined(CONFIG_LV_TOUCH_DETECT_IRQ_PRESSURE))
+#define INPUT_TOUCH_HAS_IRQ 1
+#endif
 
+#if defined(CONFIG_USE_TOUCHSCREEN) && defined(CONFIG_LV_TOUCH_CONTROLLER_XPT2046)
+#define INPUT_TOUCH_FILTERED 1
+
+// Screen size is filled in once the display is registered
+static touch_filter_config_t touch_filter_config = {
+    .x_min = CONFIG_LV_TOUCH_X_MIN,
+    .x_max = CONFIG_LV_TOUCH_X_MAX,
+    .y_min = CONFIG_LV_TOUCH_Y_MIN,
+    .y_max = CONFIG_LV_TOUCH_Y_MAX,
+#ifdef CONFIG_LV_TOUCH_XY_SWAP
+    .swap_xy = true,
+#endif
+#ifdef CONFIG_LV_TOUCH_INVERT_X
+    .invert_x = true,
+#endif
+#ifdef CONFIG_LV_TOUCH_INVERT_Y
+    .invert_y = true,
+#endif
+    .burst = INPUT_TOUCH_BURST,
+    .max_spread = INPUT_TOUCH_MAX_SPREAD,
+    .iir_shift = INPUT_TOUCH_IIR_SHIFT,
+};
+
+static touch_filter_t touch_filter;
+#endif
+
+static TaskHandle_t input_task_handle = NULL;
+
+static const input_debounce_config_t select_debounce_config = {
+    .debounce_ms = INPUT_DEBOUNCE_MS,
+    .long_press_ms = INPUT_LONG_PRESS_MS,
+};
+
+static const input_debounce_config_t direction_debounce_config = {
+    .debounce_ms = INPUT_DEBOUNCE_MS,
+    .repeat_delay_ms = INPUT_REPEAT_DELAY_MS,
+    .repeat_interval_ms = INPUT_REPEAT_INTERVAL_MS,
+};
+
+static input_debounce_t joystick_debounce[5];
+
+#ifdef CONFIG_USE_CARDPUTER
+// Cardputer key values mapped onto the joystick indices the views expect
+static const struct {
+    uint8_t key_value;
+    int joystick_index;
+} keyboard_joystick_map[] = {
+    { 39, 0 },
+    { 52, 1 },
+    { 30, 2 },
+    { 32, 3 },
+    { 56, 4 },
+};
+#endif
+
+static void IRAM_ATTR input_wakeup_isr(void *arg) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    if (input_task_handle) {
+        vTaskNotifyGiveFromISR(input_task_handle, &higher_priority_task_woken);
+    }
+
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+static void input_post_event(const InputEvent *event) {
+    // Never block the input task, a full queue means the UI is already behind
+    if (xQueueSend(input_queue, event, 0) != pdTRUE) {
+        printf("Failed to send input to queue\n");
+    }
+}
+
+#ifdef CONFIG_USE_TOUCHSCREEN
+static void input_post_touch(int16_t x, int16_t y) {
+    InputEvent event;
+    event.type = INPUT_TYPE_TOUCH;
+    event.data.touch_data.point.x = x;
+    event.data.touch_data.point.y = y;
+    event.data.touch_data.state = LV_INDEV_STATE_PR;
+    input_post_event(&event);
+}
+#endif
+
+static void input_feed_button(int index, bool pressed, uint32_t now_ms) {
+    input_debounce_event_t result;
+
+    while ((result = input_debounce_update(&joystick_debounce[index], pressed, now_ms)) != INPUT_DEBOUNCE_NONE) {
+        InputEvent event;
+        event.data.joystick_index = index;
+
+        switch (result) {
+            case INPUT_DEBOUNCE_PRESS:
+            case INPUT_DEBOUNCE_REPEAT:
+                event.type = INPUT_TYPE_JOYSTICK;
+                input_post_event(&event);
+                break;
+            case INPUT_DEBOUNCE_LONG_PRESS:
+                event.type = INPUT_TYPE_JOYSTICK_LONG_PRESS;
+                input_post_event(&event);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static uint32_t input_min_wait(uint32_t wait, uint32_t candidate) {
+    return candidate < wait ? candidate : wait;
+}
+
+void hardware_input_task(void *pvParameters) {
+#if defined(CONFIG_USE_TOUCHSCREEN) && !defined(INPUT_TOUCH_FILTERED)
     lv_indev_drv_t touch_driver;
     lv_indev_data_t touch_data;
-    uint16_t calData[5] = { 339, 3470, 237, 3438, 2 };
     bool touch_active = false;
-    int screen_width = LV_HOR_RES;
-    int screen_height = LV_VER_RES;
+#endif
+
+    input_task_handle = xTaskGetCurrentTaskHandle();
+
+    for (int i = 0; i < 5; i++) {
+        // Index 1 is select, it gets long press instead of auto repeat
+        input_debounce_init(&joystick_debounce[i], i == 1 ? &select_debounce_config : &direction_debounce_config);
+    }
+
+#ifdef CONFIG_USE_JOYSTICK
+    for (int i = 0; i < 5; i++) {
+        if (joysticks[i].pin >= 0 && joystick_enable_wakeup(&joysticks[i], input_wakeup_isr, NULL) != ESP_OK) {
+            printf("Failed to enable wakeup on joystick %d\n", i);
+        }
+    }
+#endif
+
+#ifdef INPUT_TOUCH_FILTERED
+    touch_filter_config.hor_res = lv_disp_get_hor_res(NULL);
+    touch_filter_config.ver_res = lv_disp_get_ver_res(NULL);
+    touch_filter_init(&touch_filter, &touch_filter_config);
+#endif
+
+#ifdef INPUT_TOUCH_HAS_IRQ
+    // PENIRQ is pulled low by the controller while the panel is touched
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err == ESP_OK || err == ESP_ERR_INVALID_STATE) {
+        gpio_set_intr_type(CONFIG_LV_TOUCH_PIN_IRQ, GPIO_INTR_NEGEDGE);
+        gpio_isr_handler_add(CONFIG_LV_TOUCH_PIN_IRQ, input_wakeup_isr, NULL);
+    }
+#endif
 
-    
     while (1) {
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        uint32_t wait_ms = INPUT_DEBOUNCE_IDLE;
+
+        #ifdef CONFIG_USE_JOYSTICK
+            for (int i = 0; i < 5; i++) {
+                if (joysticks[i].pin >= 0) {
+                    input_feed_button(i, joystick_get_button_state(&joysticks[i]), now_ms);
+                }
+            }
+        #endif
+
         #ifdef CONFIG_USE_CARDPUTER
             keyboard_update_key_list(&gkeyboard);
             keyboard_update_keys_state(&gkeyboard);
-            if (gkeyboard.key_list_buffer_len > 0) {
-                for (size_t i = 0; i < gkeyboard.key_list_buffer_len; ++i) {
-                    Point2D_t key_pos = gkeyboard.key_list_buffer[i];
-                    uint8_t key_value = keyboard_get_key(&gkeyboard, key_pos);
-
-
-                    if (key_value != 0 && !touch_active) {
-                        touch_active = true;
-                        InputEvent event;
-                        event.type = INPUT_TYPE_JOYSTICK;
-
-                        printf("Unhandled key value: %d\n", key_value);
-
-
-                        switch (key_value) {
-                            case 52:
-                                event.data.joystick_index = 1;
-                                break;
-                            case 39:
-                                event.data.joystick_index = 0;
-                                break;
-                            case 30:
-                                event.data.joystick_index = 2;
-                                break;
-                            case 32:
-                                event.data.joystick_index = 3;
-                                break;
-                            case 56:
-                                event.data.joystick_index = 4;
-                                break;
-                            default:
-                                printf("Unhandled key value: %d\n", key_value);
-                                continue;
-                        }
-
-                        if (xQueueSend(input_queue, &event, pdMS_TO_TICKS(10)) != pdTRUE) {
-                            printf("Failed to send button input to queue\n");
-                        }
-
-                        vTaskDelay(pdMS_TO_TICKS(300));
-                    }
-                    else if (touch_active)
-                    {
-                        touch_active = false;
+
+            bool key_down[5] = { false };
+            for (size_t i = 0; i < gkeyboard.key_list_buffer_len; ++i) {
+                uint8_t key_value = keyboard_get_key(&gkeyboard, gkeyboard.key_list_buffer[i]);
+
+                for (size_t k = 0; k < sizeof(keyboard_joystick_map) / sizeof(keyboard_joystick_map[0]); k++) {
+                    if (keyboard_joystick_map[k].key_value == key_value) {
+                        key_down[keyboard_joystick_map[k].joystick_index] = true;
                     }
                 }
             }
-        #endif
-
 
-        #ifdef CONFIG_USE_JOYSTICK
             for (int i = 0; i < 5; i++) {
-                if (joysticks[i].pin >= 0) {
-                    if (joystick_just_pressed(&joysticks[i])) {
-                        InputEvent event;
-                        event.type = INPUT_TYPE_JOYSTICK;
-                        event.data.joystick_index = i;
-
-                        if (xQueueSend(input_queue, &event, pdMS_TO_TICKS(10)) != pdTRUE) {
-                            printf("Failed to send joystick input to queue\n");
-                        }
-                    }
-                }
+                input_feed_button(i, key_down[i], now_ms);
             }
+
+            wait_ms = input_min_wait(wait_ms, INPUT_KEYBOARD_SCAN_MS);
         #endif
 
-        #ifdef CONFIG_USE_TOUCHSCREEN
-            touch_driver_read(&touch_driver, &touch_data);
+        for (int i = 0; i < 5; i++) {
+            wait_ms = input_min_wait(wait_ms, input_debounce_next_deadline(&joystick_debounce[i], now_ms));
+        }
 
-            if (touch_data.state == LV_INDEV_STATE_PR && !touch_active) {
-                touch_active = true;
+        #ifdef CONFIG_USE_TOUCHSCREEN
+        #ifdef INPUT_TOUCH_HAS_IRQ
+            bool touch_irq = gpio_get_level(CONFIG_LV_TOUCH_PIN_IRQ) == 0;
+        #else
+            bool touch_irq = true;
+        #endif
 
-                InputEvent event;
-                event.type = INPUT_TYPE_TOUCH;
-                event.data.touch_data.point.x = touch_data.point.x;
-                event.data.touch_data.point.y = touch_data.point.y;
-                event.data.touch_data.state = touch_data.state;
+        #ifdef INPUT_TOUCH_FILTERED
+            if (touch_filter_should_sample(&touch_filter, touch_irq)) {
+                uint16_t xs[TOUCH_FILTER_MAX_BURST];
+                uint16_t ys[TOUCH_FILTER_MAX_BURST];
+                uint8_t count = xpt2046_read_raw(xs, ys, touch_filter_config.burst);
 
-                if (xQueueSend(input_queue, &event, pdMS_TO_TICKS(10)) != pdTRUE) {
-                    printf("Failed to send touch input to queue\n");
+                // Views only take taps, a drag just keeps the filtered point current
+                if (touch_filter_update(&touch_filter, count > 0, xs, ys, count) == TOUCH_FILTER_PRESS) {
+                    input_post_touch(touch_filter.x, touch_filter.y);
                 }
+
+                // Keep sampling until release, PENIRQ only signals the start of a touch
+                wait_ms = input_min_wait(wait_ms, INPUT_TOUCH_POLL_MS);
             }
-            else if (touch_data.state == LV_INDEV_STATE_REL && touch_active) {
-                touch_active = false;
+        #else
+            if (touch_active || touch_irq) {
+                touch_driver_read(&touch_driver, &touch_data);
+
+                if (touch_data.state == LV_INDEV_STATE_PR && !touch_active) {
+                    touch_active = true;
+                    input_post_touch(touch_data.point.x, touch_data.point.y);
+                }
+                else if (touch_data.state == LV_INDEV_STATE_REL && touch_active) {
+                    touch_active = false;
+                }
+
+                wait_ms = input_min_wait(wait_ms, INPUT_TOUCH_POLL_MS);
             }
         #endif
+        #endif
 
-        vTaskDelay(tick_interval);
+        // Sleep until an edge interrupt or the next debounce/repeat deadline
+        TickType_t wait_ticks = portMAX_DELAY;
+        if (wait_ms != INPUT_DEBOUNCE_IDLE) {
+            wait_ticks = pdMS_TO_TICKS(wait_ms);
+            if (wait_ticks == 0) wait_ticks = 1;
+        }
+        ulTaskNotifyTake(pdTRUE, wait_ticks);
     }
 
     vTaskDelete(NULL);
 }
 
 
-void lvgl_tick_task(void *arg) {
-    const TickType_t tick_interval = pdMS_TO_TICKS(5);
-
+void display_manager_process(void) {
     InputEvent event;
 
-    int tick_increment;
-    
-    if (LV_VER_RES <= 128) {
-        tick_increment = 3;   // For screens 128x128 or smaller
-    } else if (LV_VER_RES > 240) {
-        tick_increment = 10;  // For screens larger than 240x320
-    } else {
-        tick_increment = 5;   // For 240x320 screens
-    }
-
-    while (1)
-    {
-
-        if (xQueueReceive(input_queue, &event, pdMS_TO_TICKS(10)) == pdTRUE) {
-            if (xSemaphoreTake(dm.mutex, pdMS_TO_TICKS(MUTEX_TIMEOUT_MS)) == pdTRUE) {
-                View *current = dm.current_view;
-                void (*input_callback)(InputEvent*) = NULL;
-                const char* view_name = "NULL";
+    if (xQueueReceive(input_queue, &event, pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (xSemaphoreTake(dm.mutex, pdMS_TO_TICKS(MUTEX_TIMEOUT_MS)) == pdTRUE) {
+            View *current = dm.current_view;
+            void (*input_callback)(InputEvent*) = NULL;
+            const char* view_name = "NULL";
+
+            if (current) {
+                view_name = current->name;
+                input_callback = current->input_callback;
+            } else {
+                printf("[WARNING] Current view is NULL in input_processing_task\n");
+            }
 
-                if (current) {
-                    view_name = current->name;
-                    input_callback = current->input_callback;
-                } else {
-                    printf("[WARNING] Current view is NULL in input_processing_task\n");
-                }
+            // A press that switched views must not long press in the new one
+            if (event.type == INPUT_TYPE_JOYSTICK && event.data.joystick_index == 1) {
+                select_view = current;
+            } else if (event.type == INPUT_TYPE_JOYSTICK_LONG_PRESS && current != select_view) {
+                input_callback = NULL;
+            }
 
-                xSemaphoreGive(dm.mutex);
+            xSemaphoreGive(dm.mutex);
 
-                printf("[INFO] Input event type: %d, Current view: %s\n", event.type, view_name);
+            printf("[INFO] Input event type: %d, Current view: %s\n", event.type, view_name);
 
-                if (input_callback) {
-                    input_callback(&event);
-                }
+            if (input_callback) {
+                input_callback(&event);
             }
         }
+    }
+
+    lv_timer_handler();
+    ui_benchmark_process();
 
-        lv_timer_handler();
-        lv_tick_inc(tick_increment);
-        vTaskDelay(tick_interval);
+    // Advance by the time that really passed, a slow frame must not stretch animations
+    int64_t now_us = esp_timer_get_time();
+    uint32_t elapsed_ms = (uint32_t)((now_us - last_tick_us) / 1000);
+    if (elapsed_ms > 0) {
+        lv_tick_inc(elapsed_ms);
+        last_tick_us += (int64_t)elapsed_ms * 1000;
+    }
+}
+
+void lvgl_tick_task(void *arg) {
+    while (1) {
+        display_manager_process();
+        vTaskDelay(pdMS_TO_TICKS(LVGL_TASK_PERIOD_MS));
     }
 
     vTaskDelete(NULL);
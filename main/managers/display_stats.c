@@ -0,0 +1,318 @@
+#include "managers/display_stats.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <time.h>
+#endif
+
+static lv_disp_drv_t *stats_drv = NULL;
+static void (*saved_flush_cb)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *) = NULL;
+static void (*saved_wait_cb)(lv_disp_drv_t *) = NULL;
+static void (*saved_render_start_cb)(lv_disp_drv_t *) = NULL;
+static void (*saved_monitor_cb)(lv_disp_drv_t *, uint32_t, uint32_t) = NULL;
+
+static atomic_bool recording = false;
+static atomic_bool overlay = false;
+static atomic_bool reset_requested = false;
+
+// Written by the LVGL task only, the serial commands just read it
+static display_stats_frame_t ring[DISPLAY_STATS_RING_SIZE];
+static uint32_t ring_head = 0;
+static uint32_t ring_count = 0;
+
+static display_stats_frame_t frame;
+static bool in_frame = false;
+static bool frame_recorded = false;
+static int64_t frame_start_us = 0;
+static bool in_wait = false;
+static int64_t wait_start_us = 0;
+static int64_t wait_last_us = 0;
+
+static lv_area_t redrawn[DISPLAY_STATS_MAX_AREAS];
+static uint16_t redrawn_count = 0;
+static uint32_t overlay_frame = 0;
+
+// Running per pixel cost of large redraws, kept whether or not recording is on
+static uint32_t render_ns_per_px = 0;
+static uint32_t flush_ns_per_px = 0;
+
+static const lv_palette_t overlay_palette[] = {
+    LV_PALETTE_RED, LV_PALETTE_GREEN, LV_PALETTE_BLUE, LV_PALETTE_YELLOW, LV_PALETTE_PURPLE,
+};
+
+static int64_t stats_now_us(void) {
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+// LVGL spins in wait_cb until the driver releases the buffer, so the first and last
+// call of a run bracket the time the frame was blocked on the flush
+static void close_wait(void) {
+    if (in_wait) {
+        frame.flush_us += (uint32_t)(wait_last_us - wait_start_us);
+        in_wait = false;
+    }
+}
+
+static void overlay_pixel(lv_color_t *color_p, const lv_area_t *buf_area, lv_coord_t x, lv_coord_t y,
+                          lv_color_t color) {
+    color_p[(y - buf_area->y1) * lv_area_get_width(buf_area) + (x - buf_area->x1)] = color;
+}
+
+static void draw_overlay(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    // Direct mode and software rotation do not hand over a buffer laid out like the area
+    if (drv->direct_mode || (drv->rotated != LV_DISP_ROT_NONE && drv->sw_rotate)) {
+        return;
+    }
+
+    // flush_cb gets the area shifted by the panel offset
+    lv_area_t buf_area = {
+        .x1 = area->x1 - drv->offset_x,
+        .y1 = area->y1 - drv->offset_y,
+        .x2 = area->x2 - drv->offset_x,
+        .y2 = area->y2 - drv->offset_y,
+    };
+    lv_color_t color = lv_palette_main(overlay_palette[overlay_frame % (sizeof(overlay_palette) /
+                                                                       sizeof(overlay_palette[0]))]);
+
+    for (uint16_t i = 0; i < redrawn_count; i++) {
+        const lv_area_t *r = &redrawn[i];
+        lv_area_t clip;
+        if (!_lv_area_intersect(&clip, &buf_area, r)) {
+            continue;
+        }
+
+        for (lv_coord_t x = clip.x1; x <= clip.x2; x++) {
+            if (r->y1 >= clip.y1) overlay_pixel(color_p, &buf_area, x, r->y1, color);
+            if (r->y2 <= clip.y2) overlay_pixel(color_p, &buf_area, x, r->y2, color);
+        }
+        for (lv_coord_t y = clip.y1; y <= clip.y2; y++) {
+            if (r->x1 >= clip.x1) overlay_pixel(color_p, &buf_area, r->x1, y, color);
+            if (r->x2 <= clip.x2) overlay_pixel(color_p, &buf_area, r->x2, y, color);
+        }
+    }
+}
+
+static void stats_render_start_cb(lv_disp_drv_t *drv) {
+    if (atomic_exchange(&reset_requested, false)) {
+        ring_head = 0;
+        ring_count = 0;
+    }
+
+    // Every frame is timed for the cost estimate, only recorded ones go to the ring
+    in_frame = true;
+    memset(&frame, 0, sizeof(frame));
+    in_wait = false;
+    frame_start_us = stats_now_us();
+
+    frame_recorded = atomic_load(&recording);
+    if (frame_recorded) {
+        // Called after lv_refr_join_area(), the joined flags are still set
+        lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+        frame.areas = disp->inv_p;
+        redrawn_count = 0;
+        for (uint16_t i = 0; i < disp->inv_p; i++) {
+            if (disp->inv_area_joined[i]) {
+                frame.joined++;
+            } else if (redrawn_count < DISPLAY_STATS_MAX_AREAS) {
+                redrawn[redrawn_count++] = disp->inv_areas[i];
+            }
+        }
+        overlay_frame++;
+    }
+
+    if (saved_render_start_cb) saved_render_start_cb(drv);
+}
+
+static void stats_wait_cb(lv_disp_drv_t *drv) {
+    if (in_frame) {
+        int64_t now = stats_now_us();
+        if (!in_wait) {
+            in_wait = true;
+            wait_start_us = now;
+        }
+        wait_last_us = now;
+    }
+
+    if (saved_wait_cb) saved_wait_cb(drv);
+}
+
+static void stats_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+    if (!in_frame) {
+        saved_flush_cb(drv, area, color_p);
+        return;
+    }
+
+    close_wait();
+    if (frame_recorded && atomic_load(&overlay)) {
+        draw_overlay(drv, area, color_p);
+    }
+
+    int64_t start = stats_now_us();
+    saved_flush_cb(drv, area, color_p);
+    frame.flush_us += (uint32_t)(stats_now_us() - start);
+    frame.flushes++;
+    frame.flush_bytes += lv_area_get_size(area) * sizeof(lv_color_t);
+}
+
+static void update_cost(uint32_t *avg, uint32_t sample) {
+    // Quarter weight per frame, one unusual frame does not swing the estimate
+    *avg = *avg ? *avg - *avg / 4 + sample / 4 : sample;
+}
+
+static void stats_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px) {
+    if (in_frame) {
+        close_wait();
+        uint32_t total_us = (uint32_t)(stats_now_us() - frame_start_us);
+        frame.render_us = total_us > frame.flush_us ? total_us - frame.flush_us : 0;
+        frame.px = px;
+
+        // Small redraws are mostly fixed overhead and would overstate the cost per pixel
+        uint32_t screen_px = (uint32_t)drv->hor_res * drv->ver_res;
+        if (px > 0 && px >= screen_px / DISPLAY_STATS_COST_MIN_FRACTION) {
+            update_cost(&render_ns_per_px, (uint32_t)((uint64_t)frame.render_us * 1000 / px));
+            update_cost(&flush_ns_per_px, (uint32_t)((uint64_t)frame.flush_us * 1000 / px));
+        }
+
+        if (frame_recorded) {
+            ring[ring_head] = frame;
+            ring_head = (ring_head + 1) % DISPLAY_STATS_RING_SIZE;
+            if (ring_count < DISPLAY_STATS_RING_SIZE) ring_count++;
+        }
+        in_frame = false;
+    }
+
+    if (saved_monitor_cb) saved_monitor_cb(drv, time, px);
+}
+
+void display_stats_init(lv_disp_t *disp) {
+    if (disp == NULL || stats_drv != NULL || disp->driver->flush_cb == NULL) {
+        return;
+    }
+
+    stats_drv = disp->driver;
+    saved_flush_cb = stats_drv->flush_cb;
+    saved_wait_cb = stats_drv->wait_cb;
+    saved_render_start_cb = stats_drv->render_start_cb;
+    saved_monitor_cb = stats_drv->monitor_cb;
+
+    stats_drv->flush_cb = stats_flush_cb;
+    stats_drv->wait_cb = stats_wait_cb;
+    stats_drv->render_start_cb = stats_render_start_cb;
+    stats_drv->monitor_cb = stats_monitor_cb;
+}
+
+void display_stats_set_enabled(bool enabled) {
+    atomic_store(&recording, enabled);
+    if (!enabled) {
+        atomic_store(&overlay, false);
+    }
+}
+
+void display_stats_set_overlay(bool enabled) {
+    atomic_store(&overlay, enabled);
+    if (enabled) {
+        atomic_store(&recording, true);
+    }
+    // Redraw everything so the outlines show the next real update, not stale pixels
+    if (stats_drv) {
+        lv_obj_invalidate(lv_scr_act());
+    }
+}
+
+bool display_stats_is_enabled(void) {
+    return atomic_load(&recording);
+}
+
+bool display_stats_is_overlay_enabled(void) {
+    return atomic_load(&overlay);
+}
+
+bool display_stats_get_cost(uint32_t *render_ns, uint32_t *flush_ns) {
+    if (render_ns) *render_ns = render_ns_per_px;
+    if (flush_ns) *flush_ns = flush_ns_per_px;
+    return render_ns_per_px != 0 || flush_ns_per_px != 0;
+}
+
+void display_stats_reset(void) {
+    atomic_store(&reset_requested, true);
+}
+
+static const display_stats_frame_t *ring_frame(uint32_t i) {
+    uint32_t oldest = (ring_head + DISPLAY_STATS_RING_SIZE - ring_count) % DISPLAY_STATS_RING_SIZE;
+    return &ring[(oldest + i) % DISPLAY_STATS_RING_SIZE];
+}
+
+uint32_t display_stats_frame_count(void) {
+    // A reset is applied by the next frame, until then the ring already counts as empty
+    return atomic_load(&reset_requested) ? 0 : ring_count;
+}
+
+bool display_stats_get_frame(uint32_t index, display_stats_frame_t *out) {
+    if (index >= display_stats_frame_count()) {
+        return false;
+    }
+    *out = *ring_frame(index);
+    return true;
+}
+
+void display_stats_print_summary(void) {
+    uint32_t count = display_stats_frame_count();
+    printf("Display stats: recording %s, overlay %s, %lu frames\n", atomic_load(&recording) ? "on" : "off",
+           atomic_load(&overlay) ? "on" : "off", (unsigned long)count);
+    if (count == 0) {
+        return;
+    }
+
+    uint64_t render_sum = 0, flush_sum = 0, px_sum = 0, bytes_sum = 0;
+    uint32_t render_max = 0, flush_max = 0, frame_max = 0, px_max = 0;
+    uint32_t areas_sum = 0, joined_sum = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const display_stats_frame_t *f = ring_frame(i);
+        render_sum += f->render_us;
+        flush_sum += f->flush_us;
+        px_sum += f->px;
+        bytes_sum += f->flush_bytes;
+        areas_sum += f->areas;
+        joined_sum += f->joined;
+        if (f->render_us > render_max) render_max = f->render_us;
+        if (f->flush_us > flush_max) flush_max = f->flush_us;
+        if (f->render_us + f->flush_us > frame_max) frame_max = f->render_us + f->flush_us;
+        if (f->px > px_max) px_max = f->px;
+    }
+
+    uint32_t screen_px = (uint32_t)lv_disp_get_hor_res(NULL) * lv_disp_get_ver_res(NULL);
+    printf("%-12s %10s %10s\n", "", "Avg", "Max");
+    printf("%-12s %10lu %10lu\n", "Render us", (unsigned long)(render_sum / count), (unsigned long)render_max);
+    printf("%-12s %10lu %10lu\n", "Flush us", (unsigned long)(flush_sum / count), (unsigned long)flush_max);
+    printf("%-12s %10lu %10lu\n", "Frame us", (unsigned long)((render_sum + flush_sum) / count),
+           (unsigned long)frame_max);
+    printf("%-12s %10lu %10lu\n", "Pixels", (unsigned long)(px_sum / count), (unsigned long)px_max);
+    printf("%-12s %10lu\n", "Flush bytes", (unsigned long)(bytes_sum / count));
+    printf("Screen redrawn per frame: %lu%%, areas invalidated: %lu.%lu, joined: %lu%%\n",
+           (unsigned long)(screen_px ? px_sum * 100 / count / screen_px : 0), (unsigned long)(areas_sum / count),
+           (unsigned long)(areas_sum * 10 / count % 10),
+           (unsigned long)(areas_sum ? (uint64_t)joined_sum * 100 / areas_sum : 0));
+}
+
+void display_stats_dump(void) {
+    uint32_t count = display_stats_frame_count();
+    printf("%5s %10s %9s %6s %6s %8s %7s %8s\n", "Frame", "Render us", "Flush us", "Areas", "Joined", "Pixels",
+           "Flushes", "Flush B");
+    for (uint32_t i = 0; i < count; i++) {
+        const display_stats_frame_t *f = ring_frame(i);
+        printf("%5lu %10lu %9lu %6u %6u %8lu %7u %8lu\n", (unsigned long)i, (unsigned long)f->render_us,
+               (unsigned long)f->flush_us, f->areas, f->joined, (unsigned long)f->px, f->flushes,
+               (unsigned long)f->flush_bytes);
+    }
+}
@@ -0,0 +1,472 @@
+#include "managers/image_decoder.h"
+#include "managers/display_manager.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "ImageDecoder";
+
+typedef struct {
+    uint8_t flags;
+    uint16_t width;
+    uint16_t height;
+    const uint8_t *offsets;
+    const uint8_t *rows;
+    const uint8_t *end;
+} rle_image_t;
+
+typedef struct {
+    const lv_img_dsc_t *src;
+    uint8_t *pixels;   // Planar RGB565A8, colors followed by alpha
+    size_t bytes;
+    uint32_t refs;     // Open LVGL decoder sessions drawing from this entry
+    uint32_t last_used;
+} image_cache_entry_t;
+
+static image_cache_entry_t image_cache[IMAGE_CACHE_MAX_ENTRIES];
+static size_t image_cache_bytes = 0;
+static uint32_t image_cache_tick = 0;
+static SemaphoreHandle_t image_cache_mutex = NULL;
+
+static uint32_t stat_hits = 0;
+static uint32_t stat_misses = 0;
+static uint32_t stat_evictions = 0;
+static uint32_t stat_line_opens = 0;
+static uint32_t stat_decodes = 0;
+static int64_t stat_decode_us = 0;
+
+static uint32_t read_u16(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool rle_parse(const lv_img_dsc_t *img, rle_image_t *rle) {
+    if (img == NULL || img->header.cf != LV_IMG_CF_RAW_ALPHA || img->data == NULL ||
+        img->data_size < IMAGE_RLE_HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t *data = img->data;
+    if (memcmp(data, IMAGE_RLE_MAGIC, 4) != 0 || data[4] != IMAGE_RLE_VERSION) {
+        return false;
+    }
+
+    rle->flags = data[5];
+    rle->width = read_u16(data + 6);
+    rle->height = read_u16(data + 8);
+
+    size_t table_size = (size_t)rle->height * 4;
+    if (rle->width != img->header.w || rle->height != img->header.h ||
+        img->data_size < IMAGE_RLE_HEADER_SIZE + table_size) {
+        return false;
+    }
+
+    rle->offsets = data + IMAGE_RLE_HEADER_SIZE;
+    rle->rows = rle->offsets + table_size;
+    rle->end = data + img->data_size;
+    return true;
+}
+
+/*
+ * Walks one PackBits stream of `total` units and copies units [first, first + count)
+ * to out. Returns the end of the stream, or NULL if it is malformed.
+ */
+static const uint8_t *rle_unpack(const uint8_t *src, const uint8_t *end, int unit,
+                                 int32_t total, int32_t first, int32_t count, uint8_t *out) {
+    int32_t pos = 0;
+    int32_t last = first + count;
+
+    while (pos < total) {
+        if (src >= end) return NULL;
+
+        uint8_t ctrl = *src++;
+        int32_t n = (ctrl & 0x7F) + 1;
+        bool run = (ctrl & 0x80) != 0;
+        int32_t in_bytes = run ? unit : n * unit;
+
+        if (pos + n > total || src + in_bytes > end) return NULL;
+
+        int32_t from = pos > first ? pos : first;
+        int32_t to = (pos + n) < last ? (pos + n) : last;
+
+        if (from < to) {
+            uint8_t *dst = out + (from - first) * unit;
+            if (!run) {
+                memcpy(dst, src + (from - pos) * unit, (to - from) * unit);
+            } else if (unit == 1) {
+                memset(dst, src[0], to - from);
+            } else {
+                for (int32_t i = from; i < to; i++, dst += 2) {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                }
+            }
+        }
+
+        src += in_bytes;
+        pos += n;
+    }
+
+    return src;
+}
+
+static bool rle_decode_row(const rle_image_t *rle, int32_t y, int32_t x, int32_t len,
+                           uint8_t *colors, uint8_t *alpha) {
+    if (y < 0 || y >= rle->height || x < 0 || len <= 0 || x + len > rle->width) {
+        return false;
+    }
+
+    const uint8_t *src = rle->rows + read_u32(rle->offsets + (size_t)y * 4);
+    if (src < rle->rows || src >= rle->end) {
+        return false;
+    }
+
+    src = rle_unpack(src, rle->end, 2, rle->width, x, len, colors);
+    if (src == NULL || rle_unpack(src, rle->end, 1, rle->width, x, len, alpha) == NULL) {
+        return false;
+    }
+
+    // Assets are normally exported in the display byte order, fix them up otherwise
+    if (((rle->flags & IMAGE_RLE_FLAG_SWAPPED) != 0) != (LV_COLOR_16_SWAP != 0)) {
+        for (int32_t i = 0; i < len; i++) {
+            uint8_t tmp = colors[i * 2];
+            colors[i * 2] = colors[i * 2 + 1];
+            colors[i * 2 + 1] = tmp;
+        }
+    }
+
+    return true;
+}
+
+static bool rle_decode_image(const rle_image_t *rle, uint8_t *out) {
+    size_t pixels = (size_t)rle->width * rle->height;
+    uint8_t *colors = out;
+    uint8_t *alpha = out + pixels * sizeof(lv_color_t);
+
+    for (int32_t y = 0; y < rle->height; y++) {
+        if (!rle_decode_row(rle, y, 0, rle->width, colors + (size_t)y * rle->width * sizeof(lv_color_t),
+                            alpha + (size_t)y * rle->width)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void image_cache_free_entry(image_cache_entry_t *entry) {
+    image_cache_bytes -= entry->bytes;
+    heap_caps_free(entry->pixels);
+    memset(entry, 0, sizeof(*entry));
+}
+
+static bool image_cache_make_room(size_t bytes) {
+    while (true) {
+        image_cache_entry_t *free_slot = NULL;
+        image_cache_entry_t *lru = NULL;
+
+        for (int i = 0; i < IMAGE_CACHE_MAX_ENTRIES; i++) {
+            image_cache_entry_t *entry = &image_cache[i];
+            if (entry->src == NULL) {
+                if (free_slot == NULL) free_slot = entry;
+            } else if (entry->refs == 0 && (lru == NULL || entry->last_used < lru->last_used)) {
+                lru = entry;
+            }
+        }
+
+        if (free_slot && image_cache_bytes + bytes <= IMAGE_CACHE_BUDGET_BYTES) {
+            return true;
+        }
+        if (lru == NULL) {
+            return false; // Everything left is being drawn right now
+        }
+
+        image_cache_free_entry(lru);
+        stat_evictions++;
+    }
+}
+
+static image_cache_entry_t *image_cache_acquire(const lv_img_dsc_t *img, const rle_image_t *rle) {
+    image_cache_entry_t *result = NULL;
+    size_t bytes = (size_t)rle->width * rle->height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+
+    xSemaphoreTake(image_cache_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < IMAGE_CACHE_MAX_ENTRIES; i++) {
+        if (image_cache[i].src == img) {
+            result = &image_cache[i];
+            result->refs++;
+            result->last_used = ++image_cache_tick;
+            stat_hits++;
+            xSemaphoreGive(image_cache_mutex);
+            return result;
+        }
+    }
+
+    stat_misses++;
+
+    if (bytes > IMAGE_CACHE_BUDGET_BYTES || !image_cache_make_room(bytes)) {
+        xSemaphoreGive(image_cache_mutex);
+        return NULL;
+    }
+
+#ifdef CONFIG_SPIRAM
+    uint8_t *pixels = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (pixels == NULL) pixels = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#else
+    uint8_t *pixels = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#endif
+    if (pixels == NULL) {
+        xSemaphoreGive(image_cache_mutex);
+        return NULL;
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (!rle_decode_image(rle, pixels)) {
+        ESP_LOGW(TAG, "Corrupt RLE image %p", (const void *)img);
+        heap_caps_free(pixels);
+        xSemaphoreGive(image_cache_mutex);
+        return NULL;
+    }
+    stat_decode_us += esp_timer_get_time() - start;
+    stat_decodes++;
+
+    for (int i = 0; i < IMAGE_CACHE_MAX_ENTRIES; i++) {
+        if (image_cache[i].src == NULL) {
+            result = &image_cache[i];
+            break;
+        }
+    }
+
+    result->src = img;
+    result->pixels = pixels;
+    result->bytes = bytes;
+    result->refs = 1;
+    result->last_used = ++image_cache_tick;
+    image_cache_bytes += bytes;
+
+    xSemaphoreGive(image_cache_mutex);
+    return result;
+}
+
+static lv_res_t rle_decoder_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header) {
+    LV_UNUSED(decoder);
+
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE) {
+        return LV_RES_INV;
+    }
+
+    rle_image_t rle;
+    if (!rle_parse(src, &rle)) {
+        return LV_RES_INV;
+    }
+
+    header->cf = LV_IMG_CF_RGB565A8;
+    header->always_zero = 0;
+    header->w = rle.width;
+    header->h = rle.height;
+    return LV_RES_OK;
+}
+
+static lv_res_t rle_decoder_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+
+    rle_image_t rle;
+    if (dsc->src_type != LV_IMG_SRC_VARIABLE || !rle_parse(dsc->src, &rle)) {
+        return LV_RES_INV;
+    }
+
+    image_cache_entry_t *entry = image_cache_acquire(dsc->src, &rle);
+    if (entry) {
+        dsc->img_data = entry->pixels;
+        dsc->user_data = entry;
+    } else {
+        // Too big for the cache or out of memory, LVGL falls back to read_line
+        dsc->img_data = NULL;
+        dsc->user_data = NULL;
+        stat_line_opens++;
+    }
+
+    return LV_RES_OK;
+}
+
+static lv_res_t rle_decoder_read_line(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc,
+                                      lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t *buf) {
+    LV_UNUSED(decoder);
+
+    rle_image_t rle;
+    if (!rle_parse(dsc->src, &rle)) {
+        return LV_RES_INV;
+    }
+
+    // A single RGB565A8 line is planar too: len colors, then len alpha bytes
+    uint8_t *alpha = buf + (size_t)len * sizeof(lv_color_t);
+    return rle_decode_row(&rle, y, x, len, buf, alpha) ? LV_RES_OK : LV_RES_INV;
+}
+
+static void rle_decoder_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+
+    image_cache_entry_t *entry = dsc->user_data;
+    if (entry == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(image_cache_mutex, portMAX_DELAY);
+    if (entry->refs > 0) {
+        entry->refs--;
+    }
+    xSemaphoreGive(image_cache_mutex);
+
+    dsc->user_data = NULL;
+    dsc->img_data = NULL;
+}
+
+void image_decoder_init(void) {
+#if LV_COLOR_DEPTH != 16
+    ESP_LOGW(TAG, "RLE images need LV_COLOR_DEPTH 16, decoder not registered");
+#else
+    if (image_cache_mutex != NULL) {
+        return;
+    }
+
+    image_cache_mutex = xSemaphoreCreateMutex();
+    if (image_cache_mutex == NULL) {
+        printf("Failed to create image cache mutex\n");
+        return;
+    }
+
+    lv_img_decoder_t *decoder = lv_img_decoder_create();
+    if (decoder == NULL) {
+        printf("Failed to register RLE image decoder\n");
+        return;
+    }
+
+    lv_img_decoder_set_info_cb(decoder, rle_decoder_info);
+    lv_img_decoder_set_open_cb(decoder, rle_decoder_open);
+    lv_img_decoder_set_read_line_cb(decoder, rle_decoder_read_line);
+    lv_img_decoder_set_close_cb(decoder, rle_decoder_close);
+#endif
+}
+
+void image_decoder_flush_cache(void) {
+    if (image_cache_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(image_cache_mutex, portMAX_DELAY);
+    for (int i = 0; i < IMAGE_CACHE_MAX_ENTRIES; i++) {
+        if (image_cache[i].src != NULL && image_cache[i].refs == 0) {
+            image_cache_free_entry(&image_cache[i]);
+        }
+    }
+    xSemaphoreGive(image_cache_mutex);
+}
+
+void image_decoder_print_stats(void) {
+    if (image_cache_mutex == NULL) {
+        printf("Image decoder not initialized\n");
+        return;
+    }
+
+    xSemaphoreTake(image_cache_mutex, portMAX_DELAY);
+
+    printf("Image cache: %u/%u bytes, hits: %lu, misses: %lu, evictions: %lu, line decoded: %lu\n",
+           (unsigned)image_cache_bytes, (unsigned)IMAGE_CACHE_BUDGET_BYTES, (unsigned long)stat_hits,
+           (unsigned long)stat_misses, (unsigned long)stat_evictions, (unsigned long)stat_line_opens);
+
+    for (int i = 0; i < IMAGE_CACHE_MAX_ENTRIES; i++) {
+        const image_cache_entry_t *entry = &image_cache[i];
+        if (entry->src) {
+            printf("  %3dx%-3d %6u bytes%s\n", entry->src->header.w, entry->src->header.h,
+                   (unsigned)entry->bytes, entry->refs ? " (drawing)" : "");
+        }
+    }
+
+    if (stat_decodes) {
+        printf("Full decodes: %lu, avg %lld us\n", (unsigned long)stat_decodes, stat_decode_us / stat_decodes);
+    }
+
+    xSemaphoreGive(image_cache_mutex);
+}
+
+void image_decoder_benchmark(int iterations) {
+    static const struct {
+        const char *name;
+        const lv_img_dsc_t *img;
+    } images[] = {
+        {"Ghost_ESP", &Ghost_ESP},
+        {"Map", &Map},
+        {"bluetooth", &bluetooth},
+        {"wifi", &wifi},
+        {"rave", &rave},
+        {"GESPFlappyghost", &GESPFlappyghost},
+        {"ghost", &ghost},
+        {"yappy", &yappy},
+        {"GESPAppGallery", &GESPAppGallery},
+    };
+
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    size_t total_raw = 0;
+    size_t total_rle = 0;
+    int64_t total_us = 0;
+
+    printf("%-16s %7s %7s %7s %9s %7s\n", "Image", "Size", "Raw", "RLE", "us/decode", "KB/s");
+
+    for (size_t i = 0; i < sizeof(images) / sizeof(images[0]); i++) {
+        rle_image_t rle;
+        if (!rle_parse(images[i].img, &rle)) {
+            printf("%-16s not RLE encoded\n", images[i].name);
+            continue;
+        }
+
+        // Row by row into one line buffer, the same work as a full decode without the big allocation
+        uint8_t *line = heap_caps_malloc((size_t)rle.width * LV_IMG_PX_SIZE_ALPHA_BYTE, MALLOC_CAP_8BIT);
+        if (line == NULL) {
+            printf("%-16s not enough memory\n", images[i].name);
+            continue;
+        }
+
+        uint8_t *alpha = line + rle.width * sizeof(lv_color_t);
+        size_t raw = (size_t)rle.width * rle.height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+        bool ok = true;
+
+        int64_t start = esp_timer_get_time();
+        for (int n = 0; n < iterations && ok; n++) {
+            for (int32_t y = 0; y < rle.height && ok; y++) {
+                ok = rle_decode_row(&rle, y, 0, rle.width, line, alpha);
+            }
+        }
+        int64_t elapsed = esp_timer_get_time() - start;
+        heap_caps_free(line);
+
+        if (!ok) {
+            printf("%-16s decode failed\n", images[i].name);
+            continue;
+        }
+
+        int64_t per_decode = elapsed / iterations;
+        char size[12];
+        snprintf(size, sizeof(size), "%dx%d", rle.width, rle.height);
+        printf("%-16s %7s %7u %7u %9lld %7lld\n", images[i].name, size, (unsigned)raw,
+               (unsigned)images[i].img->data_size, per_decode,
+               per_decode > 0 ? (int64_t)raw * 1000000 / 1024 / per_decode : 0);
+
+        total_raw += raw;
+        total_rle += images[i].img->data_size;
+        total_us += per_decode;
+    }
+
+    if (total_raw) {
+        printf("Total: %u -> %u bytes (%u%%), %lld us to decode everything once\n", (unsigned)total_raw,
+               (unsigned)total_rle, (unsigned)(total_rle * 100 / total_raw), total_us);
+    }
+}
@@ -68,4 +68,19 @@ bool joystick_just_released(joystick_t *joystick) {
     } else {
         return false;
     }
-}
\ No newline at end of file
+}
+
+esp_err_t joystick_enable_wakeup(joystick_t *joystick, gpio_isr_t isr, void *arg) {
+    // The service may already be installed by another driver
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        return err;
+    }
+
+    err = gpio_set_intr_type(joystick->pin, GPIO_INTR_ANYEDGE);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return gpio_isr_handler_add(joystick->pin, isr, arg);
+}
@@ -0,0 +1,131 @@
+#include "managers/led_compositor.h"
+#include <string.h>
+
+static bool is_black(led_rgb_t c) {
+    return c.r == 0 && c.g == 0 && c.b == 0;
+}
+
+static bool same_color(led_rgb_t a, led_rgb_t b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static void start_pulse(led_compositor_t *comp, uint8_t priority, led_rgb_t color, uint32_t now_ms) {
+    comp->pulsing = true;
+    comp->pulse_priority = priority;
+    comp->pulse_color = color;
+    comp->pulse_start_ms = now_ms;
+}
+
+void led_compositor_init(led_compositor_t *comp, uint32_t now_ms) {
+    memset(comp, 0, sizeof(*comp));
+    comp->effect = LED_EFFECT_NONE;
+    comp->speed_ms = 50;
+    comp->brightness = 100;
+    comp->effect_start_ms = now_ms;
+}
+
+void led_compositor_set_effect(led_compositor_t *comp, led_effect_t effect, uint16_t speed_ms, uint8_t brightness,
+                               uint32_t now_ms) {
+    if (effect >= LED_EFFECT_COUNT) effect = LED_EFFECT_NONE;
+    if (brightness > 100) brightness = 100;
+
+    if (effect != comp->effect || speed_ms != comp->speed_ms) {
+        comp->effect_start_ms = now_ms;
+    }
+    comp->effect = effect;
+    comp->speed_ms = speed_ms;
+    comp->brightness = brightness;
+}
+
+void led_compositor_set_status(led_compositor_t *comp, led_rgb_t color) {
+    comp->status = color;
+}
+
+void led_compositor_set_visualizer(led_compositor_t *comp, const led_rgb_t *frame, uint32_t now_ms) {
+    comp->visualizer = frame;
+    comp->visualizer_ms = now_ms;
+}
+
+void led_compositor_pulse(led_compositor_t *comp, uint8_t priority, led_rgb_t color, uint32_t now_ms) {
+    if (priority >= LED_COMPOSITOR_PRIORITIES) {
+        priority = LED_COMPOSITOR_PRIORITIES - 1;
+    }
+
+    if (comp->pulsing && priority < comp->pulse_priority) {
+        if (comp->waiting[priority]) {
+            comp->stats.coalesced++;
+        }
+        comp->waiting[priority] = true;
+        comp->waiting_color[priority] = color;
+        return;
+    }
+
+    // Back to back detections of the same thing keep one smooth pulse going
+    if (comp->pulsing && priority == comp->pulse_priority && same_color(color, comp->pulse_color)) {
+        comp->stats.coalesced++;
+        return;
+    }
+    if (comp->pulsing) {
+        comp->stats.preempted++;
+    }
+    start_pulse(comp, priority, color, now_ms);
+}
+
+static void end_pulse(led_compositor_t *comp, uint32_t now_ms) {
+    comp->pulsing = false;
+    comp->stats.pulses++;
+
+    for (int p = LED_COMPOSITOR_PRIORITIES - 1; p >= 0; p--) {
+        if (comp->waiting[p]) {
+            comp->waiting[p] = false;
+            start_pulse(comp, (uint8_t)p, comp->waiting_color[p], now_ms);
+            return;
+        }
+    }
+}
+
+void led_compositor_render(led_compositor_t *comp, uint32_t now_ms, led_rgb_t *frame, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    if (comp->pulsing && now_ms - comp->pulse_start_ms >= LED_COMPOSITOR_PULSE_MS) {
+        end_pulse(comp, now_ms);
+    }
+    if (comp->visualizer && now_ms - comp->visualizer_ms >= LED_COMPOSITOR_VISUALIZER_HOLD) {
+        comp->visualizer = NULL;
+    }
+
+    if (comp->visualizer) {
+        memcpy(frame, comp->visualizer, (size_t)count * sizeof(led_rgb_t));
+    } else {
+        led_effect_params_t params = {
+            .effect = is_black(comp->status) ? comp->effect : LED_EFFECT_NONE,
+            .speed_ms = comp->speed_ms,
+            .color = comp->status,
+        };
+        led_effects_render(&params, now_ms - comp->effect_start_ms, frame, count);
+    }
+
+    // The pulse fades in over the first half and out over the second
+    if (comp->pulsing) {
+        uint32_t elapsed = now_ms - comp->pulse_start_ms;
+        uint32_t half = LED_COMPOSITOR_PULSE_MS / 2;
+        uint32_t alpha = elapsed < half ? elapsed * 255 / half : (LED_COMPOSITOR_PULSE_MS - elapsed) * 255 / half;
+        led_effects_overlay(frame, count, comp->pulse_color, (uint8_t)(alpha > 255 ? 255 : alpha));
+    }
+
+    if (comp->brightness < 100) {
+        uint8_t level = (uint8_t)(comp->brightness * 255 / 100);
+        for (int i = 0; i < count; i++) {
+            frame[i].r = led_effects_scale8(frame[i].r, level);
+            frame[i].g = led_effects_scale8(frame[i].g, level);
+            frame[i].b = led_effects_scale8(frame[i].b, level);
+        }
+    }
+    comp->stats.frames++;
+}
+
+bool led_compositor_animating(const led_compositor_t *comp) {
+    return comp->pulsing || comp->visualizer != NULL || (comp->effect != LED_EFFECT_NONE && is_black(comp->status));
+}
@@ -0,0 +1,99 @@
+#include "managers/led_effects.h"
+
+static led_rgb_t hue_lut[LED_EFFECTS_HUE_STEPS];
+static bool lut_ready = false;
+
+void led_effects_init(void) {
+    if (lut_ready) {
+        return;
+    }
+
+    // Six linear segments of the hue wheel, a segment spans 256/6 table entries
+    for (int h = 0; h < LED_EFFECTS_HUE_STEPS; h++) {
+        int scaled = h * 6;
+        uint8_t rise = (uint8_t)(scaled & 0xFF);
+        uint8_t fall = 255 - rise;
+        switch (scaled >> 8) {
+            case 0: hue_lut[h] = (led_rgb_t){255, rise, 0}; break;
+            case 1: hue_lut[h] = (led_rgb_t){fall, 255, 0}; break;
+            case 2: hue_lut[h] = (led_rgb_t){0, 255, rise}; break;
+            case 3: hue_lut[h] = (led_rgb_t){0, fall, 255}; break;
+            case 4: hue_lut[h] = (led_rgb_t){rise, 0, 255}; break;
+            default: hue_lut[h] = (led_rgb_t){255, 0, fall}; break;
+        }
+    }
+    lut_ready = true;
+}
+
+led_rgb_t led_effects_hue(uint8_t hue) {
+    return hue_lut[hue];
+}
+
+static void fill(led_rgb_t *frame, int count, led_rgb_t color) {
+    for (int i = 0; i < count; i++) {
+        frame[i] = color;
+    }
+}
+
+static void render_rainbow(uint32_t speed_ms, uint32_t t_ms, led_rgb_t *frame, int count) {
+    // One degree per speed_ms, in 1/256 turns with 8 fractional bits
+    uint32_t base = (uint32_t)((uint64_t)t_ms * LED_EFFECTS_HUE_STEPS * 256 / (360 * speed_ms));
+    uint32_t spread = (uint32_t)LED_EFFECTS_HUE_STEPS * 256 / (uint32_t)count;
+
+    for (int i = 0; i < count; i++) {
+        frame[i] = hue_lut[((base + (uint32_t)i * spread) >> 8) & 0xFF];
+    }
+}
+
+static void render_police(uint32_t speed_ms, uint32_t t_ms, led_rgb_t *frame, int count) {
+    // Red up, red down, blue up, blue down
+    uint32_t ramp_ms = speed_ms * LED_EFFECTS_POLICE_STEPS;
+    uint32_t pos = t_ms % (ramp_ms * 4);
+    uint32_t segment = pos / ramp_ms;
+    uint8_t level = (uint8_t)((pos % ramp_ms) * 255 / ramp_ms);
+    if (segment & 1) {
+        level = 255 - level;
+    }
+
+    led_rgb_t color = segment < 2 ? (led_rgb_t){level, 0, 0} : (led_rgb_t){0, 0, level};
+    fill(frame, count, color);
+}
+
+void led_effects_render(const led_effect_params_t *params, uint32_t t_ms, led_rgb_t *frame, int count) {
+    if (count <= 0) {
+        return;
+    }
+    uint32_t speed_ms = params->speed_ms ? params->speed_ms : 1;
+
+    switch (params->effect) {
+        case LED_EFFECT_RAINBOW:
+            render_rainbow(speed_ms, t_ms, frame, count);
+            break;
+        case LED_EFFECT_POLICE:
+            render_police(speed_ms, t_ms, frame, count);
+            break;
+        default:
+            fill(frame, count, params->color);
+            break;
+    }
+}
+
+void led_effects_overlay(led_rgb_t *frame, int count, led_rgb_t color, uint8_t alpha) {
+    uint8_t keep = 255 - alpha;
+    for (int i = 0; i < count; i++) {
+        frame[i].r = led_effects_scale8(color.r, alpha) + led_effects_scale8(frame[i].r, keep);
+        frame[i].g = led_effects_scale8(color.g, alpha) + led_effects_scale8(frame[i].g, keep);
+        frame[i].b = led_effects_scale8(color.b, alpha) + led_effects_scale8(frame[i].b, keep);
+    }
+}
+
+const char *led_effects_name(led_effect_t effect) {
+    switch (effect) {
+        case LED_EFFECT_RAINBOW:
+            return "rainbow";
+        case LED_EFFECT_POLICE:
+            return "police";
+        default:
+            return "solid";
+    }
+}
@@ -0,0 +1,113 @@
+#include "managers/led_matrix.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void led_matrix_fit(int total_leds, uint16_t *width, uint16_t *height) {
+    if (total_leds <= 0) {
+        *width = 1;
+        *height = 1;
+        return;
+    }
+
+    // Largest divisor up to the square root gives the rows, a prime count is one long row
+    for (int rows = (int)sqrt(total_leds); rows > 0; rows--) {
+        if (total_leds % rows == 0) {
+            *height = (uint16_t)rows;
+            *width = (uint16_t)(total_leds / rows);
+            return;
+        }
+    }
+}
+
+static uint16_t wired_index(const led_matrix_geometry_t *g, int px, int py) {
+    if (g->origin == LED_MATRIX_ORIGIN_TOP_RIGHT || g->origin == LED_MATRIX_ORIGIN_BOTTOM_RIGHT) {
+        px = g->width - 1 - px;
+    }
+    if (g->origin == LED_MATRIX_ORIGIN_BOTTOM_LEFT || g->origin == LED_MATRIX_ORIGIN_BOTTOM_RIGHT) {
+        py = g->height - 1 - py;
+    }
+    if (g->serpentine && (py & 1)) {
+        px = g->width - 1 - px;
+    }
+    return (uint16_t)(py * g->width + px);
+}
+
+bool led_matrix_init(led_matrix_t *matrix, const led_matrix_geometry_t *geometry) {
+    const led_matrix_geometry_t *g = geometry;
+    if (g->width == 0 || g->height == 0 || g->rotation % 90 != 0 || g->rotation >= 360 ||
+        (uint32_t)g->width * g->height > UINT16_MAX + 1u) {
+        return false;
+    }
+
+    led_matrix_deinit(matrix);
+    matrix->lut = malloc((size_t)g->width * g->height * sizeof(uint16_t));
+    if (matrix->lut == NULL) {
+        return false;
+    }
+    matrix->geometry = *g;
+
+    bool swapped = g->rotation == 90 || g->rotation == 270;
+    matrix->width = swapped ? g->height : g->width;
+    matrix->height = swapped ? g->width : g->height;
+
+    // Image pixel to panel pixel, then panel pixel to its place on the strip
+    for (int y = 0; y < matrix->height; y++) {
+        for (int x = 0; x < matrix->width; x++) {
+            int px, py;
+            switch (g->rotation) {
+                case 90:  px = g->width - 1 - y; py = x; break;
+                case 180: px = g->width - 1 - x; py = g->height - 1 - y; break;
+                case 270: px = y; py = g->height - 1 - x; break;
+                default:  px = x; py = y; break;
+            }
+            matrix->lut[y * matrix->width + x] = wired_index(g, px, py);
+        }
+    }
+    return true;
+}
+
+void led_matrix_deinit(led_matrix_t *matrix) {
+    free(matrix->lut);
+    matrix->lut = NULL;
+    matrix->width = 0;
+    matrix->height = 0;
+}
+
+void led_matrix_blit(const led_matrix_t *matrix, const led_rgb_t *image, led_rgb_t *out) {
+    const uint16_t *lut = matrix->lut;
+    int count = matrix->width * matrix->height;
+    for (int i = 0; i < count; i++) {
+        out[lut[i]] = image[i];
+    }
+}
+
+void led_matrix_draw_bars(led_rgb_t *image, int width, int height, const uint8_t *amplitudes, size_t num_bars,
+                          led_rgb_t color) {
+    // Bars are spread over the columns, or sampled when there are more bars than columns
+    for (int x = 0; x < width; x++) {
+        uint8_t amplitude = amplitudes[(size_t)x * num_bars / width];
+        int bar_h = amplitude * height / 255;
+        for (int y = 0; y < height; y++) {
+            image[y * width + x] = y >= height - bar_h ? color : (led_rgb_t){0, 0, 0};
+        }
+    }
+}
+
+void led_matrix_draw_square(led_rgb_t *image, int width, int height, uint8_t amplitude, led_rgb_t color) {
+    // Louder draws a square further in from the edges of the largest centred square
+    int side = width < height ? width : height;
+    int inset = amplitude * (side / 2) / 256;
+    int x0 = (width - side) / 2 + inset;
+    int y0 = (height - side) / 2 + inset;
+    int x1 = x0 + side - 1 - 2 * inset;
+    int y1 = y0 + side - 1 - 2 * inset;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            bool edge = (x == x0 || x == x1) && y >= y0 && y <= y1;
+            edge = edge || ((y == y0 || y == y1) && x >= x0 && x <= x1);
+            image[y * width + x] = edge ? color : (led_rgb_t){0, 0, 0};
+        }
+    }
+}
@@ -1,24 +1,18 @@
 #include "managers/rgb_manager.h"
 #include "esp_log.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "driver/ledc.h"
+#include "esp_timer.h"
 #include "managers/settings_manager.h"
+#include "managers/led_matrix.h"
+#include "managers/led_compositor.h"
 #include "freertos/task.h"
+#include <stdatomic.h>
 
 static const char* TAG = "RGBManager";
 
-typedef struct {
-    double r;       // ∈ [0, 1]
-    double g;       // ∈ [0, 1]
-    double b;       // ∈ [0, 1]
-} rgb;
-
-typedef struct {
-    double h;       // ∈ [0, 360]
-    double s;       // ∈ [0, 1]
-    double v;       // ∈ [0, 1]
-} hsv;
-
 #define LEDC_TIMER          LEDC_TIMER_0
 #define LEDC_MODE           LEDC_LOW_SPEED_MODE
 #define LEDC_CHANNEL_RED    LEDC_CHANNEL_0
@@ -27,98 +21,103 @@ typedef struct {
 #define LEDC_DUTY_RES       LEDC_TIMER_8_BIT  // 8-bit resolution (0-255)
 #define LEDC_FREQUENCY      10000  // 10 kHz PWM frequency
 
+#define RGB_SERVICE_STACK    3072
+#define RGB_SERVICE_PRIORITY 2
 
-void calculate_matrix_dimensions(int total_leds, int *rows, int *cols) {
-    int side = (int)sqrt(total_leds);
+#ifndef CONFIG_LED_MATRIX_WIDTH
+#define CONFIG_LED_MATRIX_WIDTH 0
+#endif
+#ifndef CONFIG_LED_MATRIX_HEIGHT
+#define CONFIG_LED_MATRIX_HEIGHT 0
+#endif
+#ifndef CONFIG_LED_MATRIX_ROTATION
+#define CONFIG_LED_MATRIX_ROTATION 0
+#endif
+#ifdef CONFIG_LED_MATRIX_SERPENTINE
+#define LED_MATRIX_SERPENTINE true
+#else
+#define LED_MATRIX_SERPENTINE false
+#endif
+#if defined(CONFIG_LED_MATRIX_ORIGIN_TOP_RIGHT)
+#define LED_MATRIX_ORIGIN LED_MATRIX_ORIGIN_TOP_RIGHT
+#elif defined(CONFIG_LED_MATRIX_ORIGIN_BOTTOM_LEFT)
+#define LED_MATRIX_ORIGIN LED_MATRIX_ORIGIN_BOTTOM_LEFT
+#elif defined(CONFIG_LED_MATRIX_ORIGIN_BOTTOM_RIGHT)
+#define LED_MATRIX_ORIGIN LED_MATRIX_ORIGIN_BOTTOM_RIGHT
+#else
+#define LED_MATRIX_ORIGIN LED_MATRIX_ORIGIN_TOP_LEFT
+#endif
 
-    if (side * side == total_leds) {
-        *rows = side;
-        *cols = side;
-    } else {
-        for (int i = side; i > 0; i--) {
-            if (total_leds % i == 0) {
-                *rows = i;
-                *cols = total_leds / i;
-                return;
-            }
-        }
+// One pending pulse per priority, packed as request << 24 | red << 16 | green << 8 | blue
+static _Atomic uint32_t pending_requests[RGB_PRIORITY_COUNT];
+// The resting colour has its own slot, so a pulse posted right after cannot replace it
+static _Atomic uint32_t resting_color = 0;
+static atomic_bool resting_changed = false;
+static TaskHandle_t service_task_handle = NULL;
+
+// Background effect, packed as effect << 24 | brightness percent << 16 | speed_ms
+static _Atomic uint32_t effect_config = (uint32_t)LED_EFFECT_NONE << 24 | 30u << 16 | 50u;
+static led_rgb_t *frame = NULL;
+static int frame_leds = 0;
+
+static atomic_uint stat_posted = 0;
+static atomic_uint stat_coalesced = 0;
+static atomic_uint stat_preempted = 0;
+static atomic_uint stat_pulses = 0;
+static atomic_uint stat_frames = 0;
+
+static esp_err_t rgb_manager_write(RGBManager_t* rgb_manager, int led_idx, uint8_t red, uint8_t green, uint8_t blue);
+static void rgb_service_start(RGBManager_t* rgb_manager);
+
+#define CONFIG_EFFECT(c)     ((led_effect_t)((c) >> 24))
+#define CONFIG_BRIGHTNESS(c) ((uint8_t)((c) >> 16))
+#define CONFIG_SPEED(c)      ((uint16_t)(c))
+
+// Panel layout and the buffers the visualizer draws through, set up with the strip
+static led_matrix_t matrix;
+static led_rgb_t *matrix_image = NULL;
+static led_rgb_t *visualizer_frame = NULL;   // Strip order, the layer the compositor shows
+
+// Latest visualizer amplitudes, drawn by the service task. Copied under the lock, the
+// visualizer task posts at its own rate and the service picks up the newest.
+#define RGB_VISUALIZER_MAX_BARS 64
+static portMUX_TYPE visualizer_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t visualizer_bars[RGB_VISUALIZER_MAX_BARS];
+static uint8_t visualizer_count = 0;
+static bool visualizer_square = false;
+static uint32_t visualizer_posted = 0;  // Bumped with every frame posted
+
+static bool matrix_setup(int num_leds) {
+    led_matrix_geometry_t geometry = {
+        .width = CONFIG_LED_MATRIX_WIDTH,
+        .height = CONFIG_LED_MATRIX_HEIGHT,
+        .serpentine = LED_MATRIX_SERPENTINE,
+        .rotation = CONFIG_LED_MATRIX_ROTATION,
+        .origin = LED_MATRIX_ORIGIN,
+    };
+    if (geometry.width == 0) {
+        led_matrix_fit(num_leds, &geometry.width, &geometry.height);
+    } else if (geometry.height == 0) {
+        geometry.height = num_leds / geometry.width > 0 ? num_leds / geometry.width : 1;
     }
-}
-
-
-rgb hsv2rgb(hsv HSV) {
-    rgb RGB;
-    double H = HSV.h, S = HSV.s, V = HSV.v;
-    double P, Q, T, fract;
-
-    // Ensure hue is wrapped between 0 and 360
-    H = fmod(H, 360.0);
-    if (H < 0) H += 360.0;
-
-    // Convert hue to a 0-6 range for RGB segment
-    H /= 60.0;
-    fract = H - floor(H);
-
-    P = V * (1.0 - S);
-    Q = V * (1.0 - S * fract);
-    T = V * (1.0 - S * (1.0 - fract));
-
-    if (H < 1.0) {
-        RGB = (rgb){.r = V, .g = T, .b = P};
-    } else if (H < 2.0) {
-        RGB = (rgb){.r = Q, .g = V, .b = P};
-    } else if (H < 3.0) {
-        RGB = (rgb){.r = P, .g = V, .b = T};
-    } else if (H < 4.0) {
-        RGB = (rgb){.r = P, .g = Q, .b = V};
-    } else if (H < 5.0) {
-        RGB = (rgb){.r = T, .g = P, .b = V};
-    } else {
-        RGB = (rgb){.r = V, .g = P, .b = Q};
+    if ((int)geometry.width * geometry.height > num_leds) {
+        ESP_LOGE(TAG, "LED matrix %dx%d needs more than the %d LEDs configured", geometry.width, geometry.height, num_leds);
+        return false;
     }
 
-    return RGB;
-}
-
-
-void rainbow_task(void* pvParameter) 
-{
-    RGBManager_t* rgb_manager = (RGBManager_t*) pvParameter;
-    
-    while (1) {
-
-        if (rgb_manager->num_leds > 1)
-        {
-            rgb_manager_rainbow_effect_matrix(rgb_manager, settings_get_rgb_speed(&G_Settings));
-        }
-        else 
-        {
-            rgb_manager_rainbow_effect(rgb_manager, settings_get_rgb_speed(&G_Settings));
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(20));
+    if (!led_matrix_init(&matrix, &geometry)) {
+        ESP_LOGE(TAG, "Invalid LED matrix geometry or no memory for it");
+        return false;
     }
-    vTaskDelete(NULL);
-}
-
-void police_task(void *pvParameter)
-{
-    RGBManager_t* rgb_manager = (RGBManager_t*) pvParameter;
-    while (1) {
-        
-        rgb_manager_policesiren_effect(rgb_manager, settings_get_rgb_speed(&G_Settings));
-        
-        vTaskDelay(pdMS_TO_TICKS(20));
+    matrix_image = calloc(matrix.width * matrix.height, sizeof(led_rgb_t));
+    if (matrix_image == NULL) {
+        led_matrix_deinit(&matrix);
+        return false;
     }
-    vTaskDelete(NULL);
-}
 
-
-
-void clamp_rgb(uint8_t *r, uint8_t *g, uint8_t *b) {
-    *r = (*r > 255) ? 255 : *r;
-    *g = (*g > 255) ? 255 : *g;
-    *b = (*b > 255) ? 255 : *b;
+    ESP_LOGI(TAG, "LED matrix %dx%d, %s, rotated %d", matrix.width, matrix.height,
+             geometry.serpentine ? "serpentine" : "progressive", geometry.rotation);
+    return true;
 }
 
 // Initialize the RGB LED manager
@@ -176,6 +175,7 @@ esp_err_t rgb_manager_init(RGBManager_t* rgb_manager, gpio_num_t pin, int num_le
         ESP_ERROR_CHECK(ledc_channel_config(&ledc_channel_blue));
 
         rgb_manager_set_color(rgb_manager, 1, 0, 0, 0, false);
+        rgb_service_start(rgb_manager);
 
         ESP_LOGI(TAG, "RGBManager initialized for separate R/G/B pins: %d, %d, %d", red_pin, green_pin, blue_pin);
         return ESP_OK;
@@ -207,156 +207,324 @@ esp_err_t rgb_manager_init(RGBManager_t* rgb_manager, gpio_num_t pin, int num_le
 
         // Clear the strip (turn off all LEDs)
         led_strip_clear(rgb_manager->strip);
+        matrix_setup(num_leds);
+        rgb_service_start(rgb_manager);
 
         ESP_LOGI(TAG, "RGBManager initialized for pin %d with %d LEDs", pin, num_leds);
         return ESP_OK;
     }
 }
 
-int get_pixel_index(int row, int column) {
-    // Map 2D grid to 1D index, adjust based on your wiring
-    return row * 8 + column;
+void update_led_visualizer(uint8_t *amplitudes, size_t num_bars, bool square_mode) {
+    if (matrix_image == NULL) {
+        return;
+    }
+    if (num_bars > RGB_VISUALIZER_MAX_BARS) {
+        num_bars = RGB_VISUALIZER_MAX_BARS;
+    }
+
+    taskENTER_CRITICAL(&visualizer_lock);
+    memcpy(visualizer_bars, amplitudes, num_bars);
+    visualizer_count = (uint8_t)num_bars;
+    visualizer_square = square_mode;
+    visualizer_posted++;
+    taskEXIT_CRITICAL(&visualizer_lock);
+
+    if (service_task_handle != NULL) {
+        xTaskNotifyGive(service_task_handle);
+    }
 }
 
-void set_led_column(size_t column, uint8_t height) {
-    // Clear the column first
-    for (int row = 0; row < 8; ++row) {
-        led_strip_set_pixel(rgb_manager.strip, get_pixel_index(row, column), 0, 0, 0);
+// Draws the visualizer layer for the whole strip, LEDs past the panel stay off
+static void render_visualizer(const uint8_t *bars, uint8_t count, bool square) {
+    // Full red, the compositor scales every frame by the brightness setting
+    const led_rgb_t lit = {255, 0, 0};
+    if (square) {
+        led_matrix_draw_square(matrix_image, matrix.width, matrix.height, bars[0], lit);
+    } else {
+        led_matrix_draw_bars(matrix_image, matrix.width, matrix.height, bars, count, lit);
     }
+    memset(visualizer_frame, 0, frame_leds * sizeof(led_rgb_t));
+    led_matrix_blit(&matrix, matrix_image, visualizer_frame);
+}
 
-    uint8_t r = 255, g = 1, b = 1;
+bool rgb_manager_post(rgb_request_t request, rgb_priority_t priority, uint8_t red, uint8_t green, uint8_t blue) {
+    if (priority >= RGB_PRIORITY_COUNT || (request != RGB_REQUEST_SOLID && request != RGB_REQUEST_PULSE)) {
+        return false;
+    }
 
-    scale_grb_by_brightness(&g,&r,&b, 0.1);
+    uint32_t packed = (uint32_t)request << 24 | (uint32_t)red << 16 | (uint32_t)green << 8 | blue;
+    bool replaced;
+    if (request == RGB_REQUEST_SOLID) {
+        atomic_store(&resting_color, packed & 0xFFFFFF);
+        replaced = atomic_exchange(&resting_changed, true);
+    } else {
+        replaced = atomic_exchange(&pending_requests[priority], packed) != 0;
+    }
+    if (replaced) {
+        atomic_fetch_add_explicit(&stat_coalesced, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&stat_posted, 1, memory_order_relaxed);
 
-    // Light up the required number of LEDs with the selected primary color
-    for (int row = 0; row < height; ++row) {
-        led_strip_set_pixel(rgb_manager.strip, get_pixel_index(7 - row, column), r, g, b);
+    // Only sets a notification bit, the caller never waits on the LED
+    if (service_task_handle != NULL) {
+        xTaskNotifyGive(service_task_handle);
     }
+    return true;
 }
 
-void set_led_square(uint8_t size, uint8_t red, uint8_t green, uint8_t blue) {
-    // Size is the 'thickness' of the square from the edges. 
-    // Example: size=0 means the outermost 8x8 border, size=1 means one square inward (6x6), and so on.
+void rgb_manager_get_service_stats(rgb_service_stats_t *out) {
+    out->posted = atomic_load_explicit(&stat_posted, memory_order_relaxed);
+    out->coalesced = atomic_load_explicit(&stat_coalesced, memory_order_relaxed);
+    out->preempted = atomic_load_explicit(&stat_preempted, memory_order_relaxed);
+    out->pulses = atomic_load_explicit(&stat_pulses, memory_order_relaxed);
+    out->frames = atomic_load_explicit(&stat_frames, memory_order_relaxed);
+}
 
-    // Clear all LEDs first
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            led_strip_set_pixel(rgb_manager.strip, get_pixel_index(row, col), 0, 0, 0);
-        }
-    }
+void rgb_manager_reset_service_stats(void) {
+    atomic_store_explicit(&stat_posted, 0, memory_order_relaxed);
+    atomic_store_explicit(&stat_coalesced, 0, memory_order_relaxed);
+    atomic_store_explicit(&stat_preempted, 0, memory_order_relaxed);
+    atomic_store_explicit(&stat_pulses, 0, memory_order_relaxed);
+    atomic_store_explicit(&stat_frames, 0, memory_order_relaxed);
+}
 
-    // Draw square perimeter based on 'size'
-    int start = size;
-    int end = 7 - size;
+static uint32_t now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
 
-    // Top and Bottom sides of the square
-    for (int col = start; col <= end; ++col) {
-        led_strip_set_pixel(rgb_manager.strip, get_pixel_index(start, col), red, green, blue); // Top side
-        led_strip_set_pixel(rgb_manager.strip, get_pixel_index(end, col), red, green, blue);   // Bottom side
+void rgb_manager_set_effect(led_effect_t effect, uint16_t speed_ms, uint8_t brightness) {
+    if (effect >= LED_EFFECT_COUNT) {
+        effect = LED_EFFECT_NONE;
+    }
+    if (brightness > 100) {
+        brightness = 100;
     }
 
-    // Left and Right sides of the square
-    for (int row = start + 1; row < end; ++row) { // Avoid corners since they are already set
-        led_strip_set_pixel(rgb_manager.strip, get_pixel_index(row, start), red, green, blue); // Left side
-        led_strip_set_pixel(rgb_manager.strip, get_pixel_index(row, end), red, green, blue);   // Right side
+    atomic_store(&effect_config, (uint32_t)effect << 24 | (uint32_t)brightness << 16 | speed_ms);
+    if (service_task_handle != NULL) {
+        xTaskNotifyGive(service_task_handle);
     }
 }
 
-void update_led_visualizer(uint8_t *amplitudes, size_t num_bars, bool square_mode) {
-    if (square_mode) {
-        // Square visualizer effect
-        uint8_t amplitude = amplitudes[0]; // Use the first amplitude value
-        uint8_t square_size = (amplitude * 4) / 255; // Map amplitude to square size (0 to 4)
+void rgb_manager_apply_settings(void) {
+    led_effect_t effect;
+    switch (settings_get_rgb_mode(&G_Settings)) {
+        case RGB_MODE_RAINBOW:
+            effect = LED_EFFECT_RAINBOW;
+            break;
+        case RGB_MODE_POLICE:
+            effect = LED_EFFECT_POLICE;
+            break;
+        default:
+            effect = LED_EFFECT_NONE;
+            break;
+    }
+    rgb_manager_set_effect(effect, settings_get_rgb_speed(&G_Settings), settings_get_rgb_brightness(&G_Settings));
+}
 
-        // Randomly select one primary color for the square
-        uint8_t red = 255, green = 0, blue = 0;
+_Static_assert(sizeof(led_rgb_t) == 3, "frames are handed to the strip as packed RGB bytes");
 
-        // Draw the square based on the calculated size
-        set_led_square(square_size, red, green, blue);
-    } else {
-        // Original bar visualizer effect
-        for (size_t bar = 0; bar < num_bars; ++bar) {
-            uint8_t amplitude = amplitudes[bar];
-            uint8_t num_pixels_to_light = (amplitude * 8) / 255; // Scale to 8 pixels high
-            set_led_column(bar, num_pixels_to_light);
-        }
+static void rgb_service_flush(RGBManager_t* rgb_manager) {
+    if (rgb_manager->is_separate_pins) {
+        rgb_manager_write(rgb_manager, 0, frame[0].r, frame[0].g, frame[0].b);
+        return;
     }
 
-    // Refresh the LED strip
-    led_strip_refresh(rgb_manager.strip);
+    // The whole frame in one call and one refresh, however many pixels changed
+    led_strip_set_pixels(rgb_manager->strip, 0, frame_leds, (const uint8_t *)frame);
+    led_strip_refresh(rgb_manager->strip);
 }
 
-void pulse_once(RGBManager_t* rgb_manager, uint8_t red, uint8_t green, uint8_t blue) {
-    uint8_t brightness = 0;
-    int direction = 1;
+static void add_stat(atomic_uint *stat, uint32_t now, uint32_t *reported) {
+    if (now != *reported) {
+        atomic_fetch_add_explicit(stat, now - *reported, memory_order_relaxed);
+        *reported = now;
+    }
+}
 
-    while (brightness <= 255 || brightness > 0) {
-        
-        float brightness_scale = brightness / 255.0;
-        uint8_t adj_red = red * brightness_scale;
-        uint8_t adj_green = green * brightness_scale;
-        uint8_t adj_blue = blue * brightness_scale;
+// Hands whatever was posted since the last pass to the compositor, which decides what the
+// strip shows. Only this task touches the compositor and the strip.
+static void rgb_service_task(void *pvParameter) {
+    RGBManager_t* rgb_manager = (RGBManager_t*) pvParameter;
+    const TickType_t frame_ticks = pdMS_TO_TICKS(RGB_FRAME_MS) ? pdMS_TO_TICKS(RGB_FRAME_MS) : 1;
+
+    led_compositor_t comp;
+    led_compositor_stats_t reported = {0};
+    led_compositor_init(&comp, now_ms());
+    bool dirty = true;
+    uint8_t bars[RGB_VISUALIZER_MAX_BARS];
+    uint8_t bar_count = 0;
+    bool square = false;
+    uint32_t shown_visualizer = 0;
+    uint32_t shown_config = ~atomic_load(&effect_config);
+    TickType_t next_frame = xTaskGetTickCount();
 
-        
-        esp_err_t ret = led_strip_set_pixel(rgb_manager->strip, 0, adj_red, adj_green, adj_blue);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to set LED color");
-            return; 
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (dirty) {
+            wait = 0;
+        } else if (led_compositor_animating(&comp)) {
+            int32_t left = (int32_t)(next_frame - xTaskGetTickCount());
+            wait = left > 0 ? (TickType_t)left : 0;
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+        uint32_t t = now_ms();
+
+        uint32_t config = atomic_load(&effect_config);
+        if (config != shown_config) {
+            shown_config = config;
+            led_compositor_set_effect(&comp, CONFIG_EFFECT(config), CONFIG_SPEED(config), CONFIG_BRIGHTNESS(config), t);
+            dirty = true;
+        }
+        if (atomic_exchange(&resting_changed, false)) {
+            uint32_t resting = atomic_load(&resting_color);
+            led_compositor_set_status(&comp, (led_rgb_t){(uint8_t)(resting >> 16), (uint8_t)(resting >> 8), (uint8_t)resting});
+            dirty = true;
+        }
+
+        bool new_bars = false;
+        taskENTER_CRITICAL(&visualizer_lock);
+        if (visualizer_posted != shown_visualizer) {
+            shown_visualizer = visualizer_posted;
+            bar_count = visualizer_count;
+            square = visualizer_square;
+            memcpy(bars, visualizer_bars, bar_count);
+            new_bars = true;
         }
+        taskEXIT_CRITICAL(&visualizer_lock);
+        if (new_bars && bar_count && visualizer_frame != NULL) {
+            render_visualizer(bars, bar_count, square);
+            led_compositor_set_visualizer(&comp, visualizer_frame, t);
+            dirty = true;
+        }
+
+        // Highest first, so a lower pulse posted in the same pass waits its turn
+        for (int p = RGB_PRIORITY_COUNT - 1; p >= 0; p--) {
+            uint32_t packed = atomic_exchange(&pending_requests[p], 0);
+            if (packed != 0) {
+                led_rgb_t color = {(uint8_t)(packed >> 16), (uint8_t)(packed >> 8), (uint8_t)packed};
+                led_compositor_pulse(&comp, (uint8_t)p, color, t);
+                dirty = true;
+            }
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if (!dirty && !(led_compositor_animating(&comp) && (int32_t)(now - next_frame) >= 0)) {
+            continue;
+        }
+        dirty = false;
+        next_frame = now + frame_ticks;
+
+        led_compositor_render(&comp, t, frame, frame_leds);
+        rgb_service_flush(rgb_manager);
+
+        add_stat(&stat_coalesced, comp.stats.coalesced, &reported.coalesced);
+        add_stat(&stat_preempted, comp.stats.preempted, &reported.preempted);
+        add_stat(&stat_pulses, comp.stats.pulses, &reported.pulses);
+        add_stat(&stat_frames, comp.stats.frames, &reported.frames);
+    }
+}
 
-        led_strip_refresh(rgb_manager->strip);
-        
-        
-        brightness += direction * 5; 
+static void rgb_service_start(RGBManager_t* rgb_manager) {
+    if (service_task_handle != NULL) {
+        return;
+    }
 
-        if (brightness >= 255) {
-            direction = -1;
+    led_effects_init();
+    frame_leds = rgb_manager->num_leds > 0 ? rgb_manager->num_leds : 1;
+    frame = calloc(frame_leds, sizeof(led_rgb_t));
+    if (frame == NULL) {
+        ESP_LOGE(TAG, "No memory for the LED frame buffer");
+        return;
+    }
+    if (matrix_image != NULL) {
+        visualizer_frame = calloc(frame_leds, sizeof(led_rgb_t));
+        if (visualizer_frame == NULL) {
+            ESP_LOGW(TAG, "No memory for the visualizer layer, the visualizer stays off");
         }
+    }
 
-        
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (xTaskCreate(rgb_service_task, "LED Service", RGB_SERVICE_STACK, rgb_manager, RGB_SERVICE_PRIORITY,
+                    &service_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start the LED service task");
+        service_task_handle = NULL;
+        free(frame);
+        frame = NULL;
     }
 }
 
+static uint8_t reference_channel(float value) {
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
 
+void rgb_manager_benchmark_effects(int leds, int frames) {
+    led_effects_init();
+    led_rgb_t *buf = calloc(leds, sizeof(led_rgb_t));
+    if (buf == NULL) {
+        printf("Not enough memory for %d LEDs\n", leds);
+        return;
+    }
 
-esp_err_t rgb_manager_set_color(RGBManager_t* rgb_manager, int led_idx, uint8_t red, uint8_t green, uint8_t blue, bool pulse) {
-#ifdef CONFIG_LED_DATA_PIN
-    if (!rgb_manager) return ESP_ERR_INVALID_ARG;
+    printf("LED effects, %d LEDs, %d frames each\n", leds, frames);
+    const led_rgb_t pulse = {255, 165, 0};
+    for (int e = 0; e < LED_EFFECT_COUNT; e++) {
+        led_effect_params_t params = {.effect = (led_effect_t)e, .speed_ms = 50, .color = {0, 64, 0}};
 
-    
-    if (rgb_manager->num_leds > 1) {
-        for (int i = 0; i < rgb_manager->num_leds; i++) {
-            uint8_t r = red, g = green, b = blue;
-            scale_grb_by_brightness(&g, &r, &b, 0.3);
+        int64_t start = esp_timer_get_time();
+        for (int f = 0; f < frames; f++) {
+            led_effects_render(&params, (uint32_t)f * RGB_FRAME_MS, buf, leds);
+            led_effects_overlay(buf, leds, pulse, (uint8_t)(f * 8));
+        }
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
 
-            esp_err_t ret = led_strip_set_pixel(rgb_manager->strip, i, r, g, b);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to set LED %d color", i);
-                return ret;
-            }
+        printf("%-8s %6lu us/frame, %lu frames/s\n", led_effects_name((led_effect_t)e),
+               (unsigned long)(us / frames), (unsigned long)(us ? (uint64_t)frames * 1000000 / us : 0));
+    }
+
+    // The table against the exact float conversion it replaces
+    int max_error = 0;
+    for (int h = 0; h < LED_EFFECTS_HUE_STEPS; h++) {
+        float segment = h * 6.0f / LED_EFFECTS_HUE_STEPS;
+        float fract = segment - (int)segment;
+        float rgb[3];
+        switch ((int)segment) {
+            case 0: rgb[0] = 1; rgb[1] = fract; rgb[2] = 0; break;
+            case 1: rgb[0] = 1 - fract; rgb[1] = 1; rgb[2] = 0; break;
+            case 2: rgb[0] = 0; rgb[1] = 1; rgb[2] = fract; break;
+            case 3: rgb[0] = 0; rgb[1] = 1 - fract; rgb[2] = 1; break;
+            case 4: rgb[0] = fract; rgb[1] = 0; rgb[2] = 1; break;
+            default: rgb[0] = 1; rgb[1] = 0; rgb[2] = 1 - fract; break;
+        }
+        led_rgb_t lut = led_effects_hue((uint8_t)h);
+        int err[3] = {abs(lut.r - reference_channel(rgb[0])), abs(lut.g - reference_channel(rgb[1])),
+                      abs(lut.b - reference_channel(rgb[2]))};
+        for (int c = 0; c < 3; c++) {
+            if (err[c] > max_error) max_error = err[c];
         }
-        return led_strip_refresh(rgb_manager->strip);
     }
+    printf("Hue table max error %d/255 against float HSV\n", max_error);
+    printf("Sending %d LEDs at 800 kHz takes %lu us, the strip allows at most %lu frames/s\n", leds,
+           (unsigned long)(leds * 30), (unsigned long)(1000000 / (leds * 30 + 300)));
 
+    free(buf);
+}
 
+esp_err_t rgb_manager_set_color(RGBManager_t* rgb_manager, int led_idx, uint8_t red, uint8_t green, uint8_t blue, bool pulse) {
     if (pulse) {
-        pulse_once(rgb_manager, red, green, blue);
+        rgb_manager_post(RGB_REQUEST_PULSE, RGB_PRIORITY_NORMAL, red, green, blue);
         return ESP_OK;
-    } else {
-        scale_grb_by_brightness(&green, &red, &blue, 0.3);
-        esp_err_t ret = led_strip_set_pixel(rgb_manager->strip, led_idx, red, green, blue);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to set LED color");
-            return ret;
-        }
-        return led_strip_refresh(rgb_manager->strip);
     }
-#endif
 
-#ifdef CONFIG_RED_RGB_PIN && CONFIG_GREEN_RGB_PIN && CONFIG_BLUE_RGB_PIN
-    scale_grb_by_brightness(&green, &red, &blue, -0.3);
+    // The service task owns the LEDs, a pulse playing at the time comes back to this colour
+    rgb_manager_post(RGB_REQUEST_SOLID, RGB_PRIORITY_LOW, red, green, blue);
+    return ESP_OK;
+}
 
+// Drives the separate R/G/B pins, only called from the LED service task
+static esp_err_t rgb_manager_write(RGBManager_t* rgb_manager, int led_idx, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef CONFIG_RED_RGB_PIN && CONFIG_GREEN_RGB_PIN && CONFIG_BLUE_RGB_PIN
+    // The compositor has already applied the brightness setting
     uint8_t ired = (uint8_t)(255 - red);
     uint8_t igreen = (uint8_t)(255 - green);
     uint8_t iblue = (uint8_t)(255 - blue);
@@ -383,116 +551,6 @@ esp_err_t rgb_manager_set_color(RGBManager_t* rgb_manager, int led_idx, uint8_t
     return ESP_OK;
 }
 
-void rgb_manager_rainbow_effect_matrix(RGBManager_t* rgb_manager, int delay_ms) {
-    double hue = 0.0;
-
-    while (1) {
-        for (int i = 0; i < rgb_manager->num_leds; i++) {
-            uint8_t red, green, blue;
-
-            double hue_offset = fmod(hue + i * (360.0 / rgb_manager->num_leds), 360.0);
-
-
-            hsv hsv_color = { .h = hue_offset, .s = 1.0, .v = 0.5 };
-            rgb rgb_color = hsv2rgb(hsv_color);
-
-            red = (uint8_t)(fmin(rgb_color.r * 255, 120));
-            green = (uint8_t)(fmin(rgb_color.g * 255, 120));
-            blue = (uint8_t)(fmin(rgb_color.b * 255, 120));
-
-            
-            clamp_rgb(&red, &green, &blue);
-
-            scale_grb_by_brightness(&green, &red, &blue, 0.3);
-
-            esp_err_t ret = led_strip_set_pixel(rgb_manager->strip, i, red, green, blue);
-            
-            if (!rgb_manager->is_separate_pins) {
-                led_strip_refresh(rgb_manager->strip);
-            }
-            hue = fmod(hue + 0.5, 360.0);
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
-    }
-}
-
-// Rainbow effect
-void rgb_manager_rainbow_effect(RGBManager_t* rgb_manager, int delay_ms) {
-    double hue = 0.0;
-
-    while (1) {
-        for (int i = 0; i < rgb_manager->num_leds; i++) {
-            uint8_t red, green, blue;
-
-            double hue_offset = fmod(hue + i * (360.0 / rgb_manager->num_leds), 360.0);
-
-            hsv hsv_color = { .h = hue_offset, .s = 1.0, .v = 1.0 };
-            rgb rgb_color = hsv2rgb(hsv_color);
-
-            red = (uint8_t)(rgb_color.r * 255);
-            green = (uint8_t)(rgb_color.g * 255);
-            blue = (uint8_t)(rgb_color.b * 255);
-
-            clamp_rgb(&red, &green, &blue);
-
-            if (rgb_manager->is_separate_pins) {
-                uint8_t ired = (uint8_t)(255 - red);
-                uint8_t igreen = (uint8_t)(255 - green);
-                uint8_t iblue = (uint8_t)(255 - blue);
-                rgb_manager_set_color(rgb_manager, i, ired, igreen, iblue, false);
-            } else {
-                rgb_manager_set_color(rgb_manager, rgb_manager->num_leds == 1 ? 0 : i, red, green, blue, false);
-            }
-        }
-
-        if (!rgb_manager->is_separate_pins) {
-            led_strip_refresh(rgb_manager->strip);
-        }
-
-        hue = fmod(hue + 1, 360.0);
-
-        vTaskDelay(pdMS_TO_TICKS(delay_ms));
-    }
-}
-
-void rgb_manager_policesiren_effect(RGBManager_t *rgb_manager, int delay_ms) {
-    uint8_t brightness;
-    bool increasing = true;
-    bool is_red = true;
-
-    while (1) {
-        for (int pulse_step = 0; pulse_step <= 255; pulse_step += 5) {
-            if (increasing) {
-                brightness = pulse_step;
-            } else {
-                brightness = 255 - pulse_step;
-            }
-
-            
-            if (is_red) {
-                rgb_manager_set_color(rgb_manager, 0, brightness, 0, 0, false); 
-            } else {
-                rgb_manager_set_color(rgb_manager, 0, 0, 0, brightness, false); 
-            }
-
-            
-            led_strip_refresh(rgb_manager->strip);
-
-            
-            vTaskDelay(pdMS_TO_TICKS(delay_ms));
-        }
-
-        
-        increasing = !increasing;
-
-        
-        if (!increasing) {
-            is_red = !is_red;
-        }
-    }
-}
-
 // Deinitialize the RGB LED manager
 esp_err_t rgb_manager_deinit(RGBManager_t* rgb_manager) {
     if (!rgb_manager) return ESP_ERR_INVALID_ARG;
@@ -503,8 +561,9 @@ esp_err_t rgb_manager_deinit(RGBManager_t* rgb_manager) {
         gpio_set_level(rgb_manager->blue_pin, 0);
         ESP_LOGI(TAG, "RGBManager deinitialized (separate pins)");
     } else {
-        // Clear the LED strip and deinitialize
-        led_strip_clear(rgb_manager->strip);
+        // The service task owns the strip, it sends the blank frame
+        rgb_manager_set_effect(LED_EFFECT_NONE, 0, 0);
+        rgb_manager_post(RGB_REQUEST_SOLID, RGB_PRIORITY_LOW, 0, 0, 0);
         ESP_LOGI(TAG, "RGBManager deinitialized (LED strip)");
     }
 
@@ -12,6 +12,7 @@ static const char* NVS_BROADCAST_SPEED_KEY = "broadcast_speed";
 static const char* NVS_AP_SSID_KEY = "ap_ssid";
 static const char* NVS_AP_PASSWORD_KEY = "ap_password";
 static const char* NVS_RGB_SPEED_KEY = "rgb_speed";
+static const char* NVS_RGB_BRIGHTNESS_KEY = "rgb_bright";
 static const char* NVS_PORTAL_URL_KEY = "portal_url";
 static const char* NVS_PORTAL_SSID_KEY = "portal_ssid";
 static const char* NVS_PORTAL_PASSWORD_KEY = "portal_password";
@@ -55,6 +56,7 @@ void settings_set_defaults(FSettings* settings) {
     strcpy(settings->ap_ssid, "GhostNet");
     strcpy(settings->ap_password, "GhostNet");
     settings->rgb_speed = 50;
+    settings->rgb_brightness = 30;
 
     // Evil Portal defaults
     strcpy(settings->portal_url, "/default/path");
@@ -119,6 +121,11 @@ void settings_load(FSettings* settings) {
         settings->rgb_speed = value_u8;
     }
 
+    err = nvs_get_u8(nvsHandle, NVS_RGB_BRIGHTNESS_KEY, &value_u8);
+    if (err == ESP_OK) {
+        settings->rgb_brightness = value_u8;
+    }
+
     // Load Evil Portal settings
     str_size = sizeof(settings->portal_url);
     err = nvs_get_str(nvsHandle, NVS_PORTAL_URL_KEY, settings->portal_url, &str_size);
@@ -226,6 +233,11 @@ void settings_save(const FSettings* settings) {
         ESP_LOGE(S_TAG, "Failed to save RGB Speed");
     }
 
+    err = nvs_set_u8(nvsHandle, NVS_RGB_BRIGHTNESS_KEY, settings->rgb_brightness);
+    if (err != ESP_OK) {
+        ESP_LOGE(S_TAG, "Failed to save RGB Brightness");
+    }
+
     // Save Evil Portal settings
     err = nvs_set_str(nvsHandle, NVS_PORTAL_URL_KEY, settings->portal_url);
     if (err != ESP_OK) {
@@ -285,22 +297,11 @@ void settings_save(const FSettings* settings) {
 
     printf(" RGB MODE INDEX = %i\n", (int)settings_get_rgb_mode(&G_Settings));
 
-    if (settings_get_rgb_mode(&G_Settings) == 0)
+    rgb_manager_apply_settings();
+    if (settings_get_rgb_mode(&G_Settings) == RGB_MODE_NORMAL)
     {
-        if (rgb_effect_task_handle != NULL)
-        {
-            vTaskDelete(rgb_effect_task_handle);
-            rgb_effect_task_handle = NULL;
-        }
         rgb_manager_set_color(&rgb_manager, 0, 0, 0, 0, false);
     }
-    else 
-    {
-        if (rgb_effect_task_handle == NULL)
-        {
-            xTaskCreate(rainbow_task, "Rainbow Task", 8192, &rgb_manager, 1, &rgb_effect_task_handle);
-        }
-    }
 
     // Commit all changes
     err = nvs_commit(nvsHandle);
@@ -374,6 +375,14 @@ uint8_t settings_get_rgb_speed(const FSettings* settings) {
     return settings->rgb_speed;
 }
 
+void settings_set_rgb_brightness(FSettings* settings, uint8_t brightness) {
+    settings->rgb_brightness = brightness > 100 ? 100 : brightness;
+}
+
+uint8_t settings_get_rgb_brightness(const FSettings* settings) {
+    return settings->rgb_brightness;
+}
+
 // Evil Portal Getters and Setters
 void settings_set_portal_url(FSettings* settings, const char* url) {
     strncpy(settings->portal_url, url, sizeof(settings->portal_url) - 1);
@@ -0,0 +1,828 @@
+#include "managers/ui_benchmark.h"
+#include "managers/display_manager.h"
+#include "managers/display_stats.h"
+#include "managers/view_transition.h"
+#include "managers/views/app_gallery_screen.h"
+#include "managers/views/device_list_screen.h"
+#include "managers/views/flappy_ghost_screen.h"
+#include "managers/views/main_menu_screen.h"
+#include "managers/views/music_visualizer.h"
+#include "managers/views/options_screen.h"
+#include "managers/views/terminal_screen.h"
+#include "src/draw/sw/lv_draw_sw.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    BENCH_IDLE,
+    BENCH_SWITCH,
+    BENCH_SETTLE,
+    BENCH_MEASURE,
+} ui_benchmark_state_t;
+
+typedef struct {
+    const char *name;
+    View *view;
+    void (*setup)(void);
+    const int *script;   // Joystick indexes replayed in a loop while measuring
+    int script_len;
+} ui_benchmark_case_t;
+
+static void setup_options_wifi(void) { SelectedMenuType = OT_Wifi; }
+static void setup_options_ble(void) { SelectedMenuType = OT_Bluetooth; }
+
+// Navigation only, nothing that selects an item or leaves the view
+static const int script_menu[] = {3, 3, 3, 0, 0, 0};
+static const int script_options[] = {4, 4, 4, 2, 2, 2};
+static const int script_flap[] = {1};
+
+static const ui_benchmark_case_t bench_cases[] = {
+    {"Main Menu", &main_menu_view, NULL, script_menu, sizeof(script_menu) / sizeof(int)},
+    {"WiFi Options", &options_menu_view, setup_options_wifi, script_options, sizeof(script_options) / sizeof(int)},
+    {"BLE Options", &options_menu_view, setup_options_ble, script_options, sizeof(script_options) / sizeof(int)},
+    {"Apps", &apps_menu_view, NULL, script_menu, sizeof(script_menu) / sizeof(int)},
+    {"Terminal", &terminal_view, NULL, NULL, 0},
+    {"Visualizer", &music_visualizer_view, NULL, NULL, 0},
+    {"Flappy Ghost", &flappy_bird_view, NULL, script_flap, 1},
+};
+
+#define BENCH_CASE_COUNT (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static atomic_uint requested_ms = 0;
+static atomic_int requested_text_frames = 0;
+static atomic_int requested_flush_frames = 0;
+static atomic_int requested_list_updates = 0;
+static atomic_int requested_stress_cycles = 0;
+static atomic_bool requested_transitions = false;
+
+static ui_benchmark_state_t state = BENCH_IDLE;
+static uint32_t duration_ms = UI_BENCHMARK_DEFAULT_MS;
+static size_t case_index = 0;
+static int64_t state_since_us = 0;
+static int64_t next_input_us = 0;
+static int script_pos = 0;
+
+static int stress_cycles = 0;       // Non zero while a memory stress run is active
+static int stress_cycle = 0;
+static size_t stress_case = 0;
+static bool stress_switched = false;
+static int64_t stress_since_us = 0;
+static uint32_t stress_peak = 0;
+
+static const view_transition_t trans_strategies[] = {
+    VIEW_TRANSITION_INSTANT,
+    VIEW_TRANSITION_SLIDE,
+    VIEW_TRANSITION_CROSSFADE,
+};
+
+#define TRANS_STRATEGY_COUNT (sizeof(trans_strategies) / sizeof(trans_strategies[0]))
+
+static int trans_index = -1;        // Strategy being measured, -1 while no transition run is active
+static bool trans_switched = false;
+static View *trans_target = NULL;
+static int64_t trans_since_us = 0;
+static view_transition_t trans_saved = VIEW_TRANSITION_AUTO;
+
+static lv_disp_drv_t *bench_drv = NULL;
+static void (*saved_monitor_cb)(lv_disp_drv_t *, uint32_t, uint32_t) = NULL;
+static void (*saved_render_start_cb)(lv_disp_drv_t *) = NULL;
+
+static bool measuring = false;
+static int64_t frame_start_us = 0;
+static uint32_t frames = 0;
+static uint64_t frame_us_total = 0;
+static uint32_t frame_us_max = 0;
+static uint64_t px_total = 0;
+static size_t baseline_free = 0;
+static size_t min_free = 0;
+
+static void sample_free_memory(void) {
+    size_t free_now = display_manager_get_free_ui_memory();
+    if (free_now < min_free) min_free = free_now;
+}
+
+static void bench_render_start_cb(lv_disp_drv_t *drv) {
+    frame_start_us = esp_timer_get_time();
+    if (saved_render_start_cb) saved_render_start_cb(drv);
+}
+
+static void bench_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px) {
+    if (measuring && frame_start_us) {
+        uint32_t frame_us = (uint32_t)(esp_timer_get_time() - frame_start_us);
+        frames++;
+        frame_us_total += frame_us;
+        if (frame_us > frame_us_max) frame_us_max = frame_us;
+        px_total += px;
+    }
+    frame_start_us = 0;
+    sample_free_memory();
+
+    if (saved_monitor_cb) saved_monitor_cb(drv, time, px);
+}
+
+static void hook_driver(lv_disp_t *disp) {
+    bench_drv = disp->driver;
+    saved_monitor_cb = bench_drv->monitor_cb;
+    saved_render_start_cb = bench_drv->render_start_cb;
+    bench_drv->monitor_cb = bench_monitor_cb;
+    bench_drv->render_start_cb = bench_render_start_cb;
+}
+
+static void unhook_driver(void) {
+    measuring = false;
+    bench_drv->monitor_cb = saved_monitor_cb;
+    bench_drv->render_start_cb = saved_render_start_cb;
+    bench_drv = NULL;
+}
+
+static void bench_begin(uint32_t window_ms) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp == NULL) {
+        printf("UI benchmark: no display\n");
+        return;
+    }
+
+    hook_driver(disp);
+
+    duration_ms = window_ms;
+    case_index = 0;
+    state = BENCH_SWITCH;
+
+    printf("UI benchmark on %dx%d, %lu ms per view\n", lv_disp_get_hor_res(disp), lv_disp_get_ver_res(disp),
+           (unsigned long)duration_ms);
+    printf("%-14s %9s %8s %8s %7s %8s %8s %9s %6s\n", "View", "Create us", "Create B", "Peak B", "Frames",
+           "Avg us", "Max us", "Px/frame", "Scr %");
+}
+
+static void bench_finish(void) {
+    unhook_driver();
+    state = BENCH_IDLE;
+
+    printf("UI benchmark done\n");
+    display_manager_switch_view(&main_menu_view);
+}
+
+static void bench_report(const ui_benchmark_case_t *bench) {
+    int64_t create_us = 0;
+    size_t create_bytes = 0;
+    display_manager_get_last_create_stats(&create_us, &create_bytes);
+
+    uint32_t screen_px = (uint32_t)lv_disp_get_hor_res(NULL) * lv_disp_get_ver_res(NULL);
+    uint32_t avg_us = frames ? (uint32_t)(frame_us_total / frames) : 0;
+    uint32_t avg_px = frames ? (uint32_t)(px_total / frames) : 0;
+    uint32_t screen_pct = screen_px ? (uint32_t)((uint64_t)avg_px * 100 / screen_px) : 0;
+    size_t peak = baseline_free > min_free ? baseline_free - min_free : 0;
+
+    printf("%-14s %9lld %8u %8u %7lu %8lu %8lu %9lu %5lu%%\n", bench->name, create_us, (unsigned)create_bytes,
+           (unsigned)peak, (unsigned long)frames, (unsigned long)avg_us, (unsigned long)frame_us_max,
+           (unsigned long)avg_px, (unsigned long)screen_pct);
+}
+
+bool ui_benchmark_start(uint32_t window_ms) {
+    if (state != BENCH_IDLE || stress_cycles) {
+        return false;
+    }
+
+    unsigned int expected = 0;
+    return atomic_compare_exchange_strong(&requested_ms, &expected, window_ms ? window_ms : UI_BENCHMARK_DEFAULT_MS);
+}
+
+// Terminal and list style lines in the fonts the views use
+static const char *const text_lines[] = {
+    "Scanning for access points...",
+    "[0] GhostNet   ch 6   -48 dBm  WPA2",
+    "[1] xfinitywifi   ch 11   -71 dBm",
+    "BLE C4:3A:91:0E:22:7F  AirTag  -63",
+    "Deauth frames sent: 10240",
+    "0123456789 ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+};
+
+static const lv_font_t *const text_fonts[] = {
+    &lv_font_montserrat_10,
+    &lv_font_montserrat_12,
+    &lv_font_montserrat_14,
+    &lv_font_montserrat_16,
+};
+
+#define TEXT_LINE_COUNT (sizeof(text_lines) / sizeof(text_lines[0]))
+#define TEXT_FONT_COUNT (sizeof(text_fonts) / sizeof(text_fonts[0]))
+
+static void print_glyph_cache_stats(const char *label) {
+    lv_draw_sw_glyph_cache_stats_t stats;
+    lv_draw_sw_glyph_cache_get_stats(&stats);
+
+    uint32_t lookups = stats.hits + stats.misses;
+    printf("%s: %lu/%lu glyphs, %lu/%lu bytes, hit rate %lu%% (%lu hits, %lu misses, %lu evicted, %lu uncached)\n",
+           label, (unsigned long)stats.entries, (unsigned long)stats.max_entries, (unsigned long)stats.used_bytes,
+           (unsigned long)stats.max_bytes, (unsigned long)(lookups ? (uint64_t)stats.hits * 100 / lookups : 0),
+           (unsigned long)stats.hits, (unsigned long)stats.misses, (unsigned long)stats.evictions,
+           (unsigned long)stats.uncached);
+}
+
+static int64_t text_run(lv_obj_t *canvas, int frames) {
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.color = lv_color_white();
+
+    int64_t start = esp_timer_get_time();
+    for (int f = 0; f < frames; f++) {
+        lv_coord_t y = 0;
+        for (size_t i = 0; i < TEXT_LINE_COUNT; i++) {
+            dsc.font = text_fonts[i % TEXT_FONT_COUNT];
+            lv_canvas_draw_text(canvas, 2, y, UI_BENCHMARK_TEXT_W - 4, &dsc, text_lines[i]);
+            y += lv_font_get_line_height(dsc.font);
+        }
+    }
+    return esp_timer_get_time() - start;
+}
+
+static void text_benchmark_run(int frames) {
+    print_glyph_cache_stats("Glyph cache since boot");
+
+    size_t bytes = LV_CANVAS_BUF_SIZE_TRUE_COLOR(UI_BENCHMARK_TEXT_W, UI_BENCHMARK_TEXT_H);
+#ifdef CONFIG_SPIRAM
+    void *buf = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (buf == NULL) buf = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#else
+    void *buf = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+#endif
+    if (buf == NULL) {
+        printf("Not enough memory for the text benchmark\n");
+        return;
+    }
+
+    // Never shown, lv_canvas_draw_text renders straight into the buffer
+    lv_obj_t *canvas = lv_canvas_create(lv_layer_sys());
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_buffer(canvas, buf, UI_BENCHMARK_TEXT_W, UI_BENCHMARK_TEXT_H, LV_IMG_CF_TRUE_COLOR);
+    lv_canvas_fill_bg(canvas, lv_color_black(), LV_OPA_COVER);
+
+    printf("Text benchmark, %dx%d canvas, %u lines, %d frames\n", UI_BENCHMARK_TEXT_W, UI_BENCHMARK_TEXT_H,
+           (unsigned)TEXT_LINE_COUNT, frames);
+
+    lv_draw_sw_glyph_cache_set_enabled(false);
+    int64_t off_us = text_run(canvas, frames);
+    printf("%-12s %8lu us/frame\n", "Uncached", (unsigned long)(off_us / frames));
+
+    lv_draw_sw_glyph_cache_set_enabled(true);
+    lv_draw_sw_glyph_cache_stats_t stats;
+    lv_draw_sw_glyph_cache_get_stats(&stats);
+    if (stats.max_bytes == 0) {
+        printf("Glyph cache is disabled, nothing to compare\n");
+    } else {
+        lv_draw_sw_glyph_cache_flush();
+        lv_draw_sw_glyph_cache_reset_stats();
+
+        int64_t cold_us = text_run(canvas, 1);
+        int64_t warm_us = text_run(canvas, frames);
+        printf("%-12s %8lu us/frame\n", "Cold cache", (unsigned long)cold_us);
+        printf("%-12s %8lu us/frame, %lu.%02lux faster than uncached\n", "Warm cache",
+               (unsigned long)(warm_us / frames), (unsigned long)(warm_us ? off_us / warm_us : 0),
+               (unsigned long)(warm_us ? off_us * 100 / warm_us % 100 : 0));
+        print_glyph_cache_stats("Glyph cache after run");
+    }
+
+    lv_obj_del(canvas);
+    heap_caps_free(buf);
+}
+
+typedef struct {
+    uint64_t flush_us;
+    uint64_t bytes;
+    uint32_t flushes;
+    uint32_t frames;
+} flush_totals_t;
+
+// Redraws the area once per frame with display stats recording, then sums the frames
+static void flush_run(lv_disp_t *disp, const lv_area_t *area, int frames, flush_totals_t *totals) {
+    display_stats_reset();
+    for (int f = 0; f < frames; f++) {
+        _lv_inv_area(disp, area);
+        lv_refr_now(disp);
+    }
+
+    memset(totals, 0, sizeof(*totals));
+    display_stats_frame_t frame;
+    for (uint32_t i = 0; display_stats_get_frame(i, &frame); i++) {
+        totals->flush_us += frame.flush_us;
+        totals->bytes += frame.flush_bytes;
+        totals->flushes += frame.flushes;
+        totals->frames++;
+    }
+}
+
+static void flush_benchmark_run(int frames) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (frames > DISPLAY_STATS_RING_SIZE) frames = DISPLAY_STATS_RING_SIZE;
+
+    lv_coord_t w = lv_disp_get_hor_res(disp);
+    lv_coord_t h = lv_disp_get_ver_res(disp);
+    lv_area_t full = {0, 0, w - 1, h - 1};
+    lv_area_t small = {w / 2, h / 2, w / 2 + UI_BENCHMARK_FLUSH_SMALL - 1, h / 2 + UI_BENCHMARK_FLUSH_SMALL - 1};
+
+    bool was_recording = display_stats_is_enabled();
+    display_stats_set_enabled(true);
+
+    flush_totals_t full_run, small_run;
+    flush_run(disp, &full, frames, &full_run);
+    flush_run(disp, &small, frames, &small_run);
+
+    display_stats_reset();
+    display_stats_set_enabled(was_recording);
+
+    if (full_run.frames == 0 || full_run.flush_us == 0 || small_run.flushes == 0) {
+        printf("No frames were recorded, is the display driver registered?\n");
+        return;
+    }
+
+    // Bytes per microsecond is MB/s, keep three decimals of it as KB/s
+    uint64_t kb_per_s = full_run.bytes * 1000 / full_run.flush_us;
+    uint32_t small_flush_us = (uint32_t)(small_run.flush_us / small_run.flushes);
+    uint32_t small_bytes = (uint32_t)(small_run.bytes / small_run.flushes);
+    uint32_t transfer_us = kb_per_s ? (uint32_t)((uint64_t)small_bytes * 1000 / kb_per_s) : 0;
+
+    printf("Flush benchmark, %dx%d, %lu frames per pass\n", w, h, (unsigned long)full_run.frames);
+    printf("%-12s %8lu B/frame, %lu flushes/frame, %lu us flushing/frame, %lu.%02lu MB/s\n", "Full screen",
+           (unsigned long)(full_run.bytes / full_run.frames), (unsigned long)(full_run.flushes / full_run.frames),
+           (unsigned long)(full_run.flush_us / full_run.frames), (unsigned long)(kb_per_s / 1000),
+           (unsigned long)(kb_per_s % 1000 / 10));
+    printf("%-12s %8lu B/flush, %lu us/flush, about %lu us of it per flush overhead\n", "Small area",
+           (unsigned long)small_bytes, (unsigned long)small_flush_us,
+           (unsigned long)(small_flush_us > transfer_us ? small_flush_us - transfer_us : 0));
+}
+
+static void stress_print_row(int cycle) {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    lv_mem_class_monitor_t classes[LV_MEM_CLASS_CNT];
+    uint32_t class_cnt = lv_mem_class_monitor(classes);
+    uint32_t overflows = 0;
+    for (uint32_t i = 0; i < class_cnt; i++) {
+        overflows += classes[i].fallback_cnt;
+    }
+
+    printf("%5d %8lu %8lu %9lu %6u %8lu %9lu%s\n", cycle, (unsigned long)(mon.total_size - mon.free_size),
+           (unsigned long)mon.free_size, (unsigned long)mon.free_biggest_size, mon.frag_pct,
+           (unsigned long)stress_peak, (unsigned long)overflows, lv_mem_test() == LV_RES_OK ? "" : "  heap check FAILED");
+}
+
+static void stress_begin(int cycles) {
+#if LV_MEM_CUSTOM
+    printf("Memory stress needs the LVGL heap, this build uses LV_MEM_CUSTOM\n");
+#else
+    stress_cycles = cycles;
+    stress_cycle = 0;
+    stress_case = 0;
+    stress_switched = false;
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    stress_peak = mon.max_used;
+
+    printf("UI memory stress, %d cycles over %u views\n", cycles, (unsigned)BENCH_CASE_COUNT);
+    printf("%5s %8s %8s %9s %6s %8s %9s\n", "Cycle", "Used B", "Free B", "Biggest B", "Frag %", "Peak B",
+           "Overflows");
+    stress_print_row(0);
+#endif
+}
+
+static void stress_process(void) {
+    const ui_benchmark_case_t *bench = &bench_cases[stress_case];
+    int64_t now = esp_timer_get_time();
+
+    if (!stress_switched) {
+        if (bench->setup) bench->setup();
+        display_manager_switch_view(bench->view);
+        stress_switched = true;
+        stress_since_us = now;
+        return;
+    }
+
+    bool settled = display_manager_get_current_view() == bench->view &&
+                   now - stress_since_us >= (int64_t)UI_BENCHMARK_STRESS_DWELL_MS * 1000;
+    if (!settled && now - stress_since_us < (int64_t)UI_BENCHMARK_TIMEOUT_MS * 1000) {
+        return;
+    }
+
+    // The display manager restarts max_used on every switch, so collect it before the next one
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    if (mon.max_used > stress_peak) {
+        stress_peak = mon.max_used;
+    }
+
+    stress_switched = false;
+    if (++stress_case < BENCH_CASE_COUNT) {
+        return;
+    }
+
+    stress_case = 0;
+    stress_print_row(++stress_cycle);
+    if (stress_cycle >= stress_cycles) {
+        stress_cycles = 0;
+        printf("UI memory stress done\n");
+        display_manager_switch_view(&main_menu_view);
+    }
+}
+static void trans_begin(void) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp == NULL) {
+        printf("Transition benchmark: no display\n");
+        return;
+    }
+
+    trans_saved = view_transition_get_strategy();
+    view_transition_set_strategy(VIEW_TRANSITION_AUTO);
+    view_transition_t picked = view_transition_resolve();
+    view_transition_set_strategy(trans_saved);
+
+    uint32_t plain_us = 0, blend_us = 0;
+    view_transition_get_frame_times(&plain_us, &blend_us);
+    printf("Transition benchmark on %dx%d, %d ms per transition\n", lv_disp_get_hor_res(disp),
+           lv_disp_get_ver_res(disp), VIEW_TRANSITION_MS);
+    printf("Full frame %lu us, blended %lu us, auto picks %s\n", (unsigned long)plain_us,
+           (unsigned long)blend_us, view_transition_name(picked));
+    printf("%-10s %-10s %7s %8s %8s %8s %6s\n", "Strategy", "Ran as", "Frames", "Total ms", "Avg us",
+           "Max us", "FPS");
+
+    hook_driver(disp);
+    trans_index = 0;
+    trans_switched = false;
+}
+
+static void trans_process(void) {
+    int64_t now = esp_timer_get_time();
+    View *current = display_manager_get_current_view();
+
+    if (!trans_switched) {
+        view_transition_set_strategy(trans_strategies[trans_index]);
+        trans_target = current == &main_menu_view ? &options_menu_view : &main_menu_view;
+        frames = 0;
+        frame_us_total = 0;
+        frame_us_max = 0;
+        measuring = true;
+        display_manager_switch_view(trans_target);
+        trans_switched = true;
+        trans_since_us = now;
+        return;
+    }
+
+    bool done = current == trans_target && !view_transition_is_active();
+    if (!done && now - trans_since_us < (int64_t)UI_BENCHMARK_TIMEOUT_MS * 1000) {
+        return;
+    }
+    measuring = false;
+
+    const char *name = view_transition_name(trans_strategies[trans_index]);
+    if (!done) {
+        printf("%-10s did not finish, skipped\n", name);
+    } else {
+        uint32_t total_us = (uint32_t)(now - trans_since_us);
+        printf("%-10s %-10s %7lu %8lu %8lu %8lu %6lu\n", name, view_transition_name(view_transition_last()),
+               (unsigned long)frames, (unsigned long)(total_us / 1000),
+               (unsigned long)(frames ? frame_us_total / frames : 0), (unsigned long)frame_us_max,
+               (unsigned long)(total_us ? (uint64_t)frames * 1000000 / total_us : 0));
+    }
+
+    trans_switched = false;
+    if (++trans_index < (int)TRANS_STRATEGY_COUNT) {
+        return;
+    }
+
+    trans_index = -1;
+    unhook_driver();
+    view_transition_set_strategy(trans_saved);
+    printf("Transition benchmark done\n");
+}
+
+// Deterministic so runs are comparable, esp_random() would also cost more than the upsert
+static uint32_t list_rand(uint32_t *seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+static void list_benchmark_run(int updates) {
+    device_table_t table;
+    device_table_init(&table, DEVICE_KIND_AP, DEVICE_TABLE_SIZE);
+
+    lv_obj_t *parent = lv_obj_create(lv_scr_act());
+    lv_obj_add_flag(parent, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_size(parent, LV_HOR_RES, LV_VER_RES);
+
+    device_list_t list;
+    if (!device_list_init(&list, parent, &table, 0, LV_HOR_RES, LV_VER_RES)) {
+        printf("Not enough memory for the device list benchmark\n");
+        lv_obj_del(parent);
+        return;
+    }
+
+    // Twice as many devices as fit, so the full table path is exercised too
+    uint32_t seed = 1;
+    uint32_t pool = table.capacity * 2;
+    int64_t upsert_us = 0, refresh_us = 0;
+    uint32_t refresh_max_us = 0, refreshes = 0, relabelled = 0;
+
+    for (int done = 0; done < updates;) {
+        int batch = updates - done < UI_BENCHMARK_LIST_BATCH ? updates - done : UI_BENCHMARK_LIST_BATCH;
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < batch; i++) {
+            uint32_t id = list_rand(&seed) % pool;
+            uint8_t mac[6] = {0x02, 0x00, (uint8_t)(id >> 24), (uint8_t)(id >> 16), (uint8_t)(id >> 8), (uint8_t)id};
+            int8_t rssi = (int8_t)(-30 - (int)(list_rand(&seed) % 60));
+            device_table_upsert(&table, mac, rssi, 1 + id % 13, NULL, NULL, (uint32_t)(start / 1000) + i);
+        }
+        int64_t mid = esp_timer_get_time();
+        relabelled += device_list_refresh(&list);
+        int64_t end = esp_timer_get_time();
+
+        upsert_us += mid - start;
+        refresh_us += end - mid;
+        if (end - mid > refresh_max_us) refresh_max_us = (uint32_t)(end - mid);
+        refreshes++;
+        done += batch;
+    }
+
+    printf("Device list benchmark, %d updates over %u devices, %u tracked, %lu evicted\n", updates,
+           (unsigned)pool, table.count, (unsigned long)table.evicted);
+    printf("%-10s %lu us total, %lu updates/s\n", "Upserts", (unsigned long)upsert_us,
+           (unsigned long)(upsert_us ? (uint64_t)updates * 1000000 / upsert_us : 0));
+    printf("%-10s %lu refreshes, %lu us avg, %lu us max\n", "Refresh", (unsigned long)refreshes,
+           (unsigned long)(refreshes ? refresh_us / refreshes : 0), (unsigned long)refresh_max_us);
+    printf("%-10s %lu of %lu shown rows relabelled\n", "Rows", (unsigned long)relabelled,
+           (unsigned long)(refreshes * list.row_count));
+
+    device_list_deinit(&list);
+    lv_obj_del(parent);
+    device_table_free(&table);
+}
+
+bool ui_benchmark_memory_stress(int cycles) {
+    if (state != BENCH_IDLE || stress_cycles) {
+        return false;
+    }
+
+    int expected = 0;
+    return atomic_compare_exchange_strong(&requested_stress_cycles, &expected, cycles > 0 ? cycles : 1);
+}
+
+bool ui_benchmark_transitions(void) {
+    if (state != BENCH_IDLE || stress_cycles || trans_index >= 0) {
+        return false;
+    }
+
+    bool expected = false;
+    return atomic_compare_exchange_strong(&requested_transitions, &expected, true);
+}
+
+bool ui_benchmark_device_list(int updates) {
+    int expected = 0;
+    return atomic_compare_exchange_strong(&requested_list_updates, &expected, updates > 0 ? updates : 1);
+}
+
+bool ui_benchmark_flush(int frames) {
+    int expected = 0;
+    return atomic_compare_exchange_strong(&requested_flush_frames, &expected, frames > 0 ? frames : 1);
+}
+
+bool ui_benchmark_text(int frames) {
+    int expected = 0;
+    return atomic_compare_exchange_strong(&requested_text_frames, &expected, frames > 0 ? frames : 1);
+}
+
+bool ui_benchmark_is_running(void) {
+    return state != BENCH_IDLE || stress_cycles || trans_index >= 0 || atomic_load(&requested_ms) ||
+           atomic_load(&requested_text_frames) || atomic_load(&requested_flush_frames) ||
+           atomic_load(&requested_list_updates) || atomic_load(&requested_stress_cycles) ||
+           atomic_load(&requested_transitions);
+}
+
+void ui_benchmark_process(void) {
+    if (state == BENCH_IDLE) {
+        int text_frames = atomic_exchange(&requested_text_frames, 0);
+        if (text_frames > 0) {
+            text_benchmark_run(text_frames);
+        }
+
+        int flush_frames = atomic_exchange(&requested_flush_frames, 0);
+        if (flush_frames > 0) {
+            flush_benchmark_run(flush_frames);
+        }
+
+        int list_updates = atomic_exchange(&requested_list_updates, 0);
+        if (list_updates > 0) {
+            list_benchmark_run(list_updates);
+        }
+
+        if (stress_cycles) {
+            stress_process();
+            return;
+        }
+
+        if (trans_index >= 0) {
+            trans_process();
+            return;
+        }
+
+        if (atomic_exchange(&requested_transitions, false)) {
+            trans_begin();
+            return;
+        }
+
+        int cycles = atomic_exchange(&requested_stress_cycles, 0);
+        if (cycles > 0) {
+            stress_begin(cycles);
+            return;
+        }
+
+        unsigned int request = atomic_exchange(&requested_ms, 0);
+        if (request == 0) {
+            return;
+        }
+        bench_begin(request);
+        if (state == BENCH_IDLE) {
+            return;
+        }
+    }
+
+    int64_t now = esp_timer_get_time();
+    const ui_benchmark_case_t *bench = &bench_cases[case_index < BENCH_CASE_COUNT ? case_index : 0];
+    View *current = display_manager_get_current_view();
+
+    switch (state) {
+    case BENCH_SWITCH:
+        if (case_index >= BENCH_CASE_COUNT) {
+            bench_finish();
+            return;
+        }
+
+        // Cold start every view so create() is measured, not a cache hit
+        display_manager_flush_view_cache();
+        baseline_free = display_manager_get_free_ui_memory();
+        min_free = baseline_free;
+
+        if (bench->setup) bench->setup();
+        display_manager_switch_view(bench->view);
+
+        state_since_us = now;
+        state = BENCH_SETTLE;
+        break;
+
+    case BENCH_SETTLE:
+        sample_free_memory();
+
+        if (current != bench->view) {
+            if (now - state_since_us > (int64_t)UI_BENCHMARK_TIMEOUT_MS * 1000) {
+                printf("%-14s did not become active, skipped\n", bench->name);
+                case_index++;
+                state = BENCH_SWITCH;
+            }
+            break;
+        }
+
+        if (now - state_since_us >= (int64_t)UI_BENCHMARK_SETTLE_MS * 1000) {
+            frames = 0;
+            frame_us_total = 0;
+            frame_us_max = 0;
+            px_total = 0;
+            script_pos = 0;
+            next_input_us = now;
+            measuring = true;
+            state_since_us = now;
+            state = BENCH_MEASURE;
+        }
+        break;
+
+    case BENCH_MEASURE:
+        sample_free_memory();
+
+        if (current != bench->view) {
+            printf("%-14s left the view while measuring, skipped\n", bench->name);
+            measuring = false;
+            case_index++;
+            state = BENCH_SWITCH;
+            break;
+        }
+
+        if (bench->script_len && now >= next_input_us && current->input_callback) {
+            InputEvent event = {.type = INPUT_TYPE_JOYSTICK};
+            event.data.joystick_index = bench->script[script_pos];
+            script_pos = (script_pos + 1) % bench->script_len;
+            next_input_us = now + (int64_t)UI_BENCHMARK_INPUT_MS * 1000;
+            current->input_callback(&event);
+        }
+
+        if (now - state_since_us >= (int64_t)duration_ms * 1000) {
+            measuring = false;
+            bench_report(bench);
+            case_index++;
+            state = BENCH_SWITCH;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_MIX_ROUND_OFS != 0
+// The per channel formula lv_color_mix used before the 16 bit lanes version, test/host/test_lv_color.c
+// checks the two agree
+static inline lv_color_t blend_reference_mix(lv_color_t c1, lv_color_t c2, uint8_t mix) {
+    lv_color_t ret;
+    LV_COLOR_SET_R(ret, LV_UDIV255((uint16_t)LV_COLOR_GET_R(c1) * mix + LV_COLOR_GET_R(c2) * (255 - mix) +
+                                   LV_COLOR_MIX_ROUND_OFS));
+    LV_COLOR_SET_G(ret, LV_UDIV255((uint16_t)LV_COLOR_GET_G(c1) * mix + LV_COLOR_GET_G(c2) * (255 - mix) +
+                                   LV_COLOR_MIX_ROUND_OFS));
+    LV_COLOR_SET_B(ret, LV_UDIV255((uint16_t)LV_COLOR_GET_B(c1) * mix + LV_COLOR_GET_B(c2) * (255 - mix) +
+                                   LV_COLOR_MIX_ROUND_OFS));
+    LV_COLOR_SET_A(ret, 0xFF);
+    return ret;
+}
+
+typedef enum {
+    BLEND_CONST_OPA,
+    BLEND_MASKED,
+    BLEND_MAP_OPA,
+} blend_kernel_t;
+
+static int64_t blend_run(blend_kernel_t kernel, bool reference, lv_color_t *dest, const lv_color_t *src,
+                         const lv_opa_t *mask, int iterations) {
+    lv_color_t fg = lv_color_make(0x20, 0xC0, 0x60);
+    int64_t start = esp_timer_get_time();
+
+    for (int n = 0; n < iterations; n++) {
+        for (int i = 0; i < UI_BENCHMARK_BLEND_PX; i++) {
+            switch (kernel) {
+            case BLEND_CONST_OPA:
+                dest[i] = reference ? blend_reference_mix(fg, dest[i], LV_OPA_60) : lv_color_mix(fg, dest[i], LV_OPA_60);
+                break;
+            case BLEND_MASKED:
+                dest[i] = reference ? blend_reference_mix(fg, dest[i], mask[i]) : lv_color_mix(fg, dest[i], mask[i]);
+                break;
+            case BLEND_MAP_OPA:
+                dest[i] = reference ? blend_reference_mix(src[i], dest[i], LV_OPA_60)
+                                    : lv_color_mix(src[i], dest[i], LV_OPA_60);
+                break;
+            }
+        }
+    }
+
+    return esp_timer_get_time() - start;
+}
+
+void ui_benchmark_blend(int iterations) {
+    static const char *names[] = {"Const opacity", "Masked", "Image opacity"};
+
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    lv_color_t *dest = heap_caps_malloc(UI_BENCHMARK_BLEND_PX * sizeof(lv_color_t), MALLOC_CAP_8BIT);
+    lv_color_t *src = heap_caps_malloc(UI_BENCHMARK_BLEND_PX * sizeof(lv_color_t), MALLOC_CAP_8BIT);
+    lv_opa_t *mask = heap_caps_malloc(UI_BENCHMARK_BLEND_PX, MALLOC_CAP_8BIT);
+    if (dest == NULL || src == NULL || mask == NULL) {
+        printf("Not enough memory for the blend benchmark\n");
+        heap_caps_free(dest);
+        heap_caps_free(src);
+        heap_caps_free(mask);
+        return;
+    }
+
+    uint32_t seed = 1;
+    for (int i = 0; i < UI_BENCHMARK_BLEND_PX; i++) {
+        seed = seed * 1103515245 + 12345;
+        src[i].full = seed >> 16;
+        // Glyph edges: mostly transparent or opaque with some partial coverage
+        mask[i] = (i % 7 == 0) ? (seed >> 8) & 0xFF : ((i / 5) % 2 ? LV_OPA_COVER : LV_OPA_TRANSP);
+    }
+
+    printf("%-14s %12s %12s\n", "Kernel", "Ref Mpx/s", "Fast Mpx/s");
+
+    for (int k = BLEND_CONST_OPA; k <= BLEND_MAP_OPA; k++) {
+        uint64_t px = (uint64_t)UI_BENCHMARK_BLEND_PX * iterations;
+
+        lv_color_fill(dest, lv_color_make(0x40, 0x40, 0x40), UI_BENCHMARK_BLEND_PX);
+        int64_t ref_us = blend_run(k, true, dest, src, mask, iterations);
+        lv_color_fill(dest, lv_color_make(0x40, 0x40, 0x40), UI_BENCHMARK_BLEND_PX);
+        int64_t fast_us = blend_run(k, false, dest, src, mask, iterations);
+
+        // Mpx/s with one decimal, px per us is Mpx per s
+        uint32_t ref_rate = ref_us > 0 ? (uint32_t)(px * 10 / ref_us) : 0;
+        uint32_t fast_rate = fast_us > 0 ? (uint32_t)(px * 10 / fast_us) : 0;
+        printf("%-14s %10lu.%lu %10lu.%lu\n", names[k], (unsigned long)(ref_rate / 10), (unsigned long)(ref_rate % 10),
+               (unsigned long)(fast_rate / 10), (unsigned long)(fast_rate % 10));
+    }
+
+    heap_caps_free(dest);
+    heap_caps_free(src);
+    heap_caps_free(mask);
+}
+#else
+void ui_benchmark_blend(int iterations) {
+    printf("Blend benchmark needs LV_COLOR_DEPTH 16 and a non zero LV_COLOR_MIX_ROUND_OFS\n");
+}
+#endif
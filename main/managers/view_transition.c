@@ -0,0 +1,234 @@
+#include "managers/view_transition.h"
+#include "managers/display_stats.h"
+#include "esp_heap_caps.h"
+#include <stdio.h>
+
+#if defined(CONFIG_VIEW_TRANSITION_INSTANT)
+#define VIEW_TRANSITION_DEFAULT VIEW_TRANSITION_INSTANT
+#elif defined(CONFIG_VIEW_TRANSITION_SLIDE)
+#define VIEW_TRANSITION_DEFAULT VIEW_TRANSITION_SLIDE
+#elif defined(CONFIG_VIEW_TRANSITION_CROSSFADE)
+#define VIEW_TRANSITION_DEFAULT VIEW_TRANSITION_CROSSFADE
+#else
+#define VIEW_TRANSITION_DEFAULT VIEW_TRANSITION_AUTO
+#endif
+
+static view_transition_t strategy = VIEW_TRANSITION_DEFAULT;
+static view_transition_t pending = VIEW_TRANSITION_INSTANT;
+static view_transition_t last_used = VIEW_TRANSITION_INSTANT;
+
+static bool active = false;
+static lv_obj_t *slide_root = NULL;
+static lv_obj_t *slide_parent = NULL;
+static lv_color_t slide_parent_bg;
+static bool slide_parent_had_bg = false;
+static lv_obj_t *fade_img = NULL;
+static lv_img_dsc_t fade_dsc;
+static void *fade_buf = NULL;
+
+void view_transition_set_strategy(view_transition_t new_strategy) {
+    strategy = new_strategy;
+}
+
+view_transition_t view_transition_get_strategy(void) {
+    return strategy;
+}
+
+view_transition_t view_transition_last(void) {
+    return last_used;
+}
+
+const char *view_transition_name(view_transition_t s) {
+    switch (s) {
+        case VIEW_TRANSITION_INSTANT:
+            return "instant";
+        case VIEW_TRANSITION_SLIDE:
+            return "slide";
+        case VIEW_TRANSITION_CROSSFADE:
+            return "crossfade";
+        default:
+            return "auto";
+    }
+}
+
+bool view_transition_get_frame_times(uint32_t *plain_us, uint32_t *blend_us) {
+    uint32_t render_ns = 0, flush_ns = 0;
+    lv_disp_t *disp = lv_disp_get_default();
+    bool known = disp != NULL && display_stats_get_cost(&render_ns, &flush_ns);
+    uint64_t px = known ? (uint64_t)lv_disp_get_hor_res(disp) * lv_disp_get_ver_res(disp) : 0;
+
+    // A slide redraws and flushes the whole screen every frame, a crossfade draws the
+    // snapshot over the new view on top of that
+    if (plain_us) *plain_us = (uint32_t)(px * (render_ns + flush_ns) / 1000);
+    if (blend_us) *blend_us = (uint32_t)(px * (render_ns * VIEW_TRANSITION_BLEND_RENDER_COST + flush_ns) / 1000);
+    return known;
+}
+
+view_transition_t view_transition_resolve(void) {
+    if (strategy != VIEW_TRANSITION_AUTO) {
+        return strategy;
+    }
+
+    // Until the panel has drawn a large frame its speed is unknown, swapping is always safe
+    uint32_t plain_frame_us, blend_frame_us;
+    if (!view_transition_get_frame_times(&plain_frame_us, &blend_frame_us)) {
+        return VIEW_TRANSITION_INSTANT;
+    }
+
+    uint32_t budget_us = 1000000 / VIEW_TRANSITION_MIN_FPS;
+    if ((uint32_t)VIEW_TRANSITION_MS * 1000 / VIEW_TRANSITION_MIN_FRAMES < budget_us) {
+        budget_us = (uint32_t)VIEW_TRANSITION_MS * 1000 / VIEW_TRANSITION_MIN_FRAMES;
+    }
+
+    if (blend_frame_us <= budget_us) {
+        return VIEW_TRANSITION_CROSSFADE;
+    }
+    if (plain_frame_us <= budget_us) {
+        return VIEW_TRANSITION_SLIDE;
+    }
+    return VIEW_TRANSITION_INSTANT;
+}
+
+static void free_snapshot(void) {
+    if (fade_img != NULL) {
+        if (lv_obj_is_valid(fade_img)) {
+            lv_obj_del(fade_img);
+        }
+        fade_img = NULL;
+    }
+    if (fade_buf != NULL) {
+        heap_caps_free(fade_buf);
+        fade_buf = NULL;
+    }
+}
+
+static bool take_snapshot(lv_obj_t *old_root) {
+#if LV_USE_SNAPSHOT
+    uint32_t size = lv_snapshot_buf_size_needed(old_root, LV_IMG_CF_TRUE_COLOR);
+#ifdef CONFIG_SPIRAM
+    fade_buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (fade_buf == NULL) fade_buf = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+#else
+    fade_buf = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+#endif
+    if (fade_buf == NULL) {
+        return false;
+    }
+
+    if (lv_snapshot_take_to_buf(old_root, LV_IMG_CF_TRUE_COLOR, &fade_dsc, fade_buf, size) != LV_RES_OK) {
+        free_snapshot();
+        return false;
+    }
+
+    fade_img = lv_img_create(lv_scr_act());
+    lv_img_set_src(fade_img, &fade_dsc);
+    lv_obj_set_pos(fade_img, old_root->coords.x1, old_root->coords.y1);
+    lv_obj_clear_flag(fade_img, LV_OBJ_FLAG_CLICKABLE);
+    return true;
+#else
+    return false;
+#endif
+}
+
+static void restore_backdrop(void) {
+    if (slide_parent == NULL) {
+        return;
+    }
+    if (lv_obj_is_valid(slide_parent)) {
+        if (slide_parent_had_bg) {
+            lv_obj_set_style_bg_color(slide_parent, slide_parent_bg, 0);
+        } else {
+            lv_obj_remove_local_style_prop(slide_parent, LV_STYLE_BG_COLOR, 0);
+        }
+    }
+    slide_parent = NULL;
+}
+
+static void finish(void) {
+    if (slide_root != NULL) {
+        // The view may have been destroyed under the animation, which also removed it
+        if (lv_obj_is_valid(slide_root)) {
+            lv_anim_del(slide_root, NULL);
+            lv_obj_set_x(slide_root, 0);
+        }
+        slide_root = NULL;
+    }
+    restore_backdrop();
+    if (fade_img != NULL && lv_obj_is_valid(fade_img)) {
+        lv_anim_del(fade_img, NULL);
+    }
+    free_snapshot();
+    active = false;
+}
+
+static void transition_ready_cb(lv_anim_t *anim) {
+    slide_root = NULL;
+    restore_backdrop();
+    free_snapshot();
+    active = false;
+}
+
+static void slide_exec_cb(void *obj, int32_t v) {
+    lv_obj_set_x(obj, (lv_coord_t)v);
+}
+
+static void fade_exec_cb(void *obj, int32_t v) {
+    lv_obj_set_style_img_opa(obj, (lv_opa_t)v, 0);
+}
+
+void view_transition_prepare(lv_obj_t *old_root) {
+    finish();
+
+    pending = view_transition_resolve();
+    if (pending == VIEW_TRANSITION_CROSSFADE && (old_root == NULL || !take_snapshot(old_root))) {
+        pending = VIEW_TRANSITION_SLIDE;
+    }
+}
+
+void view_transition_start(lv_obj_t *new_root) {
+    view_transition_t run = pending;
+    pending = VIEW_TRANSITION_INSTANT;
+    last_used = run;
+
+    if (new_root == NULL || run == VIEW_TRANSITION_INSTANT) {
+        free_snapshot();
+        return;
+    }
+
+    // lv_anim follows the tick, so a slow panel shows fewer frames but still finishes on time
+    lv_anim_t anim;
+    lv_anim_init(&anim);
+    lv_anim_set_time(&anim, VIEW_TRANSITION_MS);
+    lv_anim_set_ready_cb(&anim, transition_ready_cb);
+
+    if (run == VIEW_TRANSITION_CROSSFADE && fade_img != NULL) {
+        lv_obj_move_foreground(fade_img);
+        lv_anim_set_var(&anim, fade_img);
+        lv_anim_set_values(&anim, LV_OPA_COVER, LV_OPA_TRANSP);
+        lv_anim_set_exec_cb(&anim, fade_exec_cb);
+    } else {
+        free_snapshot();
+        // The area the view has not covered yet shows the screen itself, black until the
+        // slide ends and the screen gets back its own color
+        slide_parent = lv_obj_get_parent(new_root);
+        lv_style_value_t bg;
+        slide_parent_had_bg = lv_obj_get_local_style_prop(slide_parent, LV_STYLE_BG_COLOR, &bg, 0) == LV_STYLE_RES_FOUND;
+        slide_parent_bg = bg.color;
+        lv_obj_set_style_bg_color(slide_parent, lv_color_black(), 0);
+        slide_root = new_root;
+        // lv_obj_get_x() would read the coordinates of the last layout, not the x just set
+        lv_coord_t from_x = lv_obj_get_width(slide_parent);
+        lv_obj_set_x(new_root, from_x);
+        lv_anim_set_var(&anim, new_root);
+        lv_anim_set_values(&anim, from_x, 0);
+        lv_anim_set_path_cb(&anim, lv_anim_path_ease_out);
+        lv_anim_set_exec_cb(&anim, slide_exec_cb);
+    }
+
+    active = true;
+    lv_anim_start(&anim);
+}
+
+bool view_transition_is_active(void) {
+    return active;
+}
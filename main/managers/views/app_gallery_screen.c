@@ -378,6 +378,7 @@ void apps_menu_destroy(void) {
         lv_obj_clean(apps_container);
         lv_obj_del(apps_container);
         apps_container = NULL;
+        apps_menu_view.root = NULL;
     }
 }
 
@@ -392,4 +393,5 @@ View apps_menu_view = {
     .input_callback = apps_menu_event_handler,
     .name = "Apps Menu",
     .get_hardwareinput_callback = get_apps_menu_callback,
+    .cacheable = true,
 };
\ No newline at end of file
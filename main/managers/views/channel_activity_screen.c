@@ -0,0 +1,271 @@
+#include "managers/views/channel_activity_screen.h"
+#include "managers/views/options_screen.h"
+#include "managers/wifi_manager.h"
+#include "core/channel_stats.h"
+#include "core/serial_manager.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ACTIVITY_TOP      22   // Below the status bar
+#define ACTIVITY_COLUMNS  CHANNEL_HOP_LAST
+#define HEAT_LEVELS       8    // Shades a heatmap cell can take
+
+typedef struct {
+    lv_coord_t bar_h[CHANNEL_FRAME_TYPES];       // Stacked segment heights in pixels
+    uint8_t heat[CHANNEL_STATS_RSSI_BUCKETS];    // Heatmap shade per RSSI bucket
+} column_state_t;
+
+static lv_obj_t *info_label = NULL;
+static lv_obj_t *graph = NULL;
+static lv_timer_t *refresh_timer = NULL;
+
+static channel_stats_counts_t prev_counts;
+static uint32_t prev_tick = 0;
+static channel_summary_t summaries[ACTIVITY_COLUMNS];
+static column_state_t columns[ACTIVITY_COLUMNS];
+static uint32_t scale = CHANNEL_ACTIVITY_MIN_SCALE;
+
+// Layout relative to the graph object, set when the view is created
+static lv_coord_t col_w;
+static lv_coord_t bars_h;
+static lv_coord_t cell_h;
+static lv_coord_t label_h;
+
+static const uint32_t type_colors[CHANNEL_FRAME_TYPES] = {
+    0x3399FF,  // Management
+    0xFFCC00,  // Control
+    0x33CC33,  // Data
+    0x808080,  // Other
+};
+
+static void column_area(int col, lv_area_t *area) {
+    area->x1 = graph->coords.x1 + col * col_w;
+    area->x2 = area->x1 + col_w - 1;
+    area->y1 = graph->coords.y1;
+    area->y2 = graph->coords.y2;
+}
+
+static void compute_column(const channel_summary_t *sum, column_state_t *out) {
+    memset(out, 0, sizeof(*out));
+    for (int t = 0; t < CHANNEL_FRAME_TYPES; t++) {
+        uint32_t h = (uint32_t)((uint64_t)sum->rate[t] * bars_h / scale);
+        out->bar_h[t] = h > (uint32_t)bars_h ? bars_h : (lv_coord_t)h;
+    }
+    for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+        // Any traffic at all in a bucket gets at least the faintest shade
+        uint8_t share = sum->rssi_share[b];
+        out->heat[b] = share ? 1 + share * (HEAT_LEVELS - 2) / 255 : 0;
+    }
+}
+
+static void graph_draw_cb(lv_event_t *e) {
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    const lv_area_t *coords = &graph->coords;
+
+    lv_draw_rect_dsc_t rect_dsc;
+    lv_draw_rect_dsc_init(&rect_dsc);
+    rect_dsc.bg_opa = LV_OPA_COVER;
+
+    lv_draw_label_dsc_t label_dsc;
+    lv_draw_label_dsc_init(&label_dsc);
+    label_dsc.font = &lv_font_montserrat_10;
+    label_dsc.color = lv_color_hex(0xAAAAAA);
+    label_dsc.align = LV_TEXT_ALIGN_CENTER;
+
+    // Labels need about two digits of room, narrow panels only label odd channels
+    bool label_all = col_w >= 14;
+
+    lv_area_t clipped;
+    for (int col = 0; col < ACTIVITY_COLUMNS; col++) {
+        lv_area_t column;
+        column_area(col, &column);
+        if (!_lv_area_intersect(&clipped, &column, draw_ctx->clip_area)) {
+            continue;
+        }
+
+        const column_state_t *state = &columns[col];
+        lv_coord_t bottom = coords->y1 + bars_h - 1;
+        for (int t = 0; t < CHANNEL_FRAME_TYPES; t++) {
+            if (state->bar_h[t] == 0) continue;
+            lv_area_t seg = {column.x1 + 1, bottom - state->bar_h[t] + 1, column.x2 - 1, bottom};
+            rect_dsc.bg_color = lv_color_hex(type_colors[t]);
+            lv_draw_rect(draw_ctx, &rect_dsc, &seg);
+            bottom -= state->bar_h[t];
+        }
+
+        // Strongest bucket on top, so close transmitters read as the upper rows
+        for (int b = 0; b < CHANNEL_STATS_RSSI_BUCKETS; b++) {
+            if (state->heat[b] == 0) continue;
+            lv_coord_t y1 = coords->y1 + bars_h + 2 + b * cell_h;
+            lv_area_t cell = {column.x1 + 1, y1, column.x2 - 1, y1 + cell_h - 2};
+            rect_dsc.bg_color = lv_color_mix(lv_palette_main(LV_PALETTE_ORANGE), lv_color_black(),
+                                             (lv_opa_t)(state->heat[b] * 255 / (HEAT_LEVELS - 1)));
+            lv_draw_rect(draw_ctx, &rect_dsc, &cell);
+        }
+
+        int channel = col + 1;
+        if (label_all || channel % 2 == 1) {
+            char text[4];
+            snprintf(text, sizeof(text), "%d", channel);
+            lv_area_t label_area = {column.x1 - 4, coords->y2 - label_h + 1, column.x2 + 4, coords->y2};
+            lv_draw_label(draw_ctx, &label_dsc, &label_area, text, NULL);
+        }
+    }
+}
+
+static void update_info(void) {
+    int busiest = -1;
+    for (int col = 0; col < ACTIVITY_COLUMNS; col++) {
+        if (busiest < 0 || summaries[col].total_rate > summaries[busiest].total_rate) {
+            busiest = col;
+        }
+    }
+
+    char text[48];
+    if (busiest < 0 || summaries[busiest].total_rate == 0) {
+        snprintf(text, sizeof(text), "Listening...  scale %lu f/s", (unsigned long)scale);
+    } else {
+        snprintf(text, sizeof(text), "Busiest ch%d %lu f/s  scale %lu", busiest + 1,
+                 (unsigned long)summaries[busiest].total_rate, (unsigned long)scale);
+    }
+    if (strcmp(lv_label_get_text(info_label), text) != 0) {
+        lv_label_set_text(info_label, text);
+    }
+}
+
+static void refresh_timer_cb(lv_timer_t *timer) {
+    channel_stats_counts_t counts, delta;
+    channel_stats_snapshot(&wifi_channel_stats, &counts);
+    channel_stats_delta(&prev_counts, &counts, &delta);
+    uint32_t elapsed_ms = lv_tick_elaps(prev_tick);
+    prev_counts = counts;
+    prev_tick = lv_tick_get();
+
+    // While hopping a channel keeps its last rates until the radio comes back to it
+    bool hopping = wifi_manager_is_channel_hopping();
+    uint32_t peak = 0;
+    for (int col = 0; col < ACTIVITY_COLUMNS; col++) {
+        channel_summary_t sum;
+        if (channel_stats_summarize(&delta, col + 1, hopping ? 0 : elapsed_ms, &sum)) {
+            summaries[col] = sum;
+        }
+        if (summaries[col].total_rate > peak) peak = summaries[col].total_rate;
+    }
+
+    // Grow at once, shrink only once the band is much quieter so bars do not keep rescaling
+    uint32_t new_scale = scale;
+    if (peak > scale) {
+        while (new_scale < peak) new_scale *= 2;
+    } else if (peak < scale / 4 && scale / 2 >= CHANNEL_ACTIVITY_MIN_SCALE) {
+        new_scale = scale / 2;
+    }
+
+    if (new_scale != scale) {
+        scale = new_scale;
+        for (int col = 0; col < ACTIVITY_COLUMNS; col++) {
+            compute_column(&summaries[col], &columns[col]);
+        }
+        lv_obj_invalidate(graph);
+    } else {
+        for (int col = 0; col < ACTIVITY_COLUMNS; col++) {
+            column_state_t state;
+            compute_column(&summaries[col], &state);
+            if (memcmp(&state, &columns[col], sizeof(state)) != 0) {
+                columns[col] = state;
+                lv_area_t area;
+                column_area(col, &area);
+                lv_obj_invalidate_area(graph, &area);
+            }
+        }
+    }
+
+    update_info();
+}
+
+void channel_activity_view_create(void) {
+    if (channel_activity_view.root != NULL) {
+        return;
+    }
+
+    channel_activity_view.root = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(channel_activity_view.root, LV_HOR_RES, LV_VER_RES);
+    lv_obj_set_style_bg_color(channel_activity_view.root, lv_color_black(), 0);
+    lv_obj_set_style_border_width(channel_activity_view.root, 0, 0);
+    lv_obj_set_style_pad_all(channel_activity_view.root, 0, 0);
+    lv_obj_set_scrollbar_mode(channel_activity_view.root, LV_SCROLLBAR_MODE_OFF);
+    lv_obj_clear_flag(channel_activity_view.root, LV_OBJ_FLAG_SCROLLABLE);
+
+    const lv_font_t *font = &lv_font_montserrat_10;
+    label_h = lv_font_get_line_height(font);
+
+    info_label = lv_label_create(channel_activity_view.root);
+    lv_obj_set_style_text_font(info_label, font, 0);
+    lv_obj_set_style_text_color(info_label, lv_color_hex(0xAAAAAA), 0);
+    lv_label_set_long_mode(info_label, LV_LABEL_LONG_CLIP);
+    lv_obj_set_size(info_label, LV_HOR_RES - 4, label_h);
+    lv_obj_set_pos(info_label, 2, ACTIVITY_TOP);
+    lv_label_set_text(info_label, "");
+
+    // One object draws every column so an update only invalidates the columns that changed
+    lv_coord_t graph_y = ACTIVITY_TOP + label_h + 2;
+    lv_coord_t graph_h = LV_VER_RES - graph_y;
+    col_w = LV_HOR_RES / ACTIVITY_COLUMNS;
+    cell_h = (graph_h - label_h) / 3 / CHANNEL_STATS_RSSI_BUCKETS;
+    if (cell_h < 2) cell_h = 2;
+    bars_h = graph_h - label_h - 2 - cell_h * CHANNEL_STATS_RSSI_BUCKETS;
+
+    graph = lv_obj_create(channel_activity_view.root);
+    lv_obj_remove_style_all(graph);
+    lv_obj_set_size(graph, col_w * ACTIVITY_COLUMNS, graph_h);
+    lv_obj_set_pos(graph, (LV_HOR_RES - col_w * ACTIVITY_COLUMNS) / 2, graph_y);
+    lv_obj_clear_flag(graph, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(graph, graph_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+
+    memset(summaries, 0, sizeof(summaries));
+    memset(columns, 0, sizeof(columns));
+    scale = CHANNEL_ACTIVITY_MIN_SCALE;
+    channel_stats_snapshot(&wifi_channel_stats, &prev_counts);
+    prev_tick = lv_tick_get();
+    update_info();
+
+    refresh_timer = lv_timer_create(refresh_timer_cb, CHANNEL_ACTIVITY_REFRESH_MS, NULL);
+
+    display_manager_add_status_bar("Channels");
+}
+
+void channel_activity_view_destroy(void) {
+    if (refresh_timer != NULL) {
+        lv_timer_del(refresh_timer);
+        refresh_timer = NULL;
+    }
+
+    if (channel_activity_view.root != NULL) {
+        lv_obj_del(channel_activity_view.root);
+        channel_activity_view.root = NULL;
+        graph = NULL;
+        info_label = NULL;
+    }
+}
+
+void channel_activity_view_hardwareinput_callback(InputEvent *event) {
+    if (event->type == INPUT_TYPE_TOUCH ||
+        (event->type == INPUT_TYPE_JOYSTICK && event->data.joystick_index == 1)) {
+        handle_serial_command("chanstats stop");
+        display_manager_switch_view(&options_menu_view);
+    }
+}
+
+void channel_activity_view_get_hardwareinput_callback(void **callback) {
+    if (callback != NULL) {
+        *callback = (void *)channel_activity_view_hardwareinput_callback;
+    }
+}
+
+View channel_activity_view = {
+    .root = NULL,
+    .create = channel_activity_view_create,
+    .destroy = channel_activity_view_destroy,
+    .input_callback = channel_activity_view_hardwareinput_callback,
+    .name = "ChannelActivityView",
+    .get_hardwareinput_callback = channel_activity_view_get_hardwareinput_callback
+};
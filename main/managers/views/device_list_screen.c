@@ -0,0 +1,305 @@
+#include "managers/views/device_list_screen.h"
+#include "managers/views/options_screen.h"
+#include "core/serial_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEVICE_LIST_TOP      22   // Below the status bar
+#define DEVICE_LIST_NO_ENTRY 0xFFFF
+
+static device_kind_t view_kind = DEVICE_KIND_AP;
+static device_list_t view_list;
+static lv_timer_t *refresh_timer = NULL;
+
+static device_table_t *table_for_kind(device_kind_t kind) {
+    switch (kind) {
+        case DEVICE_KIND_STATION:
+            return &device_table_stations;
+        case DEVICE_KIND_BLE:
+            return &device_table_ble;
+        default:
+            return &device_table_aps;
+    }
+}
+
+static const char *kind_title(device_kind_t kind) {
+    switch (kind) {
+        case DEVICE_KIND_STATION:
+            return "Stations";
+        case DEVICE_KIND_BLE:
+            return "BLE Devices";
+        default:
+            return "Access Points";
+    }
+}
+
+static void format_row(const device_table_t *table, const device_entry_t *e, char *buf, size_t size) {
+    const uint8_t *m = e->mac;
+    switch (table->kind) {
+        case DEVICE_KIND_STATION:
+            snprintf(buf, size, "%4d %2u  %02X:%02X:%02X:%02X:%02X:%02X > %02X%02X", e->rssi, e->channel, m[0], m[1],
+                     m[2], m[3], m[4], m[5], e->peer[4], e->peer[5]);
+            break;
+        case DEVICE_KIND_BLE:
+            if (e->name[0]) {
+                snprintf(buf, size, "%4d  %s", e->rssi, e->name);
+            } else {
+                snprintf(buf, size, "%4d  %02X:%02X:%02X:%02X:%02X:%02X", e->rssi, m[0], m[1], m[2], m[3], m[4],
+                         m[5]);
+            }
+            break;
+        default:
+            snprintf(buf, size, "%4d %2u  %s", e->rssi, e->channel, e->name[0] ? e->name : "(hidden)");
+            break;
+    }
+}
+
+static void update_header(device_list_t *list) {
+    char text[48];
+    uint16_t last = list->top + list->row_count;
+    if (last > list->key_count) last = list->key_count;
+    snprintf(text, sizeof(text), "%u found  %u-%u  by %s", list->key_count, list->key_count ? list->top + 1 : 0,
+             last, list->sort == DEVICE_SORT_RSSI ? "RSSI" : "last seen");
+
+    // Skip the redraw when nothing moved
+    if (strcmp(lv_label_get_text(list->header), text) != 0) {
+        lv_label_set_text(list->header, text);
+    }
+}
+
+bool device_list_init(device_list_t *list, lv_obj_t *parent, device_table_t *table, lv_coord_t y, lv_coord_t w,
+                      lv_coord_t h) {
+    memset(list, 0, sizeof(*list));
+    list->table = table;
+    list->sort = DEVICE_SORT_RSSI;
+    list->dirty = true;
+    list->keys = malloc(table->capacity * sizeof(device_sort_key_t));
+    if (list->keys == NULL) {
+        return false;
+    }
+    list->key_capacity = table->capacity;
+
+    const lv_font_t *font = &lv_font_montserrat_10;
+    lv_coord_t line_h = lv_font_get_line_height(font) + 2;
+
+    list->header = lv_label_create(parent);
+    lv_obj_set_style_text_font(list->header, font, 0);
+    lv_obj_set_style_text_color(list->header, lv_color_hex(0xAAAAAA), 0);
+    lv_label_set_long_mode(list->header, LV_LABEL_LONG_CLIP);
+    lv_obj_set_size(list->header, w, line_h);
+    lv_obj_set_pos(list->header, 2, y);
+    lv_label_set_text(list->header, "");
+
+    // Only the visible window gets labels, scrolling rebinds them to other entries
+    int rows = (h - line_h) / line_h;
+    if (rows > DEVICE_LIST_MAX_ROWS) rows = DEVICE_LIST_MAX_ROWS;
+    if (rows < 1) rows = 1;
+    list->row_count = rows;
+
+    for (int i = 0; i < rows; i++) {
+        lv_obj_t *row = lv_label_create(parent);
+        lv_obj_set_style_text_font(row, font, 0);
+        lv_obj_set_style_text_color(row, lv_color_hex(0x00FF00), 0);
+        lv_label_set_long_mode(row, LV_LABEL_LONG_CLIP);
+        lv_obj_set_size(row, w, line_h);
+        lv_obj_set_pos(row, 2, y + line_h * (i + 1));
+        lv_label_set_text(row, "");
+        list->rows[i] = row;
+        list->row_entry[i] = DEVICE_LIST_NO_ENTRY;
+    }
+    return true;
+}
+
+uint16_t device_list_refresh(device_list_t *list) {
+    uint32_t version = device_table_version(list->table);
+    if (version == list->seen_version && !list->dirty) {
+        return 0;
+    }
+    list->seen_version = version;
+    list->dirty = false;
+
+    if (list->table->capacity > list->key_capacity) {
+        device_sort_key_t *keys = realloc(list->keys, list->table->capacity * sizeof(device_sort_key_t));
+        if (keys != NULL) {
+            list->keys = keys;
+            list->key_capacity = list->table->capacity;
+        }
+    }
+
+    list->key_count = device_table_sorted(list->table, list->sort, list->keys, list->key_capacity);
+    if (list->top + list->row_count > list->key_count) {
+        list->top = list->key_count > list->row_count ? list->key_count - list->row_count : 0;
+    }
+
+    uint16_t relabelled = 0;
+    for (int i = 0; i < list->row_count; i++) {
+        uint16_t pos = list->top + i;
+        device_entry_t e;
+
+        if (pos >= list->key_count || !device_table_get(list->table, list->keys[pos].entry, &e)) {
+            if (list->row_entry[i] != DEVICE_LIST_NO_ENTRY) {
+                lv_label_set_text(list->rows[i], "");
+                list->row_entry[i] = DEVICE_LIST_NO_ENTRY;
+                relabelled++;
+            }
+            continue;
+        }
+
+        uint16_t entry = list->keys[pos].entry;
+        if (list->row_entry[i] == entry && list->row_version[i] == e.version) {
+            continue;
+        }
+
+        char text[64];
+        format_row(list->table, &e, text, sizeof(text));
+        lv_label_set_text(list->rows[i], text);
+        list->row_entry[i] = entry;
+        list->row_version[i] = e.version;
+        relabelled++;
+    }
+
+    update_header(list);
+    return relabelled;
+}
+
+void device_list_scroll(device_list_t *list, int rows) {
+    int top = (int)list->top + rows;
+    int max_top = list->key_count > list->row_count ? list->key_count - list->row_count : 0;
+    if (top > max_top) top = max_top;
+    if (top < 0) top = 0;
+    if (top != list->top) {
+        list->top = top;
+        list->dirty = true;
+    }
+}
+
+void device_list_set_sort(device_list_t *list, device_sort_t sort) {
+    if (sort != list->sort) {
+        list->sort = sort;
+        list->top = 0;
+        list->dirty = true;
+    }
+}
+
+void device_list_deinit(device_list_t *list) {
+    free(list->keys);
+    list->keys = NULL;
+    list->key_count = 0;
+    list->key_capacity = 0;
+}
+
+void device_list_view_set_kind(device_kind_t kind) {
+    view_kind = kind;
+}
+
+static void refresh_timer_cb(lv_timer_t *timer) {
+    device_list_refresh(&view_list);
+}
+
+static void toggle_sort(void) {
+    device_list_set_sort(&view_list, view_list.sort == DEVICE_SORT_RSSI ? DEVICE_SORT_LAST_SEEN : DEVICE_SORT_RSSI);
+    device_list_refresh(&view_list);
+}
+
+static void scroll_and_refresh(int rows) {
+    device_list_scroll(&view_list, rows);
+    device_list_refresh(&view_list);
+}
+
+void device_list_view_create(void) {
+    if (device_list_view.root != NULL) {
+        return;
+    }
+
+    device_list_view.root = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(device_list_view.root, LV_HOR_RES, LV_VER_RES);
+    lv_obj_set_style_bg_color(device_list_view.root, lv_color_black(), 0);
+    lv_obj_set_style_border_width(device_list_view.root, 0, 0);
+    lv_obj_set_style_pad_all(device_list_view.root, 0, 0);
+    lv_obj_set_scrollbar_mode(device_list_view.root, LV_SCROLLBAR_MODE_OFF);
+    lv_obj_clear_flag(device_list_view.root, LV_OBJ_FLAG_SCROLLABLE);
+
+    if (device_list_init(&view_list, device_list_view.root, table_for_kind(view_kind), DEVICE_LIST_TOP,
+                         LV_HOR_RES - 4, LV_VER_RES - DEVICE_LIST_TOP)) {
+        device_list_refresh(&view_list);
+        refresh_timer = lv_timer_create(refresh_timer_cb, DEVICE_LIST_REFRESH_MS, NULL);
+    }
+
+    display_manager_add_status_bar(kind_title(view_kind));
+}
+
+void device_list_view_destroy(void) {
+    if (refresh_timer != NULL) {
+        lv_timer_del(refresh_timer);
+        refresh_timer = NULL;
+    }
+    device_list_deinit(&view_list);
+
+    if (device_list_view.root != NULL) {
+        lv_obj_del(device_list_view.root);
+        device_list_view.root = NULL;
+    }
+}
+
+static void leave_view(void) {
+    if (view_kind == DEVICE_KIND_BLE) {
+        handle_serial_command("blescan -s");
+    } else {
+        handle_serial_command("capture -stop");
+    }
+    display_manager_switch_view(&options_menu_view);
+}
+
+void device_list_view_hardwareinput_callback(InputEvent *event) {
+    if (view_list.keys == NULL) {
+        if (event->type == INPUT_TYPE_TOUCH || (event->type == INPUT_TYPE_JOYSTICK &&
+                                                event->data.joystick_index == 1)) {
+            leave_view();
+        }
+        return;
+    }
+
+    if (event->type == INPUT_TYPE_TOUCH) {
+        lv_indev_data_t *data = &event->data.touch_data;
+        int third_height = LV_VER_RES / 3;
+
+        // Tapping the header line switches the sort order, the upper and lower thirds page
+        if (data->point.y < DEVICE_LIST_TOP + lv_obj_get_height(view_list.header)) {
+            toggle_sort();
+        } else if (data->point.y < third_height) {
+            scroll_and_refresh(-view_list.row_count);
+        } else if (data->point.y > 2 * third_height) {
+            scroll_and_refresh(view_list.row_count);
+        } else {
+            leave_view();
+        }
+    } else if (event->type == INPUT_TYPE_JOYSTICK) {
+        int button = event->data.joystick_index;
+
+        if (button == 2) {
+            scroll_and_refresh(-1);
+        } else if (button == 4) {
+            scroll_and_refresh(1);
+        } else if (button == 0 || button == 3) {
+            toggle_sort();
+        } else if (button == 1) {
+            leave_view();
+        }
+    }
+}
+
+void device_list_view_get_hardwareinput_callback(void **callback) {
+    if (callback != NULL) {
+        *callback = (void *)device_list_view_hardwareinput_callback;
+    }
+}
+
+View device_list_view = {
+    .root = NULL,
+    .create = device_list_view_create,
+    .destroy = device_list_view_destroy,
+    .input_callback = device_list_view_hardwareinput_callback,
+    .name = "DeviceListView",
+    .get_hardwareinput_callback = device_list_view_get_hardwareinput_callback
+};
@@ -11,12 +11,16 @@
 #include "esp_http_client.h"     // For HTTP requests
 #include "managers/settings_manager.h"
 #include "esp_crt_bundle.h"
+#include "esp_timer.h"
+#include "managers/views/flappy_ghost_physics.h"
 
 
-#define MAX_PIPE_SETS 2
+#define MAX_PIPE_SETS FLAPPY_MAX_PIPES
 
-
-#define GAME_LOOP_INTERVAL_MS LV_VER_RES > 320 ? 10 : 25
+// Physics runs at a fixed step per board, rendering is paced separately
+#define PHYSICS_STEP_MS (LV_VER_RES > 320 ? 10 : 25)
+#define RENDER_INTERVAL_MS 33
+#define MAX_STEPS_PER_FRAME 4   // Bounds catch-up work after a stall
 
 
 typedef enum {
@@ -51,7 +55,6 @@ void flappy_bird_view_destroy(void);
 void flappy_bird_view_hardwareinput_callback(InputEvent *event);
 void flappy_bird_view_get_hardwareinput_callback(void **callback);
 void flappy_bird_game_loop(lv_timer_t *timer);
-int flappy_bird_check_collision(lv_obj_t *bird, lv_obj_t *pipe);
 void flappy_bird_game_over();
 void flappy_bird_restart();
 bool check_internet_connectivity();
@@ -62,25 +65,17 @@ lv_obj_t *name_text_area = NULL;
 lv_obj_t *keyboard = NULL;
 bool internet_connected = false;
 
-// Define a structure for a single pipe
-typedef struct {
-    lv_obj_t *pipe;
-    int gap_center_y;
-} pipe_set_t;
-
 // Global Game Objects
-lv_obj_t *flappy_bird_canvas = NULL;
-lv_obj_t *bird = NULL;
-pipe_set_t pipes[MAX_PIPE_SETS];
+lv_obj_t *flappy_bird_canvas = NULL;   // Sprite layer, draws the bird and pipes
 lv_obj_t *score_label = NULL;
+const lv_img_dsc_t *bird_img = NULL;
 
 lv_timer_t *game_loop_timer = NULL;
-int bird_y_position = 0;
-float bird_velocity = 0;
-int pipe_gap; // Gap size between pipe and top of the screen
-int pipe_min_gap_y;
-int pipe_max_gap_y;
-int score = 0;
+static flappy_physics_config_t physics_config;
+static flappy_physics_t game;
+static flappy_physics_t rendered;     // State the screen currently shows, used for dirty rects
+static int64_t last_frame_us = 0;
+static int64_t step_accumulator_us = 0;
 bool is_game_over = false;
 
 // Define Web Hook URL if not defined
@@ -255,6 +250,120 @@ void submit_score_to_api(const char *name, int score) {
     esp_log_level_set("esp_http_client", ESP_LOG_INFO);
 }
 
+static void rect_to_area(const flappy_rect_t *rect, lv_area_t *area) {
+    area->x1 = rect->x1;
+    area->y1 = rect->y1;
+    area->x2 = rect->x2;
+    area->y2 = rect->y2;
+}
+
+// Bird box grown to cover the corners of the sprite when it is tilted
+static void bird_draw_area(const flappy_physics_t *state, lv_area_t *area) {
+    flappy_rect_t rect;
+    flappy_physics_bird_rect(state, &rect);
+    rect_to_area(&rect, area);
+    lv_area_increase(area, settings.bird_size / 4, settings.bird_size / 4);
+}
+
+static void invalidate_screen_area(lv_area_t *area) {
+    lv_area_move(area, flappy_bird_canvas->coords.x1, flappy_bird_canvas->coords.y1);
+    lv_obj_invalidate_area(flappy_bird_canvas, area);
+}
+
+static void invalidate_moved(const lv_area_t *old_area, const lv_area_t *new_area) {
+    lv_area_t merged;
+
+    if (_lv_area_is_on(old_area, new_area)) {
+        _lv_area_join(&merged, old_area, new_area);
+        invalidate_screen_area(&merged);
+    } else {
+        merged = *old_area;
+        invalidate_screen_area(&merged);
+        merged = *new_area;
+        invalidate_screen_area(&merged);
+    }
+}
+
+// Invalidates only what changed between the last rendered state and the current one
+static void flappy_bird_invalidate_changes(void) {
+    lv_area_t old_area;
+    lv_area_t new_area;
+
+    if (rendered.bird_y != game.bird_y || flappy_physics_bird_angle(&rendered) != flappy_physics_bird_angle(&game)) {
+        bird_draw_area(&rendered, &old_area);
+        bird_draw_area(&game, &new_area);
+        invalidate_moved(&old_area, &new_area);
+    }
+
+    for (int i = 0; i < MAX_PIPE_SETS; i++) {
+        if (rendered.pipes[i].x == game.pipes[i].x && rendered.pipes[i].gap_center_y == game.pipes[i].gap_center_y) {
+            continue;
+        }
+
+        flappy_rect_t rect;
+        flappy_physics_pipe_rect(&rendered, i, &rect);
+        rect_to_area(&rect, &old_area);
+        flappy_physics_pipe_rect(&game, i, &rect);
+        rect_to_area(&rect, &new_area);
+        invalidate_moved(&old_area, &new_area);
+    }
+
+    if (rendered.score != game.score) {
+        lv_label_set_text_fmt(score_label, "Score: %d", game.score);
+    }
+
+    rendered = game;
+}
+
+static void flappy_bird_sprite_draw_cb(lv_event_t *e) {
+    lv_obj_t *obj = lv_event_get_target(e);
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    lv_area_t area;
+    lv_area_t clipped;
+
+    lv_draw_rect_dsc_t pipe_dsc;
+    lv_draw_rect_dsc_init(&pipe_dsc);
+    pipe_dsc.bg_color = lv_color_hex(0x00FF00);
+    pipe_dsc.bg_opa = LV_OPA_COVER;
+
+    for (int i = 0; i < MAX_PIPE_SETS; i++) {
+        flappy_rect_t rect;
+        flappy_physics_pipe_rect(&rendered, i, &rect);
+        rect_to_area(&rect, &area);
+        lv_area_move(&area, obj->coords.x1, obj->coords.y1);
+
+        if (_lv_area_intersect(&clipped, &area, draw_ctx->clip_area)) {
+            lv_draw_rect(draw_ctx, &pipe_dsc, &area);
+        }
+    }
+
+    // The sprite is drawn at its native size and clipped to the tilted bird box
+    lv_area_t bird_clip;
+    bird_draw_area(&rendered, &bird_clip);
+    lv_area_move(&bird_clip, obj->coords.x1, obj->coords.y1);
+
+    if (_lv_area_intersect(&clipped, &bird_clip, draw_ctx->clip_area)) {
+        flappy_rect_t rect;
+        flappy_physics_bird_rect(&rendered, &rect);
+
+        area.x1 = obj->coords.x1 + rect.x1;
+        area.y1 = obj->coords.y1 + rect.y1;
+        area.x2 = area.x1 + bird_img->header.w - 1;
+        area.y2 = area.y1 + bird_img->header.h - 1;
+
+        lv_draw_img_dsc_t img_dsc;
+        lv_draw_img_dsc_init(&img_dsc);
+        img_dsc.angle = flappy_physics_bird_angle(&rendered);
+        img_dsc.pivot.x = settings.bird_size / 2;
+        img_dsc.pivot.y = settings.bird_size / 2;
+
+        const lv_area_t *clip_area_ori = draw_ctx->clip_area;
+        draw_ctx->clip_area = &clipped;
+        lv_draw_img(draw_ctx, &img_dsc, &area, bird_img);
+        draw_ctx->clip_area = clip_area_ori;
+    }
+}
+
 // Function to create the Flappy Bird view
 void flappy_bird_view_create(void) {
     if (flappy_bird_view.root != NULL) {
@@ -265,64 +374,56 @@ void flappy_bird_view_create(void) {
     int screen_height = LV_VER_RES;
     set_game_settings(screen_height);
 
-    // Initialize variables based on the screen dimensions
-    pipe_gap = (int)(screen_height * settings.pipe_gap_ratio);
-    pipe_min_gap_y = (int)(screen_height * 0.05f);    // 5% of screen height
-    pipe_max_gap_y = screen_height - pipe_gap - settings.ground_height;
-    bird_y_position = screen_height <= 128 ? 3 : screen_height / 2;
+    // Initialize the simulation based on the screen dimensions
+    physics_config.screen_width = LV_HOR_RES;
+    physics_config.screen_height = screen_height;
+    physics_config.step_ms = PHYSICS_STEP_MS;
+    physics_config.pipe_speed = settings.pipe_speed;
+    physics_config.pipe_width = settings.pipe_width;
+    physics_config.gravity = settings.gravity;
+    physics_config.flap_strength = settings.flap_strength;
+    physics_config.pipe_gap = (int)(screen_height * settings.pipe_gap_ratio);
+    physics_config.pipe_min_gap_y = (int)(screen_height * 0.05f);    // 5% of screen height
+    physics_config.pipe_max_gap_y = screen_height - physics_config.pipe_gap - settings.ground_height;
+    physics_config.bird_x = LV_HOR_RES / 4;
+    physics_config.bird_size = settings.bird_size;
+    physics_config.ground_height = settings.ground_height;
+    physics_config.buffer_top = settings.buffer_top;
+    physics_config.buffer_bottom = settings.buffer_bottom;
+    physics_config.collision_padding = (int)(screen_height * 0.02f); // 2% of screen height
+
+    flappy_physics_reset(&game, &physics_config, (uint32_t)rand());
+    rendered = game;
+    is_game_over = false;
 
     // Create root object
     flappy_bird_view.root = lv_obj_create(lv_scr_act());
     lv_obj_set_size(flappy_bird_view.root, LV_HOR_RES, screen_height);
     lv_obj_set_style_bg_color(flappy_bird_view.root, lv_color_black(), 0);
+    lv_obj_set_style_pad_all(flappy_bird_view.root, 0, 0);
+    lv_obj_set_style_border_width(flappy_bird_view.root, 0, 0);
     lv_obj_clear_flag(flappy_bird_view.root, LV_OBJ_FLAG_SCROLLABLE);
 
-    // Draw background
+    // Draw background, these objects never move so they are only redrawn under dirty areas
     draw_halloween_night_sky(flappy_bird_view.root, 
                              (screen_height <= 135) ? lv_color_hex(0x0D0D40) : 
                              lv_color_hex(0x87CEEB), 
                              (screen_height <= 135) ? lv_color_hex(0x0A0A30) : 
                              lv_color_hex(0xFFA500));
 
-    // Create canvas for pipes
-    flappy_bird_canvas = lv_canvas_create(flappy_bird_view.root);
-    lv_obj_set_size(flappy_bird_canvas, LV_HOR_RES, screen_height);
-    lv_obj_set_scrollbar_mode(flappy_bird_canvas, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_clear_flag(flappy_bird_canvas, LV_OBJ_FLAG_SCROLLABLE);
-
-    // Create bird
-    bird = lv_img_create(flappy_bird_view.root);
+    bird_img = (rand() % 2 == 0) ? &ghost : &yappy;
 
-    bool use_ghost_image = rand() % 2 == 0;
-
-    if (use_ghost_image) {
-        lv_img_set_src(bird, &ghost);
-    } else {
-        lv_img_set_src(bird, &yappy);
-    }
-
-    lv_obj_set_size(bird, settings.bird_size, settings.bird_size);
-    lv_obj_set_pos(bird, LV_HOR_RES / 4, bird_y_position);
-    lv_obj_clear_flag(bird, LV_OBJ_FLAG_SCROLLABLE);
-
-    // Create pipe sets
-    for (int i = 0; i < MAX_PIPE_SETS; i++) {
-        // Initialize gap center position
-        pipes[i].gap_center_y = rand() % (pipe_max_gap_y - pipe_min_gap_y + 1) + pipe_min_gap_y;
-
-        // Create pipe
-        pipes[i].pipe = lv_obj_create(flappy_bird_canvas);
-        lv_obj_set_size(pipes[i].pipe, settings.pipe_width, screen_height - pipes[i].gap_center_y - settings.ground_height);
-        lv_obj_set_style_bg_color(pipes[i].pipe, lv_color_hex(0x00FF00), 0);
-        lv_obj_set_style_radius(pipes[i].pipe, 0, 0); // Ensure sharp edges
-        lv_obj_set_pos(pipes[i].pipe, LV_HOR_RES + i * (LV_HOR_RES / MAX_PIPE_SETS), pipes[i].gap_center_y + pipe_gap);
-        lv_obj_set_scrollbar_mode(pipes[i].pipe, LV_SCROLLBAR_MODE_OFF);
-        lv_obj_clear_flag(pipes[i].pipe, LV_OBJ_FLAG_SCROLLABLE);
-    }
+    // Sprite layer for the bird and pipes
+    flappy_bird_canvas = lv_obj_create(flappy_bird_view.root);
+    lv_obj_remove_style_all(flappy_bird_canvas);
+    lv_obj_set_size(flappy_bird_canvas, LV_HOR_RES, screen_height);
+    lv_obj_set_pos(flappy_bird_canvas, 0, 0);
+    lv_obj_clear_flag(flappy_bird_canvas, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(flappy_bird_canvas, flappy_bird_sprite_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
 
     // Create score label
     score_label = lv_label_create(flappy_bird_view.root);
-    lv_label_set_text_fmt(score_label, "Score: %d", score);
+    lv_label_set_text_fmt(score_label, "Score: %d", game.score);
     lv_obj_align(score_label, LV_ALIGN_TOP_LEFT, 10, 10);
     lv_obj_set_style_text_color(score_label, lv_color_white(), 0);
     lv_obj_set_style_text_font(score_label, settings.score_font, 0);
@@ -332,16 +433,15 @@ void flappy_bird_view_create(void) {
     display_manager_add_status_bar(settings.pipe_speed > 3 ? "Flappy Ghost" : "Flap");
 
     // Create game loop timer
-    game_loop_timer = lv_timer_create(flappy_bird_game_loop, GAME_LOOP_INTERVAL_MS, NULL);
+    last_frame_us = esp_timer_get_time();
+    step_accumulator_us = 0;
+    game_loop_timer = lv_timer_create(flappy_bird_game_loop, RENDER_INTERVAL_MS, NULL);
 }
 
 // Function to destroy the Flappy Bird view
 void flappy_bird_view_destroy(void) {
     if (flappy_bird_view.root != NULL) {
         is_game_over = false;
-        bird_y_position = LV_VER_RES / 2;
-        bird_velocity = 0;
-        score = 0;
 
         if (game_loop_timer != NULL) {
             lv_timer_del(game_loop_timer);
@@ -351,10 +451,6 @@ void flappy_bird_view_destroy(void) {
         lv_obj_del(flappy_bird_view.root);
         flappy_bird_view.root = NULL;
         flappy_bird_canvas = NULL;
-        bird = NULL;
-        for (int i = 0; i < MAX_PIPE_SETS; i++) {
-            pipes[i].pipe = NULL;
-        }
         score_label = NULL;
     }
 }
@@ -365,8 +461,6 @@ void flappy_bird_view_hardwareinput_callback(InputEvent *event) {
         lv_obj_t *game_over_container = lv_obj_get_child(flappy_bird_view.root, -1);
         if (!game_over_container) return;
 
-        lv_obj_t *game_over_label = lv_obj_get_child(game_over_container, -1);
-
         if (event->type == INPUT_TYPE_TOUCH) {
             int touch_x = event->data.touch_data.point.x;
             int touch_y = event->data.touch_data.point.y;
@@ -395,10 +489,10 @@ void flappy_bird_view_hardwareinput_callback(InputEvent *event) {
     if (event->type == INPUT_TYPE_JOYSTICK) {
         int button = event->data.joystick_index;
         if (button == 1) {
-            bird_velocity = settings.flap_strength;
+            flappy_physics_flap(&game);
         }
     } else if (event->type == INPUT_TYPE_TOUCH) {
-        bird_velocity = settings.flap_strength;
+        flappy_physics_flap(&game);
     }
 }
 
@@ -411,78 +505,40 @@ void flappy_bird_view_get_hardwareinput_callback(void **callback) {
 
 // Game Loop Function
 void flappy_bird_game_loop(lv_timer_t *timer) {
+    int64_t now = esp_timer_get_time();
+    step_accumulator_us += now - last_frame_us;
+    last_frame_us = now;
+
     if (is_game_over) {
+        step_accumulator_us = 0;
         return;
     }
 
-    // Update bird's physics
-    bird_velocity += settings.gravity;
-    bird_y_position += (int)bird_velocity;
-    lv_obj_set_pos(bird, LV_HOR_RES / 4, bird_y_position);
+    // Advance the simulation by whole fixed steps for the real time that passed
+    const int64_t step_us = (int64_t)physics_config.step_ms * 1000;
+    int steps = 0;
+    uint32_t events = 0;
 
-    // Update bird's angle based on velocity
-    int angle = (int)(bird_velocity * 5); 
-    if (angle > 45) angle = 45;
-    if (angle < -45) angle = -45;
-    lv_img_set_angle(bird, angle * 10);
+    while (step_accumulator_us >= step_us && steps < MAX_STEPS_PER_FRAME) {
+        events |= flappy_physics_step(&game);
+        step_accumulator_us -= step_us;
+        steps++;
 
-    // Check collision with ground or ceiling
-    if ((bird_y_position + lv_obj_get_height(bird)) >= (LV_VER_RES - settings.ground_height + settings.buffer_bottom) || 
-        (bird_y_position <= -settings.buffer_top)) {
-        flappy_bird_game_over();
+        if (game.game_over) break;
     }
 
-    // Update each pipe set
-    for (int i = 0; i < MAX_PIPE_SETS; i++) {
-        // Move pipe left
-        int pipe_x = lv_obj_get_x(pipes[i].pipe);
-        pipe_x -= settings.pipe_speed;
-
-        if (pipe_x < -settings.pipe_width) {
-            pipe_x = LV_HOR_RES;
-
-            // Update gap center position
-            pipes[i].gap_center_y = rand() % (pipe_max_gap_y - pipe_min_gap_y + 1) + pipe_min_gap_y;
-
-            // Resize and reposition pipe
-            lv_obj_set_size(pipes[i].pipe, settings.pipe_width, LV_VER_RES - pipes[i].gap_center_y - settings.ground_height);
-            lv_obj_set_pos(pipes[i].pipe, pipe_x, pipes[i].gap_center_y + pipe_gap);
-
-            // Update score
-            score++;
-            lv_label_set_text_fmt(score_label, "Score: %d", score);
-        } else {
-            // Update pipe position
-            lv_obj_set_x(pipes[i].pipe, pipe_x);
-        }
-
-        // Check collision with pipe
-        if (flappy_bird_check_collision(bird, pipes[i].pipe)) {
-            flappy_bird_game_over();
-        }
+    // Drop time we could not catch up on instead of spiraling
+    if (steps == MAX_STEPS_PER_FRAME && step_accumulator_us >= step_us) {
+        step_accumulator_us = 0;
     }
-}
-
-// Collision Detection Function
-int flappy_bird_check_collision(lv_obj_t *bird, lv_obj_t *pipe) {
-    float padding_ratio = 0.02f; // 2% of screen height
-    int padding = (int)(LV_VER_RES * padding_ratio);
-
-    // Get bird's absolute coordinates
-    lv_area_t bird_area;
-    lv_obj_get_coords(bird, &bird_area);
-
-    // Get pipe's absolute coordinates
-    lv_area_t pipe_area;
-    lv_obj_get_coords(pipe, &pipe_area);
 
-    // Check for overlap with padding
-    bool overlap_x = (bird_area.x2 + padding) >= pipe_area.x1 && (bird_area.x1 - padding) <= pipe_area.x2;
-    bool overlap_y = (bird_area.y2 + padding) >= pipe_area.y1 && (bird_area.y1 - padding) <= pipe_area.y2;
-
-    bool collision = overlap_x && overlap_y;
+    if (steps > 0) {
+        flappy_bird_invalidate_changes();
+    }
 
-    return collision ? 1 : 0;
+    if (events & FLAPPY_EVENT_GAME_OVER) {
+        flappy_bird_game_over();
+    }
 }
 
 // Game Over Handling Function
@@ -522,32 +578,17 @@ void flappy_bird_game_over() {
     internet_connected = check_internet_connectivity();
 
     if (internet_connected) {
-        submit_score_to_api(settings_get_flappy_ghost_name(&G_Settings), score);
+        submit_score_to_api(settings_get_flappy_ghost_name(&G_Settings), game.score);
     }
 }
 
 // Restart Game Function
 void flappy_bird_restart() {
     is_game_over = false;
-    bird_y_position = (LV_VER_RES <= 128) ? 3 : (LV_VER_RES / 2);
-    bird_velocity = 0;
-    score = 0;
-    lv_label_set_text_fmt(score_label, "Score: %d", score);
 
-    // Reset bird position
-    lv_obj_set_pos(bird, LV_HOR_RES / 4, bird_y_position);
-
-    // Reset pipe positions and sizes
-    for (int i = 0; i < MAX_PIPE_SETS; i++) {
-        // Reposition pipe off-screen
-        lv_obj_set_pos(pipes[i].pipe, LV_HOR_RES + i * (LV_HOR_RES / MAX_PIPE_SETS), pipes[i].gap_center_y + pipe_gap);
-
-        // Update gap center position
-        pipes[i].gap_center_y = rand() % (pipe_max_gap_y - pipe_min_gap_y + 1) + pipe_min_gap_y;
-
-        // Reset pipe size based on new gap center
-        lv_obj_set_size(pipes[i].pipe, settings.pipe_width, LV_VER_RES - pipes[i].gap_center_y - settings.ground_height);
-    }
+    flappy_physics_reset(&game, &physics_config, (uint32_t)rand());
+    rendered = game;
+    lv_label_set_text_fmt(score_label, "Score: %d", game.score);
 
     // Remove the game over overlay if it exists
     lv_obj_t *game_over_container = lv_obj_get_child(flappy_bird_view.root, -1);
@@ -555,8 +596,13 @@ void flappy_bird_restart() {
         lv_obj_del(game_over_container);
     }
 
+    lv_obj_invalidate(flappy_bird_canvas);
+
+    last_frame_us = esp_timer_get_time();
+    step_accumulator_us = 0;
+
     // Restart game loop timer if necessary
     if (game_loop_timer == NULL) {
-        game_loop_timer = lv_timer_create(flappy_bird_game_loop, GAME_LOOP_INTERVAL_MS, NULL);
+        game_loop_timer = lv_timer_create(flappy_bird_game_loop, RENDER_INTERVAL_MS, NULL);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#include "managers/views/flappy_ghost_physics.h"
+
+static uint32_t flappy_rand(flappy_physics_t *game) {
+    // xorshift32, keeps the simulation reproducible for a given seed
+    uint32_t x = game->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    game->rng = x;
+    return x;
+}
+
+static int flappy_random_gap(flappy_physics_t *game) {
+    const flappy_physics_config_t *cfg = game->config;
+    int range = cfg->pipe_max_gap_y - cfg->pipe_min_gap_y + 1;
+    if (range < 1) range = 1;
+    return (int)(flappy_rand(game) % (uint32_t)range) + cfg->pipe_min_gap_y;
+}
+
+static bool flappy_rects_overlap(const flappy_rect_t *a, const flappy_rect_t *b, int padding) {
+    bool overlap_x = (a->x2 + padding) >= b->x1 && (a->x1 - padding) <= b->x2;
+    bool overlap_y = (a->y2 + padding) >= b->y1 && (a->y1 - padding) <= b->y2;
+    return overlap_x && overlap_y;
+}
+
+void flappy_physics_reset(flappy_physics_t *game, const flappy_physics_config_t *config, uint32_t seed) {
+    game->config = config;
+    game->bird_y = config->screen_height <= 128 ? 3 : config->screen_height / 2;
+    game->bird_velocity = 0;
+    game->score = 0;
+    game->game_over = false;
+    game->rng = seed ? seed : 1;
+    game->steps = 0;
+
+    for (int i = 0; i < FLAPPY_MAX_PIPES; i++) {
+        game->pipes[i].x = config->screen_width + i * (config->screen_width / FLAPPY_MAX_PIPES);
+        game->pipes[i].gap_center_y = flappy_random_gap(game);
+    }
+}
+
+void flappy_physics_flap(flappy_physics_t *game) {
+    if (!game->game_over) {
+        game->bird_velocity = game->config->flap_strength;
+    }
+}
+
+uint32_t flappy_physics_step(flappy_physics_t *game) {
+    const flappy_physics_config_t *cfg = game->config;
+    uint32_t events = 0;
+
+    if (game->game_over) {
+        return 0;
+    }
+
+    game->steps++;
+
+    game->bird_velocity += cfg->gravity;
+    game->bird_y += (int)game->bird_velocity;
+
+    // Ground and ceiling
+    if ((game->bird_y + cfg->bird_size) >= (cfg->screen_height - cfg->ground_height + cfg->buffer_bottom) ||
+        (game->bird_y <= -cfg->buffer_top)) {
+        game->game_over = true;
+        return FLAPPY_EVENT_GAME_OVER;
+    }
+
+    flappy_rect_t bird;
+    flappy_physics_bird_rect(game, &bird);
+
+    for (int i = 0; i < FLAPPY_MAX_PIPES; i++) {
+        flappy_pipe_t *pipe = &game->pipes[i];
+        pipe->x -= cfg->pipe_speed;
+
+        if (pipe->x < -cfg->pipe_width) {
+            pipe->x = cfg->screen_width;
+            pipe->gap_center_y = flappy_random_gap(game);
+            game->score++;
+            events |= FLAPPY_EVENT_SCORED;
+        }
+
+        flappy_rect_t pipe_rect;
+        flappy_physics_pipe_rect(game, i, &pipe_rect);
+        if (flappy_rects_overlap(&bird, &pipe_rect, cfg->collision_padding)) {
+            game->game_over = true;
+            events |= FLAPPY_EVENT_GAME_OVER;
+            break;
+        }
+    }
+
+    return events;
+}
+
+int flappy_physics_bird_angle(const flappy_physics_t *game) {
+    int angle = (int)(game->bird_velocity * 5);
+    if (angle > 45) angle = 45;
+    if (angle < -45) angle = -45;
+    return angle * 10;
+}
+
+void flappy_physics_bird_rect(const flappy_physics_t *game, flappy_rect_t *rect) {
+    const flappy_physics_config_t *cfg = game->config;
+    rect->x1 = cfg->bird_x;
+    rect->y1 = game->bird_y;
+    rect->x2 = cfg->bird_x + cfg->bird_size - 1;
+    rect->y2 = game->bird_y + cfg->bird_size - 1;
+}
+
+void flappy_physics_pipe_rect(const flappy_physics_t *game, int index, flappy_rect_t *rect) {
+    const flappy_physics_config_t *cfg = game->config;
+    const flappy_pipe_t *pipe = &game->pipes[index];
+    rect->x1 = pipe->x;
+    rect->y1 = pipe->gap_center_y + cfg->pipe_gap;
+    rect->x2 = pipe->x + cfg->pipe_width - 1;
+    rect->y2 = rect->y1 + (cfg->screen_height - pipe->gap_center_y - cfg->ground_height) - 1;
+}
@@ -5,7 +5,7 @@
 #include <stdio.h>
 
 
-lv_obj_t *menu_container;
+static lv_obj_t *menu_container;
 static int selected_item_index = 0;
 
 typedef struct {
@@ -234,6 +234,7 @@ void main_menu_destroy(void) {
         lv_obj_clean(menu_container);
         lv_obj_del(menu_container);
         menu_container = NULL;
+        main_menu_view.root = NULL;
     }
 }
 
@@ -251,4 +252,5 @@ View main_menu_view = {
     .input_callback = menu_item_event_handler,
     .name = "Main Menu",
     .get_hardwareinput_callback = get_main_menu_callback,
+    .cacheable = true,
 };
\ No newline at end of file
@@ -1,33 +1,56 @@
 #include "managers/views/music_visualizer.h"
 #include "managers/views/main_menu_screen.h"
 #include <freertos/FreeRTOS.h>
-#include <freertos/queue.h>
 #include <lvgl.h>
-#include <math.h> 
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "esp_timer.h"
 
 #define NUM_PARTICLES 5
-#define ANIMATION_INTERVAL_MS 5  // Approximately 30 FPS
+#define ANIMATION_INTERVAL_MS (1000 / VISUALIZER_TARGET_FPS)
+#define BAR_DECAY_DIVISOR 4
+#define STATUS_BAR_HEIGHT 20
 
-lv_timer_t *animation_timer = NULL;
+static lv_timer_t *animation_timer = NULL;
 
 typedef struct {
-    lv_obj_t *obj;
     int x;  // Current x position
     int y;  // Current y position
     int velocity;  // Horizontal velocity
 } Particle;
 
 typedef struct {
-    int bars[NUM_BARS];  // Amplitude data for each bar
-} AmplitudeData;
-
-Particle particles[NUM_PARTICLES];
-MusicVisualizerView view;
-lv_obj_t *root;
-QueueHandle_t amplitudeQueue;
-
-int target_amplitudes[NUM_BARS] = {0};
-int current_amplitudes[NUM_BARS] = {0};
+    uint8_t bars[NUM_BARS];
+    char track_name[VISUALIZER_NAME_LEN + 1];
+    char artist_name[VISUALIZER_NAME_LEN + 1];
+} VisualizerFrame;
+
+// Triple buffer between the UDP task (producer) and the LVGL timer (consumer).
+// Each side owns one slot, the third is swapped through frame_middle so neither side ever blocks.
+#define FRAME_SLOT_MASK 0x3
+#define FRAME_FRESH     0x4
+
+static VisualizerFrame frame_slots[3];
+static atomic_int frame_middle = 1;
+static int frame_back = 0;   // Producer only
+static int frame_front = 2;  // Consumer only
+
+static Particle particles[NUM_PARTICLES];
+static MusicVisualizerView view;
+static lv_obj_t *root = NULL;
+
+static int target_amplitudes[NUM_BARS] = {0};
+static int current_amplitudes[NUM_BARS] = {0};
+
+static int bar_x[NUM_BARS];
+static int bar_width;
+static int bar_bottom;
+static int bar_max_height;
+
+static uint32_t stat_frames = 0;
+static uint32_t stat_draws = 0;
+static uint64_t stat_draw_us = 0;
+static uint64_t stat_invalidated_px = 0;
 
 void handle_hardware_input_music_callback(InputEvent *event) {
     if (event->type == INPUT_TYPE_TOUCH) {
@@ -55,10 +78,71 @@ View music_visualizer_view = {
 
 void animation_timer_callback(lv_timer_t *timer);
 
+static int bar_display_height(int amplitude) {
+    if (amplitude < 1) return 1;
+    if (amplitude > bar_max_height) return bar_max_height;
+    return amplitude;
+}
+
+static void bar_get_area(int index, int height, lv_area_t *area) {
+    lv_area_t *coords = &view.bars_area->coords;
+    area->x1 = coords->x1 + bar_x[index];
+    area->x2 = area->x1 + bar_width - 1;
+    area->y2 = coords->y1 + bar_bottom;
+    area->y1 = area->y2 - height + 1;
+}
+
+static void particle_get_area(const Particle *particle, lv_area_t *area) {
+    lv_area_t *coords = &view.bars_area->coords;
+    area->x1 = coords->x1 + particle->x;
+    area->y1 = coords->y1 + particle->y;
+    area->x2 = area->x1;
+    area->y2 = area->y1;
+}
+
+static void invalidate_area(const lv_area_t *area) {
+    lv_obj_invalidate_area(view.bars_area, area);
+    stat_invalidated_px += lv_area_get_size(area);
+}
+
+static void bars_area_draw_cb(lv_event_t *e) {
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    int64_t start = esp_timer_get_time();
+
+    lv_draw_rect_dsc_t bar_dsc;
+    lv_draw_rect_dsc_init(&bar_dsc);
+    bar_dsc.bg_color = lv_color_make(147, 112, 219);
+    bar_dsc.bg_opa = LV_OPA_COVER;
+
+    lv_area_t area;
+    lv_area_t clipped;
+    for (int i = 0; i < NUM_BARS; i++) {
+        bar_get_area(i, bar_display_height(current_amplitudes[i]), &area);
+        if (_lv_area_intersect(&clipped, &area, draw_ctx->clip_area)) {
+            lv_draw_rect(draw_ctx, &bar_dsc, &area);
+        }
+    }
+
+    lv_draw_rect_dsc_t particle_dsc;
+    lv_draw_rect_dsc_init(&particle_dsc);
+    particle_dsc.bg_color = lv_color_white();
+    particle_dsc.bg_opa = LV_OPA_COVER;
+
+    for (int i = 0; i < NUM_PARTICLES; i++) {
+        particle_get_area(&particles[i], &area);
+        if (_lv_area_intersect(&clipped, &area, draw_ctx->clip_area)) {
+            lv_draw_rect(draw_ctx, &particle_dsc, &area);
+        }
+    }
+
+    stat_draws++;
+    stat_draw_us += esp_timer_get_time() - start;
+}
+
 void music_visualizer_view_create() {
     display_manager_fill_screen(lv_color_black());
 
-   root = lv_obj_create(lv_scr_act());
+    root = lv_obj_create(lv_scr_act());
     music_visualizer_view.root = root;
     lv_obj_set_style_bg_color(music_visualizer_view.root, lv_color_black(), LV_PART_MAIN);
     lv_obj_set_size(music_visualizer_view.root, LV_HOR_RES, LV_VER_RES);
@@ -85,10 +169,26 @@ void music_visualizer_view_create() {
 
     int label_x_offset = LV_HOR_RES / 12;
     int label_y_offset = LV_VER_RES / 8;
-    int bar_width = LV_HOR_RES / (NUM_BARS * 2);
     int bar_spacing = LV_HOR_RES / (NUM_BARS + 2);
     int bar_y_offset = LV_VER_RES / 4;
 
+    bar_width = LV_HOR_RES / (NUM_BARS * 2);
+    bar_bottom = LV_VER_RES - 1 - bar_y_offset;
+    bar_max_height = bar_bottom - STATUS_BAR_HEIGHT;
+    for (int i = 0; i < NUM_BARS; i++) {
+        bar_x[i] = label_x_offset + (bar_spacing * i);
+        target_amplitudes[i] = 0;
+        current_amplitudes[i] = 0;
+    }
+
+    // Bars and particles are drawn by one object so a frame only invalidates the strips that changed
+    view.bars_area = lv_obj_create(music_visualizer_view.root);
+    lv_obj_remove_style_all(view.bars_area);
+    lv_obj_set_size(view.bars_area, LV_HOR_RES, LV_VER_RES);
+    lv_obj_set_pos(view.bars_area, 0, 0);
+    lv_obj_clear_flag(view.bars_area, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(view.bars_area, bars_area_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+
     view.track_label = lv_label_create(music_visualizer_view.root);
     lv_label_set_text(view.track_label, "Ghost ESP");
     lv_obj_set_style_text_font(view.track_label, track_label_font, LV_PART_MAIN);
@@ -101,73 +201,98 @@ void music_visualizer_view_create() {
     lv_obj_set_style_text_color(view.artist_label, lv_color_white(), LV_PART_MAIN);
     lv_obj_align_to(view.artist_label, view.track_label, LV_ALIGN_OUT_BOTTOM_LEFT, 0, lv_font_get_line_height(track_label_font) / 4);
 
-    for (int i = 0; i < NUM_BARS; i++) {
-        view.bars[i] = lv_obj_create(music_visualizer_view.root);
-        lv_obj_set_size(view.bars[i], bar_width, 1);
-        lv_obj_align(view.bars[i], LV_ALIGN_BOTTOM_LEFT, label_x_offset + (bar_spacing * i), -bar_y_offset);
-
-
-        lv_obj_set_style_radius(view.bars[i], 0, LV_PART_MAIN); 
-        lv_obj_set_style_bg_opa(view.bars[i], LV_OPA_COVER, LV_PART_MAIN); 
-        lv_obj_set_style_bg_color(view.bars[i], lv_color_make(147, 112, 219), LV_PART_MAIN);
-        lv_obj_set_style_bg_grad_color(view.bars[i], lv_color_make(147, 112, 219), LV_PART_MAIN);
-        lv_obj_set_style_bg_grad_dir(view.bars[i], LV_GRAD_DIR_VER, LV_PART_MAIN);
-    }
-
     for (int i = 0; i < NUM_PARTICLES; i++) {
-        particles[i].obj = lv_obj_create(music_visualizer_view.root);
-        lv_obj_set_size(particles[i].obj, 1, 1);
-        lv_obj_set_style_radius(particles[i].obj, LV_RADIUS_CIRCLE, LV_PART_MAIN);
-        lv_obj_set_style_bg_color(particles[i].obj, lv_color_white(), LV_PART_MAIN);
         particles[i].x = 0;
         particles[i].y = rand() % LV_VER_RES;
         particles[i].velocity = 1 + rand() % 3;
-        lv_obj_align(particles[i].obj, LV_ALIGN_TOP_LEFT, particles[i].x, particles[i].y);
     }
 
     display_manager_add_status_bar(LV_VER_RES > 320 ? "Rave Mode" : "Rave");
 
-    amplitudeQueue = xQueueCreate(10, sizeof(AmplitudeData));
+    // Drop any frame published while the view was closed
+    atomic_fetch_and(&frame_middle, FRAME_SLOT_MASK);
+
+    stat_frames = 0;
+    stat_draws = 0;
+    stat_draw_us = 0;
+    stat_invalidated_px = 0;
+
     animation_timer = lv_timer_create(animation_timer_callback, ANIMATION_INTERVAL_MS, NULL);
 }
 
+static void apply_frame(const VisualizerFrame *frame) {
+    // Amplitudes are 0 to 255 on the wire, full scale is the tallest bar that fits
+    for (int i = 0; i < NUM_BARS; i++) {
+        target_amplitudes[i] = frame->bars[i] * bar_max_height / 255;
+    }
+
+    if (strcmp(lv_label_get_text(view.track_label), frame->track_name) != 0) {
+        lv_label_set_text(view.track_label, frame->track_name);
+    }
+    if (strcmp(lv_label_get_text(view.artist_label), frame->artist_name) != 0) {
+        lv_label_set_text(view.artist_label, frame->artist_name);
+    }
+}
+
 void animation_timer_callback(lv_timer_t *timer) {
-    AmplitudeData amplitudeData;
-    bool dataAvailable = xQueueReceive(amplitudeQueue, &amplitudeData, 0) == pdTRUE;
+    if (atomic_load(&frame_middle) & FRAME_FRESH) {
+        frame_front = atomic_exchange(&frame_middle, frame_front) & FRAME_SLOT_MASK;
+        apply_frame(&frame_slots[frame_front]);
+    }
+
+    lv_area_t area;
 
-    if (dataAvailable) {
-        for (int i = 0; i < NUM_BARS; i++) {
-            lv_obj_set_height(view.bars[i], amplitudeData.bars[i]);
+    for (int i = 0; i < NUM_BARS; i++) {
+        int previous = current_amplitudes[i];
+        int target = target_amplitudes[i];
+
+        // Rise instantly, fall off over a few frames
+        if (target >= previous) {
+            current_amplitudes[i] = target;
+        } else {
+            int step = (previous - target) / BAR_DECAY_DIVISOR;
+            current_amplitudes[i] = previous - (step > 0 ? step : 1);
         }
+
+        int old_height = bar_display_height(previous);
+        int new_height = bar_display_height(current_amplitudes[i]);
+        if (old_height == new_height) continue;
+
+        // Only the strip between the old and new bar tops changes
+        bar_get_area(i, old_height > new_height ? old_height : new_height, &area);
+        area.y2 -= (old_height < new_height ? old_height : new_height);
+        invalidate_area(&area);
     }
 
     for (int i = 0; i < NUM_PARTICLES; i++) {
+        particle_get_area(&particles[i], &area);
+        invalidate_area(&area);
+
         particles[i].x += particles[i].velocity;
-        if (particles[i].x > LV_HOR_RES) {
+        if (particles[i].x >= LV_HOR_RES) {
             particles[i].x = 0;
             particles[i].y = rand() % LV_VER_RES;
             particles[i].velocity = 1 + rand() % 3;
         }
-        lv_obj_set_pos(particles[i].obj, particles[i].x, particles[i].y);
+
+        particle_get_area(&particles[i], &area);
+        invalidate_area(&area);
     }
+
+    stat_frames++;
 }
 
 void music_visualizer_view_update(const uint8_t *amplitudes, const char *track_name, const char *artist_name) {
+    // Called from the UDP task, only touches the producer slot and never calls into LVGL
+    VisualizerFrame *frame = &frame_slots[frame_back];
 
-    if (music_visualizer_view.root) {
-        if (strcmp(lv_label_get_text(view.track_label), track_name) != 0) {
-            lv_label_set_text(view.track_label, track_name);
-        }
-        if (strcmp(lv_label_get_text(view.artist_label), artist_name) != 0) {
-            lv_label_set_text(view.artist_label, artist_name);
-        }
+    memcpy(frame->bars, amplitudes, NUM_BARS);
+    strncpy(frame->track_name, track_name, VISUALIZER_NAME_LEN);
+    frame->track_name[VISUALIZER_NAME_LEN] = '\0';
+    strncpy(frame->artist_name, artist_name, VISUALIZER_NAME_LEN);
+    frame->artist_name[VISUALIZER_NAME_LEN] = '\0';
 
-        AmplitudeData amplitudeData;
-        for (int i = 0; i < NUM_BARS; i++) {
-            amplitudeData.bars[i] = amplitudes[i];
-        }
-        xQueueSend(amplitudeQueue, &amplitudeData, portMAX_DELAY);
-    }
+    frame_back = atomic_exchange(&frame_middle, frame_back | FRAME_FRESH) & FRAME_SLOT_MASK;
 }
 
 void music_visualizer_destroy(void) {
@@ -175,15 +300,19 @@ void music_visualizer_destroy(void) {
     if (animation_timer) {
         lv_timer_del(animation_timer);
         animation_timer = NULL;
+
+        if (stat_frames > 0) {
+            printf("Visualizer: %lu frames, %lu draws, avg draw %lu us, avg invalidated %lu px/frame\n",
+                   (unsigned long)stat_frames, (unsigned long)stat_draws,
+                   (unsigned long)(stat_draws ? stat_draw_us / stat_draws : 0),
+                   (unsigned long)(stat_invalidated_px / stat_frames));
+        }
     }
 
     if (root) {
         lv_obj_del(root);
         root = NULL;
         music_visualizer_view.root = NULL;
+        view.bars_area = NULL;
     }
-    if (amplitudeQueue) {
-        vQueueDelete(amplitudeQueue);
-        amplitudeQueue = NULL;
-    }
-}
\ No newline at end of file
+}
@@ -2,6 +2,8 @@
 #include "managers/views/terminal_screen.h"
 #include "managers/views/main_menu_screen.h"
 #include "managers/views/error_popup.h"
+#include "managers/views/device_list_screen.h"
+#include "managers/views/channel_activity_screen.h"
 #include "managers/wifi_manager.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -10,8 +12,9 @@
 #include <stdio.h>
 
 EOptionsMenuType SelectedMenuType = OT_Wifi;
+static EOptionsMenuType CreatedMenuType = OT_Wifi; // Menu type the current object tree was built for
 int selected_item_index = 0;
-lv_obj_t *root = NULL;
+static lv_obj_t *root = NULL;
 lv_obj_t *menu_container = NULL;
 int num_items = 0;
 
@@ -34,6 +37,9 @@ const char* options_menu_type_to_string(EOptionsMenuType menuType) {
 
 static const char *wifi_options[] = {
     "Scan Access Points",
+    "View Access Points",
+    "View Stations",
+    "Channel Activity",
     "Start Deauth Attack",
     "Beacon Spam - Random",
     "Beacon Spam - Rickroll",
@@ -53,6 +59,7 @@ static const char *wifi_options[] = {
 
 static const char *bluetooth_options[] = {
     "Find Flippers",
+    "List BLE Devices",
     "Start AirTag Scanner",
     "Go Back",
     NULL
@@ -82,6 +89,7 @@ void options_menu_create() {
 
     display_manager_fill_screen(lv_color_black());
 
+    CreatedMenuType = SelectedMenuType;
 
     root = lv_obj_create(lv_scr_act());
     options_menu_view.root = root;
@@ -229,6 +237,9 @@ void handle_hardware_button_press_options(InputEvent *event) {
             );
             option_event_cb(selected_option);
         }
+    } else if (event->type == INPUT_TYPE_JOYSTICK_LONG_PRESS && event->data.joystick_index == 1) {
+        // Holding select is the same as picking Go Back, which sits at the end of every list
+        display_manager_switch_view(&main_menu_view);
     }
 }
 
@@ -240,6 +251,26 @@ void option_event_cb(const char* Selected_Option) {
         simulateCommand("scanap");
     }
 
+    if (strcmp(Selected_Option, "View Access Points") == 0) {
+        device_list_view_set_kind(DEVICE_KIND_AP);
+        display_manager_switch_view(&device_list_view);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        simulateCommand("scansta");
+    }
+
+    if (strcmp(Selected_Option, "View Stations") == 0) {
+        device_list_view_set_kind(DEVICE_KIND_STATION);
+        display_manager_switch_view(&device_list_view);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        simulateCommand("scansta");
+    }
+
+    if (strcmp(Selected_Option, "Channel Activity") == 0) {
+        display_manager_switch_view(&channel_activity_view);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        simulateCommand("chanstats start");
+    }
+
     if (strcmp(Selected_Option, "Start Deauth Attack") == 0) {
         if (scanned_aps)
         {
@@ -360,6 +391,17 @@ if (strcmp(Selected_Option, "Start AirTag Scanner") == 0) {
     }
     
 
+if (strcmp(Selected_Option, "List BLE Devices") == 0) {
+#ifndef CONFIG_IDF_TARGET_ESP32S2
+        device_list_view_set_kind(DEVICE_KIND_BLE);
+        display_manager_switch_view(&device_list_view);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        simulateCommand("blescan -l");
+#else 
+    error_popup_create("Device Does not Support Bluetooth...");
+#endif
+    }
+
 if (strcmp(Selected_Option, "Find Flippers") == 0) {
 #ifndef CONFIG_IDF_TARGET_ESP32S2
         display_manager_switch_view(&terminal_view);
@@ -410,11 +452,17 @@ void get_options_menu_callback(void **callback) {
     *callback = options_menu_view.input_callback;
 }
 
+bool options_menu_is_cache_valid(void) {
+    return CreatedMenuType == SelectedMenuType;
+}
+
 View options_menu_view = {
     .root = NULL,
     .create = options_menu_create,
     .destroy = options_menu_destroy,
     .input_callback = handle_hardware_button_press_options,
     .name = "Options Screen",
-    .get_hardwareinput_callback = get_options_menu_callback
+    .get_hardwareinput_callback = get_options_menu_callback,
+    .cacheable = true,
+    .is_cache_valid = options_menu_is_cache_valid
 };
\ No newline at end of file
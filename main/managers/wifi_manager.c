@@ -4,6 +4,7 @@
 #include "managers/rgb_manager.h"
 #include "managers/ap_manager.h"
 #include "managers/settings_manager.h"
+#include "core/device_table.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
 #include "esp_wifi.h"
@@ -23,7 +24,9 @@
 #include <esp_http_server.h>
 #include <core/dns_server.h>
 #include "esp_crt_bundle.h"
-#ifdef WITH_SCREEN
+#include "core/visualizer_stream.h"
+#include "lwip/sockets.h"
+#ifdef CONFIG_WITH_SCREEN
 #include "managers/views/music_visualizer.h"
 #endif
 
@@ -39,6 +42,11 @@
 
 uint16_t ap_count;
 wifi_ap_record_t* scanned_aps;
+channel_stats_t wifi_channel_stats;
+static wifi_promiscuous_cb_t_t monitor_callback = NULL;
+static esp_timer_handle_t hop_timer = NULL;
+static uint8_t hop_channel = 1;
+static int64_t hop_entered_us = 0;
 const char *TAG = "WiFiManager";
 char* PORTALURL = "";
 char* DOMAIN = "";
@@ -316,23 +324,60 @@ ECompany match_bssid_to_company(const uint8_t *bssid) {
     return COMPANY_UNKNOWN;
 }
 
+static void update_ap_from_beacon(const wifi_promiscuous_pkt_t *packet) {
+    const uint8_t *frame = packet->payload;
+    uint16_t len = packet->rx_ctrl.sig_len;
+
+    // Header, fixed fields, then the SSID element is always first
+    if (len < 38 || frame[0] != 0x80 || frame[36] != 0 || frame[37] > 32 || 38 + frame[37] > len) {
+        return;
+    }
+
+    char ssid[33];
+    memcpy(ssid, &frame[38], frame[37]);
+    ssid[frame[37]] = '\0';
+    device_table_upsert(&device_table_aps, &frame[16], packet->rx_ctrl.rssi, packet->rx_ctrl.channel, ssid,
+                        NULL, device_table_now_ms());
+}
+
 void wifi_stations_sniffer_callback(void *buf, wifi_promiscuous_pkt_type_t type) {
+    const wifi_promiscuous_pkt_t *packet = (wifi_promiscuous_pkt_t *)buf;
+
+    if (type == WIFI_PKT_MGMT) {
+        update_ap_from_beacon(packet);
+        return;
+    }
     if (type != WIFI_PKT_DATA) {
         return;
     }
 
-    const wifi_promiscuous_pkt_t *packet = (wifi_promiscuous_pkt_t *)buf;
     const wifi_ieee80211_packet_t *ipkt = (wifi_ieee80211_packet_t *)packet->payload;
     const wifi_ieee80211_hdr_t *hdr = &ipkt->hdr;
 
-    
-    const uint8_t *src_mac = hdr->addr2;  // Station MAC
-    const uint8_t *dest_mac = hdr->addr1; // AP BSSID
+    // The DS bits say which side the AP is on. Frames with neither (ad hoc) or both (bridges
+    // between APs) have no station and AP pair.
+    const uint8_t *station_mac;
+    const uint8_t *bssid;
+    if (hdr->frame_ctrl.to_ds && !hdr->frame_ctrl.from_ds) {
+        station_mac = hdr->addr2;
+        bssid = hdr->addr1;
+    } else if (hdr->frame_ctrl.from_ds && !hdr->frame_ctrl.to_ds) {
+        station_mac = hdr->addr1;
+        bssid = hdr->addr2;
+    } else {
+        return;
+    }
 
+    // Broadcast and multicast receivers are not stations
+    if (station_mac[0] & 0x01) {
+        return;
+    }
 
-    if (!station_exists(src_mac, dest_mac)) {
-        add_station_ap_pair(src_mac, dest_mac);
+    if (!station_exists(station_mac, bssid)) {
+        add_station_ap_pair(station_mac, bssid);
     }
+    device_table_upsert(&device_table_stations, station_mac, packet->rx_ctrl.rssi, packet->rx_ctrl.channel, NULL,
+                        bssid, device_table_now_ms());
 }
 
 esp_err_t stream_data_to_client(httpd_req_t *req, const char *url, const char *content_type) {
@@ -840,6 +885,20 @@ void wifi_manager_stop_evil_portal()
 }
 
 
+static void monitor_rx_callback(void *buf, wifi_promiscuous_pkt_type_t type) {
+    const wifi_promiscuous_pkt_t *packet = (wifi_promiscuous_pkt_t *)buf;
+    channel_frame_type_t frame_type = CHANNEL_FRAME_MISC;
+    if (type != WIFI_PKT_MISC && packet->rx_ctrl.sig_len > 0) {
+        frame_type = channel_stats_frame_type(packet->payload[0]);
+    }
+    channel_stats_record(&wifi_channel_stats, packet->rx_ctrl.channel, frame_type, packet->rx_ctrl.rssi);
+
+    wifi_promiscuous_cb_t_t callback = monitor_callback;
+    if (callback) {
+        callback(buf, type);
+    }
+}
+
 void wifi_manager_start_monitor_mode(wifi_promiscuous_cb_t_t callback) {
     
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_NULL));
@@ -847,14 +906,54 @@ void wifi_manager_start_monitor_mode(wifi_promiscuous_cb_t_t callback) {
  
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(true));
 
-    
-    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_rx_cb(callback));
+    // Every mode goes through the channel counters first
+    monitor_callback = callback;
+    ESP_ERROR_CHECK(esp_wifi_set_promiscuous_rx_cb(monitor_rx_callback));
 
     ESP_LOGI(TAG, "WiFi monitor mode started.");
     TERMINAL_VIEW_ADD_TEXT("WiFi monitor mode started.");
 }
 
+static void channel_hop_callback(void *arg) {
+    int64_t now = esp_timer_get_time();
+    channel_stats_add_dwell(&wifi_channel_stats, hop_channel, (uint32_t)((now - hop_entered_us) / 1000));
+
+    hop_channel = hop_channel >= CHANNEL_HOP_LAST ? 1 : hop_channel + 1;
+    esp_wifi_set_channel(hop_channel, WIFI_SECOND_CHAN_NONE);
+    hop_entered_us = esp_timer_get_time();
+}
+
+esp_err_t wifi_manager_start_channel_hop(uint32_t dwell_ms) {
+    if (hop_timer == NULL) {
+        const esp_timer_create_args_t args = {
+            .callback = channel_hop_callback,
+            .name = "channel_hop",
+        };
+        esp_err_t err = esp_timer_create(&args, &hop_timer);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    wifi_manager_stop_channel_hop();
+    hop_channel = 1;
+    esp_wifi_set_channel(hop_channel, WIFI_SECOND_CHAN_NONE);
+    hop_entered_us = esp_timer_get_time();
+    return esp_timer_start_periodic(hop_timer, (uint64_t)(dwell_ms ? dwell_ms : CHANNEL_HOP_DEFAULT_MS) * 1000);
+}
+
+void wifi_manager_stop_channel_hop(void) {
+    if (hop_timer != NULL && esp_timer_is_active(hop_timer)) {
+        esp_timer_stop(hop_timer);
+    }
+}
+
+bool wifi_manager_is_channel_hopping(void) {
+    return hop_timer != NULL && esp_timer_is_active(hop_timer);
+}
+
 void wifi_manager_stop_monitor_mode() {
+    wifi_manager_stop_channel_hop();
     ESP_ERROR_CHECK(esp_wifi_set_promiscuous(false));
 
     ESP_LOGI(TAG, "WiFi monitor mode stopped.");
@@ -1021,6 +1120,12 @@ void wifi_manager_stop_scan() {
         ap_count = actual_ap_count;
         ESP_LOGI(TAG, "Actual AP count retrieved: %u", ap_count);
         TERMINAL_VIEW_ADD_TEXT("Actual AP count retrieved: %u", ap_count);
+
+        uint32_t now_ms = device_table_now_ms();
+        for (int i = 0; i < ap_count; i++) {
+            device_table_upsert(&device_table_aps, scanned_aps[i].bssid, scanned_aps[i].rssi,
+                                scanned_aps[i].primary, (const char *)scanned_aps[i].ssid, NULL, now_ms);
+        }
     } else {
         ESP_LOGI(TAG, "No access points found");
         ap_count = 0;
@@ -1197,244 +1302,129 @@ void wifi_manager_select_ap(int index)
     TERMINAL_VIEW_ADD_TEXT("Selected Access Point Successfully\n");
 }
 
-#define MAX_PAYLOAD    64
-#define UDP_PORT 6677
-#define TRACK_NAME_LEN 32
-#define ARTIST_NAME_LEN 32
-#define NUM_BARS 15
-
-void screen_music_visualizer_task(void *pvParameters) {
-    char rx_buffer[128];
-    char track_name[TRACK_NAME_LEN + 1];
-    char artist_name[ARTIST_NAME_LEN + 1];
-    uint8_t amplitudes[NUM_BARS];
-
-    struct sockaddr_in dest_addr;
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_port = htons(UDP_PORT);
-    dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-
-    
-    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (sock < 0) {
-        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
-        vTaskDelete(NULL);
-        return;
-    }
-
-    ESP_LOGI(TAG, "Socket created");
-
-    int err = bind(sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-    if (err < 0) {
-        ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
-        close(sock);
-        vTaskDelete(NULL);
-        return;
-    }
-
-    ESP_LOGI(TAG, "Socket bound, port %d", UDP_PORT);
-
-    while (1) {
-        ESP_LOGI(TAG, "Waiting for data...");
-
-        struct sockaddr_in6 source_addr;
-        socklen_t socklen = sizeof(source_addr);
-
-        int len = recvfrom(sock, rx_buffer, sizeof(rx_buffer) - 1, 0, (struct sockaddr *)&source_addr, &socklen);
-        if (len < 0) {
-            ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
-            break;
-        }
-
-        
-        rx_buffer[len] = '\0';
-        ESP_LOGI(TAG, "Received %d bytes from %s:", len, inet6_ntoa(source_addr.sin6_addr));
-        ESP_LOGI(TAG, "%s", rx_buffer);
-
-        
-        if (len >= TRACK_NAME_LEN + ARTIST_NAME_LEN + NUM_BARS) {
-           
-            memcpy(track_name, rx_buffer, TRACK_NAME_LEN);
-            track_name[TRACK_NAME_LEN] = '\0';
-
-            memcpy(artist_name, rx_buffer + TRACK_NAME_LEN, ARTIST_NAME_LEN);
-            artist_name[ARTIST_NAME_LEN] = '\0';
-
-            memcpy(amplitudes, rx_buffer + TRACK_NAME_LEN + ARTIST_NAME_LEN, NUM_BARS);
-
-#ifdef WITH_SCREEN    
-            music_visualizer_view_update(amplitudes, track_name, artist_name);
-#endif
-        } else {
-            ESP_LOGW(TAG, "Received packet of unexpected size");
-        }
-    }
-
-    if (sock != -1) {
-        ESP_LOGE(TAG, "Shutting down socket and restarting...");
-        shutdown(sock, 0);
-        close(sock);
-    }
-
-    vTaskDelete(NULL);
+static uint32_t visualizer_now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
 }
 
-void animate_led_based_on_amplitude(void *pvParameters)
-{
-    char rx_buffer[128];
-    char addr_str[128];
-    int addr_family = AF_INET;
-    int ip_protocol = IPPROTO_IP;
-    struct sockaddr_in dest_addr;
-
-    dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    dest_addr.sin_family = addr_family;
-    dest_addr.sin_port = htons(UDP_PORT);
-
-    int sock = socket(addr_family, SOCK_DGRAM, ip_protocol);
-    if (sock < 0) {
-        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
-        return;
+static void visualizer_output(const uint8_t *bars, int count, const char *track, const char *artist) {
+#ifdef CONFIG_WITH_SCREEN
+    // The screen always shows NUM_BARS, spread or sampled from what was sent
+    uint8_t screen_bars[NUM_BARS];
+    for (int i = 0; i < NUM_BARS; i++) {
+        screen_bars[i] = count ? bars[i * count / NUM_BARS] : 0;
     }
-    ESP_LOGI(TAG, "Socket created");
+    music_visualizer_view_update(screen_bars, track, artist);
+#endif
 
-    if (bind(sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr)) < 0) {
-        ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
-        close(sock);
+    if (rgb_manager.num_leds > 1 && !rgb_manager.is_separate_pins) {
+        uint8_t silent = 0;
+        update_led_visualizer(count ? (uint8_t *)bars : &silent, count ? count : 1, false);
         return;
     }
-    ESP_LOGI(TAG, "Socket bound, port %d", UDP_PORT);
-
-    float amplitude = 0.0f;
-    float last_amplitude = 0.0f;
-    float smoothing_factor = 0.1f;
-    int hue = 0;
-
-    while (1) {
-        struct sockaddr_in source_addr;
-        socklen_t socklen = sizeof(source_addr);
-        int len = recvfrom(sock, rx_buffer, sizeof(rx_buffer) - 1, MSG_DONTWAIT,
-                           (struct sockaddr *)&source_addr, &socklen);
-
-        if (len > 0) {
-            rx_buffer[len] = '\0';
-            inet_ntoa_r(source_addr.sin_addr, addr_str, sizeof(addr_str) - 1);
-            ESP_LOGI(TAG, "Received %d bytes from %s: %s", len, addr_str, rx_buffer);
-
-            amplitude = atof(rx_buffer);
-            amplitude = fmaxf(0.0f, fminf(amplitude, 1.0f)); // Clamp between 0.0 and 1.0
-
-            // Smooth amplitude to avoid sudden changes (optional)
-            amplitude = (smoothing_factor * amplitude) + ((1.0f - smoothing_factor) * last_amplitude);
-            last_amplitude = amplitude;
-        } else {
-            // Gradually decrease amplitude when no data is received
-            amplitude = last_amplitude * 0.9f; // Adjust decay rate as needed
-            last_amplitude = amplitude;
-        }
-
-        // Ensure amplitude doesn't go below zero
-        amplitude = fmaxf(0.0f, amplitude);
-
-
-        hue = (int)(amplitude * 360) % 360;
-
-        
-        float h = hue / 60.0f;
-        float s = 1.0f;
-        float v = amplitude;
-
-        int i = (int)h % 6;
-        float f = h - (int)h;
-        float p = v * (1.0f - s);
-        float q = v * (1.0f - f * s);
-        float t = v * (1.0f - (1.0f - f) * s);
-
-        float r = 0.0f, g = 0.0f, b = 0.0f;
-        switch (i) {
-            case 0: r = v; g = t; b = p; break;
-            case 1: r = q; g = v; b = p; break;
-            case 2: r = p; g = v; b = t; break;
-            case 3: r = p; g = q; b = v; break;
-            case 4: r = t; g = p; b = v; break;
-            case 5: r = v; g = p; b = q; break;
-        }
-
-        uint8_t red = (uint8_t)(r * 255);
-        uint8_t green = (uint8_t)(g * 255);
-        uint8_t blue = (uint8_t)(b * 255);
-
-        
-        esp_err_t ret = rgb_manager_set_color(&rgb_manager, 0, red, green, blue, false);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to set color");
-        }
-
-        vTaskDelay(10 / portTICK_PERIOD_MS);
-    }
 
-    if (sock != -1) {
-        ESP_LOGE(TAG, "Shutting down socket...");
-        shutdown(sock, 0);
-        close(sock);
+    // A single LED shows the overall level as a hue, dimmed by the same level
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += bars[i];
     }
+    uint8_t level = count ? (uint8_t)(sum / count) : 0;
+    led_rgb_t color = led_effects_hue(level);
+    rgb_manager_set_color(&rgb_manager, 0, led_effects_scale8(color.r, level), led_effects_scale8(color.g, level),
+                          led_effects_scale8(color.b, level), false);
 }
 
-void rgb_visualizer_server_task(void *pvParameters) {
-    char rx_buffer[MAX_PAYLOAD];
-    char addr_str[128];
-    int addr_family;
-    int ip_protocol;
+void visualizer_server_task(void *pvParameters) {
+    static visualizer_jitter_t jitter;
+    static uint8_t rx_buffer[VISUALIZER_MAX_PACKET];
+    visualizer_packet_t packet;
+    uint8_t bars[VISUALIZER_MAX_BARS];
+    char track[VISUALIZER_NAME_LEN + 1] = "Ghost ESP";
+    char artist[VISUALIZER_NAME_LEN + 1] = "Spooky";
+    const uint32_t period_ms = 1000 / VISUALIZER_OUTPUT_FPS;
+
+    led_effects_init();
 
     while (1) {
         struct sockaddr_in dest_addr;
         dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
         dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(UDP_PORT);
-        addr_family = AF_INET;
-        ip_protocol = IPPROTO_IP;
-        inet_ntoa_r(dest_addr.sin_addr, addr_str, sizeof(addr_str) - 1);
+        dest_addr.sin_port = htons(VISUALIZER_PORT);
 
-        int sock = socket(addr_family, SOCK_DGRAM, ip_protocol);
+        int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
         if (sock < 0) {
             ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
             break;
         }
-        ESP_LOGI(TAG, "Socket created");
-
-        int err = bind(sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-        if (err < 0) {
+        if (bind(sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr)) < 0) {
             ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
+            close(sock);
+            break;
         }
-        ESP_LOGI(TAG, "Socket bound, port %d", UDP_PORT);
+        ESP_LOGI(TAG, "Visualizer listening on port %d", VISUALIZER_PORT);
+
+        visualizer_jitter_reset(&jitter);
+        bool playing = false;
+        uint32_t next_output = visualizer_now_ms() + period_ms;
 
         while (1) {
-            ESP_LOGI(TAG, "Waiting for data");
-            struct sockaddr_in6 source_addr;
-            socklen_t socklen = sizeof(source_addr);
-            int len = recvfrom(sock, rx_buffer, sizeof(rx_buffer) - 1, 0,
-                               (struct sockaddr *)&source_addr, &socklen);
-
-            if (len < 0) {
-                ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
+            // Sleep until a packet arrives or the next output frame is due, never spin
+            int32_t wait_ms = (int32_t)(next_output - visualizer_now_ms());
+            if (wait_ms < 0) wait_ms = 0;
+            struct timeval timeout = {.tv_sec = 0, .tv_usec = wait_ms * 1000};
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(sock, &readable);
+
+            int ready = select(sock + 1, &readable, NULL, NULL, &timeout);
+            if (ready < 0) {
+                ESP_LOGE(TAG, "select failed: errno %d", errno);
                 break;
-            } else {
-                // Data received
-                rx_buffer[len] = 0; // Null-terminate
-                ESP_LOGI(TAG, "Received %d bytes", len);
-
-                // Process the received data
-                uint8_t *amplitudes = (uint8_t *)rx_buffer;
-                size_t num_bars = len;
-                update_led_visualizer(amplitudes, num_bars, false);
             }
-        }
+            if (ready > 0) {
+                int len = recv(sock, rx_buffer, sizeof(rx_buffer), 0);
+                if (len < 0) {
+                    ESP_LOGE(TAG, "recv failed: errno %d", errno);
+                    break;
+                }
+                if (visualizer_parse(rx_buffer, len, &packet)) {
+                    if (packet.has_metadata) {
+                        strcpy(track, packet.track);
+                        strcpy(artist, packet.artist);
+                    }
+                    visualizer_jitter_push(&jitter, &packet, visualizer_now_ms());
+                } else {
+                    jitter.stats.invalid++;
+                }
+            }
 
-        if (sock != -1) {
-            ESP_LOGE(TAG, "Shutting down socket and restarting...");
-            shutdown(sock, 0);
-            close(sock);
+            uint32_t now = visualizer_now_ms();
+            if ((int32_t)(now - next_output) < 0) {
+                continue;
+            }
+            next_output += period_ms;
+            if ((int32_t)(now - next_output) >= 0) {
+                next_output = now + period_ms;
+            }
+
+            int count = visualizer_jitter_sample(&jitter, now, bars);
+            if (count > 0) {
+                visualizer_output(bars, count, track, artist);
+                playing = true;
+            } else if (playing) {
+                // Blank once when the stream stops and report how it went
+                visualizer_output(bars, 0, track, artist);
+                playing = false;
+                const visualizer_stream_stats_t *st = &jitter.stats;
+                ESP_LOGI(TAG, "Visualizer stream stopped: %lu received, %lu lost, %lu late, %lu reordered, "
+                         "%lu duplicate, %lu invalid", (unsigned long)st->received, (unsigned long)st->lost,
+                         (unsigned long)st->late, (unsigned long)st->reordered, (unsigned long)st->duplicate,
+                         (unsigned long)st->invalid);
+            }
         }
+
+        ESP_LOGE(TAG, "Shutting down socket and restarting...");
+        shutdown(sock, 0);
+        close(sock);
     }
 
     vTaskDelete(NULL);
@@ -1,7 +1,7 @@
 import pyaudio
 import numpy as np
 import socket
-import time
+from visualizer_protocol import UDP_PORT, VisualizerSender
 
 # Audio settings
 CHUNK = 1024             # Number of audio samples per frame
@@ -10,7 +10,6 @@ FORMAT = pyaudio.paInt16 # Audio format
 CHANNELS = 1             # Mono audio
 
 # Network settings
-UDP_PORT = 6677          # Port number
 BROADCAST_IP = '192.168.1.255'  # Broadcast address
 
 # Track info
@@ -22,6 +21,8 @@ p = pyaudio.PyAudio()
 stream = p.open(format=FORMAT, channels=CHANNELS, rate=RATE, input=True, frames_per_buffer=CHUNK)
 sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
 sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)  # Enable broadcasting
+sender = VisualizerSender(sock, (BROADCAST_IP, UDP_PORT))
+sender.set_metadata(TRACK_NAME, ARTIST_NAME)  # Sent on change and once a second, not in every frame
 
 # Frequency bands
 num_bands = 15  # Number of amplitude values you want
@@ -71,7 +72,7 @@ try:
             normalized_amplitudes = [0] * num_bands
         else:
             # Normalize and ensure no NaN values
-            normalized_amplitudes = [int(np.nan_to_num((amp / max_amplitude) * 200)) for amp in band_amplitudes]
+            normalized_amplitudes = [int(np.nan_to_num((amp / max_amplitude) * 255)) for amp in band_amplitudes]
 
         # Apply decay to each bar for a smoother fall-off effect
         for i in range(num_bands):
@@ -90,17 +91,8 @@ try:
         # Convert previous amplitudes to integer for sending
         final_amplitudes = [int(amp) for amp in previous_amplitudes]
 
-        # Create a message including the track info and normalized amplitudes
-        message = TRACK_NAME.encode('utf-8')[:32].ljust(32, b'\0')  # 32 bytes for track name
-        message += ARTIST_NAME.encode('utf-8')[:32].ljust(32, b'\0')  # 32 bytes for artist name
-        message += bytes(final_amplitudes)  # Include all 15 amplitude values
-
-        # Ensure the message length is 79 bytes
-        if len(message) != 79:
-            print(f"Message length is {len(message)}, expected 79 bytes")
-
-        # Send the message over UDP to the broadcast address
-        sock.sendto(message, (BROADCAST_IP, UDP_PORT))
+        # Send one sequence numbered frame over UDP to the broadcast address
+        sender.send(final_amplitudes)
 except KeyboardInterrupt:
     pass
 finally:
@@ -2,10 +2,10 @@ import pyaudio
 import numpy as np
 import socket
 import logging
+from visualizer_protocol import UDP_PORT, VisualizerSender
 
-# Replace with the IP address and port of your ESP32
+# Replace with the IP address of your ESP32, or your network's broadcast address
 UDP_IP = "192.168.1.255"
-UDP_PORT = 6677
 
 # Audio configuration
 CHUNK = 1024  # Adjusted chunk size for FFT analysis
@@ -25,12 +25,10 @@ NOISE_THRESHOLD = 0.2  # Amplitude below which is considered noise and set to ze
 # Configure logging
 logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(levelname)s - %(message)s')
 
-def send_amplitude(amplitude):
+def send_amplitude(sender, amplitude):
     try:
-        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-        message = f"{amplitude}".encode('utf-8')
-        sock.sendto(message, (UDP_IP, UDP_PORT))
-        sock.close()
+        # One bar, 0.0 to 1.0 mapped onto 0 to 255
+        sender.send([round(amplitude * 255)])
         logging.debug(f"Sent amplitude: {amplitude} to {UDP_IP}:{UDP_PORT}")
     except Exception as e:
         logging.error(f"Failed to send data: {e}")
@@ -77,6 +75,9 @@ def main():
     p = pyaudio.PyAudio()
 
     stream = None
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    sender = VisualizerSender(sock, (UDP_IP, UDP_PORT))
     amplitude = 0.0  # Initialize amplitude
     dynamic_threshold = NOISE_THRESHOLD * 1.5  # Initial threshold for beat detection
     try:
@@ -112,7 +113,7 @@ def main():
                     amplitude = current_amplitude  # Update amplitude with detected value
 
                 # Send the current amplitude even as it decays
-                send_amplitude(amplitude)
+                send_amplitude(sender, amplitude)
 
                 # Apply "gravity" to pull the amplitude back towards zero
                 amplitude = max(amplitude - GRAVITY, 0.0)
@@ -136,6 +137,7 @@ def main():
             stream.stop_stream()
             stream.close()
         p.terminate()
+        sock.close()
         logging.info("Audio stream closed and resources released.")
 
 if __name__ == "__main__":
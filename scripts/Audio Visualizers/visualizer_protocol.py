@@ -0,0 +1,49 @@
+import struct
+import time
+
+# Binary visualizer stream understood by Ghost ESP, one frame per UDP datagram.
+# Header (little endian): b'GV', version, flags, sequence (u16), bar count (u8),
+# reserved (u8), sender time in ms (u32). Then one byte per bar, 0 to 255.
+# With FLAG_METADATA the track and artist follow, each as a length byte and UTF-8.
+
+UDP_PORT = 6677
+VERSION = 1
+FLAG_METADATA = 0x01
+MAX_BARS = 64
+NAME_LEN = 32
+METADATA_REPEAT_S = 1.0  # Metadata is resent this often so late listeners pick it up
+
+_HEADER = struct.Struct('<2sBBHBBI')
+
+
+class VisualizerSender:
+    def __init__(self, sock, address):
+        self.sock = sock
+        self.address = address
+        self.seq = 0
+        self.start = time.monotonic()
+        self.metadata = None
+        self.metadata_sent = 0.0
+
+    def set_metadata(self, track, artist):
+        metadata = (track.encode('utf-8')[:NAME_LEN], artist.encode('utf-8')[:NAME_LEN])
+        if metadata != self.metadata:
+            self.metadata = metadata
+            self.metadata_sent = 0.0
+
+    def send(self, bars):
+        bars = [max(0, min(255, int(b))) for b in bars[:MAX_BARS]]
+        now = time.monotonic()
+
+        flags = 0
+        tail = b''
+        if self.metadata is not None and now - self.metadata_sent >= METADATA_REPEAT_S:
+            track, artist = self.metadata
+            flags |= FLAG_METADATA
+            tail = bytes([len(track)]) + track + bytes([len(artist)]) + artist
+            self.metadata_sent = now
+
+        timestamp = int((now - self.start) * 1000) & 0xFFFFFFFF
+        header = _HEADER.pack(b'GV', VERSION, flags, self.seq, len(bars), 0, timestamp)
+        self.sock.sendto(header + bytes(bars) + tail, self.address)
+        self.seq = (self.seq + 1) & 0xFFFF
@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""
+Convert images into the row-indexed RLE ("GRLE") format decoded by
+main/managers/image_decoder.c.
+
+Layout (little endian):
+    char     magic[4]        "GRLE"
+    uint8    version         1
+    uint8    flags           bit 0: colors are stored byte swapped (LV_COLOR_16_SWAP)
+    uint16   width
+    uint16   height
+    uint16   reserved
+    uint32   row_offsets[height]   offset of each row from the end of this table
+    rows...                  per row: PackBits colors (2 byte units), PackBits alpha (1 byte units)
+
+PackBits control byte: 0x80 | (n - 1) repeats the next unit n times,
+otherwise (n - 1) is followed by n literal units. n is at most 128.
+
+Usage:
+    python image_rle.py png icon.png --name my_icon -o ../../main/vendor/images/my_icon.c
+    python image_rle.py lvgl ../../main/vendor/images/*.c
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b"GRLE"
+VERSION = 1
+FLAG_SWAPPED = 0x01
+MAX_RUN = 128
+
+
+def packbits(units):
+    out = bytearray()
+    i = 0
+    n = len(units)
+    while i < n:
+        j = i
+        while j + 1 < n and units[j + 1] == units[i] and j - i + 1 < MAX_RUN:
+            j += 1
+        run = j - i + 1
+        if run >= 2:
+            out.append(0x80 | (run - 1))
+            out += units[i]
+            i = j + 1
+            continue
+
+        start = i
+        i += 1
+        while i < n and i - start < MAX_RUN and not (i + 1 < n and units[i + 1] == units[i]):
+            i += 1
+        out.append(i - start - 1)
+        for unit in units[start:i]:
+            out += unit
+    return out
+
+
+def encode(colors, alpha, width, height, swapped):
+    """colors: list of 2 byte units, alpha: list of ints, both width * height long."""
+    rows = bytearray()
+    offsets = []
+    for y in range(height):
+        row_colors = colors[y * width:(y + 1) * width]
+        row_alpha = alpha[y * width:(y + 1) * width]
+
+        # Fully transparent pixels never show, reuse the previous color to extend runs
+        prev = row_colors[0]
+        for x in range(width):
+            if row_alpha[x] == 0:
+                row_colors[x] = prev
+            prev = row_colors[x]
+
+        offsets.append(len(rows))
+        rows += packbits(row_colors)
+        rows += packbits([bytes([a]) for a in row_alpha])
+
+    flags = FLAG_SWAPPED if swapped else 0
+    header = MAGIC + struct.pack("<BBHHH", VERSION, flags, width, height, 0)
+    return header + struct.pack("<%dI" % height, *offsets) + rows
+
+
+def rgb565(r, g, b, swapped):
+    value = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+    return struct.pack(">H" if swapped else "<H", value)
+
+
+def load_png(path, swapped):
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("Pillow is required for PNG input: pip install pillow")
+
+    img = Image.open(path).convert("RGBA")
+    width, height = img.size
+    colors = []
+    alpha = []
+    for r, g, b, a in img.getdata():
+        colors.append(rgb565(r, g, b, swapped))
+        alpha.append(a)
+    return colors, alpha, width, height
+
+
+def load_lvgl_c(text):
+    """Reads an LVGL converter RGB565A8 C file. Pixel byte order is kept as is."""
+    if "LV_IMG_CF_RGB565A8" not in text:
+        raise ValueError("only LV_IMG_CF_RGB565A8 images can be re-encoded")
+
+    name = re.search(r"const lv_img_dsc_t (\w+) = \{", text).group(1)
+    width = int(re.search(r"\.header\.w = (\d+)", text).group(1))
+    height = int(re.search(r"\.header\.h = (\d+)", text).group(1))
+
+    array = text[text.index("_map[] = {"):]
+    array = array[:array.index("};")]
+    data = bytes(int(x, 16) for x in re.findall(r"0x([0-9a-fA-F]{2})", array))
+
+    count = width * height
+    if len(data) != count * 3:
+        raise ValueError("%s: expected %d bytes, found %d" % (name, count * 3, len(data)))
+
+    colors = [data[2 * i:2 * i + 2] for i in range(count)]
+    alpha = list(data[2 * count:])
+    return name, colors, alpha, width, height
+
+
+def write_c(name, blob, width, height):
+    guard = "LV_ATTRIBUTE_IMG_" + name.upper()
+    lines = [
+        "#ifdef __has_include",
+        "    #if __has_include(\"lvgl.h\")",
+        "        #ifndef LV_LVGL_H_INCLUDE_SIMPLE",
+        "            #define LV_LVGL_H_INCLUDE_SIMPLE",
+        "        #endif",
+        "    #endif",
+        "#endif",
+        "",
+        "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)",
+        "    #include \"lvgl.h\"",
+        "#else",
+        "    #include \"lvgl/lvgl.h\"",
+        "#endif",
+        "",
+        "// GRLE compressed, decoded by managers/image_decoder.c",
+        "// Generated by scripts/Image Tools/image_rle.py",
+        "",
+        "#ifndef LV_ATTRIBUTE_MEM_ALIGN",
+        "#define LV_ATTRIBUTE_MEM_ALIGN",
+        "#endif",
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "#endif",
+        "",
+        "const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST %s uint8_t %s_map[] = {" % (guard, name),
+    ]
+    for i in range(0, len(blob), 24):
+        lines.append("  " + " ".join("0x%02x," % b for b in blob[i:i + 24]))
+    lines += [
+        "};",
+        "",
+        "const lv_img_dsc_t %s = {" % name,
+        "  .header.cf = LV_IMG_CF_RAW_ALPHA,",
+        "  .header.always_zero = 0,",
+        "  .header.reserved = 0,",
+        "  .header.w = %d," % width,
+        "  .header.h = %d," % height,
+        "  .data_size = %d," % len(blob),
+        "  .data = %s_map," % name,
+        "};",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def cmd_png(args):
+    colors, alpha, width, height = load_png(args.input, not args.no_swap)
+    blob = encode(colors, alpha, width, height, not args.no_swap)
+    out = args.output or (args.name + ".c")
+    with open(out, "w") as f:
+        f.write(write_c(args.name, blob, width, height))
+    print("%s: %dx%d, %d -> %d bytes" % (out, width, height, width * height * 3, len(blob)))
+
+
+def cmd_lvgl(args):
+    total_raw = total_rle = 0
+    for path in args.files:
+        with open(path) as f:
+            text = f.read()
+        if "LV_IMG_CF_RAW_ALPHA" in text:
+            print("%s: already compressed, skipped" % path)
+            continue
+        name, colors, alpha, width, height = load_lvgl_c(text)
+        # The checked in assets were exported with LV_COLOR_16_SWAP byte order
+        blob = encode(colors, alpha, width, height, not args.no_swap)
+        with open(path, "w") as f:
+            f.write(write_c(name, blob, width, height))
+        total_raw += width * height * 3
+        total_rle += len(blob)
+        print("%s: %dx%d, %d -> %d bytes" % (path, width, height, width * height * 3, len(blob)))
+    if total_raw:
+        print("Total: %d -> %d bytes (%.0f%%)" % (total_raw, total_rle, 100.0 * total_rle / total_raw))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert images to the GRLE format used by the firmware")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    png = sub.add_parser("png", help="convert a PNG into a C image file")
+    png.add_argument("input")
+    png.add_argument("--name", required=True, help="C symbol name of the image")
+    png.add_argument("-o", "--output", help="output .c file, defaults to <name>.c")
+    png.add_argument("--no-swap", action="store_true", help="store colors in native RGB565 byte order")
+    png.set_defaults(func=cmd_png)
+
+    lvgl = sub.add_parser("lvgl", help="re-encode LVGL RGB565A8 C files in place")
+    lvgl.add_argument("files", nargs="+")
+    lvgl.add_argument("--no-swap", action="store_true", help="the input colors are in native byte order")
+    lvgl.set_defaults(func=cmd_lvgl)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,30 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+// Minimal checks for the host tests. A failed check is reported and counted, the
+// test keeps going so one run shows every broken case.
+static int host_test_failures = 0;
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                                    \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                              \
+    do {                                                                                        \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);                         \
+        if (a_ != e_) {                                                                         \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, \
+                    a_, e_);                                                                    \
+            host_test_failures++;                                                               \
+        }                                                                                       \
+    } while (0)
+
+#define HOST_TEST_RESULT() (host_test_failures ? 1 : 0)
+
+#endif // HOST_TEST_H
@@ -0,0 +1,14 @@
+#ifndef HOST_STUB_ESP_HEAP_CAPS_H
+#define HOST_STUB_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT   (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+#endif // HOST_STUB_ESP_HEAP_CAPS_H
@@ -0,0 +1,12 @@
+#ifndef HOST_STUB_FREERTOS_H
+#define HOST_STUB_FREERTOS_H
+
+// The host tests are single threaded, a critical section only has to compile
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portMUX_INITIALIZE(mux) ((mux)->owner = 0)
+
+#endif // HOST_STUB_FREERTOS_H
@@ -0,0 +1,9 @@
+#ifndef HOST_STUB_FREERTOS_TASK_H
+#define HOST_STUB_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+#define taskENTER_CRITICAL(mux) ((void)(mux))
+#define taskEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // HOST_STUB_FREERTOS_TASK_H
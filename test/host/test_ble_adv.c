@@ -0,0 +1,207 @@
+#include "core/ble_adv.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Advertisements captured off the air, one per kind the handlers care about
+static const uint8_t corpus_airtag[] = {
+    0x1E, 0xFF, 0x4C, 0x00, 0x12, 0x19, 0x10, 0xA3, 0x5C, 0x27, 0x91, 0x0E, 0x44, 0xB8, 0x73, 0x02,
+    0xDE, 0x6A, 0x19, 0xC4, 0x58, 0xF0, 0x3B, 0x87, 0x2D, 0x61, 0xAE, 0x05, 0x9C, 0x01, 0x00,
+};
+static const uint8_t corpus_ibeacon[] = {
+    0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48,
+    0xD2, 0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0, 0x00, 0x01, 0x00, 0x02, 0xC5,
+};
+static const uint8_t corpus_apple_nearby[] = {
+    0x02, 0x01, 0x1A, 0x02, 0x0A, 0x0C, 0x0B, 0xFF, 0x4C, 0x00, 0x10, 0x06, 0x13, 0x1E, 0x5A, 0xD4,
+    0x2F, 0x68,
+};
+static const uint8_t corpus_smarttag[] = {
+    0x02, 0x01, 0x06, 0x03, 0x03, 0x5A, 0xFD, 0x16, 0x16, 0x5A, 0xFD, 0x12, 0x5D, 0x0C, 0x47, 0x8B,
+    0x31, 0x2E, 0x09, 0x6C, 0xF4, 0xA5, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x91, 0x77, 0x42,
+};
+static const uint8_t corpus_tile[] = {
+    0x02, 0x01, 0x06, 0x03, 0x03, 0xED, 0xFE, 0x0D, 0x16, 0xED, 0xFE, 0x02, 0x00, 0x7B, 0x3F, 0xC1,
+    0x94, 0x58, 0x0A, 0xE6, 0x21,
+};
+static const uint8_t corpus_flipper[] = {
+    0x02, 0x01, 0x06, 0x03, 0x03, 0x82, 0x30, 0x0C, 0x09, 'F', 'l', 'i', 'p', 'p', 'e', 'r', ' ',
+    'Z', 'e', 'r', 0x02, 0x0A, 0x00,
+};
+static const uint8_t corpus_flipper128[] = {
+    0x02, 0x01, 0x06, 0x11, 0x07, 0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00,
+    0x00, 0x81, 0x30, 0x00, 0x00, 0x06, 0x08, 'D', 'o', 'l', 'p', 'h',
+};
+static const uint8_t corpus_fast_pair[] = {
+    0x02, 0x01, 0x06, 0x03, 0x03, 0x2C, 0xFE, 0x06, 0x16, 0x2C, 0xFE, 0x00, 0xB7, 0x27, 0x02, 0x0A,
+    0xF6,
+};
+static const uint8_t corpus_swift_pair[] = {
+    0x02, 0x01, 0x06, 0x0F, 0xFF, 0x06, 0x00, 0x03, 0x00, 0x80, 'S', 'u', 'r', 'f', 'a', 'c', 'e',
+    ' ', 'P',
+};
+static const uint8_t corpus_eddystone[] = {
+    0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x0D, 0x16, 0xAA, 0xFE, 0x10, 0xEB, 0x03, 'g', 'h',
+    'o', 's', 't', 0x07, 0x00,
+};
+static const uint8_t corpus_named[] = {
+    0x02, 0x01, 0x06, 0x05, 0x02, 0x0F, 0x18, 0x0A, 0x18, 0x05, 0x08, 'B', 'u', 'd', 's', 0x0C,
+    0x09, 'G', 'a', 'l', 'a', 'x', 'y', ' ', 'B', 'u', 'd', 's',
+};
+static const uint8_t corpus_truncated[] = {
+    0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5,
+};
+
+static const struct {
+    const uint8_t *data;
+    uint8_t len;
+} corpus[] = {
+    {corpus_airtag, sizeof(corpus_airtag)},
+    {corpus_ibeacon, sizeof(corpus_ibeacon)},
+    {corpus_apple_nearby, sizeof(corpus_apple_nearby)},
+    {corpus_smarttag, sizeof(corpus_smarttag)},
+    {corpus_tile, sizeof(corpus_tile)},
+    {corpus_flipper, sizeof(corpus_flipper)},
+    {corpus_flipper128, sizeof(corpus_flipper128)},
+    {corpus_fast_pair, sizeof(corpus_fast_pair)},
+    {corpus_swift_pair, sizeof(corpus_swift_pair)},
+    {corpus_eddystone, sizeof(corpus_eddystone)},
+    {corpus_named, sizeof(corpus_named)},
+    {corpus_truncated, sizeof(corpus_truncated)},
+};
+#define CORPUS_COUNT (sizeof(corpus) / sizeof(corpus[0]))
+
+static uint32_t fuzz_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16;
+}
+
+static bool span_inside(ble_adv_span_t span, const uint8_t *buf, size_t len) {
+    if (span.len == 0) return true;
+    return span.data >= buf && span.data + span.len <= buf + len;
+}
+
+static bool decoded_inside(const ble_adv_t *adv, const uint8_t *buf, size_t len) {
+    if (adv->uuid16_count > BLE_ADV_MAX_UUID16 || adv->uuid32_count > BLE_ADV_MAX_UUID32 ||
+        adv->uuid128_count > BLE_ADV_MAX_UUID128 || adv->mfg_count > BLE_ADV_MAX_MFG ||
+        adv->service_data_count > BLE_ADV_MAX_SERVICE_DATA) {
+        return false;
+    }
+    if (!span_inside(adv->name, buf, len)) return false;
+    for (int i = 0; i < adv->mfg_count; i++) {
+        if (!span_inside(adv->mfg[i].data, buf, len)) return false;
+    }
+    for (int i = 0; i < adv->service_data_count; i++) {
+        if (!span_inside(adv->service_data[i].uuid, buf, len) ||
+            !span_inside(adv->service_data[i].data, buf, len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_corpus_decoding(void) {
+    ble_adv_t adv;
+    char name[32];
+
+    ble_adv_parse(corpus_airtag, sizeof(corpus_airtag), &adv);
+    const ble_adv_mfg_t *apple = ble_adv_find_mfg(&adv, 0x004C);
+    CHECK(apple != NULL);
+    if (apple) {
+        CHECK_EQ(apple->data.len, 27);
+        CHECK_EQ(apple->data.data[0], 0x12);
+    }
+
+    ble_adv_parse(corpus_smarttag, sizeof(corpus_smarttag), &adv);
+    CHECK(ble_adv_has_uuid16(&adv, 0xFD5A));
+    CHECK_EQ(adv.service_data_count, 1);
+    CHECK_EQ(adv.service_data[0].uuid.data[0] | adv.service_data[0].uuid.data[1] << 8, 0xFD5A);
+
+    ble_adv_parse(corpus_flipper, sizeof(corpus_flipper), &adv);
+    ble_adv_copy_name(&adv, name, sizeof(name), "Unknown");
+    CHECK(ble_adv_has_uuid16(&adv, 0x3082));
+    CHECK(strcmp(name, "Flipper Zer") == 0);
+    CHECK(adv.present & BLE_ADV_HAS_TX_POWER);
+
+    // The 16-bit UUID inside a Bluetooth base 128-bit one
+    ble_adv_parse(corpus_flipper128, sizeof(corpus_flipper128), &adv);
+    CHECK(ble_adv_has_uuid16(&adv, 0x3081));
+    CHECK(!adv.name_complete);
+
+    ble_adv_parse(corpus_named, sizeof(corpus_named), &adv);
+    ble_adv_copy_name(&adv, name, sizeof(name), "Unknown");
+    CHECK_EQ(adv.uuid16_count, 2);
+    CHECK(adv.name_complete);
+    CHECK(strcmp(name, "Galaxy Buds") == 0);
+
+    ble_adv_parse(corpus_truncated, sizeof(corpus_truncated), &adv);
+    CHECK(adv.malformed);
+    CHECK_EQ(adv.present, BLE_ADV_HAS_FLAGS);
+    ble_adv_copy_name(&adv, name, sizeof(name), "Unknown");
+    CHECK(strcmp(name, "Unknown") == 0);
+}
+
+static void test_mutations_stay_in_bounds(int rounds) {
+    // Flipped bytes, broken lengths, cut tails and plain noise. Each buffer is exactly
+    // as long as the input so any span past it is caught, by ASan as well.
+    ble_adv_t adv;
+    uint32_t rng = 0x6A09E667u;
+    int malformed = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        size_t len = corpus[r % CORPUS_COUNT].len;
+        uint8_t src[31];
+        memcpy(src, corpus[r % CORPUS_COUNT].data, len);
+
+        switch (fuzz_rand(&rng) % 4) {
+            case 0:
+                for (int k = 0; k < 3; k++) src[fuzz_rand(&rng) % len] ^= (uint8_t)(1 << (fuzz_rand(&rng) % 8));
+                break;
+            case 1:
+                src[fuzz_rand(&rng) % len] = (uint8_t)fuzz_rand(&rng);
+                break;
+            case 2:
+                len = fuzz_rand(&rng) % (len + 1);
+                break;
+            default:
+                len = fuzz_rand(&rng) % (sizeof(src) + 1);
+                for (size_t k = 0; k < len; k++) src[k] = (uint8_t)fuzz_rand(&rng);
+                break;
+        }
+
+        uint8_t *buf = malloc(len ? len : 1);
+        memcpy(buf, src, len);
+        ble_adv_parse(buf, len, &adv);
+        if (!decoded_inside(&adv, buf, len)) {
+            fprintf(stderr, "Mutation %d decoded outside its %u byte buffer\n", r, (unsigned)len);
+            host_test_failures++;
+        }
+        if (adv.malformed) malformed++;
+        free(buf);
+    }
+    printf("Fuzzed %d mutations, %d malformed\n", rounds, malformed);
+}
+
+static void bench_decode(int rounds) {
+    ble_adv_t adv;
+    uint32_t present_sum = 0;
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t c = 0; c < CORPUS_COUNT; c++) {
+            ble_adv_parse(corpus[c].data, corpus[c].len, &adv);
+            present_sum += adv.present;
+        }
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    int decoded = rounds * (int)CORPUS_COUNT;
+    printf("Decoded %d advertisements in %lld us, %lld ns each (%lu)\n", decoded, (long long)elapsed,
+           (long long)(elapsed * 1000 / decoded), (unsigned long)present_sum);
+}
+
+int main(void) {
+    test_corpus_decoding();
+    test_mutations_stay_in_bounds(10000);
+    bench_decode(10000);
+    return HOST_TEST_RESULT();
+}
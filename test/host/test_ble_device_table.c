@@ -0,0 +1,228 @@
+#include "core/ble_device_table.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include <string.h>
+
+#define NONE 0xFFFF
+
+static const uint8_t payload_a[] = {0x02, 0x01, 0x06};
+static const uint8_t payload_b[] = {0x02, 0x01, 0x1A};
+
+static uint32_t bench_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16;
+}
+
+static void bench_addr(uint32_t id, uint8_t addr[6]) {
+    // Spread like random static addresses, with a run of near neighbours to stress probing
+    uint32_t mixed = id * 0x9E3779B1u;
+    addr[0] = (uint8_t)id;
+    addr[1] = (uint8_t)(id >> 8);
+    addr[2] = (uint8_t)mixed;
+    addr[3] = (uint8_t)(mixed >> 8);
+    addr[4] = (id & 1) ? 0x42 : (uint8_t)(mixed >> 16);
+    addr[5] = 0xC0 | (uint8_t)(mixed >> 26);
+}
+
+static uint32_t observe(ble_device_table_t *table, uint32_t id, uint8_t type, int8_t rssi, const uint8_t *payload,
+                        uint8_t len, uint32_t now_ms) {
+    uint8_t addr[6];
+    bench_addr(id, addr);
+    ble_adv_report_t report = {.addr = addr, .addr_type = type, .rssi = rssi, .raw = {payload, len}};
+    return ble_device_table_observe(table, &report, now_ms);
+}
+
+static bool present(const ble_device_table_t *table, uint32_t id, uint8_t type) {
+    uint8_t addr[6];
+    bench_addr(id, addr);
+    return ble_device_table_find(table, addr, type) != NULL;
+}
+
+// Every device on the LRU list is reachable through the hash and nothing else is
+static bool table_consistent(const ble_device_table_t *table) {
+    uint16_t listed = 0;
+    uint32_t last_seen = UINT32_MAX;
+    for (uint16_t idx = table->lru_head; idx != NONE; idx = table->devices[idx].lru_next) {
+        const ble_device_t *d = &table->devices[idx];
+        if (++listed > table->count || d->last_seen_ms > last_seen ||
+            ble_device_table_find(table, d->addr, d->addr_type) != d) {
+            return false;
+        }
+        last_seen = d->last_seen_ms;
+    }
+    uint32_t used = 0;
+    for (uint32_t s = 0; s <= table->index_mask; s++) {
+        used += table->index[s] != NONE;
+    }
+    return listed == table->count && used == table->count;
+}
+
+static void test_full_table_evicts_least_recent(void) {
+    ble_device_table_t table;
+    CHECK(ble_device_table_init(&table, 64));
+
+    for (uint32_t id = 0; id < 64; id++) {
+        CHECK_EQ(observe(&table, id, 1, -60, payload_a, sizeof(payload_a), id), BLE_DEVICE_NEW);
+    }
+    CHECK_EQ(observe(&table, 0, 1, -60, payload_a, sizeof(payload_a), 100), 0);
+    CHECK_EQ(observe(&table, 1000, 1, -60, payload_a, sizeof(payload_a), 101), BLE_DEVICE_NEW);
+    CHECK(present(&table, 0, 1));
+    CHECK(!present(&table, 1, 1));
+    CHECK_EQ(table.evicted, 1);
+
+    // Slots stay with their device, the evicted one's slot went to the newcomer
+    uint8_t addr[6];
+    bench_addr(1000, addr);
+    const ble_device_t *newcomer = ble_device_table_find(&table, addr, 1);
+    CHECK(newcomer != NULL);
+    if (newcomer) {
+        CHECK(ble_device_table_at(&table, (uint16_t)(newcomer - table.devices)) == newcomer);
+        CHECK_EQ(newcomer->version, table.version);
+        CHECK_EQ(newcomer->name[0], '\0');
+    }
+    CHECK(table_consistent(&table));
+    ble_device_table_free(&table);
+}
+
+static void test_changes_reported_once(void) {
+    ble_device_table_t table;
+    CHECK(ble_device_table_init(&table, 64));
+    uint8_t addr[6];
+    bench_addr(5, addr);
+
+    // An advertised name is kept, a repeat that changes nothing leaves the version alone
+    static const uint8_t named[] = {0x02, 0x01, 0x06, 0x06, 0x09, 'G', 'h', 'o', 's', 't'};
+    CHECK_EQ(observe(&table, 5, 1, -60, payload_a, sizeof(payload_a), 100), BLE_DEVICE_NEW);
+    ble_adv_report_t report = {.addr = addr, .addr_type = 1, .rssi = -60, .raw = {named, sizeof(named)}};
+    ble_adv_parse(named, sizeof(named), &report.adv);
+    CHECK_EQ(ble_device_table_observe(&table, &report, 101), BLE_DEVICE_PAYLOAD);
+    const ble_device_t *d = ble_device_table_find(&table, addr, 1);
+    CHECK(d != NULL && strcmp(d->name, "Ghost") == 0);
+    uint32_t version = table.version;
+    CHECK_EQ(ble_device_table_observe(&table, &report, 101), 0);
+    CHECK_EQ(table.version, version);
+
+    // Same address, other type, is another device
+    CHECK_EQ(observe(&table, 5, 0, -60, payload_a, sizeof(payload_a), 102), BLE_DEVICE_NEW);
+    CHECK(present(&table, 5, 0));
+    CHECK(present(&table, 5, 1));
+    CHECK(!present(&table, 6, 1));
+
+    // A device heard again after a long silence has returned
+    CHECK_EQ(observe(&table, 5, 0, -60, payload_b, sizeof(payload_b), 200), BLE_DEVICE_PAYLOAD);
+    CHECK_EQ(observe(&table, 5, 0, -60, payload_b, sizeof(payload_b), 200 + BLE_DEVICE_RETURN_MS),
+             BLE_DEVICE_RETURNED);
+    ble_device_table_free(&table);
+}
+
+static void test_smoothed_rssi(void) {
+    ble_device_table_t table;
+    CHECK(ble_device_table_init(&table, 16));
+    CHECK_EQ(observe(&table, 0, 1, -60, payload_a, sizeof(payload_a), 0), BLE_DEVICE_NEW);
+
+    // Single outliers are absorbed, a real move is reported once or twice on the way
+    uint32_t moved = 0;
+    moved += (observe(&table, 0, 1, -90, payload_a, sizeof(payload_a), 1) & BLE_DEVICE_RSSI_MOVED) != 0;
+    moved += (observe(&table, 0, 1, -60, payload_a, sizeof(payload_a), 2) & BLE_DEVICE_RSSI_MOVED) != 0;
+    CHECK_EQ(moved, 0);
+    for (uint32_t t = 0; t < 20; t++) {
+        moved += (observe(&table, 0, 1, -80, payload_a, sizeof(payload_a), 3 + t) & BLE_DEVICE_RSSI_MOVED) != 0;
+    }
+    CHECK(moved >= 1 && moved <= 3);
+
+    uint8_t addr[6];
+    bench_addr(0, addr);
+    const ble_device_t *d = ble_device_table_find(&table, addr, 1);
+    CHECK(d != NULL);
+    if (d) {
+        CHECK_EQ(d->rssi_min, -90);
+        CHECK_EQ(d->rssi_max, -60);
+        CHECK(ble_device_rssi(d) <= -77);
+        CHECK_EQ(d->count, 23);
+    }
+    ble_device_table_free(&table);
+}
+
+static void test_expire(void) {
+    ble_device_table_t table;
+    CHECK(ble_device_table_init(&table, 64));
+    for (uint32_t id = 0; id < 64; id++) {
+        observe(&table, id, 1, -60, payload_a, sizeof(payload_a), id);
+    }
+    uint8_t addr[6];
+    bench_addr(10, addr);
+    uint16_t slot = (uint16_t)(ble_device_table_find(&table, addr, 1) - table.devices);
+    observe(&table, 0, 1, -60, payload_a, sizeof(payload_a), 5000);
+
+    // Aging drops the quiet devices in batches and keeps the one just heard
+    CHECK_EQ(ble_device_table_expire(&table, 5000, 1000, 40), 40);
+    CHECK_EQ(ble_device_table_expire(&table, 5000, 1000, UINT16_MAX), 23);
+    CHECK_EQ(table.count, 1);
+    CHECK_EQ(table.expired, 63);
+    CHECK(present(&table, 0, 1));
+    CHECK(ble_device_table_at(&table, slot) == NULL);
+    CHECK(table_consistent(&table));
+    ble_device_table_free(&table);
+}
+
+static void test_random_churn_stays_consistent(void) {
+    // Eviction and aging at random keep the hash and the LRU list in step
+    ble_device_table_t table;
+    CHECK(ble_device_table_init(&table, 64));
+    uint32_t rng = 0xB5297A4Du;
+    int broken = 0;
+    for (uint32_t t = 0; t < 20000; t++) {
+        observe(&table, bench_rand(&rng) % 300, bench_rand(&rng) & 1, -40 - (int8_t)(bench_rand(&rng) % 50),
+                payload_a, sizeof(payload_a), t);
+        if (t % 500 == 499) ble_device_table_expire(&table, t, 100, 16);
+        if (t % 97 == 0 && !table_consistent(&table)) broken++;
+    }
+    CHECK_EQ(broken, 0);
+    ble_device_table_free(&table);
+}
+
+static void bench_lookups(int devices, int lookups) {
+    ble_device_table_t table;
+    CHECK(ble_device_table_init(&table, (uint16_t)devices));
+
+    static const uint8_t payload[] = {0x02, 0x01, 0x06, 0x03, 0xFF, 0x4C, 0x00};
+    int64_t start = esp_timer_get_time();
+    for (int id = 0; id < devices; id++) {
+        observe(&table, id, 1, -70, payload, sizeof(payload), id);
+    }
+    int64_t insert_us = esp_timer_get_time() - start;
+
+    uint32_t rng = 0x2545F491u, found = 0;
+    uint8_t addr[6];
+    start = esp_timer_get_time();
+    for (int i = 0; i < lookups; i++) {
+        bench_addr(bench_rand(&rng) % devices, addr);
+        found += ble_device_table_find(&table, addr, 1) != NULL;
+    }
+    int64_t lookup_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < lookups; i++) {
+        observe(&table, bench_rand(&rng) % (devices + devices / 4), 1, -70, payload, sizeof(payload), devices + i);
+    }
+    int64_t observe_us = esp_timer_get_time() - start;
+
+    printf("%d devices: insert %lld ns, lookup %lld ns, observe with churn %lld ns each\n", devices,
+           (long long)(insert_us * 1000 / devices), (long long)(lookup_us * 1000 / lookups),
+           (long long)(observe_us * 1000 / lookups));
+    printf("Found %lu of %d, evicted %lu\n", (unsigned long)found, lookups, (unsigned long)table.evicted);
+
+    CHECK_EQ(found, lookups);
+    CHECK(table_consistent(&table));
+    ble_device_table_free(&table);
+}
+
+int main(void) {
+    test_full_table_evicts_least_recent();
+    test_changes_reported_once();
+    test_smoothed_rssi();
+    test_expire();
+    test_random_churn_stays_consistent();
+    bench_lookups(2000, 100000);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,129 @@
+#include "core/ble_pcap.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include <string.h>
+
+// Event type of a scan report to the PDU type in the frame, and channel to RF channel
+static const uint8_t pdu_of_event[] = {0x0, 0x1, 0x6, 0x2, 0x4};
+#define PDU_ADV_DIRECT_IND 0x1
+
+static uint8_t rf_of_channel(uint8_t channel) {
+    return channel == 38 ? 12 : channel == 39 ? 39 : 0;
+}
+
+static uint32_t lcg(uint32_t *s) {
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 16;
+}
+
+// Reads a frame back the way a capture reader would and compares it with the report
+static bool check_frame(const ble_adv_report_t *report, uint8_t channel, const uint8_t *frame, size_t len) {
+    if (len < BLE_PCAP_PHDR_LEN + 4 + 2 + 6 + 3) return false;
+    uint16_t flags = frame[8] | (frame[9] << 8);
+    if (frame[0] != rf_of_channel(channel) || (int8_t)frame[1] != report->rssi) return false;
+    if (!(flags & BLE_PCAP_FLAG_SIGNAL_VALID) || !(flags & BLE_PCAP_FLAG_DEWHITENED)) return false;
+
+    const uint8_t *ll = frame + BLE_PCAP_PHDR_LEN;
+    uint32_t access = ll[0] | (ll[1] << 8) | (ll[2] << 16) | ((uint32_t)ll[3] << 24);
+    if (access != BLE_PCAP_ACCESS_ADDRESS) return false;
+
+    const uint8_t *pdu = ll + 4;
+    uint8_t payload_len = pdu[1];
+    if (BLE_PCAP_PHDR_LEN + 4 + 2 + (size_t)payload_len + 3 != len) return false;
+    if ((pdu[0] & 0x0F) != pdu_of_event[report->event_type]) return false;
+    if (((pdu[0] >> 6) & 1) != (report->addr_type & 1)) return false;
+    if (memcmp(pdu + 2, report->addr, 6) != 0) return false;
+
+    if ((pdu[0] & 0x0F) == PDU_ADV_DIRECT_IND) {
+        if (payload_len != 12 || memcmp(pdu + 8, report->direct_addr, 6) != 0) return false;
+        if (((pdu[0] >> 7) & 1) != (report->direct_addr_type & 1)) return false;
+    } else {
+        if (payload_len != 6 + report->raw.len) return false;
+        if (report->raw.len && memcmp(pdu + 8, report->raw.data, report->raw.len) != 0) return false;
+    }
+
+    uint8_t crc[3];
+    ble_pcap_crc(pdu, 2 + payload_len, crc);
+    return memcmp(pdu + 2 + payload_len, crc, 3) == 0;
+}
+
+static const uint8_t addr[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0xC6};
+static const uint8_t data[] = {0x02, 0x01, 0x06, 0x07, 0x09, 'G', 'h', 'o', 's', 't', '!'};
+
+static void test_fixed_frame(void) {
+    // Hand checked frame: ADV_IND from a random address with flags and a name
+    static const uint8_t expected_crc[3] = {0xAC, 0x38, 0x13};
+    uint8_t frame[BLE_PCAP_MAX_FRAME];
+    ble_adv_report_t report = {.addr = addr, .addr_type = 1, .event_type = 0, .rssi = -60, .raw = {data, sizeof(data)}};
+
+    size_t len = ble_pcap_frame(&report, 38, frame, sizeof(frame));
+    CHECK_EQ(len, BLE_PCAP_PHDR_LEN + 4 + 2 + 17 + 3);
+    CHECK(check_frame(&report, 38, frame, len));
+    CHECK_EQ(frame[BLE_PCAP_PHDR_LEN + 4], 0x40);
+    CHECK(memcmp(frame + len - 3, expected_crc, 3) == 0);
+}
+
+static void test_unwritable_frames(void) {
+    uint8_t frame[BLE_PCAP_MAX_FRAME];
+    uint8_t big[BLE_PCAP_MAX_ADV_DATA + 1] = {0};
+    ble_adv_report_t report = {.addr = addr, .addr_type = 1, .event_type = 0, .rssi = -60, .raw = {big, sizeof(big)}};
+
+    CHECK_EQ(ble_pcap_frame(&report, 37, frame, sizeof(frame)), 0);   // More than a legacy PDU holds
+    report.raw = (ble_adv_span_t){data, sizeof(data)};
+    CHECK_EQ(ble_pcap_frame(&report, 37, frame, 20), 0);              // Short buffer
+    report.event_type = 5;
+    CHECK_EQ(ble_pcap_frame(&report, 37, frame, sizeof(frame)), 0);   // Unknown event type
+}
+
+static void test_random_frames_read_back(int rounds) {
+    uint8_t frame[BLE_PCAP_MAX_FRAME];
+    uint32_t seed = 0x5EED;
+    uint8_t raddr[6], target[6], payload[BLE_PCAP_MAX_ADV_DATA];
+    uint32_t bytes = 0;
+    int bad = 0;
+
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < 6; i++) {
+            raddr[i] = lcg(&seed);
+            target[i] = lcg(&seed);
+        }
+        uint8_t plen = lcg(&seed) % (BLE_PCAP_MAX_ADV_DATA + 1);
+        for (int i = 0; i < plen; i++) {
+            payload[i] = lcg(&seed);
+        }
+        ble_adv_report_t report = {
+            .addr = raddr,
+            .addr_type = lcg(&seed) % 4,
+            .event_type = lcg(&seed) % 5,
+            .rssi = -(int8_t)(lcg(&seed) % 100),
+            .raw = {payload, plen},
+        };
+        if (report.event_type == 1) {
+            report.direct_addr = target;
+            report.direct_addr_type = lcg(&seed) % 2;
+        }
+        uint8_t channel = 37 + lcg(&seed) % 3;
+
+        size_t len = ble_pcap_frame(&report, channel, frame, sizeof(frame));
+        if (len == 0 || !check_frame(&report, channel, frame, len)) {
+            if (bad++ == 0) {
+                fprintf(stderr, "Round %d: frame does not read back (event %u, %u data bytes)\n", r,
+                        report.event_type, plen);
+            }
+        }
+        bytes += len;
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    CHECK_EQ(bad, 0);
+    printf("%d frames, %lu bytes, %lld ns each to build and check\n", rounds, (unsigned long)bytes,
+           rounds ? (long long)(elapsed * 1000 / rounds) : 0ll);
+}
+
+int main(void) {
+    test_fixed_frame();
+    test_unwritable_frames();
+    test_random_frames_read_back(100000);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,304 @@
+#include "core/ble_spam.h"
+#include "core/ble_device_table.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Synthetic traces on a simulated clock. Benign devices keep their address for the whole
+// trace apart from the odd rotation and a steady trickle of passers by, spam uses a fresh
+// random address for nearly every advertisement.
+
+#define REPLAY_EMITTERS     80
+#define REPLAY_CHUNK_MS     250
+#define REPLAY_CHUNK_EVENTS 256
+#define REPLAY_SPAM_MS      5000
+#define REPLAY_SECONDS      30
+
+typedef struct {
+    uint32_t t;
+    uint8_t addr[6];
+    uint8_t addr_type;
+    int8_t rssi;
+    uint8_t len;
+    uint8_t data[31];
+} replay_event_t;
+
+typedef struct {
+    uint16_t company;           // BLE_COMPANY_NONE for no manufacturer data
+    uint8_t type;
+    uint16_t service;           // Service data UUID, 0 for none
+    const char *name;
+    uint8_t body_len;
+    bool random_body;           // New body bytes with every advertisement
+    bool random_company;
+    uint16_t interval_ms;
+    uint32_t rotate_ms;         // Address lifetime, 0 to rotate with every advertisement
+    uint32_t start_ms;
+    uint8_t addr_type;
+    int8_t rssi;
+    uint8_t addr[6];
+    uint8_t body[20];
+    uint32_t next_ms;
+    uint32_t rotated_ms;
+} replay_emitter_t;
+
+typedef struct {
+    replay_emitter_t emitters[REPLAY_EMITTERS];
+    int count;
+    uint32_t rng;
+} replay_trace_t;
+
+static uint32_t replay_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16;
+}
+
+static void random_bytes(uint32_t *rng, uint8_t *out, size_t len) {
+    for (size_t i = 0; i < len; i++) out[i] = (uint8_t)replay_rand(rng);
+}
+
+static replay_emitter_t *add_emitter(replay_trace_t *trace, uint16_t company, uint8_t type, uint16_t service,
+                                     uint16_t interval_ms, uint32_t start_ms) {
+    if (trace->count >= REPLAY_EMITTERS) return NULL;
+    replay_emitter_t *e = &trace->emitters[trace->count++];
+    memset(e, 0, sizeof(*e));
+    e->company = company;
+    e->type = type;
+    e->service = service;
+    e->body_len = 10;
+    e->interval_ms = interval_ms;
+    e->rotate_ms = UINT32_MAX;
+    e->start_ms = start_ms;
+    e->next_ms = start_ms + replay_rand(&trace->rng) % interval_ms;
+    e->rotated_ms = start_ms;
+    e->addr_type = 1;
+    e->rssi = -40 - (int8_t)(replay_rand(&trace->rng) % 50);
+    random_bytes(&trace->rng, e->addr, 6);
+    random_bytes(&trace->rng, e->body, sizeof(e->body));
+    return e;
+}
+
+static void add_benign(replay_trace_t *trace) {
+    replay_emitter_t *e;
+    for (int i = 0; i < 25; i++) {
+        e = add_emitter(trace, 0x004C, 0x10, 0, 200, 0);            // Apple Nearby Info
+        e->rotate_ms = 60000 + replay_rand(&trace->rng) % 120000;
+        e->random_body = i % 3 == 0;
+    }
+    for (int i = 0; i < 10; i++) add_emitter(trace, 0x0075, 0x42, 0, 500, 0);       // Samsung
+    for (int i = 0; i < 5; i++) add_emitter(trace, 0x0006, 0x01, 0, 1000, 0);       // Microsoft CDP
+    for (int i = 0; i < 10; i++) {
+        e = add_emitter(trace, 0x004C, 0x02, 0, 100, 0);            // iBeacons of one deployment
+        e->addr_type = 0;
+        memset(e->body, 0x5A, 16);
+    }
+    for (int i = 0; i < 5; i++) add_emitter(trace, BLE_COMPANY_NONE, 0, 0xFE9F, 1000, 0);
+    for (int i = 0; i < 5; i++) {
+        e = add_emitter(trace, BLE_COMPANY_NONE, 0, 0, 1000, 0);
+        e->name = "Sensor";
+    }
+    for (int i = 0; i < 15; i++) add_emitter(trace, 0x004C, 0x10, 0, 300, 2000 * i);  // Passers by
+}
+
+static uint8_t build_payload(replay_trace_t *trace, replay_emitter_t *e, uint8_t *out) {
+    uint8_t len = 0;
+    out[len++] = 0x02;
+    out[len++] = BLE_AD_FLAGS;
+    out[len++] = 0x1A;
+
+    if (e->random_body) random_bytes(&trace->rng, e->body, sizeof(e->body));
+    if (e->company != BLE_COMPANY_NONE) {
+        uint16_t company = e->random_company ? (uint16_t)replay_rand(&trace->rng) : e->company;
+        out[len++] = (uint8_t)(4 + e->body_len);
+        out[len++] = BLE_AD_MANUFACTURER;
+        out[len++] = (uint8_t)company;
+        out[len++] = (uint8_t)(company >> 8);
+        out[len++] = e->type;
+        memcpy(&out[len], e->body, e->body_len);
+        len += e->body_len;
+    } else if (e->service) {
+        out[len++] = (uint8_t)(3 + e->body_len);
+        out[len++] = BLE_AD_SERVICE_DATA16;
+        out[len++] = (uint8_t)e->service;
+        out[len++] = (uint8_t)(e->service >> 8);
+        memcpy(&out[len], e->body, e->body_len);
+        len += e->body_len;
+    } else if (e->name) {
+        uint8_t n = (uint8_t)strlen(e->name);
+        out[len++] = (uint8_t)(1 + n);
+        out[len++] = BLE_AD_NAME_COMPLETE;
+        memcpy(&out[len], e->name, n);
+        len += n;
+    }
+    return len;
+}
+
+static int compare_events(const void *a, const void *b) {
+    uint32_t ta = ((const replay_event_t *)a)->t, tb = ((const replay_event_t *)b)->t;
+    return ta < tb ? -1 : ta > tb;
+}
+
+static int generate_chunk(replay_trace_t *trace, uint32_t end_ms, replay_event_t *events) {
+    int n = 0;
+    for (int i = 0; i < trace->count; i++) {
+        replay_emitter_t *e = &trace->emitters[i];
+        while (e->next_ms < end_ms && n < REPLAY_CHUNK_EVENTS) {
+            if (e->rotate_ms == 0 || e->next_ms - e->rotated_ms >= e->rotate_ms) {
+                random_bytes(&trace->rng, e->addr, 6);
+                e->rotated_ms = e->next_ms;
+            }
+            replay_event_t *ev = &events[n++];
+            ev->t = e->next_ms;
+            memcpy(ev->addr, e->addr, 6);
+            ev->addr_type = e->addr_type;
+            ev->rssi = (int8_t)(e->rssi - (int8_t)(replay_rand(&trace->rng) % 6));
+            ev->len = build_payload(trace, e, ev->data);
+            e->next_ms += e->interval_ms - e->interval_ms / 8 + replay_rand(&trace->rng) % (e->interval_ms / 4 + 1);
+        }
+    }
+    qsort(events, n, sizeof(*events), compare_events);
+    return n;
+}
+
+typedef struct {
+    const char *name;
+    ble_spam_key_kind_t expect_kind;
+    uint32_t expect_ids[2];     // Vendor keys that must alert, 0 for none or any
+} replay_scenario_t;
+
+static void add_spam(replay_trace_t *trace, int scenario) {
+    replay_emitter_t *e;
+    switch (scenario) {
+        case 1:     // Apple Continuity proximity pairing popups
+            e = add_emitter(trace, 0x004C, 0x07, 0, 20, REPLAY_SPAM_MS);
+            e->rotate_ms = 0;
+            e->random_body = true;
+            break;
+        case 2:     // Samsung and Microsoft Swift Pair interleaved
+            e = add_emitter(trace, 0x0075, 0x42, 0, 120, REPLAY_SPAM_MS);
+            e->rotate_ms = 0;
+            e->random_body = true;
+            e = add_emitter(trace, 0x0006, 0x03, 0, 120, REPLAY_SPAM_MS + 60);
+            e->rotate_ms = 0;
+            e->random_body = true;
+            break;
+        case 3:     // Google Fast Pair model IDs
+            e = add_emitter(trace, BLE_COMPANY_NONE, 0, 0xFE2C, 40, REPLAY_SPAM_MS);
+            e->rotate_ms = 0;
+            e->random_body = true;
+            break;
+        case 4:     // One fixed advertisement from rotating addresses
+            e = add_emitter(trace, BLE_COMPANY_NONE, 0, 0, 150, REPLAY_SPAM_MS);
+            e->name = "FreeWiFi";
+            e->rotate_ms = 0;
+            break;
+        case 5:     // A different made up vendor every time
+            e = add_emitter(trace, 0x0001, 0x00, 0, 30, REPLAY_SPAM_MS);
+            e->rotate_ms = 0;
+            e->random_body = true;
+            e->random_company = true;
+            break;
+        default:
+            break;
+    }
+}
+
+static const replay_scenario_t scenarios[] = {
+    {"benign", BLE_SPAM_KEY_VENDOR, {0, 0}},
+    {"apple", BLE_SPAM_KEY_VENDOR, {0x004C, 0}},
+    {"samsung+microsoft", BLE_SPAM_KEY_VENDOR, {0x0075, 0x0006}},
+    {"fastpair", BLE_SPAM_KEY_VENDOR, {0x10000u | 0xFE2C, 0}},
+    {"same payload", BLE_SPAM_KEY_PAYLOAD, {0, 0}},
+    {"vendor churn", BLE_SPAM_KEY_CHURN, {0, 0}},
+};
+
+static void run_scenario(int s, int seconds, replay_event_t *events, ble_device_table_t *table,
+                         int64_t *busy_us, uint32_t *processed) {
+    static replay_trace_t trace;
+    ble_spam_detector_t detector;
+    const replay_scenario_t *sc = &scenarios[s];
+
+    memset(&trace, 0, sizeof(trace));
+    trace.rng = 0x1234567u + s;
+    add_benign(&trace);
+    add_spam(&trace, s);
+    ble_spam_reset(&detector);
+    ble_device_table_clear(table);
+
+    int alerts = 0, early = 0;
+    bool seen[2] = {sc->expect_ids[0] == 0, sc->expect_ids[1] == 0};
+    bool kind_seen = false;
+    uint32_t first_ms = 0;
+    ble_spam_alert_t first = {0};
+
+    for (uint32_t chunk = 0; chunk < (uint32_t)seconds * 1000; chunk += REPLAY_CHUNK_MS) {
+        int n = generate_chunk(&trace, chunk + REPLAY_CHUNK_MS, events);
+
+        int64_t start = esp_timer_get_time();
+        for (int i = 0; i < n; i++) {
+            replay_event_t *ev = &events[i];
+            ble_adv_report_t report = {
+                .addr = ev->addr, .addr_type = ev->addr_type, .rssi = ev->rssi, .raw = {ev->data, ev->len}};
+            ble_adv_parse(ev->data, ev->len, &report.adv);
+            report.changes = ble_device_table_observe(table, &report, ev->t);
+
+            ble_spam_alert_t alert;
+            if (!ble_spam_observe(&detector, &report, ev->t, &alert)) continue;
+
+            alerts++;
+            if (ev->t < REPLAY_SPAM_MS) early++;
+            uint32_t id = alert.company_id != BLE_COMPANY_NONE ? alert.company_id : 0x10000u | alert.service_uuid;
+            bool expected = alert.kind == sc->expect_kind;
+            for (int j = 0; j < 2; j++) {
+                if (expected && id == sc->expect_ids[j]) seen[j] = true;
+            }
+            if (expected && !kind_seen) {
+                kind_seen = true;
+                first_ms = ev->t;
+                first = alert;
+            }
+        }
+        *busy_us += esp_timer_get_time() - start;
+        *processed += n;
+    }
+
+    if (s == 0) {
+        printf("%-18s %d alerts\n", sc->name, alerts);
+        CHECK_EQ(alerts, 0);
+        return;
+    }
+
+    char what[64] = "none";
+    if (kind_seen) ble_spam_describe(&first, what, sizeof(what));
+    printf("%-18s %d alerts, first after %lu ms: %s, score %u\n", sc->name, alerts,
+           kind_seen ? (unsigned long)(first_ms - REPLAY_SPAM_MS) : 0ul, what, first.score);
+
+    // Nothing before the spam starts, and the expected keys within one window of it
+    CHECK_EQ(early, 0);
+    CHECK(kind_seen);
+    CHECK(seen[0]);
+    CHECK(seen[1]);
+    CHECK(!kind_seen || first_ms - REPLAY_SPAM_MS <= BLE_SPAM_WINDOW_MS);
+}
+
+int main(void) {
+    replay_event_t *events = malloc(REPLAY_CHUNK_EVENTS * sizeof(replay_event_t));
+    ble_device_table_t table;
+    if (events == NULL || !ble_device_table_init(&table, 256)) {
+        fprintf(stderr, "Not enough memory for the replay\n");
+        return 1;
+    }
+
+    int64_t busy_us = 0;
+    uint32_t processed = 0;
+    for (int s = 0; s < (int)(sizeof(scenarios) / sizeof(scenarios[0])); s++) {
+        run_scenario(s, REPLAY_SECONDS, events, &table, &busy_us, &processed);
+    }
+    printf("%lu advertisements, %lld ns each to decode, track and score\n", (unsigned long)processed,
+           processed ? (long long)(busy_us * 1000 / processed) : 0ll);
+
+    ble_device_table_free(&table);
+    free(events);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,202 @@
+#include "core/ble_tracker.h"
+#include "host_test.h"
+#include <string.h>
+
+#define FIND_MY_OFFLINE   0x12
+#define FIND_MY_FULL_LEN  0x19
+#define UUID_TILE         0xFEED
+#define UUID_SMARTTAG     0xFD5A
+#define UUID_GOOGLE_FMDN  0xFEAA
+
+// Scripted timelines. Each tag advertises every `every` seconds between `from` and `to`,
+// changing its address every `rotate` seconds, on a simulated clock.
+
+#define TL_WINDOW_MS  (10 * 60 * 1000)
+
+typedef enum {
+    TL_FIND_MY,
+    TL_TILE,
+    TL_SMARTTAG,
+    TL_FMDN,
+    TL_APPLE_NEARBY,    // Not a tracker
+} tl_format_t;
+
+typedef struct {
+    const char *name;
+    tl_format_t format;
+    uint8_t seed;           // Key, privacy ID or address seed
+    uint32_t from_s, to_s, every_s, rotate_s;
+    uint32_t gap_from_s, gap_to_s;   // Silent stretch, both 0 for none
+    bool expect_following;
+} tl_tag_t;
+
+static uint8_t tl_payload(const tl_tag_t *tag, uint32_t epoch, uint8_t *out) {
+    uint8_t len = 0;
+    out[len++] = 0x02;
+    out[len++] = BLE_AD_FLAGS;
+    out[len++] = 0x06;
+    switch (tag->format) {
+        case TL_FIND_MY:
+            len = 0;                         // A full Find My frame leaves no room for flags
+            out[len++] = 0x1E;
+            out[len++] = BLE_AD_MANUFACTURER;
+            out[len++] = 0x4C;
+            out[len++] = 0x00;
+            out[len++] = FIND_MY_OFFLINE;
+            out[len++] = FIND_MY_FULL_LEN;
+            out[len++] = 0x10;
+            for (int i = 0; i < 22; i++) out[len++] = (uint8_t)(tag->seed * 31 + i);
+            out[len++] = 0x01;
+            out[len++] = (uint8_t)epoch;     // Hint byte, not part of the identity
+            break;
+        case TL_TILE:
+            out[len++] = 0x03;
+            out[len++] = BLE_AD_UUID16_COMPLETE;
+            out[len++] = (uint8_t)UUID_TILE;
+            out[len++] = (uint8_t)(UUID_TILE >> 8);
+            break;
+        case TL_SMARTTAG:
+            out[len++] = 0x11;
+            out[len++] = BLE_AD_SERVICE_DATA16;
+            out[len++] = (uint8_t)UUID_SMARTTAG;
+            out[len++] = (uint8_t)(UUID_SMARTTAG >> 8);
+            out[len++] = 0x10;
+            out[len++] = (uint8_t)epoch;     // Aging counter
+            out[len++] = 0;
+            out[len++] = 0;
+            for (int i = 0; i < 8; i++) out[len++] = (uint8_t)(tag->seed + i);
+            out[len++] = 0;
+            out[len++] = 0;
+            break;
+        case TL_FMDN:
+            out[len++] = 0x18;
+            out[len++] = BLE_AD_SERVICE_DATA16;
+            out[len++] = (uint8_t)UUID_GOOGLE_FMDN;
+            out[len++] = (uint8_t)(UUID_GOOGLE_FMDN >> 8);
+            out[len++] = 0x41;
+            for (int i = 0; i < 20; i++) out[len++] = (uint8_t)(tag->seed ^ (i * 7));
+            out[len++] = 0;
+            break;
+        case TL_APPLE_NEARBY:
+            out[len++] = 0x07;
+            out[len++] = BLE_AD_MANUFACTURER;
+            out[len++] = 0x4C;
+            out[len++] = 0x00;
+            out[len++] = 0x10;
+            out[len++] = 0x02;
+            out[len++] = tag->seed;
+            out[len++] = (uint8_t)epoch;
+            break;
+    }
+    return len;
+}
+
+static const tl_tag_t timeline[] = {
+    // Travels along the whole time, key constant as for a tag away from its owner
+    {"airtag along", TL_FIND_MY, 1, 0, 1800, 2, 900, 0, 0, true},
+    // Passes by for three minutes
+    {"airtag passing", TL_FIND_MY, 2, 300, 480, 2, 0, 0, 0, false},
+    // Heard now and then, a neighbour's tag through a wall
+    {"airtag sporadic", TL_FIND_MY, 3, 0, 1800, 240, 0, 0, 0, false},
+    // Static address
+    {"tile along", TL_TILE, 4, 60, 1800, 5, 0, 0, 0, true},
+    // Rotates its address every 15 minutes, the privacy ID stays
+    {"smarttag along", TL_SMARTTAG, 5, 0, 1800, 3, 900, 0, 0, true},
+    // Seen in the morning and again much later, never a whole window at once
+    {"smarttag twice", TL_SMARTTAG, 6, 0, 1620, 3, 0, 420, 1200, false},
+    {"fmdn along", TL_FMDN, 7, 200, 1800, 4, 1024, 0, 0, true},
+    {"iphone", TL_APPLE_NEARBY, 8, 0, 1800, 1, 0, 0, 0, false},
+};
+#define TL_TAGS (sizeof(timeline) / sizeof(timeline[0]))
+
+static void feed(ble_tracker_t *t, const uint8_t *data, uint8_t len, const uint8_t addr[6], int8_t rssi,
+                 uint32_t now_ms, ble_tracker_event_t *event, const ble_tracker_entry_t **entry) {
+    ble_adv_report_t report = {.addr = addr, .addr_type = 1, .rssi = rssi, .raw = {data, len}};
+    ble_adv_parse(data, len, &report.adv);
+    *event = ble_tracker_observe(t, &report, now_ms, entry);
+}
+
+static void test_timeline(void) {
+    static ble_tracker_t tracker;
+    ble_tracker_init(&tracker, TL_WINDOW_MS);
+
+    bool following[TL_TAGS] = {0};
+    uint32_t flagged_at[TL_TAGS] = {0};
+    uint16_t addresses[TL_TAGS] = {0};
+    uint8_t data[31], addr[6];
+
+    for (uint32_t s = 0; s <= 1800; s++) {
+        for (size_t i = 0; i < TL_TAGS; i++) {
+            const tl_tag_t *tag = &timeline[i];
+            if (s < tag->from_s || s > tag->to_s || (s - tag->from_s) % tag->every_s != 0) continue;
+            if (s >= tag->gap_from_s && s < tag->gap_to_s) continue;
+
+            uint32_t epoch = tag->rotate_s ? s / tag->rotate_s : 0;
+            memset(addr, 0, sizeof(addr));
+            addr[0] = tag->seed;
+            addr[1] = (uint8_t)epoch;
+            addr[5] = 0xC0;
+            uint8_t len = tl_payload(tag, epoch, data);
+
+            ble_tracker_event_t event;
+            const ble_tracker_entry_t *entry = NULL;
+            feed(&tracker, data, len, addr, (int8_t)(-50 - (s % 7)), s * 1000, &event, &entry);
+            if (event == BLE_TRACKER_EVENT_FOLLOWING) {
+                following[i] = true;
+                flagged_at[i] = s;
+            }
+            if (entry) addresses[i] = entry->addresses;
+        }
+    }
+
+    for (size_t i = 0; i < TL_TAGS; i++) {
+        printf("%-16s %-9s", timeline[i].name, following[i] ? "following" : "-");
+        if (following[i]) printf(" after %lu s, %u addresses", (unsigned long)(flagged_at[i] - timeline[i].from_s),
+                                 addresses[i]);
+        printf("\n");
+        if (following[i] != timeline[i].expect_following) {
+            fprintf(stderr, "%s: expected %s\n", timeline[i].name,
+                    timeline[i].expect_following ? "following" : "not following");
+            host_test_failures++;
+        }
+    }
+}
+
+static void test_crowd_keeps_follower(void) {
+    // Far more passing tags than entries, the one travelling along must stay
+    static ble_tracker_t tracker;
+    ble_tracker_init(&tracker, TL_WINDOW_MS);
+    tl_tag_t along = {"along", TL_FIND_MY, 200, 0, 900, 5, 0, 0, 0, true};
+    tl_tag_t crowd = {"crowd", TL_FIND_MY, 0, 0, 900, 1, 0, 0, 0, false};
+    uint8_t data[31], addr[6] = {0xAA, 0, 0, 0, 0, 0xC0};
+    bool flagged = false;
+
+    for (uint32_t s = 0; s <= 900; s++) {
+        ble_tracker_event_t event;
+        const ble_tracker_entry_t *entry;
+        if (s % along.every_s == 0) {
+            uint8_t len = tl_payload(&along, 0, data);
+            feed(&tracker, data, len, addr, -55, s * 1000, &event, &entry);
+            flagged |= event == BLE_TRACKER_EVENT_FOLLOWING;
+        }
+        crowd.seed = (uint8_t)(s % 150);    // 150 tags in rotation, each heard every 150 s
+        addr[0] = crowd.seed;
+        uint8_t len = tl_payload(&crowd, 0, data);
+        feed(&tracker, data, len, addr, -80, s * 1000, &event, &entry);
+    }
+
+    printf("crowd            %u trackers kept, %lu evicted, travelling tag %s\n", tracker.count,
+           (unsigned long)tracker.evicted, flagged ? "flagged" : "MISSED");
+    CHECK(flagged);
+    CHECK_EQ(tracker.count, BLE_TRACKER_MAX);
+    CHECK(tracker.evicted > 0);
+}
+
+int main(void) {
+    printf("Tracker timelines, %d minute window:\n", TL_WINDOW_MS / 60000);
+    test_timeline();
+    test_crowd_keeps_follower();
+    printf("%u bytes per tracker, %u for the list\n", (unsigned)sizeof(ble_tracker_entry_t),
+           (unsigned)sizeof(ble_tracker_t));
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+#include "core/channel_stats.h"
+#include "host_test.h"
+
+// First frame control byte of common frames
+#define FC_BEACON    0x80  // Management, subtype 8
+#define FC_PROBE_REQ 0x40
+#define FC_ACK       0xD4  // Control, subtype 13
+#define FC_RTS       0xB4
+#define FC_QOS_DATA  0x88  // Data, subtype 8
+#define FC_EXTENSION 0x0C  // Type 3
+
+typedef struct {
+    uint8_t channel;
+    uint8_t frame_control;
+    int8_t rssi;
+    int count;
+} burst_t;
+
+static void feed(channel_stats_t *stats, const burst_t *bursts, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < bursts[i].count; k++) {
+            channel_stats_record(stats, bursts[i].channel, channel_stats_frame_type(bursts[i].frame_control),
+                                 bursts[i].rssi);
+        }
+    }
+}
+
+static void test_classify(void) {
+    CHECK_EQ(channel_stats_frame_type(FC_BEACON), CHANNEL_FRAME_MGMT);
+    CHECK_EQ(channel_stats_frame_type(FC_PROBE_REQ), CHANNEL_FRAME_MGMT);
+    CHECK_EQ(channel_stats_frame_type(FC_ACK), CHANNEL_FRAME_CTRL);
+    CHECK_EQ(channel_stats_frame_type(FC_RTS), CHANNEL_FRAME_CTRL);
+    CHECK_EQ(channel_stats_frame_type(FC_QOS_DATA), CHANNEL_FRAME_DATA);
+    CHECK_EQ(channel_stats_frame_type(FC_EXTENSION), CHANNEL_FRAME_MISC);
+
+    CHECK_EQ(channel_stats_rssi_bucket(-30), 0);
+    CHECK_EQ(channel_stats_rssi_bucket(-40), 0);
+    CHECK_EQ(channel_stats_rssi_bucket(-41), 1);
+    CHECK_EQ(channel_stats_rssi_bucket(-55), 1);
+    CHECK_EQ(channel_stats_rssi_bucket(-70), 2);
+    CHECK_EQ(channel_stats_rssi_bucket(-85), 3);
+    CHECK_EQ(channel_stats_rssi_bucket(-86), 4);
+    CHECK_EQ(channel_stats_rssi_bucket(-128), 4);
+}
+
+static void test_fixed_channel(void) {
+    // One second on channel 6 without hopping: a busy AP, its clients and some noise
+    static const burst_t second[] = {
+        {6, FC_BEACON, -45, 10},
+        {6, FC_QOS_DATA, -60, 200},
+        {6, FC_ACK, -60, 180},
+        {6, FC_PROBE_REQ, -88, 10},
+        {6, FC_EXTENSION, -75, 0},
+        {0, FC_BEACON, -50, 3},      // Channels the radio should not report
+        {15, FC_BEACON, -50, 2},
+    };
+    channel_stats_t stats;
+    channel_stats_counts_t prev, cur, delta;
+    channel_summary_t sum;
+
+    channel_stats_reset(&stats);
+    channel_stats_snapshot(&stats, &prev);
+    feed(&stats, second, 7);
+    channel_stats_snapshot(&stats, &cur);
+    channel_stats_delta(&prev, &cur, &delta);
+
+    CHECK_EQ(atomic_load(&stats.ignored), 5);
+    CHECK(channel_stats_summarize(&delta, 6, 1000, &sum));
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_MGMT], 20);
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_DATA], 200);
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_CTRL], 180);
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_MISC], 0);
+    CHECK_EQ(sum.total_rate, 400);
+
+    // 10 strong, 380 middling, 10 weak out of 400
+    CHECK_EQ(sum.rssi_share[0], 0);
+    CHECK_EQ(sum.rssi_share[1], 10 * 255 / 400);
+    CHECK_EQ(sum.rssi_share[2], 380 * 255 / 400);
+    CHECK_EQ(sum.rssi_share[3], 0);
+    CHECK_EQ(sum.rssi_share[4], 10 * 255 / 400);
+
+    // The same counts over half the time are twice the rate
+    CHECK(channel_stats_summarize(&delta, 6, 500, &sum));
+    CHECK_EQ(sum.total_rate, 800);
+
+    // Quiet channels have a rate of zero, no time at all or a bad channel has none
+    CHECK(channel_stats_summarize(&delta, 1, 1000, &sum));
+    CHECK_EQ(sum.total_rate, 0);
+    CHECK_EQ(sum.rssi_share[0], 0);
+    CHECK(!channel_stats_summarize(&delta, 6, 0, &sum));
+    CHECK(!channel_stats_summarize(&delta, 0, 1000, &sum));
+    CHECK(!channel_stats_summarize(&delta, 15, 1000, &sum));
+}
+
+static void test_hopping(void) {
+    // Hops over 1, 6 and 11 for 100 ms each, five rounds, with traffic only while tuned in
+    channel_stats_t stats;
+    channel_stats_counts_t prev, cur, delta;
+    channel_summary_t sum;
+    static const uint8_t hops[] = {1, 6, 11};
+
+    channel_stats_reset(&stats);
+    channel_stats_snapshot(&stats, &prev);
+    for (int round = 0; round < 5; round++) {
+        for (int h = 0; h < 3; h++) {
+            burst_t burst[] = {
+                {hops[h], FC_BEACON, -50, 1 + h},
+                {hops[h], FC_QOS_DATA, -65, 4 * h},
+            };
+            feed(&stats, burst, 2);
+            channel_stats_add_dwell(&stats, hops[h], 100);
+        }
+    }
+    channel_stats_add_dwell(&stats, 0, 100);   // Ignored
+    channel_stats_snapshot(&stats, &cur);
+    channel_stats_delta(&prev, &cur, &delta);
+
+    // Rates are taken over the 500 ms spent on each channel, not the 1.5 s of wall time
+    CHECK_EQ(delta.dwell_ms[0], 500);
+    CHECK(channel_stats_summarize(&delta, 1, 0, &sum));
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_MGMT], 10);
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_DATA], 0);
+    CHECK(channel_stats_summarize(&delta, 11, 0, &sum));
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_MGMT], 30);
+    CHECK_EQ(sum.rate[CHANNEL_FRAME_DATA], 80);
+    CHECK_EQ(sum.rssi_share[1], 15 * 255 / 55);
+    CHECK_EQ(sum.rssi_share[2], 40 * 255 / 55);
+
+    // A channel the radio never reached has no window while hopping
+    CHECK(!channel_stats_summarize(&delta, 3, 0, &sum));
+}
+
+static void test_delta_wraps(void) {
+    channel_stats_counts_t prev = {0}, cur = {0}, delta;
+    prev.frames[5][CHANNEL_FRAME_DATA] = UINT32_MAX - 9;
+    cur.frames[5][CHANNEL_FRAME_DATA] = 20;
+    prev.rssi[5][2] = UINT32_MAX - 9;
+    cur.rssi[5][2] = 20;
+    prev.dwell_ms[5] = UINT32_MAX - 99;
+    cur.dwell_ms[5] = 900;
+    channel_stats_delta(&prev, &cur, &delta);
+    CHECK_EQ(delta.frames[5][CHANNEL_FRAME_DATA], 30);
+    CHECK_EQ(delta.rssi[5][2], 30);
+    CHECK_EQ(delta.dwell_ms[5], 1000);
+
+    channel_summary_t sum;
+    CHECK(channel_stats_summarize(&delta, 6, 0, &sum));
+    CHECK_EQ(sum.total_rate, 30);
+    CHECK_EQ(sum.rssi_share[2], 255);
+}
+
+int main(void) {
+    test_classify();
+    test_fixed_channel();
+    test_hopping();
+    test_delta_wraps();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,110 @@
+#include "core/device_table.h"
+#include "host_test.h"
+#include <string.h>
+
+static void mac_of(int n, uint8_t mac[6]) {
+    // Shared OUI, so the hash has only the low bytes to spread on
+    uint8_t m[6] = {0x24, 0x0A, 0xC4, (uint8_t)(n >> 16), (uint8_t)(n >> 8), (uint8_t)n};
+    memcpy(mac, m, 6);
+}
+
+static bool find(device_table_t *table, int n, device_entry_t *out) {
+    uint8_t mac[6];
+    mac_of(n, mac);
+    for (uint16_t i = 0; i < table->count; i++) {
+        if (device_table_get(table, i, out) && memcmp(out->mac, mac, 6) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_refresh_keeps_entry(void) {
+    device_table_t table;
+    device_table_init(&table, DEVICE_KIND_STATION, 8);
+    uint8_t mac[6], peer[6] = {2, 0, 0, 0, 0, 1};
+    mac_of(1, mac);
+
+    CHECK(device_table_upsert(&table, mac, -60, 6, NULL, peer, 1000));
+    uint32_t version = table.version;
+    CHECK(device_table_upsert(&table, mac, -60, 6, NULL, NULL, 1200));
+    CHECK_EQ(table.version, version);     // Same reading within a second
+    CHECK(device_table_upsert(&table, mac, -50, 0, NULL, NULL, 1300));
+    CHECK(table.version != version);
+    CHECK_EQ(table.count, 1);
+
+    device_entry_t e;
+    CHECK(device_table_get(&table, 0, &e));
+    CHECK_EQ(e.rssi, -50);
+    CHECK_EQ(e.channel, 6);               // Unknown channel keeps the known one
+    CHECK(memcmp(e.peer, peer, 6) == 0);
+    device_table_free(&table);
+}
+
+static void test_full_table_evicts_oldest(void) {
+    device_table_t table;
+    device_table_init(&table, DEVICE_KIND_STATION, 16);
+    device_entry_t e;
+
+    for (int n = 0; n < 16; n++) {
+        uint8_t mac[6];
+        mac_of(n, mac);
+        CHECK(device_table_upsert(&table, mac, -70, 1, NULL, NULL, 1000 + n * 10));
+    }
+    // Device 0 is heard again, so device 1 becomes the oldest
+    uint8_t mac[6];
+    mac_of(0, mac);
+    device_table_upsert(&table, mac, -70, 1, NULL, NULL, 5000);
+
+    mac_of(100, mac);
+    CHECK(device_table_upsert(&table, mac, -40, 1, NULL, NULL, 6000));
+    CHECK_EQ(table.count, 16);
+    CHECK_EQ(table.evicted, 1);
+    CHECK(!find(&table, 1, &e));
+    CHECK(find(&table, 0, &e));
+    CHECK(find(&table, 100, &e));
+    CHECK_EQ(e.rssi, -40);
+
+    // The new device took the old one's entry and the hash still finds everyone
+    for (int n = 0; n < 16; n++) {
+        if (n == 1) continue;
+        mac_of(n, mac);
+        uint16_t before = table.count;
+        device_table_upsert(&table, mac, -70, 1, NULL, NULL, 7000);
+        CHECK_EQ(table.count, before);
+    }
+    CHECK_EQ(table.evicted, 1);
+    device_table_free(&table);
+}
+
+static void test_churn_keeps_index_consistent(void) {
+    // Many more devices than entries, the most recent ones must always be found
+    device_table_t table;
+    device_table_init(&table, DEVICE_KIND_STATION, 32);
+    device_entry_t e;
+
+    for (int n = 0; n < 2000; n++) {
+        uint8_t mac[6];
+        mac_of(n * 7919, mac);
+        CHECK(device_table_upsert(&table, mac, -70, 1, NULL, NULL, (uint32_t)n * 100));
+    }
+    CHECK_EQ(table.count, 32);
+    CHECK_EQ(table.evicted, 2000 - 32);
+    for (int n = 2000 - 32; n < 2000; n++) {
+        CHECK(find(&table, n * 7919, &e));
+        // Refreshing a tracked device must not evict anything
+        device_table_upsert(&table, e.mac, -70, 1, NULL, NULL, 300000);
+    }
+    CHECK_EQ(table.evicted, 2000 - 32);
+
+    device_sort_key_t keys[32];
+    CHECK_EQ(device_table_sorted(&table, DEVICE_SORT_LAST_SEEN, keys, 32), 32);
+    device_table_free(&table);
+}
+
+int main(void) {
+    test_refresh_keeps_entry();
+    test_full_table_evicts_oldest();
+    test_churn_keeps_index_consistent();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+#include "managers/views/flappy_ghost_physics.h"
+#include "host_test.h"
+#include <string.h>
+
+// The medium screen settings flappy_ghost.c derives for a 320x240 panel
+static const flappy_physics_config_t config = {
+    .screen_width = 320,
+    .screen_height = 240,
+    .step_ms = 25,
+    .pipe_speed = 3,
+    .pipe_width = 30,
+    .gravity = 2.0f,
+    .flap_strength = -10.0f,
+    .pipe_gap = 72,
+    .pipe_min_gap_y = 12,
+    .pipe_max_gap_y = 144,
+    .bird_x = 80,
+    .bird_size = 32,
+    .ground_height = 24,
+    .buffer_top = 60,
+    .buffer_bottom = 12,
+    .collision_padding = 4,
+};
+
+static bool gaps_in_range(const flappy_physics_t *game) {
+    for (int i = 0; i < FLAPPY_MAX_PIPES; i++) {
+        int gap = game->pipes[i].gap_center_y;
+        if (gap < config.pipe_min_gap_y || gap > config.pipe_max_gap_y) return false;
+    }
+    return true;
+}
+
+// Flaps when the bird sinks below the gap of the next pipe, good enough to fly forever
+static void autopilot(flappy_physics_t *game) {
+    int next = -1;
+    for (int i = 0; i < FLAPPY_MAX_PIPES; i++) {
+        if (game->pipes[i].x + config.pipe_width >= config.bird_x &&
+            (next < 0 || game->pipes[i].x < game->pipes[next].x)) {
+            next = i;
+        }
+    }
+    int target = next >= 0 ? game->pipes[next].gap_center_y : config.screen_height / 2;
+    if (game->bird_y > target && game->bird_velocity >= 0) {
+        flappy_physics_flap(game);
+    }
+}
+
+static void test_free_fall(void) {
+    flappy_physics_t game;
+    flappy_physics_reset(&game, &config, 42);
+    CHECK_EQ(game.bird_y, 120);
+    CHECK_EQ(game.pipes[0].x, 320);
+    CHECK_EQ(game.pipes[1].x, 480);
+    CHECK(gaps_in_range(&game));
+
+    // Falling 2, 4, 6 ... pixels per step hits the ground on the ninth step
+    static const int expected_y[] = {122, 126, 132, 140, 150, 162, 176, 192};
+    for (int i = 0; i < 8; i++) {
+        CHECK_EQ(flappy_physics_step(&game), 0);
+        CHECK_EQ(game.bird_y, expected_y[i]);
+    }
+    CHECK_EQ(flappy_physics_step(&game), FLAPPY_EVENT_GAME_OVER);
+    CHECK(game.game_over);
+    CHECK_EQ(game.steps, 9);
+
+    // A finished game is frozen and ignores flaps
+    int y = game.bird_y;
+    flappy_physics_flap(&game);
+    CHECK_EQ(flappy_physics_step(&game), 0);
+    CHECK_EQ(game.bird_y, y);
+    CHECK_EQ(game.steps, 9);
+}
+
+static void test_flap_and_ceiling(void) {
+    flappy_physics_t game;
+    flappy_physics_reset(&game, &config, 42);
+
+    flappy_physics_flap(&game);
+    CHECK_EQ(flappy_physics_bird_angle(&game), -450);  // Clamped at 45 degrees nose up
+    CHECK_EQ(flappy_physics_step(&game), 0);
+    CHECK_EQ(game.bird_y, 112);
+
+    // Flapping every step climbs 8 pixels a step until the bird leaves the top buffer
+    uint32_t events = 0;
+    while (!(events & FLAPPY_EVENT_GAME_OVER) && game.steps < 100) {
+        flappy_physics_flap(&game);
+        events = flappy_physics_step(&game);
+    }
+    CHECK_EQ(game.steps, 23);
+    CHECK(game.bird_y <= -config.buffer_top);
+
+    flappy_physics_reset(&game, &config, 42);
+    game.bird_velocity = 4.0f;
+    CHECK_EQ(flappy_physics_bird_angle(&game), 200);
+}
+
+static void test_pipe_collision(void) {
+    flappy_physics_t game;
+    flappy_physics_reset(&game, &config, 7);
+
+    // Park the bird low in front of a pipe and keep it there
+    game.pipes[0].gap_center_y = config.pipe_min_gap_y;
+    uint32_t events = 0;
+    while (!(events & FLAPPY_EVENT_GAME_OVER) && game.steps < 200) {
+        game.bird_y = 150;
+        game.bird_velocity = -config.gravity;
+        events = flappy_physics_step(&game);
+    }
+    CHECK(events & FLAPPY_EVENT_GAME_OVER);
+
+    // Game over on the first step the padded boxes touch
+    flappy_rect_t bird, pipe;
+    flappy_physics_bird_rect(&game, &bird);
+    flappy_physics_pipe_rect(&game, 0, &pipe);
+    CHECK(pipe.x1 <= bird.x2 + config.collision_padding);
+    CHECK(pipe.x1 + config.pipe_speed > bird.x2 + config.collision_padding);
+}
+
+static uint32_t run_autopilot(uint32_t seed, int steps, flappy_physics_t *game) {
+    // Folds every step's state into one value, a replay has to match it exactly
+    uint32_t trace = 2166136261u;
+    flappy_physics_reset(game, &config, seed);
+    for (int i = 0; i < steps && !game->game_over; i++) {
+        autopilot(game);
+        uint32_t events = flappy_physics_step(game);
+        uint32_t words[] = {(uint32_t)game->bird_y, (uint32_t)game->pipes[0].x, (uint32_t)game->pipes[0].gap_center_y,
+                            (uint32_t)game->pipes[1].gap_center_y, events};
+        for (size_t w = 0; w < sizeof(words) / sizeof(words[0]); w++) {
+            trace = (trace ^ words[w]) * 16777619u;
+        }
+        if (!gaps_in_range(game)) {
+            CHECK(gaps_in_range(game));
+            break;
+        }
+    }
+    return trace;
+}
+
+static void test_deterministic_replay(void) {
+    flappy_physics_t a, b;
+    uint32_t trace_a = run_autopilot(1234, 5000, &a);
+    uint32_t trace_b = run_autopilot(1234, 5000, &b);
+    CHECK_EQ(trace_a, trace_b);
+    CHECK(memcmp(a.pipes, b.pipes, sizeof(a.pipes)) == 0);
+    CHECK_EQ(a.score, b.score);
+
+    // The autopilot survives, and every pipe that leaves the screen scores once
+    CHECK(!a.game_over);
+    CHECK_EQ(a.steps, 5000);
+    CHECK_EQ(a.score, 84);
+    CHECK_EQ(trace_a, 0x52d6d2bd);  // Golden run, changes whenever the physics do
+
+    // Another seed lays the pipes out differently, seed 0 behaves as seed 1
+    CHECK(trace_a != run_autopilot(99, 5000, &b));
+    flappy_physics_reset(&a, &config, 0);
+    flappy_physics_reset(&b, &config, 1);
+    CHECK_EQ(a.pipes[0].gap_center_y, b.pipes[0].gap_center_y);
+    CHECK_EQ(a.pipes[1].gap_center_y, b.pipes[1].gap_center_y);
+}
+
+int main(void) {
+    test_free_fall();
+    test_flap_and_ceiling();
+    test_pipe_collision();
+    test_deterministic_replay();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,111 @@
+#include "ili9341_window.h"
+#include "host_test.h"
+#include <string.h>
+
+// What the flush puts on the bus besides pixels, as ili9341_flush() queues it
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+} bus_cost_t;
+
+static uint8_t flush(ili9341_window_t *win, int x1, int y1, int x2, int y2, int page_end,
+                     ili9341_window_cmd_t *cmds, bus_cost_t *cost) {
+    uint8_t n = ili9341_window_commands(win, x1, y1, x2, y2, page_end, cmds);
+    for (uint8_t i = 0; i < n; i++) {
+        cost->transactions += 1 + (cmds[i].len ? 1 : 0);
+        cost->bytes += 1 + cmds[i].len;
+    }
+    return n;
+}
+
+static bool is_cmd(const ili9341_window_cmd_t *c, uint8_t cmd, const uint8_t *data, uint8_t len) {
+    return c->cmd == cmd && c->len == len && (len == 0 || memcmp(c->data, data, len) == 0);
+}
+
+static void test_first_flush_sets_window(void) {
+    ili9341_window_t win = {0};
+    ili9341_window_cmd_t cmds[ILI9341_WINDOW_MAX_CMDS];
+    bus_cost_t cost = {0};
+
+    // Landscape 320x240, so the columns need both address bytes
+    CHECK_EQ(flush(&win, 0, 0, 319, 23, 239, cmds, &cost), 3);
+    CHECK(is_cmd(&cmds[0], ILI9341_CMD_CASET, (const uint8_t[]){0x00, 0x00, 0x01, 0x3F}, 4));
+    CHECK(is_cmd(&cmds[1], ILI9341_CMD_PASET, (const uint8_t[]){0x00, 0x00, 0x00, 0xEF}, 4));
+    CHECK(is_cmd(&cmds[2], ILI9341_CMD_RAMWR, NULL, 0));
+    CHECK_EQ(cost.transactions, 5);
+    CHECK_EQ(cost.bytes, 11);
+}
+
+static void test_bands_continue(void) {
+    ili9341_window_t win = {0};
+    ili9341_window_cmd_t cmds[ILI9341_WINDOW_MAX_CMDS];
+    bus_cost_t cost = {0};
+
+    // A full frame drawn in ten 24 row bands sets the window once
+    flush(&win, 0, 0, 319, 23, 239, cmds, &cost);
+    for (int band = 1; band < 10; band++) {
+        CHECK_EQ(flush(&win, 0, band * 24, 319, band * 24 + 23, 239, cmds, &cost), 1);
+        CHECK(is_cmd(&cmds[0], ILI9341_CMD_RAMWR_CONT, NULL, 0));
+    }
+    CHECK_EQ(cost.transactions, 5 + 9);
+    CHECK_EQ(cost.bytes, 11 + 9);
+
+    // Each flush used to send CASET, PASET and RAMWR with their arguments
+    printf("Full frame in 10 bands: %u transactions, %u bytes of commands (was 50 and 110)\n",
+           (unsigned)cost.transactions, (unsigned)cost.bytes);
+}
+
+static void test_window_changes(void) {
+    ili9341_window_t win = {0};
+    ili9341_window_cmd_t cmds[ILI9341_WINDOW_MAX_CMDS];
+    bus_cost_t cost = {0};
+
+    flush(&win, 8, 16, 15, 23, 239, cmds, &cost);
+
+    // Same columns further down skips CASET only
+    CHECK_EQ(flush(&win, 8, 100, 15, 107, 239, cmds, &cost), 2);
+    CHECK(is_cmd(&cmds[0], ILI9341_CMD_PASET, (const uint8_t[]){0x00, 100, 0x00, 0xEF}, 4));
+    CHECK(is_cmd(&cmds[1], ILI9341_CMD_RAMWR, NULL, 0));
+
+    // Same columns above the previous band must not continue
+    CHECK_EQ(flush(&win, 8, 50, 15, 57, 239, cmds, &cost), 2);
+    CHECK_EQ(cmds[1].cmd, ILI9341_CMD_RAMWR);
+
+    // Other columns, even when the rows follow on, set the whole window
+    CHECK_EQ(flush(&win, 9, 58, 15, 65, 239, cmds, &cost), 3);
+    CHECK(is_cmd(&cmds[0], ILI9341_CMD_CASET, (const uint8_t[]){0x00, 9, 0x00, 15}, 4));
+
+    // Any other command drops the window
+    ili9341_window_invalidate(&win);
+    CHECK_EQ(flush(&win, 9, 66, 15, 73, 239, cmds, &cost), 3);
+
+    // An area reaching past the page end keeps its own last row
+    CHECK_EQ(flush(&win, 0, 200, 15, 300, 239, cmds, &cost), 3);
+    CHECK(is_cmd(&cmds[1], ILI9341_CMD_PASET, (const uint8_t[]){0x00, 200, 0x01, 0x2C}, 4));
+}
+
+static void test_scattered_squares(void) {
+    // 8x8 squares all over the screen, the cost flushbench reports as fixed per flush
+    ili9341_window_t win = {0};
+    ili9341_window_cmd_t cmds[ILI9341_WINDOW_MAX_CMDS];
+    bus_cost_t cost = {0};
+    uint32_t x = 7, y = 3;
+    for (int i = 0; i < 1000; i++) {
+        x = (x * 37 + 11) % 40;
+        y = (y * 29 + 5) % 30;
+        flush(&win, (int)x * 8, (int)y * 8, (int)x * 8 + 7, (int)y * 8 + 7, 239, cmds, &cost);
+    }
+    // Never more than the old sequence
+    CHECK(cost.transactions <= 1000 * 5);
+    CHECK(cost.bytes <= 1000 * 11);
+    printf("1000 scattered 8x8 flushes: %u transactions, %u bytes of commands (was 5000 and 11000)\n",
+           (unsigned)cost.transactions, (unsigned)cost.bytes);
+}
+
+int main(void) {
+    test_first_flush_sets_window();
+    test_bands_continue();
+    test_window_changes();
+    test_scattered_squares();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,105 @@
+#include "core/input_debounce.h"
+#include "host_test.h"
+
+// The timings display_manager gives the select button and the directions
+static const input_debounce_config_t select_config = {
+    .debounce_ms = 20,
+    .long_press_ms = 600,
+};
+
+static const input_debounce_config_t direction_config = {
+    .debounce_ms = 20,
+    .repeat_delay_ms = 400,
+    .repeat_interval_ms = 120,
+};
+
+static void test_first_press_not_delayed(void) {
+    input_debounce_t db;
+    input_debounce_init(&db, &select_config);
+    CHECK_EQ(input_debounce_next_deadline(&db, 0), INPUT_DEBOUNCE_IDLE);
+    CHECK_EQ(input_debounce_update(&db, true, 0), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_update(&db, true, 0), INPUT_DEBOUNCE_NONE);
+}
+
+static void test_bounce(void) {
+    input_debounce_t db;
+    input_debounce_init(&db, &select_config);
+
+    // Contact chatter inside the lockout is ignored
+    CHECK_EQ(input_debounce_update(&db, true, 1000), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_update(&db, false, 1005), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_update(&db, true, 1008), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_update(&db, true, 1030), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_update(&db, false, 1100), INPUT_DEBOUNCE_RELEASE);
+
+    // A release that lands in the lockout is resolved once it expires, the caller is told when
+    CHECK_EQ(input_debounce_update(&db, true, 2000), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_update(&db, false, 2005), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_next_deadline(&db, 2005), 15);
+    CHECK_EQ(input_debounce_update(&db, false, 2020), INPUT_DEBOUNCE_RELEASE);
+    CHECK_EQ(input_debounce_update(&db, false, 2021), INPUT_DEBOUNCE_NONE);
+}
+
+static void test_long_press(void) {
+    input_debounce_t db;
+    input_debounce_init(&db, &select_config);
+
+    CHECK_EQ(input_debounce_update(&db, true, 3000), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_next_deadline(&db, 3000), 600);
+    CHECK_EQ(input_debounce_update(&db, true, 3599), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_update(&db, true, 3600), INPUT_DEBOUNCE_LONG_PRESS);
+
+    // Sent once per hold, and select never repeats
+    CHECK_EQ(input_debounce_update(&db, true, 5000), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_next_deadline(&db, 5000), INPUT_DEBOUNCE_IDLE);
+    CHECK_EQ(input_debounce_update(&db, false, 5100), INPUT_DEBOUNCE_RELEASE);
+
+    // A short tap does not long press
+    CHECK_EQ(input_debounce_update(&db, true, 6000), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_update(&db, false, 6100), INPUT_DEBOUNCE_RELEASE);
+    CHECK_EQ(input_debounce_update(&db, false, 6700), INPUT_DEBOUNCE_NONE);
+
+    // The next hold gets its own long press
+    CHECK_EQ(input_debounce_update(&db, true, 7000), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_update(&db, true, 7600), INPUT_DEBOUNCE_LONG_PRESS);
+}
+
+static void test_repeat(void) {
+    input_debounce_t db;
+    input_debounce_init(&db, &direction_config);
+
+    CHECK_EQ(input_debounce_update(&db, true, 5000), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_next_deadline(&db, 5000), 400);
+    CHECK_EQ(input_debounce_update(&db, true, 5399), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_update(&db, true, 5400), INPUT_DEBOUNCE_REPEAT);
+    CHECK_EQ(input_debounce_next_deadline(&db, 5400), 120);
+    CHECK_EQ(input_debounce_update(&db, true, 5520), INPUT_DEBOUNCE_REPEAT);
+
+    // A stalled caller gets one repeat, not a burst of the missed ones
+    CHECK_EQ(input_debounce_update(&db, true, 6500), INPUT_DEBOUNCE_REPEAT);
+    CHECK_EQ(input_debounce_update(&db, true, 6500), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_next_deadline(&db, 6500), 120);
+
+    CHECK_EQ(input_debounce_update(&db, false, 6550), INPUT_DEBOUNCE_RELEASE);
+    CHECK_EQ(input_debounce_next_deadline(&db, 6550), INPUT_DEBOUNCE_IDLE);
+}
+
+static void test_clock_wrap(void) {
+    input_debounce_t db;
+    input_debounce_init(&db, &select_config);
+    uint32_t start = UINT32_MAX - 100;
+
+    CHECK_EQ(input_debounce_update(&db, true, start), INPUT_DEBOUNCE_PRESS);
+    CHECK_EQ(input_debounce_next_deadline(&db, start + 200), 400);
+    CHECK_EQ(input_debounce_update(&db, true, start + 599), INPUT_DEBOUNCE_NONE);
+    CHECK_EQ(input_debounce_update(&db, true, start + 600), INPUT_DEBOUNCE_LONG_PRESS);
+}
+
+int main(void) {
+    test_first_press_not_delayed();
+    test_bounce();
+    test_long_press();
+    test_repeat();
+    test_clock_wrap();
+    return HOST_TEST_RESULT();
+}
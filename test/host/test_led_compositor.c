@@ -0,0 +1,229 @@
+#include "managers/led_compositor.h"
+#include "host_test.h"
+#include <esp_timer.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STRIP_LEDS 4
+#define MAX_FLUSHES 256
+
+static const led_rgb_t BLACK = {0, 0, 0};
+static const led_rgb_t RED = {255, 0, 0};
+static const led_rgb_t GREEN = {0, 255, 0};
+static const led_rgb_t BLUE = {0, 0, 255};
+static const led_rgb_t WHITE = {255, 255, 255};
+
+// Stands in for the strip behind the service task, keeps every frame it was sent
+typedef struct {
+    led_rgb_t frames[MAX_FLUSHES][STRIP_LEDS];
+    uint32_t at_ms[MAX_FLUSHES];
+    int flushes;
+} mock_strip_t;
+
+static void mock_strip_flush(mock_strip_t *strip, const led_rgb_t *frame, uint32_t now_ms) {
+    if (strip->flushes < MAX_FLUSHES) {
+        memcpy(strip->frames[strip->flushes], frame, sizeof(strip->frames[0]));
+        strip->at_ms[strip->flushes] = now_ms;
+    }
+    strip->flushes++;
+}
+
+// What the strip showed last at or before t_ms
+static const led_rgb_t *mock_strip_at(const mock_strip_t *strip, uint32_t t_ms) {
+    const led_rgb_t *shown = NULL;
+    for (int i = 0; i < strip->flushes && i < MAX_FLUSHES; i++) {
+        if (strip->at_ms[i] <= t_ms) shown = strip->frames[i];
+    }
+    return shown;
+}
+
+// Renders one frame every RGB_FRAME_MS while something animates, the way the service task does
+static void run(led_compositor_t *comp, mock_strip_t *strip, uint32_t from_ms, uint32_t to_ms) {
+    led_rgb_t frame[STRIP_LEDS];
+    for (uint32_t t = from_ms; t < to_ms; t += 20) {
+        if (t != from_ms && !led_compositor_animating(comp)) break;
+        led_compositor_render(comp, t, frame, STRIP_LEDS);
+        mock_strip_flush(strip, frame, t);
+    }
+}
+
+static bool same(led_rgb_t a, led_rgb_t b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static bool all(const led_rgb_t *frame, int count, led_rgb_t color) {
+    for (int i = 0; i < count; i++) {
+        if (!same(frame[i], color)) return false;
+    }
+    return true;
+}
+
+static bool equal(const led_rgb_t *a, const led_rgb_t *b, int count) {
+    return memcmp(a, b, count * sizeof(led_rgb_t)) == 0;
+}
+
+static void test_golden_frames(void) {
+    led_compositor_t comp;
+    led_rgb_t frame[STRIP_LEDS];
+
+    // Rainbow over four LEDs is a quarter turn apart, 1800 ms at 50 ms a degree is 36 degrees on
+    static const led_rgb_t rainbow_0[STRIP_LEDS] = {{255, 0, 0}, {127, 255, 0}, {0, 255, 255}, {128, 0, 255}};
+    static const led_rgb_t rainbow_1800[STRIP_LEDS] = {{255, 150, 0}, {0, 255, 22}, {0, 105, 255}, {255, 0, 233}};
+    led_compositor_init(&comp, 0);
+    led_compositor_set_effect(&comp, LED_EFFECT_RAINBOW, 50, 100, 0);
+    led_compositor_render(&comp, 0, frame, STRIP_LEDS);
+    CHECK(equal(frame, rainbow_0, STRIP_LEDS));
+    led_compositor_render(&comp, 1800, frame, STRIP_LEDS);
+    CHECK(equal(frame, rainbow_1800, STRIP_LEDS));
+
+    // Police at 10 ms a step ramps over 520 ms: half up red, half down red, half up blue
+    led_compositor_set_effect(&comp, LED_EFFECT_POLICE, 10, 100, 0);
+    led_compositor_render(&comp, 260, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, (led_rgb_t){127, 0, 0}));
+    led_compositor_render(&comp, 650, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, (led_rgb_t){192, 0, 0}));
+    led_compositor_render(&comp, 1300, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, (led_rgb_t){0, 0, 127}));
+
+    // Half brightness, and a changed speed restarts the effect
+    led_compositor_set_effect(&comp, LED_EFFECT_RAINBOW, 40, 50, 1000);
+    led_compositor_render(&comp, 1000, frame, STRIP_LEDS);
+    CHECK(same(frame[0], (led_rgb_t){127, 0, 0}));
+    CHECK(same(frame[2], (led_rgb_t){0, 127, 127}));
+}
+
+static void test_pulse_over_status(void) {
+    static mock_strip_t strip;
+    led_compositor_t comp;
+    memset(&strip, 0, sizeof(strip));
+    led_compositor_init(&comp, 0);
+
+    led_compositor_set_status(&comp, GREEN);
+    led_compositor_pulse(&comp, 1, RED, 0);
+    run(&comp, &strip, 0, 3000);
+
+    CHECK(all(mock_strip_at(&strip, 0), STRIP_LEDS, GREEN));
+    CHECK(all(mock_strip_at(&strip, 500), STRIP_LEDS, RED));
+    CHECK(all(mock_strip_at(&strip, 1000), STRIP_LEDS, GREEN));
+    // The pulse ends on the frame at 1000 ms and nothing animates after it
+    CHECK_EQ(strip.flushes, 51);
+    CHECK_EQ(comp.stats.pulses, 1);
+    CHECK(!led_compositor_animating(&comp));
+}
+
+static void test_pulse_priorities(void) {
+    led_compositor_t comp;
+    led_rgb_t frame[STRIP_LEDS];
+    led_compositor_init(&comp, 0);
+
+    led_compositor_pulse(&comp, 0, BLUE, 0);
+    led_compositor_pulse(&comp, 2, RED, 200);       // Cuts the blue one short
+    led_compositor_pulse(&comp, 2, RED, 300);       // Same again, keeps going
+    led_compositor_pulse(&comp, 0, GREEN, 300);     // Waits for the red one
+    led_compositor_pulse(&comp, 0, WHITE, 350);     // Replaces the waiting green
+    CHECK_EQ(comp.stats.preempted, 1);
+    CHECK_EQ(comp.stats.coalesced, 2);
+
+    led_compositor_render(&comp, 700, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, RED));
+    led_compositor_render(&comp, 1200, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, BLACK));
+    CHECK_EQ(comp.stats.pulses, 1);
+    CHECK(led_compositor_animating(&comp));
+    led_compositor_render(&comp, 1700, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, WHITE));
+    led_compositor_render(&comp, 2200, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, BLACK));
+    CHECK_EQ(comp.stats.pulses, 2);
+    CHECK(!led_compositor_animating(&comp));
+}
+
+static void test_status_over_effect(void) {
+    led_compositor_t comp;
+    led_rgb_t frame[STRIP_LEDS], effect[STRIP_LEDS];
+    led_compositor_init(&comp, 0);
+    led_compositor_set_effect(&comp, LED_EFFECT_RAINBOW, 50, 100, 0);
+
+    led_compositor_set_status(&comp, RED);
+    CHECK(!led_compositor_animating(&comp));
+    led_compositor_render(&comp, 900, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, RED));
+
+    // Back to black lets the running effect show again, where it would have been anyway
+    led_compositor_set_status(&comp, BLACK);
+    CHECK(led_compositor_animating(&comp));
+    led_compositor_render(&comp, 1800, frame, STRIP_LEDS);
+    led_effect_params_t params = {.effect = LED_EFFECT_RAINBOW, .speed_ms = 50};
+    led_effects_render(&params, 1800, effect, STRIP_LEDS);
+    CHECK(equal(frame, effect, STRIP_LEDS));
+}
+
+static void test_visualizer_layer(void) {
+    static mock_strip_t strip;
+    static const led_rgb_t bars[STRIP_LEDS] = {{255, 0, 0}, {255, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+    led_compositor_t comp;
+    led_rgb_t expected[STRIP_LEDS];
+    memset(&strip, 0, sizeof(strip));
+    led_compositor_init(&comp, 0);
+    led_compositor_set_effect(&comp, LED_EFFECT_POLICE, 10, 100, 0);
+    led_compositor_set_status(&comp, BLUE);
+
+    // The visualizer covers the status colour, and a pulse plays over the visualizer
+    led_compositor_set_visualizer(&comp, bars, 0);
+    run(&comp, &strip, 0, 100);
+    led_compositor_pulse(&comp, 1, WHITE, 100);
+    run(&comp, &strip, 100, 2000);
+
+    CHECK(equal(mock_strip_at(&strip, 0), bars, STRIP_LEDS));
+    memcpy(expected, bars, sizeof(expected));
+    led_effects_overlay(expected, STRIP_LEDS, WHITE, 102);  // 200 ms into the pulse
+    CHECK(equal(mock_strip_at(&strip, 300), expected, STRIP_LEDS));
+
+    // Once the stream goes quiet the status colour is back under the pulse
+    memcpy(expected, (led_rgb_t[STRIP_LEDS]){BLUE, BLUE, BLUE, BLUE}, sizeof(expected));
+    led_effects_overlay(expected, STRIP_LEDS, WHITE, 204);  // 400 ms into the pulse
+    CHECK(equal(mock_strip_at(&strip, 500), expected, STRIP_LEDS));
+    CHECK(all(mock_strip_at(&strip, 1100), STRIP_LEDS, BLUE));
+    CHECK(comp.visualizer == NULL);
+    CHECK(!led_compositor_animating(&comp));
+
+    // A new frame brings it back, brightness 0 keeps the strip dark whatever is shown
+    led_rgb_t frame[STRIP_LEDS];
+    led_compositor_set_visualizer(&comp, bars, 2000);
+    led_compositor_set_effect(&comp, LED_EFFECT_POLICE, 10, 0, 2000);
+    led_compositor_pulse(&comp, 2, WHITE, 2000);
+    led_compositor_render(&comp, 2500, frame, STRIP_LEDS);
+    CHECK(all(frame, STRIP_LEDS, BLACK));
+}
+
+static void benchmark(int leds, int frames) {
+    static led_rgb_t frame[256];
+    led_compositor_t comp;
+    if (leds > 256) leds = 256;
+    led_compositor_init(&comp, 0);
+    led_compositor_set_effect(&comp, LED_EFFECT_RAINBOW, 20, 60, 0);
+
+    uint32_t checksum = 0;
+    int64_t start = esp_timer_get_time();
+    for (int f = 0; f < frames; f++) {
+        uint32_t t = (uint32_t)f * 20;
+        if (f % 100 == 0) led_compositor_pulse(&comp, f % 3, RED, t);
+        led_compositor_render(&comp, t, frame, leds);
+        checksum += frame[f % leds].r;
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    printf("%d LEDs, %d frames with pulses, %lld ns a frame (checksum %lu)\n", leds, frames,
+           frames ? (long long)(elapsed * 1000 / frames) : 0ll, (unsigned long)checksum);
+}
+
+int main(void) {
+    led_effects_init();
+    test_golden_frames();
+    test_pulse_over_status();
+    test_pulse_priorities();
+    test_status_over_effect();
+    test_visualizer_layer();
+    benchmark(256, 20000);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,194 @@
+#include "managers/led_matrix.h"
+#include "esp_timer.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define O {0, 0, 0}
+#define R {255, 0, 0}
+
+static void check_index(const led_matrix_t *m, int x, int y, int expected, const char *layout) {
+    int index = led_matrix_index(m, x, y);
+    if (index != expected) {
+        printf("  %s: (%d,%d) maps to LED %d, expected %d\n", layout, x, y, index, expected);
+        host_test_failures++;
+    }
+}
+
+static void test_layouts(void) {
+    led_matrix_t m = {0};
+
+    // Known corners of a 4x3 panel in every wiring
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 0, LED_MATRIX_ORIGIN_TOP_LEFT});
+    check_index(&m, 1, 2, 9, "progressive");
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, true, 0, LED_MATRIX_ORIGIN_TOP_LEFT});
+    check_index(&m, 3, 1, 4, "serpentine");
+    check_index(&m, 0, 2, 8, "serpentine");
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, true, 0, LED_MATRIX_ORIGIN_BOTTOM_LEFT});
+    check_index(&m, 0, 2, 0, "serpentine bottom left");
+    check_index(&m, 0, 1, 7, "serpentine bottom left");
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 0, LED_MATRIX_ORIGIN_TOP_RIGHT});
+    check_index(&m, 3, 0, 0, "top right");
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 90, LED_MATRIX_ORIGIN_TOP_LEFT});
+    check_index(&m, 0, 0, 3, "rotated 90");
+    check_index(&m, 2, 3, 8, "rotated 90");
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 180, LED_MATRIX_ORIGIN_TOP_LEFT});
+    check_index(&m, 0, 0, 11, "rotated 180");
+    led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 270, LED_MATRIX_ORIGIN_TOP_LEFT});
+    check_index(&m, 0, 0, 8, "rotated 270");
+    led_matrix_deinit(&m);
+}
+
+// Every layout is a permutation of the strip, and a blit puts each pixel where the table says
+static void test_every_layout_blits(void) {
+    led_matrix_t m = {0};
+    uint8_t seen[12];
+    led_rgb_t image[12], strip[12];
+    for (int i = 0; i < 12; i++) {
+        image[i] = (led_rgb_t){(uint8_t)i, (uint8_t)(i * 7), (uint8_t)(255 - i)};
+    }
+    for (int layout = 0; layout < 2 * 4 * 4; layout++) {
+        led_matrix_geometry_t g = {4, 3, layout & 1, (uint16_t)((layout >> 1) % 4 * 90),
+                                   (led_matrix_origin_t)(layout >> 3)};
+        CHECK(led_matrix_init(&m, &g));
+        memset(seen, 0, sizeof(seen));
+        for (int i = 0; i < 12; i++) {
+            seen[m.lut[i]]++;
+        }
+        CHECK(memchr(seen, 0, sizeof(seen)) == NULL);
+        led_matrix_blit(&m, image, strip);
+        for (int i = 0; i < 12; i++) {
+            CHECK(memcmp(&strip[m.lut[i]], &image[i], sizeof(led_rgb_t)) == 0);
+        }
+    }
+    led_matrix_deinit(&m);
+}
+
+static void test_invalid_geometry(void) {
+    // Refused, and the matrix keeps the table it had
+    led_matrix_t m = {0};
+    CHECK(led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 0, LED_MATRIX_ORIGIN_TOP_LEFT}));
+    CHECK(!led_matrix_init(&m, &(led_matrix_geometry_t){0, 3, false, 0, LED_MATRIX_ORIGIN_TOP_LEFT}));
+    CHECK(!led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, false, 45, LED_MATRIX_ORIGIN_TOP_LEFT}));
+    CHECK(m.lut != NULL);
+    CHECK_EQ(m.width, 4);
+    led_matrix_deinit(&m);
+}
+
+static void test_fit(void) {
+    uint16_t w, h;
+    led_matrix_fit(256, &w, &h);
+    CHECK(w == 16 && h == 16);
+    led_matrix_fit(60, &w, &h);
+    CHECK(w == 10 && h == 6);
+    led_matrix_fit(13, &w, &h);
+    CHECK(w == 13 && h == 1);
+}
+
+static void test_bars(void) {
+    // 255 fills a column, 128 a third of three rows, 64 and 0 stay dark
+    static const uint8_t amplitudes[4] = {255, 128, 64, 0};
+    static const led_rgb_t expected[3 * 4] = {
+        R, O, O, O,
+        R, O, O, O,
+        R, R, O, O,
+    };
+    led_rgb_t image[3 * 4];
+    led_matrix_draw_bars(image, 4, 3, amplitudes, 4, (led_rgb_t)R);
+    CHECK(memcmp(image, expected, sizeof(image)) == 0);
+
+    // Eight bars over four columns take every other one
+    static const uint8_t eight[8] = {255, 0, 0, 0, 255, 0, 0, 0};
+    static const led_rgb_t sampled[3 * 4] = {
+        R, O, R, O,
+        R, O, R, O,
+        R, O, R, O,
+    };
+    led_matrix_draw_bars(image, 4, 3, eight, 8, (led_rgb_t)R);
+    CHECK(memcmp(image, sampled, sizeof(image)) == 0);
+}
+
+static void test_square(void) {
+    static const led_rgb_t quiet[4 * 4] = {
+        R, R, R, R,
+        R, O, O, R,
+        R, O, O, R,
+        R, R, R, R,
+    };
+    static const led_rgb_t loud[4 * 4] = {
+        O, O, O, O,
+        O, R, R, O,
+        O, R, R, O,
+        O, O, O, O,
+    };
+    led_rgb_t image[4 * 4];
+    led_matrix_draw_square(image, 4, 4, 0, (led_rgb_t)R);
+    CHECK(memcmp(image, quiet, sizeof(image)) == 0);
+    led_matrix_draw_square(image, 4, 4, 255, (led_rgb_t)R);
+    CHECK(memcmp(image, loud, sizeof(image)) == 0);
+}
+
+// A serpentine panel wired from the bottom left shows a bar in the first column on LEDs
+// 0, 7 and 8, the start of every row
+static void test_visualizer_on_panel(void) {
+    static const uint8_t amplitudes[4] = {255, 0, 0, 0};
+    led_matrix_t m = {0};
+    led_rgb_t image[12], strip[12];
+    CHECK(led_matrix_init(&m, &(led_matrix_geometry_t){4, 3, true, 0, LED_MATRIX_ORIGIN_BOTTOM_LEFT}));
+    led_matrix_draw_bars(image, m.width, m.height, amplitudes, 4, (led_rgb_t)R);
+    led_matrix_blit(&m, image, strip);
+    for (int i = 0; i < 12; i++) {
+        CHECK_EQ(strip[i].r, i == 0 || i == 7 || i == 8 ? 255 : 0);
+    }
+    led_matrix_deinit(&m);
+}
+
+static void bench_matrix(int width, int height, int frames) {
+    led_matrix_t m = {0};
+    led_matrix_geometry_t geometry = {(uint16_t)width, (uint16_t)height, true, 0, LED_MATRIX_ORIGIN_TOP_LEFT};
+    led_rgb_t *image = calloc(width * height, sizeof(led_rgb_t));
+    led_rgb_t *strip = calloc(width * height, sizeof(led_rgb_t));
+    CHECK(image != NULL && strip != NULL && led_matrix_init(&m, &geometry));
+
+    uint8_t amplitudes[64];
+    int64_t draw_us = 0, blit_us = 0;
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < (int)sizeof(amplitudes); i++) {
+            amplitudes[i] = (uint8_t)((i * 37 + f * 11) & 0xFF);
+        }
+
+        int64_t start = esp_timer_get_time();
+        if (f & 1) {
+            led_matrix_draw_square(image, m.width, m.height, amplitudes[0], (led_rgb_t){255, 0, 0});
+        } else {
+            led_matrix_draw_bars(image, m.width, m.height, amplitudes, sizeof(amplitudes), (led_rgb_t){255, 0, 0});
+        }
+        int64_t drawn = esp_timer_get_time();
+        led_matrix_blit(&m, image, strip);
+        blit_us += esp_timer_get_time() - drawn;
+        draw_us += drawn - start;
+    }
+
+    int leds = width * height;
+    printf("%dx%d matrix, %d frames: draw %lld ns/frame, blit %lld ns/frame\n", width, height, frames,
+           (long long)(draw_us * 1000 / frames), (long long)(blit_us * 1000 / frames));
+    printf("Sending %d LEDs at 800 kHz takes %lu us, the strip allows at most %lu frames/s\n", leds,
+           (unsigned long)(leds * 30), (unsigned long)(1000000 / (leds * 30 + 300)));
+
+    led_matrix_deinit(&m);
+    free(image);
+    free(strip);
+}
+
+int main(void) {
+    test_layouts();
+    test_every_layout_blits();
+    test_invalid_geometry();
+    test_fit();
+    test_bars();
+    test_square();
+    test_visualizer_on_panel();
+    bench_matrix(16, 16, 2000);
+    return HOST_TEST_RESULT();
+}
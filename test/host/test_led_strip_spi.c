@@ -0,0 +1,95 @@
+#include "vendor/led/led_strip_spi_encoder.h"
+#include "host_test.h"
+#include <esp_timer.h>
+#include <stdio.h>
+#include <string.h>
+
+// Written from the timing the strip expects rather than from the driver: every colour
+// bit, most significant first, goes out as 110 for a one and 100 for a zero
+static void reference_encode(uint8_t data, uint8_t out[3]) {
+    uint32_t word = 0;
+    for (int bit = 7; bit >= 0; bit--) {
+        word = word << 3 | ((data >> bit) & 1 ? 0x6 : 0x4);
+    }
+    out[0] = word >> 16;
+    out[1] = word >> 8;
+    out[2] = word;
+}
+
+static void test_every_byte(void) {
+    for (int data = 0; data < 256; data++) {
+        uint8_t expected[3], bitwise[3] = {0}, lut[3];
+        reference_encode((uint8_t)data, expected);
+        led_strip_spi_encode_bitwise((uint8_t)data, bitwise);
+        CHECK(led_strip_spi_encode((uint8_t)data, lut) == lut + 3);
+        if (memcmp(expected, bitwise, 3) != 0 || memcmp(expected, lut, 3) != 0) {
+            printf("0x%02x encodes as %02x%02x%02x bitwise and %02x%02x%02x from the table, expected %02x%02x%02x\n",
+                   data, bitwise[0], bitwise[1], bitwise[2], lut[0], lut[1], lut[2], expected[0], expected[1],
+                   expected[2]);
+            CHECK(false);
+        }
+    }
+
+    static const uint8_t zero[3] = {0x92, 0x49, 0x24};
+    static const uint8_t ones[3] = {0xDB, 0x6D, 0xB6};
+    CHECK(memcmp(led_strip_spi_encode_lut[0x00], zero, 3) == 0);
+    CHECK(memcmp(led_strip_spi_encode_lut[0xFF], ones, 3) == 0);
+}
+
+static void test_pixel_order(void) {
+    static const uint8_t rgb[6] = {0x11, 0x22, 0x33, 0xFF, 0x00, 0x80};
+    static const uint8_t grb[6] = {0x22, 0x11, 0x33, 0x00, 0xFF, 0x80};
+    uint8_t out[2 * 4 * 3], expected[2 * 4 * 3];
+
+    uint8_t *end = led_strip_spi_encode_pixels(rgb, 2, false, out);
+    CHECK_EQ(end - out, 2 * 3 * 3);
+    for (int i = 0; i < 6; i++) {
+        reference_encode(grb[i], expected + i * 3);
+    }
+    CHECK(memcmp(out, expected, 2 * 3 * 3) == 0);
+
+    // GRBW strips get a dark white channel after every pixel
+    end = led_strip_spi_encode_pixels(rgb, 2, true, out);
+    CHECK_EQ(end - out, 2 * 4 * 3);
+    for (int p = 0; p < 2; p++) {
+        for (int c = 0; c < 3; c++) {
+            reference_encode(grb[p * 3 + c], expected + (p * 4 + c) * 3);
+        }
+        reference_encode(0, expected + (p * 4 + 3) * 3);
+    }
+    CHECK(memcmp(out, expected, sizeof(expected)) == 0);
+}
+
+static void benchmark(int pixels, int rounds) {
+    static uint8_t buf[256 * 3 * 3];
+    if (pixels > 256) pixels = 256;
+
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        memset(buf, 0, (size_t)pixels * 9);
+        for (int i = 0; i < pixels * 3; i++) {
+            led_strip_spi_encode_bitwise((uint8_t)(i + r), buf + i * 3);
+        }
+    }
+    int64_t bitwise = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++) {
+        uint8_t *out = buf;
+        for (int i = 0; i < pixels * 3; i++) {
+            out = led_strip_spi_encode((uint8_t)(i + r), out);
+        }
+    }
+    int64_t lut = esp_timer_get_time() - start;
+
+    printf("%d pixels x %d rounds: bitwise %lld us, table %lld us (byte %u)\n", pixels, rounds, (long long)bitwise,
+           (long long)lut, buf[0]);
+}
+
+int main(void) {
+    led_strip_spi_encoder_init();
+    test_every_byte();
+    test_pixel_order();
+    benchmark(256, 2000);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,137 @@
+#include "lvgl.h"
+#include "esp_timer.h"
+#include "host_test.h"
+
+// Built for RGB565 with LV_COLOR_16_SWAP and LV_COLOR_MIX_ROUND_OFS as set in CMakeLists.txt.
+// The packed mixes must match the per channel formula LVGL uses for the other depths.
+
+static uint8_t reference_channel(uint32_t fg_weighted, uint32_t bg_weighted) {
+    return (uint8_t)LV_UDIV255(fg_weighted + bg_weighted + LV_COLOR_MIX_ROUND_OFS);
+}
+
+static lv_color_t reference_mix(lv_color_t c1, lv_color_t c2, uint8_t mix) {
+    lv_color_t ret;
+    LV_COLOR_SET_R(ret, reference_channel(LV_COLOR_GET_R(c1) * mix, LV_COLOR_GET_R(c2) * (255u - mix)));
+    LV_COLOR_SET_G(ret, reference_channel(LV_COLOR_GET_G(c1) * mix, LV_COLOR_GET_G(c2) * (255u - mix)));
+    LV_COLOR_SET_B(ret, reference_channel(LV_COLOR_GET_B(c1) * mix, LV_COLOR_GET_B(c2) * (255u - mix)));
+    return ret;
+}
+
+static lv_color_t reference_mix_premult(const uint16_t *premult_c1, lv_color_t c2, uint8_t mix) {
+    lv_color_t ret;
+    LV_COLOR_SET_R(ret, reference_channel(premult_c1[0], LV_COLOR_GET_R(c2) * mix));
+    LV_COLOR_SET_G(ret, reference_channel(premult_c1[1], LV_COLOR_GET_G(c2) * mix));
+    LV_COLOR_SET_B(ret, reference_channel(premult_c1[2], LV_COLOR_GET_B(c2) * mix));
+    return ret;
+}
+
+static lv_color_t color_of(int r, int g, int b) {
+    lv_color_t c = lv_color_black();
+    LV_COLOR_SET_R(c, r);
+    LV_COLOR_SET_G(c, g);
+    LV_COLOR_SET_B(c, b);
+    return c;
+}
+
+// Every weighted sum a mix can produce, in both lanes at once and in green
+static void test_udiv255_lanes(void) {
+    const uint32_t rb_max = 31 * 255 + LV_COLOR_MIX_ROUND_OFS;
+    const uint32_t g_max = 63 * 255 + LV_COLOR_MIX_ROUND_OFS;
+    uint32_t mismatches = 0;
+
+    for (uint32_t r = 0; r <= rb_max; r++) {
+        for (uint32_t b = 0; b <= rb_max; b++) {
+            uint16_t out = _lv_color_565_udiv255(r << 16 | b, (b * 2) % (g_max + 1));
+            mismatches += (out >> 11) != LV_UDIV255(r) || (out & 0x1F) != LV_UDIV255(b);
+        }
+    }
+    for (uint32_t g = 0; g <= g_max; g++) {
+        uint16_t out = _lv_color_565_udiv255(rb_max << 16 | rb_max, g);
+        mismatches += ((out >> 5) & 0x3F) != LV_UDIV255(g);
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+// The channels are independent, so every green pair and every red/blue pair under every
+// mix covers all inputs
+static void test_mix_every_channel_pair(void) {
+    uint32_t mismatches = 0, premult_mismatches = 0;
+    uint16_t premult[3];
+
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            lv_color_t c1 = color_of(a & 0x1F, a, b & 0x1F);
+            lv_color_t c2 = color_of(b & 0x1F, b, a & 0x1F);
+
+            for (int mix = 0; mix < 256; mix++) {
+                mismatches += lv_color_mix(c1, c2, mix).full != reference_mix(c1, c2, mix).full;
+
+                lv_color_premult(c1, 255 - mix, premult);
+                premult_mismatches +=
+                    lv_color_mix_premult(premult, c2, mix).full != reference_mix_premult(premult, c2, mix).full;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(premult_mismatches, 0);
+}
+
+// Whole colors with all three channels different, mixing into itself is the identity
+static void test_mix_random_colors(void) {
+    uint32_t seed = 0x12345678u;
+    uint32_t mismatches = 0;
+
+    for (int i = 0; i < 1000000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        lv_color_t c1 = {.full = (uint16_t)(seed >> 16)};
+        seed = seed * 1103515245u + 12345u;
+        lv_color_t c2 = {.full = (uint16_t)(seed >> 16)};
+        uint8_t mix = (uint8_t)(seed >> 4);
+
+        mismatches += lv_color_mix(c1, c2, mix).full != reference_mix(c1, c2, mix).full;
+        mismatches += lv_color_mix(c1, c1, mix).full != c1.full;
+    }
+    CHECK_EQ(mismatches, 0);
+    CHECK_EQ(lv_color_mix(lv_color_white(), lv_color_black(), LV_OPA_COVER).full, lv_color_white().full);
+    CHECK_EQ(lv_color_mix(lv_color_white(), lv_color_black(), LV_OPA_TRANSP).full, lv_color_black().full);
+}
+
+// Masked blend over one draw buffer, as text and anti-aliased edges do it
+static void bench_masked_blend(int iterations) {
+    static lv_color_t dest[4096];
+    static lv_opa_t mask[4096];
+    uint32_t seed = 1;
+    for (int i = 0; i < 4096; i++) {
+        seed = seed * 1103515245u + 12345u;
+        mask[i] = (i % 7 == 0) ? (seed >> 8) & 0xFF : ((i / 5) % 2 ? LV_OPA_COVER : LV_OPA_TRANSP);
+    }
+
+    lv_color_t fg = lv_color_make(0x20, 0xC0, 0x60);
+    int64_t elapsed[2];
+    uint32_t sum[2] = {0, 0};
+    for (int packed = 0; packed < 2; packed++) {
+        for (int i = 0; i < 4096; i++) dest[i] = lv_color_make(0x40, 0x40, 0x40);
+        int64_t start = esp_timer_get_time();
+        for (int n = 0; n < iterations; n++) {
+            for (int i = 0; i < 4096; i++) {
+                dest[i] = packed ? lv_color_mix(fg, dest[i], mask[i]) : reference_mix(fg, dest[i], mask[i]);
+            }
+        }
+        elapsed[packed] = esp_timer_get_time() - start;
+        for (int i = 0; i < 4096; i++) sum[packed] += dest[i].full;
+    }
+
+    uint64_t px = 4096ull * iterations;
+    printf("Masked blend: reference %llu px/us, packed %llu px/us\n",
+           (unsigned long long)(elapsed[0] > 0 ? px / elapsed[0] : 0),
+           (unsigned long long)(elapsed[1] > 0 ? px / elapsed[1] : 0));
+    CHECK_EQ(sum[1], sum[0]);
+}
+
+int main(void) {
+    test_udiv255_lanes();
+    test_mix_every_channel_pair();
+    test_mix_random_colors();
+    bench_masked_blend(200);
+    return HOST_TEST_RESULT();
+}
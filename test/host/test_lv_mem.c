@@ -0,0 +1,162 @@
+#include "lvgl.h"
+#include "host_test.h"
+#include <string.h>
+
+// Built with LV_MEM_SIZE 64 KB and a quarter of it for size classes, see CMakeLists.txt
+
+static lv_mem_class_monitor_t classes[LV_MEM_CLASS_CNT];
+
+static uint32_t class_used(int i) {
+    lv_mem_class_monitor(classes);
+    return classes[i].used_cnt;
+}
+
+static void test_layout(void) {
+    lv_mem_init();
+    CHECK_EQ(lv_mem_class_monitor(classes), LV_MEM_CLASS_CNT);
+
+    // 16 KB split 10/20/15/20/35 percent, rounded down to whole blocks
+    static const uint32_t sizes[] = {8, 16, 24, 32, 40};
+    static const uint32_t counts[] = {204, 204, 102, 102, 143};
+    for (int i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        CHECK_EQ(classes[i].block_size, sizes[i]);
+        CHECK_EQ(classes[i].block_cnt, counts[i]);
+        CHECK_EQ(classes[i].used_cnt, 0);
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    CHECK_EQ(mon.total_size, LV_MEM_SIZE);
+    CHECK(mon.free_size > LV_MEM_SIZE * 9 / 10);
+    CHECK_EQ(mon.max_used, 0);
+}
+
+static void test_routing(void) {
+    lv_mem_init();
+
+    // Each small size lands in the smallest class that holds it
+    static const struct {
+        size_t size;
+        int class_index;
+    } cases[] = {{1, 0}, {8, 0}, {9, 1}, {16, 1}, {17, 2}, {28, 3}, {36, 4}, {40, 4}};
+    void *p[8];
+    for (int i = 0; i < 8; i++) {
+        uint32_t before = class_used(cases[i].class_index);
+        p[i] = lv_mem_alloc(cases[i].size);
+        CHECK(p[i] != NULL);
+        CHECK_EQ(class_used(cases[i].class_index), before + 1);
+    }
+
+    // Larger requests go to TLSF
+    uint32_t used[LV_MEM_CLASS_CNT];
+    for (int i = 0; i < LV_MEM_CLASS_CNT; i++) used[i] = class_used(i);
+    void *big = lv_mem_alloc(41);
+    CHECK(big != NULL);
+    for (int i = 0; i < LV_MEM_CLASS_CNT; i++) CHECK_EQ(class_used(i), used[i]);
+
+    // A freed block is the next one handed out
+    lv_mem_free(p[6]);
+    CHECK(lv_mem_alloc(33) == p[6]);
+
+    for (int i = 0; i < 8; i++) lv_mem_free(p[i]);
+    lv_mem_free(big);
+    for (int i = 0; i < LV_MEM_CLASS_CNT; i++) CHECK_EQ(class_used(i), 0);
+    CHECK_EQ(lv_mem_test(), LV_RES_OK);
+}
+
+static void test_fallback_and_realloc(void) {
+    lv_mem_init();
+
+    // Use up the 24 byte class, the next request is served by TLSF and counted
+    void *blocks[103];
+    for (int i = 0; i < 103; i++) {
+        blocks[i] = lv_mem_alloc(24);
+        CHECK(blocks[i] != NULL);
+    }
+    lv_mem_class_monitor(classes);
+    CHECK_EQ(classes[2].used_cnt, 102);
+    CHECK_EQ(classes[2].max_used_cnt, 102);
+    CHECK_EQ(classes[2].fallback_cnt, 1);
+    for (int i = 0; i < 103; i++) lv_mem_free(blocks[i]);
+    CHECK_EQ(class_used(2), 0);
+
+    // Shrinking or growing inside the block keeps it, growing past it moves to a larger home
+    uint8_t *p = lv_mem_alloc(20);
+    for (int i = 0; i < 20; i++) p[i] = (uint8_t)i;
+    CHECK(lv_mem_realloc(p, 12) == p);
+    CHECK(lv_mem_realloc(p, 24) == p);
+    uint8_t *q = lv_mem_realloc(p, 100);
+    CHECK(q != NULL && q != p);
+    for (int i = 0; i < 20; i++) CHECK_EQ(q[i], i);
+    CHECK_EQ(class_used(2), 0);
+    lv_mem_free(q);
+
+    // Usage accounting returns to where it started
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    CHECK(mon.max_used > 0);
+    lv_mem_reset_max_used();
+    lv_mem_monitor(&mon);
+    CHECK_EQ(mon.max_used, 0);
+    CHECK_EQ(lv_mem_test(), LV_RES_OK);
+}
+
+static uint32_t next_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void test_view_churn(void) {
+    // Views built and torn down over and over, with objects, attributes, style lists
+    // and label text mixed in, must not leave TLSF any more fragmented than it started
+    static const size_t object_sizes[] = {36, 28, 8, 16, 24, 12, 40};
+    void *live[400];
+    uint32_t rng = 12345;
+
+    lv_mem_init();
+    lv_mem_monitor_t start;
+    lv_mem_monitor(&start);
+
+    for (int cycle = 0; cycle < 200; cycle++) {
+        int n = 100 + (int)(next_rand(&rng) % 300);
+        for (int i = 0; i < n; i++) {
+            uint32_t r = next_rand(&rng);
+            size_t size = r % 10 == 0 ? 48 + r % 400 : object_sizes[r % 7];
+            live[i] = lv_mem_alloc(size);
+            CHECK(live[i] != NULL);
+            memset(live[i], 0x5A, size);
+        }
+        // Widgets go away in no particular order
+        for (int i = 0; i < n; i++) {
+            int j = i + (int)(next_rand(&rng) % (uint32_t)(n - i));
+            void *tmp = live[i];
+            live[i] = live[j];
+            live[j] = tmp;
+            lv_mem_free(live[i]);
+        }
+    }
+
+    lv_mem_monitor_t end;
+    lv_mem_monitor(&end);
+    CHECK_EQ(end.free_size, start.free_size);
+    CHECK_EQ(end.free_biggest_size, start.free_biggest_size);
+    CHECK_EQ(end.frag_pct, 0);
+    CHECK(end.max_used > 0 && end.max_used < LV_MEM_SIZE);
+    lv_mem_class_monitor(classes);
+    for (int i = 0; i < LV_MEM_CLASS_CNT; i++) {
+        CHECK_EQ(classes[i].used_cnt, 0);
+        CHECK(classes[i].max_used_cnt > 0);
+    }
+    CHECK_EQ(lv_mem_test(), LV_RES_OK);
+}
+
+int main(void) {
+    test_layout();
+    test_routing();
+    test_fallback_and_realloc();
+    test_view_churn();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+#include "core/touch_filter.h"
+#include "host_test.h"
+
+static const touch_filter_config_t config = {
+    .x_min = 200,
+    .x_max = 3900,
+    .y_min = 200,
+    .y_max = 3900,
+    .hor_res = 320,
+    .ver_res = 240,
+    .burst = 5,
+    .max_spread = 100,
+    .iir_shift = 2,
+};
+
+static touch_filter_event_t feed(touch_filter_t *tf, uint16_t x, uint16_t y) {
+    uint16_t xs[5] = {x, x, x, x, x};
+    uint16_t ys[5] = {y, y, y, y, y};
+    return touch_filter_update(tf, true, xs, ys, 5);
+}
+
+static void test_median(void) {
+    uint16_t samples[5] = {5, 1, 4, 2, 3};
+    CHECK_EQ(touch_filter_median(samples, 5), 3);
+    CHECK_EQ(samples[0], 1);
+    CHECK_EQ(samples[4], 5);
+    CHECK_EQ(touch_filter_median(samples, 0), 0);
+}
+
+static void test_press_move_release(void) {
+    touch_filter_t tf;
+    touch_filter_init(&tf, &config);
+    CHECK(!touch_filter_should_sample(&tf, false));
+    CHECK(touch_filter_should_sample(&tf, true));
+
+    // The first sample is reported unsmoothed, the middle of the panel is the middle of the screen
+    CHECK_EQ(feed(&tf, 2050, 2050), TOUCH_FILTER_PRESS);
+    CHECK_EQ(tf.x, 160);
+    CHECK_EQ(tf.y, 120);
+    CHECK(touch_filter_should_sample(&tf, false));  // Followed until release without the IRQ
+
+    // Holding still reports nothing
+    CHECK_EQ(feed(&tf, 2050, 2050), TOUCH_FILTER_NONE);
+
+    // A jump to the right edge moves a quarter of the way per sample
+    CHECK_EQ(feed(&tf, 3900, 2050), TOUCH_FILTER_MOVE);
+    CHECK_EQ(tf.x, 200);
+    CHECK_EQ(tf.y, 120);
+
+    // Following the finger converges on the edge and never overshoots it
+    int16_t last_x = tf.x;
+    for (int i = 0; i < 40; i++) {
+        touch_filter_event_t ev = feed(&tf, 3900, 2050);
+        CHECK(ev == TOUCH_FILTER_MOVE || ev == TOUCH_FILTER_NONE);
+        CHECK(tf.x >= last_x && tf.x <= 319);
+        last_x = tf.x;
+    }
+    CHECK(tf.x >= 318);
+
+    uint16_t xs[1], ys[1];
+    CHECK_EQ(touch_filter_update(&tf, false, xs, ys, 0), TOUCH_FILTER_RELEASE);
+    CHECK_EQ(touch_filter_update(&tf, false, xs, ys, 0), TOUCH_FILTER_NONE);
+    CHECK(!touch_filter_should_sample(&tf, false));
+
+    // The next touch starts fresh instead of sliding from the old point
+    CHECK_EQ(feed(&tf, 200, 200), TOUCH_FILTER_PRESS);
+    CHECK_EQ(tf.x, 0);
+    CHECK_EQ(tf.y, 0);
+}
+
+static void test_noisy_burst_dropped(void) {
+    touch_filter_t tf;
+    touch_filter_init(&tf, &config);
+    CHECK_EQ(feed(&tf, 2050, 2050), TOUCH_FILTER_PRESS);
+
+    uint16_t xs[5] = {2000, 2400, 2000, 2000, 2000};
+    uint16_t ys[5] = {2050, 2050, 2050, 2050, 2050};
+    CHECK_EQ(touch_filter_update(&tf, true, xs, ys, 5), TOUCH_FILTER_NONE);
+    CHECK_EQ(tf.dropped, 1);
+    CHECK_EQ(tf.x, 160);
+
+    // A single wild conversion inside the allowed spread is outvoted by the median
+    uint16_t xs2[5] = {2050, 2050, 2120, 2050, 2050};
+    uint16_t ys2[5] = {2050, 2050, 2050, 2050, 2050};
+    CHECK_EQ(touch_filter_update(&tf, true, xs2, ys2, 5), TOUCH_FILTER_NONE);
+    CHECK_EQ(tf.dropped, 1);
+}
+
+static void test_orientation(void) {
+    touch_filter_config_t rotated = config;
+    rotated.swap_xy = true;
+    rotated.invert_x = true;
+    rotated.iir_shift = 0;
+
+    touch_filter_t tf;
+    touch_filter_init(&tf, &rotated);
+    // Raw Y is the screen X and runs backwards, raw X past the edge is clamped
+    CHECK_EQ(feed(&tf, 4095, 200), TOUCH_FILTER_PRESS);
+    CHECK_EQ(tf.x, 319);
+    CHECK_EQ(tf.y, 239);
+
+    // Without smoothing a move lands on the sample
+    CHECK_EQ(feed(&tf, 2050, 2050), TOUCH_FILTER_MOVE);
+    CHECK_EQ(tf.x, 159);
+    CHECK_EQ(tf.y, 120);
+}
+
+int main(void) {
+    test_median();
+    test_press_move_release();
+    test_noisy_burst_dropped();
+    test_orientation();
+    return HOST_TEST_RESULT();
+}
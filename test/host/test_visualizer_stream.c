@@ -0,0 +1,164 @@
+#include "core/visualizer_stream.h"
+#include "host_test.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Replay of a synthetic trace on a simulated clock
+
+#define REPLAY_FRAME_MS   (1000 / 30)
+#define REPLAY_BARS       15
+#define REPLAY_CLOCK_SKEW 100000    // Local clock is this far ahead of the sender
+
+typedef struct {
+    uint32_t arrival_ms;
+    uint16_t frame;
+} replay_event_t;
+
+static uint32_t replay_rand(uint32_t *state) {
+    *state = *state * 1103515245u + 12345u;
+    return *state >> 16;
+}
+
+// Each bar is a triangle wave, so straight line interpolation is exact between peaks
+static uint8_t replay_bar(uint32_t ts, int bar) {
+    uint32_t x = (ts / 4 + bar * 20) % 512;
+    return (uint8_t)(x < 256 ? x : 511 - x);
+}
+
+static int compare_events(const void *a, const void *b) {
+    const replay_event_t *ea = a, *eb = b;
+    if (ea->arrival_ms != eb->arrival_ms) return ea->arrival_ms < eb->arrival_ms ? -1 : 1;
+    return (int)ea->frame - (int)eb->frame;
+}
+
+static bool replay_trace(int frames, int loss_pct, int reorder_pct) {
+    replay_event_t *events = calloc(frames + frames / 50 + 1, sizeof(replay_event_t));
+    visualizer_jitter_t *jb = calloc(1, sizeof(visualizer_jitter_t));
+    if (events == NULL || jb == NULL) {
+        free(events);
+        free(jb);
+        printf("Not enough memory for %d frames\n", frames);
+        return false;
+    }
+
+    // Network delay of 5 to 25 ms, reordered frames are held back behind the next one,
+    // every 50th frame is sent twice. The last frame always arrives so no loss goes unseen.
+    uint32_t rng = 0x47686f73;
+    int events_count = 0, dropped = 0, duplicated = 0;
+    for (int f = 0; f < frames; f++) {
+        if (f > 0 && f < frames - 1 && (int)(replay_rand(&rng) % 100) < loss_pct) {
+            dropped++;
+            continue;
+        }
+        uint32_t delay = 5 + replay_rand(&rng) % 20;
+        if ((int)(replay_rand(&rng) % 100) < reorder_pct) {
+            delay += REPLAY_FRAME_MS + 1;
+        }
+        uint32_t sent = (uint32_t)f * REPLAY_FRAME_MS;
+        events[events_count++] = (replay_event_t){sent + delay + REPLAY_CLOCK_SKEW, (uint16_t)f};
+        if (f % 50 == 25) {
+            events[events_count++] = (replay_event_t){sent + delay + 3 + REPLAY_CLOCK_SKEW, (uint16_t)f};
+            duplicated++;
+        }
+    }
+    qsort(events, events_count, sizeof(replay_event_t), compare_events);
+
+    visualizer_jitter_reset(jb);
+    uint8_t wire[VISUALIZER_MAX_PACKET];
+    uint8_t bars[VISUALIZER_MAX_BARS];
+    int next_event = 0, outputs = 0, wire_errors = 0, max_error = 0;
+    uint64_t total_error = 0;
+    uint32_t end_ms = (uint32_t)frames * REPLAY_FRAME_MS + REPLAY_CLOCK_SKEW + 200;
+
+    for (uint32_t now = REPLAY_CLOCK_SKEW; now < end_ms; now++) {
+        while (next_event < events_count && events[next_event].arrival_ms <= now) {
+            uint16_t f = events[next_event++].frame;
+            visualizer_packet_t packet = {.seq = f, .timestamp_ms = (uint32_t)f * REPLAY_FRAME_MS,
+                                          .bar_count = REPLAY_BARS, .has_metadata = f % 30 == 0};
+            for (int b = 0; b < REPLAY_BARS; b++) packet.bars[b] = replay_bar(packet.timestamp_ms, b);
+            strcpy(packet.track, "Replay");
+            strcpy(packet.artist, "Ghost ESP");
+
+            // Through the wire format and back, as the socket task sees it
+            visualizer_packet_t parsed;
+            size_t len = visualizer_encode(&packet, wire, sizeof(wire));
+            if (len == 0 || !visualizer_parse(wire, len, &parsed) || parsed.seq != f ||
+                memcmp(parsed.bars, packet.bars, REPLAY_BARS) != 0 ||
+                (packet.has_metadata && strcmp(parsed.artist, packet.artist) != 0)) {
+                wire_errors++;
+                continue;
+            }
+            visualizer_jitter_push(jb, &parsed, now);
+        }
+
+        if ((now - REPLAY_CLOCK_SKEW) % REPLAY_FRAME_MS != 0) continue;
+        int count = visualizer_jitter_sample(jb, now, bars);
+        if (count == 0) continue;
+
+        // Past the last frame the output holds it, there is nothing left to compare against
+        uint32_t target = now - (uint32_t)jb->offset_ms - VISUALIZER_JITTER_MS;
+        if (target > (uint32_t)(frames - 1) * REPLAY_FRAME_MS) continue;
+        for (int b = 0; b < count; b++) {
+            int error = abs((int)bars[b] - (int)replay_bar(target, b));
+            total_error += error;
+            if (error > max_error) max_error = error;
+        }
+        outputs++;
+    }
+
+    const visualizer_stream_stats_t *s = &jb->stats;
+    uint32_t mean_x100 = outputs ? (uint32_t)(total_error * 100 / ((uint64_t)outputs * REPLAY_BARS)) : 0;
+    printf("Replayed %d frames: %d dropped, %d sent twice, %d%% held back behind the next\n", frames, dropped,
+           duplicated, reorder_pct);
+    printf("Stream: received %lu, lost %lu, duplicate %lu, reordered %lu, late %lu, resets %lu\n",
+           (unsigned long)s->received, (unsigned long)s->lost, (unsigned long)s->duplicate,
+           (unsigned long)s->reordered, (unsigned long)s->late, (unsigned long)s->resets);
+    printf("Output: %d frames, error against the source mean %lu.%02lu max %d of 255\n", outputs,
+           (unsigned long)(mean_x100 / 100), (unsigned long)(mean_x100 % 100), max_error);
+
+    // Frames only arrive out of order by up to one frame, well inside the playout delay
+    bool ok = wire_errors == 0 && s->lost == (uint32_t)dropped && s->duplicate == (uint32_t)duplicated &&
+              s->late == 0 && s->resets == 0 && mean_x100 <= 400 && outputs > 0;
+    printf("Replay %s\n", ok ? "passed" : "FAILED");
+
+    free(events);
+    free(jb);
+    return ok;
+}
+
+static void test_encode_parse(void) {
+    visualizer_packet_t in = {.seq = 0xBEEF, .timestamp_ms = 123456789, .bar_count = 16, .has_metadata = true};
+    for (int i = 0; i < in.bar_count; i++) in.bars[i] = (uint8_t)(i * 16);
+    strcpy(in.track, "Track");
+    strcpy(in.artist, "Artist");
+
+    uint8_t buf[VISUALIZER_MAX_PACKET];
+    size_t len = visualizer_encode(&in, buf, sizeof(buf));
+    CHECK(len > VISUALIZER_HEADER_LEN + 16);
+
+    visualizer_packet_t out;
+    CHECK(visualizer_parse(buf, len, &out));
+    CHECK_EQ(out.seq, in.seq);
+    CHECK_EQ(out.timestamp_ms, in.timestamp_ms);
+    CHECK_EQ(out.bar_count, in.bar_count);
+    CHECK(memcmp(out.bars, in.bars, in.bar_count) == 0);
+    CHECK(out.has_metadata);
+    CHECK(strcmp(out.track, "Track") == 0 && strcmp(out.artist, "Artist") == 0);
+
+    // Every truncation is rejected or parsed without reading past the end
+    for (size_t cut = 0; cut < len; cut++) {
+        visualizer_packet_t tmp;
+        if (cut < VISUALIZER_HEADER_LEN + 16) CHECK(!visualizer_parse(buf, cut, &tmp));
+        else visualizer_parse(buf, cut, &tmp);
+    }
+    CHECK_EQ(visualizer_encode(&in, buf, 10), 0);
+}
+
+int main(void) {
+    test_encode_parse();
+    CHECK(replay_trace(3000, 0, 0));
+    CHECK(replay_trace(3000, 5, 10));
+    CHECK(replay_trace(3000, 20, 30));
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,42 @@
+#ifndef UI_SIM_H
+#define UI_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+typedef struct {
+    uint32_t flushes;     // Flushes into the framebuffer
+    uint64_t flushed_px;  // Pixels they carried
+} sim_panel_stats_t;
+
+/**
+ * @brief Moves the sim clock ahead without sleeping, as a blocking wait on the board would.
+ */
+void sim_clock_skip_us(int64_t us);
+
+/**
+ * @brief Time the sim clock has skipped so far.
+ */
+int64_t sim_clock_skipped_us(void);
+
+void sim_panel_get_stats(sim_panel_stats_t *stats);
+void sim_panel_reset_stats(void);
+
+/**
+ * @brief Pixel of the framebuffer as the panel last got it, black before the first flush.
+ */
+lv_color_t sim_panel_get_pixel(lv_coord_t x, lv_coord_t y);
+
+/**
+ * @brief Share of the framebuffer, in percent, that differs from the color of its top left pixel.
+ *        A view that drew nothing but a background scores 0.
+ */
+uint8_t sim_panel_coverage_pct(void);
+
+/**
+ * @brief Commands the views handed to the serial command line since the last call.
+ */
+uint32_t sim_services_take_commands(void);
+
+#endif // UI_SIM_H
@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <string.h>
+#include "lvgl_helpers.h"
+#include "esp_heap_caps.h"
+#include "vendor/m5/m5gfx_wrapper.h"
+// The keymap is defined in the header, display_manager.c already holds the one copy C allows
+#define _kb_asciimap sim_panel_kb_asciimap
+#include "vendor/keyboard_handler.h"
+#undef _kb_asciimap
+#include "vendor/drivers/ST7262.h"
+#include "sim.h"
+
+// Every panel driver the display manager can pick, writing into one memory framebuffer.
+// Each board keeps its own draw buffers and flush path, only the pixels end up here.
+
+static lv_color_t *framebuffer = NULL;
+static lv_coord_t fb_width = 0;
+static lv_coord_t fb_height = 0;
+static sim_panel_stats_t stats;
+
+static void framebuffer_write(lv_coord_t x1, lv_coord_t y1, lv_coord_t x2, lv_coord_t y2, const lv_color_t *pixels) {
+    if (framebuffer == NULL) {
+        lv_disp_t *disp = lv_disp_get_default();
+        fb_width = lv_disp_get_hor_res(disp);
+        fb_height = lv_disp_get_ver_res(disp);
+        framebuffer = calloc((size_t)fb_width * fb_height, sizeof(lv_color_t));
+        if (framebuffer == NULL) {
+            abort();
+        }
+    }
+
+    // LVGL never flushes outside the display, a driver that would is a bug worth stopping on
+    if (x1 < 0 || y1 < 0 || x2 >= fb_width || y2 >= fb_height || x1 > x2 || y1 > y2) {
+        abort();
+    }
+
+    lv_coord_t w = x2 - x1 + 1;
+    for (lv_coord_t y = y1; y <= y2; y++) {
+        memcpy(&framebuffer[(size_t)y * fb_width + x1], pixels, (size_t)w * sizeof(lv_color_t));
+        pixels += w;
+    }
+
+    stats.flushes++;
+    stats.flushed_px += (uint64_t)w * (y2 - y1 + 1);
+}
+
+void sim_panel_get_stats(sim_panel_stats_t *out) {
+    *out = stats;
+}
+
+void sim_panel_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+lv_color_t sim_panel_get_pixel(lv_coord_t x, lv_coord_t y) {
+    if (framebuffer == NULL || x < 0 || y < 0 || x >= fb_width || y >= fb_height) {
+        return lv_color_black();
+    }
+    return framebuffer[(size_t)y * fb_width + x];
+}
+
+uint8_t sim_panel_coverage_pct(void) {
+    if (framebuffer == NULL) {
+        return 0;
+    }
+
+    size_t total = (size_t)fb_width * fb_height;
+    size_t drawn = 0;
+    for (size_t i = 0; i < total; i++) {
+        drawn += framebuffer[i].full != framebuffer[0].full;
+    }
+    return (uint8_t)(drawn * 100 / total);
+}
+
+// lvgl_esp32_drivers, the SPI panels and touch controllers
+
+void lvgl_driver_init(void) {
+}
+
+void disp_driver_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map) {
+    framebuffer_write(area->x1, area->y1, area->x2, area->y2, color_map);
+    lv_disp_flush_ready(drv);
+}
+
+void touch_driver_read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+    (void)drv;
+    data->state = LV_INDEV_STATE_REL;
+}
+
+uint8_t xpt2046_read_raw(uint16_t *xs, uint16_t *ys, uint8_t count) {
+    (void)xs;
+    (void)ys;
+    (void)count;
+    return 0;
+}
+
+// M5GFX and the keyboard matrix of the Cardputer
+
+void init_m5gfx_display() {
+}
+
+void m5gfx_write_pixels(int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint16_t *color_p) {
+    framebuffer_write(x1, y1, x2, y2, (const lv_color_t *)color_p);
+}
+
+void keyboard_init(Keyboard_t *keyboard) {
+    memset(keyboard, 0, sizeof(*keyboard));
+}
+
+void keyboard_begin(Keyboard_t *keyboard) {
+    (void)keyboard;
+}
+
+void keyboard_update_key_list(Keyboard_t *keyboard) {
+    keyboard->key_list_buffer_len = 0;
+}
+
+void keyboard_update_keys_state(Keyboard_t *keyboard) {
+    (void)keyboard;
+}
+
+uint8_t keyboard_get_key(const Keyboard_t *keyboard, Point2D_t key) {
+    (void)keyboard;
+    (void)key;
+    return 0;
+}
+
+// ST7262 RGB panel of the 7 inch boards, registered the way its driver does it
+
+static lv_disp_drv_t st7262_disp_drv;
+
+static void st7262_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map) {
+    framebuffer_write(area->x1, area->y1, area->x2, area->y2, color_map);
+    lv_disp_flush_ready(drv);
+}
+
+esp_err_t lcd_st7262_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t lcd_st7262_lvgl_init(void) {
+    lv_init();
+
+    static lv_disp_draw_buf_t draw_buf;
+    lv_color_t *buf1 = heap_caps_malloc(800 * 480 * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    lv_color_t *buf2 = heap_caps_malloc(800 * 480 * sizeof(lv_color_t), MALLOC_CAP_SPIRAM);
+    if (buf1 == NULL || buf2 == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, 800 * 480);
+
+    lv_disp_drv_init(&st7262_disp_drv);
+    st7262_disp_drv.hor_res = 800;
+    st7262_disp_drv.ver_res = 480;
+    st7262_disp_drv.flush_cb = st7262_flush;
+    st7262_disp_drv.draw_buf = &draw_buf;
+    lv_disp_drv_register(&st7262_disp_drv);
+    return ESP_OK;
+}
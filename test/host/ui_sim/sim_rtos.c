@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "sim.h"
+
+// FreeRTOS and esp_timer for a single threaded sim. Nothing ever waits: a call that
+// would block on the board skips its timeout on the sim clock instead, so drawing is
+// timed for real while idle periods cost nothing.
+
+struct sim_queue {
+    uint8_t *items;
+    UBaseType_t item_size;
+    UBaseType_t length;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+struct sim_semaphore {
+    bool mutex;
+    bool recursive;
+    UBaseType_t count;  // Times a mutex is held, or the count of a binary semaphore
+};
+
+struct sim_task {
+    const char *name;
+};
+
+#define SIM_MAX_TASKS 16
+
+static int64_t clock_start_us = -1;
+static int64_t clock_skipped_us = 0;
+static struct sim_task sim_main_task = {"main"};
+static struct sim_task tasks[SIM_MAX_TASKS];
+static int task_count = 0;
+
+static int64_t host_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int64_t esp_timer_get_time(void) {
+    int64_t now_us = host_time_us();
+    if (clock_start_us < 0) {
+        clock_start_us = now_us;
+    }
+    return now_us - clock_start_us + clock_skipped_us;
+}
+
+void sim_clock_skip_us(int64_t us) {
+    if (us > 0) {
+        clock_skipped_us += us;
+    }
+}
+
+int64_t sim_clock_skipped_us(void) {
+    return clock_skipped_us;
+}
+
+static void skip_ticks(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        fprintf(stderr, "ui_sim: wait forever on a single thread, the board would hang here\n");
+        abort();
+    }
+    sim_clock_skip_us((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+    (void)fn;
+    (void)stack_depth;
+    (void)arg;
+    (void)priority;
+
+    if (task_count == SIM_MAX_TASKS) {
+        return pdFAIL;
+    }
+    struct sim_task *task = &tasks[task_count++];
+    task->name = name;
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    (void)core;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    (void)task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    skip_ticks(ticks);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return &sim_main_task;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    (void)clear_on_exit;
+    skip_ticks(ticks);
+    return 0;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    (void)task;
+    if (woken) {
+        *woken = pdFALSE;
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct sim_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    queue->item_size = item_size;
+    queue->length = length;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue) {
+        free(queue->items);
+        free(queue);
+    }
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    if (queue->count == queue->length) {
+        skip_ticks(ticks);
+        return errQUEUE_FULL;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + (size_t)tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    if (queue->count == 0) {
+        skip_ticks(ticks);
+        return pdFALSE;
+    }
+    memcpy(item, queue->items + (size_t)queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    queue->head = 0;
+    queue->count = 0;
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return queue->count;
+}
+
+static SemaphoreHandle_t semaphore_create(bool mutex, bool recursive, UBaseType_t count) {
+    struct sim_semaphore *sem = calloc(1, sizeof(*sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    sem->mutex = mutex;
+    sem->recursive = recursive;
+    sem->count = count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_create(true, false, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return semaphore_create(true, true, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_create(false, false, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    free(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (sem->mutex) {
+        if (sem->count > 0 && !sem->recursive) {
+            skip_ticks(ticks);
+            return pdFALSE;
+        }
+        sem->count++;
+        return pdTRUE;
+    }
+
+    if (sem->count == 0) {
+        skip_ticks(ticks);
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (sem->mutex) {
+        if (sem->count == 0) {
+            return pdFALSE;
+        }
+        sem->count--;
+        return pdTRUE;
+    }
+
+    if (sem->count > 0) {
+        return pdFALSE;
+    }
+    sem->count = 1;
+    return pdTRUE;
+}
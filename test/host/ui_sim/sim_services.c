@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include "core/serial_manager.h"
+// utils.h defines functions in the header, flappy_ghost.c already brings them in
+#define UTILS_H
+#include "managers/settings_manager.h"
+#include "managers/sd_card_manager.h"
+#include "managers/wifi_manager.h"
+#include "sim.h"
+
+// Firmware state and services the views reach, answered the way an idle board with no
+// card and no scan running would. Commands are counted, not run, they start radio work.
+
+sd_card_manager_t sd_card_manager = {.card = NULL, .is_initialized = false};
+
+wifi_ap_record_t *scanned_aps = NULL;
+wifi_ap_record_t selected_ap;
+channel_stats_t wifi_channel_stats;
+
+static uint32_t commands = 0;
+
+int handle_serial_command(const char *input) {
+    printf("[sim] command: %s\n", input);
+    commands++;
+    return 0;
+}
+
+void simulateCommand(const char *commandString) {
+    handle_serial_command(commandString);
+}
+
+uint32_t sim_services_take_commands(void) {
+    uint32_t count = commands;
+    commands = 0;
+    return count;
+}
+
+bool wifi_manager_is_channel_hopping(void) {
+    return false;
+}
+
+const char *settings_get_flappy_ghost_name(const FSettings *settings) {
+    return settings->flappy_ghost_name;
+}
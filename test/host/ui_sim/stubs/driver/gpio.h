@@ -0,0 +1,80 @@
+#ifndef UI_SIM_STUB_DRIVER_GPIO_H
+#define UI_SIM_STUB_DRIVER_GPIO_H
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+typedef void (*gpio_isr_t)(void *arg);
+
+typedef enum {
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+} gpio_int_type_t;
+
+typedef enum {
+    GPIO_MODE_INPUT = 1,
+    GPIO_MODE_OUTPUT = 2,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE,
+    GPIO_PULLUP_ENABLE,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE,
+    GPIO_PULLDOWN_ENABLE,
+} gpio_pulldown_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+static inline esp_err_t gpio_config(const gpio_config_t *config) {
+    (void)config;
+    return ESP_OK;
+}
+
+// Pins idle high, nothing is pressed or touched unless the sim posts it
+static inline int gpio_get_level(gpio_num_t pin) {
+    (void)pin;
+    return 1;
+}
+
+static inline esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level) {
+    (void)pin;
+    (void)level;
+    return ESP_OK;
+}
+
+static inline esp_err_t gpio_set_direction(gpio_num_t pin, gpio_mode_t mode) {
+    (void)pin;
+    (void)mode;
+    return ESP_OK;
+}
+
+static inline esp_err_t gpio_install_isr_service(int flags) {
+    (void)flags;
+    return ESP_OK;
+}
+
+static inline esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+    (void)pin;
+    (void)type;
+    return ESP_OK;
+}
+
+static inline esp_err_t gpio_isr_handler_add(gpio_num_t pin, gpio_isr_t isr, void *arg) {
+    (void)pin;
+    (void)isr;
+    (void)arg;
+    return ESP_OK;
+}
+
+#endif // UI_SIM_STUB_DRIVER_GPIO_H
@@ -0,0 +1,6 @@
+#ifndef UI_SIM_STUB_DRIVER_SDMMC_HOST_H
+#define UI_SIM_STUB_DRIVER_SDMMC_HOST_H
+
+#include "driver/sdmmc_types.h"
+
+#endif // UI_SIM_STUB_DRIVER_SDMMC_HOST_H
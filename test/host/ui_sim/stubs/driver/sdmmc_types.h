@@ -0,0 +1,6 @@
+#ifndef UI_SIM_STUB_DRIVER_SDMMC_TYPES_H
+#define UI_SIM_STUB_DRIVER_SDMMC_TYPES_H
+
+typedef struct sdmmc_card_t sdmmc_card_t;
+
+#endif // UI_SIM_STUB_DRIVER_SDMMC_TYPES_H
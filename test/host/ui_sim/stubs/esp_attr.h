@@ -0,0 +1,8 @@
+#ifndef UI_SIM_STUB_ESP_ATTR_H
+#define UI_SIM_STUB_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif // UI_SIM_STUB_ESP_ATTR_H
@@ -0,0 +1,11 @@
+#ifndef UI_SIM_STUB_ESP_CRT_BUNDLE_H
+#define UI_SIM_STUB_ESP_CRT_BUNDLE_H
+
+#include "esp_err.h"
+
+static inline esp_err_t esp_crt_bundle_attach(void *conf) {
+    (void)conf;
+    return ESP_OK;
+}
+
+#endif // UI_SIM_STUB_ESP_CRT_BUNDLE_H
@@ -0,0 +1,31 @@
+#ifndef UI_SIM_STUB_ESP_HEAP_CAPS_H
+#define UI_SIM_STUB_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+// The boards the sim runs keep LVGL in its own pool, the system heap is never the limit
+static inline size_t heap_caps_get_free_size(unsigned caps) {
+    (void)caps;
+    return 1024 * 1024;
+}
+
+static inline size_t heap_caps_get_largest_free_block(unsigned caps) {
+    (void)caps;
+    return 1024 * 1024;
+}
+
+#endif // UI_SIM_STUB_ESP_HEAP_CAPS_H
@@ -0,0 +1,63 @@
+#ifndef UI_SIM_STUB_ESP_HTTP_CLIENT_H
+#define UI_SIM_STUB_ESP_HTTP_CLIENT_H
+
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct sim_http_client *esp_http_client_handle_t;
+
+typedef enum {
+    HTTP_METHOD_GET,
+    HTTP_METHOD_POST,
+} esp_http_client_method_t;
+
+typedef enum {
+    HTTP_TRANSPORT_UNKNOWN,
+    HTTP_TRANSPORT_OVER_TCP,
+    HTTP_TRANSPORT_OVER_SSL,
+} esp_http_client_transport_t;
+
+typedef struct {
+    const char *url;
+    int timeout_ms;
+    esp_err_t (*crt_bundle_attach)(void *conf);
+    esp_http_client_transport_t transport_type;
+} esp_http_client_config_t;
+
+// Requests are never sent, the client only has to exist
+static inline esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) {
+    (void)config;
+    return NULL;
+}
+
+static inline esp_err_t esp_http_client_set_method(esp_http_client_handle_t client, esp_http_client_method_t method) {
+    (void)client;
+    (void)method;
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value) {
+    (void)client;
+    (void)key;
+    (void)value;
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len) {
+    (void)client;
+    (void)data;
+    (void)len;
+    return ESP_OK;
+}
+
+static inline esp_err_t esp_http_client_perform(esp_http_client_handle_t client) {
+    (void)client;
+    return ESP_FAIL;
+}
+
+static inline esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+    (void)client;
+    return ESP_OK;
+}
+
+#endif // UI_SIM_STUB_ESP_HTTP_CLIENT_H
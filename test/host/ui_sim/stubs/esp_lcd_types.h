@@ -0,0 +1,6 @@
+#ifndef UI_SIM_STUB_ESP_LCD_TYPES_H
+#define UI_SIM_STUB_ESP_LCD_TYPES_H
+
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+
+#endif // UI_SIM_STUB_ESP_LCD_TYPES_H
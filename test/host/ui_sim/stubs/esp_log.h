@@ -0,0 +1,35 @@
+#ifndef UI_SIM_STUB_ESP_LOG_H
+#define UI_SIM_STUB_ESP_LOG_H
+
+#include <stdarg.h>
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+typedef int (*vprintf_like_t)(const char *, va_list);
+
+// Errors and warnings reach the test log, the chatter the views print on every input does not
+#define ESP_LOGE(tag, fmt, ...) printf("E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) printf("W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGD(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGV(tag, fmt, ...) ((void)(tag))
+
+static inline void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    (void)tag;
+    (void)level;
+}
+
+static inline vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+    (void)func;
+    return vprintf;
+}
+
+#endif // UI_SIM_STUB_ESP_LOG_H
@@ -0,0 +1,13 @@
+#ifndef UI_SIM_STUB_ESP_TIMER_H
+#define UI_SIM_STUB_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * Microseconds since the sim started: the host's monotonic clock plus every wait the
+ * sim skipped instead of sleeping, see sim_rtos.c. Drawing costs real time, blocking
+ * in FreeRTOS calls costs none.
+ */
+int64_t esp_timer_get_time(void);
+
+#endif // UI_SIM_STUB_ESP_TIMER_H
@@ -0,0 +1,8 @@
+#ifndef UI_SIM_STUB_ESP_TYPES_H
+#define UI_SIM_STUB_ESP_TYPES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#endif // UI_SIM_STUB_ESP_TYPES_H
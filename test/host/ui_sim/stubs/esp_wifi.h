@@ -0,0 +1,13 @@
+#ifndef UI_SIM_STUB_ESP_WIFI_H
+#define UI_SIM_STUB_ESP_WIFI_H
+
+#include "esp_err.h"
+#include "esp_wifi_types.h"
+
+// Never associated, the sim has no network
+static inline esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *info) {
+    (void)info;
+    return ESP_ERR_INVALID_STATE;
+}
+
+#endif // UI_SIM_STUB_ESP_WIFI_H
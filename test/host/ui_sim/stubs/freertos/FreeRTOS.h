@@ -0,0 +1,31 @@
+#ifndef UI_SIM_STUB_FREERTOS_H
+#define UI_SIM_STUB_FREERTOS_H
+
+#include <stdint.h>
+#include "esp_attr.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+#define errQUEUE_FULL 0
+
+#define configTICK_RATE_HZ  CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / 1000U))
+
+// The sim runs the UI on one thread, a critical section only has to compile
+typedef struct {
+    int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portMUX_INITIALIZE(mux) ((mux)->owner = 0)
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+#endif // UI_SIM_STUB_FREERTOS_H
@@ -0,0 +1,9 @@
+#ifndef UI_SIM_STUB_FREERTOS_EVENT_GROUPS_H
+#define UI_SIM_STUB_FREERTOS_EVENT_GROUPS_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_event_group *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#endif // UI_SIM_STUB_FREERTOS_EVENT_GROUPS_H
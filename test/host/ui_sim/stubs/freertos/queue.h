@@ -0,0 +1,19 @@
+#ifndef UI_SIM_STUB_FREERTOS_QUEUE_H
+#define UI_SIM_STUB_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_queue *QueueHandle_t;
+
+// A ring buffer, a wait on an empty or full queue skips its timeout and fails
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack(queue, item, ticks) xQueueSend(queue, item, ticks)
+#define xQueueSendFromISR(queue, item, woken) xQueueSend(queue, item, 0)
+
+#endif // UI_SIM_STUB_FREERTOS_QUEUE_H
@@ -0,0 +1,25 @@
+#ifndef UI_SIM_STUB_FREERTOS_SEMPHR_H
+#define UI_SIM_STUB_FREERTOS_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+typedef struct sim_semaphore *SemaphoreHandle_t;
+
+/**
+ * With one thread a mutex that is already held can never be given back. Taking it
+ * again skips the timeout and fails as on the board, with portMAX_DELAY the sim aborts
+ * where the board would deadlock.
+ */
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+#define xSemaphoreTakeRecursive(sem, ticks) xSemaphoreTake(sem, ticks)
+#define xSemaphoreGiveRecursive(sem) xSemaphoreGive(sem)
+#define xSemaphoreGiveFromISR(sem, woken) xSemaphoreGive(sem)
+
+#endif // UI_SIM_STUB_FREERTOS_SEMPHR_H
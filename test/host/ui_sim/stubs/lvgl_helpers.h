@@ -0,0 +1,14 @@
+#ifndef UI_SIM_STUB_LVGL_HELPERS_H
+#define UI_SIM_STUB_LVGL_HELPERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+// The panel and touch entry points of lvgl_esp32_drivers, backed by the sim framebuffer in sim_panel.c
+void lvgl_driver_init(void);
+void disp_driver_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
+void touch_driver_read(lv_indev_drv_t *drv, lv_indev_data_t *data);
+uint8_t xpt2046_read_raw(uint16_t *xs, uint16_t *ys, uint8_t count);
+
+#endif // UI_SIM_STUB_LVGL_HELPERS_H
@@ -0,0 +1,9 @@
+#ifndef UI_SIM_STUB_NVS_H
+#define UI_SIM_STUB_NVS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef uint32_t nvs_handle_t;
+
+#endif // UI_SIM_STUB_NVS_H
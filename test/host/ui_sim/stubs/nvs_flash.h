@@ -0,0 +1,6 @@
+#ifndef UI_SIM_STUB_NVS_FLASH_H
+#define UI_SIM_STUB_NVS_FLASH_H
+
+#include "nvs.h"
+
+#endif // UI_SIM_STUB_NVS_FLASH_H
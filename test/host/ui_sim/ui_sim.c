@@ -0,0 +1,812 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "managers/display_manager.h"
+#include "managers/display_stats.h"
+#include "managers/ui_benchmark.h"
+#include "managers/view_transition.h"
+#include "src/draw/sw/lv_draw_sw.h"
+#include "managers/views/main_menu_screen.h"
+#include "managers/views/options_screen.h"
+#include "managers/views/app_gallery_screen.h"
+#include "managers/views/terminal_screen.h"
+#include "managers/views/music_visualizer.h"
+#include "managers/views/flappy_ghost_screen.h"
+#include "managers/views/splash_screen.h"
+#include "managers/views/error_popup.h"
+#include "managers/views/device_list_screen.h"
+#include "managers/views/channel_activity_screen.h"
+#include "core/device_table.h"
+#include "managers/wifi_manager.h"
+#include "host_test.h"
+#include "sim.h"
+
+// Every view of one board through the display manager, as the LVGL task runs it:
+// switch to the view, let it settle, post scripted input to the input queue, then let
+// the view leave through its own exit when it has one. Frame costs come from
+// display_stats, memory from LVGL's heap monitor. LVGL traps on a failed allocation,
+// so a view that does not fit the board's LVGL heap stops the run.
+//
+// The views are run twice. The second pass must end with the heap where the first left
+// it, anything else is a view leaking LVGL objects or buffers.
+//
+// An argument picks a benchmark instead of the view run, see sim_modes.
+
+#define SIM_SETTLE_MS         500   // Time a view gets to finish its fade in
+#define SIM_INPUT_MS          250   // Interval between scripted inputs
+#define SIM_MEASURE_MS        1000  // Frames recorded after the script
+#define SIM_SWITCH_TIMEOUT_MS 3000  // Give up on a view that never becomes current
+#define SIM_PASSES            2
+#define SIM_BENCH_TIMEOUT_MS  120000  // Sim time a firmware benchmark gets to print its results
+#define SIM_SWITCH_ROUNDS     3
+#define SIM_STRESS_CYCLES     3
+#define SIM_STRESS_RUNS       3     // The last two have to end with the same heap
+#define SIM_TEXT_FRAMES       50    // Frames per pass of the firmware's text benchmark
+#define SIM_VISUALIZER_MS     1000  // Per visualizer run, the display stats ring holds 64 frames
+
+typedef struct {
+    InputType type;
+    int joystick;   // Joystick index for joystick events
+    uint8_t x_pct;  // Touch position in percent of the screen
+    uint8_t y_pct;
+} sim_input_t;
+
+#define JOY(index) {INPUT_TYPE_JOYSTICK, (index), 0, 0}
+#define TAP(x, y)  {INPUT_TYPE_TOUCH, 0, (x), (y)}
+
+typedef struct {
+    const char *name;
+    View *view;              // NULL when setup shows something that is not a view
+    void (*setup)(void);     // Runs before the switch
+    void (*feed)(void);      // Runs before every LVGL pass while the view is open
+    void (*teardown)(void);  // Runs after the measurement
+    const sim_input_t *script;
+    size_t script_len;
+    bool has_exit;           // Select leaves the view
+    bool leaves_itself;      // Moves on after a while without input, nothing is measured
+} sim_case_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t render_avg_us;
+    uint32_t render_max_us;
+    uint32_t flush_avg_us;
+    uint32_t px_avg;
+} sim_frames_t;
+
+typedef struct {
+    int64_t create_us;
+    size_t create_bytes;
+    uint8_t coverage;    // Percent of the screen drawn after settling
+    sim_frames_t frames;
+    uint32_t heap_peak;  // LVGL heap used at most while the view was open
+    uint32_t commands;   // Serial commands the view issued
+    const char *left_to; // View it left for, through select or by itself
+} sim_row_t;
+
+static uint32_t heap_total = 0;
+static uint32_t heap_peak = 0;
+
+static uint32_t heap_used(void) {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    heap_total = mon.total_size;
+    return mon.total_size - mon.free_size;
+}
+
+// One pass of the LVGL task, heap sampled after it
+static void sim_pass(const sim_case_t *c) {
+    if (c && c->feed) {
+        c->feed();
+    }
+    display_manager_process();
+    vTaskDelay(pdMS_TO_TICKS(LVGL_TASK_PERIOD_MS));
+
+    uint32_t used = heap_used();
+    if (used > heap_peak) {
+        heap_peak = used;
+    }
+}
+
+static void sim_run_ms(const sim_case_t *c, uint32_t ms) {
+    int64_t end_us = esp_timer_get_time() + (int64_t)ms * 1000;
+    while (esp_timer_get_time() < end_us) {
+        sim_pass(c);
+    }
+}
+
+static void sim_post(const sim_input_t *input) {
+    InputEvent event;
+    memset(&event, 0, sizeof(event));
+    event.type = input->type;
+
+    if (input->type == INPUT_TYPE_TOUCH) {
+        event.data.touch_data.point.x = LV_HOR_RES * input->x_pct / 100;
+        event.data.touch_data.point.y = LV_VER_RES * input->y_pct / 100;
+        event.data.touch_data.state = LV_INDEV_STATE_PR;
+    } else {
+        event.data.joystick_index = input->joystick;
+    }
+    CHECK(xQueueSend(input_queue, &event, 0) == pdTRUE);
+}
+
+static bool sim_wait_for_view(const sim_case_t *c, View *view) {
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)SIM_SWITCH_TIMEOUT_MS * 1000;
+    while (display_manager_get_current_view() != view) {
+        if (esp_timer_get_time() > deadline_us) {
+            return false;
+        }
+        sim_pass(c);
+    }
+    return true;
+}
+
+static void sim_collect_frames(sim_frames_t *out) {
+    memset(out, 0, sizeof(*out));
+    uint64_t render_sum = 0, flush_sum = 0, px_sum = 0;
+
+    out->frames = display_stats_frame_count();
+    for (uint32_t i = 0; i < out->frames; i++) {
+        display_stats_frame_t frame;
+        display_stats_get_frame(i, &frame);
+        render_sum += frame.render_us;
+        flush_sum += frame.flush_us;
+        px_sum += frame.px;
+        if (frame.render_us > out->render_max_us) {
+            out->render_max_us = frame.render_us;
+        }
+    }
+    if (out->frames > 0) {
+        out->render_avg_us = (uint32_t)(render_sum / out->frames);
+        out->flush_avg_us = (uint32_t)(flush_sum / out->frames);
+        out->px_avg = (uint32_t)(px_sum / out->frames);
+    }
+}
+
+// Live data for the views that show it
+
+static uint32_t feed_count = 0;
+
+static void feed_terminal(void) {
+    if (++feed_count % 8 == 0) {
+        TERMINAL_VIEW_ADD_TEXT("[sim] line %u, AP found on channel %u\n", (unsigned)feed_count,
+                               (unsigned)(feed_count % 13 + 1));
+    }
+}
+
+static void feed_visualizer(void) {
+    uint8_t bars[NUM_BARS];
+    feed_count++;
+    for (int i = 0; i < NUM_BARS; i++) {
+        bars[i] = (uint8_t)(127 + 127 * sin(feed_count * 0.2 + i * 0.7));
+    }
+    music_visualizer_view_update(bars, "Sim Track", "Sim Artist");
+}
+
+static void feed_devices(void) {
+    uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x00};
+    feed_count++;
+    for (int i = 0; i < 4; i++) {
+        uint32_t n = (feed_count * 4 + i) % 48;
+        mac[5] = (uint8_t)n;
+        char name[16];
+        snprintf(name, sizeof(name), "sim-%02u", (unsigned)n);
+        device_table_upsert(&device_table_ble, mac, (int8_t)(-40 - (int)((n * 7 + feed_count) % 50)), 0, name, NULL,
+                            device_table_now_ms());
+    }
+}
+
+static void feed_channels(void) {
+    feed_count++;
+    for (int i = 0; i < 16; i++) {
+        uint8_t channel = (uint8_t)((feed_count + i * 5) % 13 + 1);
+        channel_stats_record(&wifi_channel_stats, channel, (channel_frame_type_t)(i % CHANNEL_FRAME_TYPES),
+                             (int8_t)(-30 - channel * 4));
+    }
+}
+
+static void feed_flappy(void) {
+    // Flaps often enough to keep the game moving, a flap after game over restarts it
+    if (++feed_count % 30 == 0) {
+        sim_post(&(sim_input_t)JOY(1));
+    }
+}
+
+static void setup_wifi_options(void) {
+    SelectedMenuType = OT_Wifi;
+}
+
+static void setup_ble_options(void) {
+    SelectedMenuType = OT_Bluetooth;
+}
+
+static void setup_device_list(void) {
+    device_list_view_set_kind(DEVICE_KIND_BLE);
+}
+
+static void setup_error_popup(void) {
+    error_popup_create("Simulated error, nothing went wrong");
+}
+
+static void teardown_error_popup(void) {
+    error_popup_destroy();
+}
+
+static const sim_input_t script_menu[] = {JOY(3), JOY(3), JOY(3), JOY(0), JOY(0), JOY(0)};
+static const sim_input_t script_options[] = {JOY(4), JOY(4), JOY(4), JOY(2), JOY(2), JOY(2)};
+static const sim_input_t script_list[] = {JOY(4), JOY(4), JOY(0), JOY(2), JOY(3)};
+static const sim_input_t script_flappy[] = {JOY(1), TAP(10, 10), JOY(1), TAP(90, 10)};
+
+#define SCRIPT(s) (s), sizeof(s) / sizeof((s)[0])
+
+static const sim_case_t sim_cases[] = {
+    {"Splash", &splash_view, NULL, NULL, NULL, NULL, 0, false, true},
+    {"Main Menu", &main_menu_view, NULL, NULL, NULL, SCRIPT(script_menu), true},
+    {"WiFi Options", &options_menu_view, setup_wifi_options, NULL, NULL, SCRIPT(script_options), true},
+    {"BLE Options", &options_menu_view, setup_ble_options, NULL, NULL, SCRIPT(script_options), true},
+    {"Apps", &apps_menu_view, NULL, NULL, NULL, SCRIPT(script_menu), true},
+    {"Terminal", &terminal_view, NULL, feed_terminal, NULL, NULL, 0, true},
+    {"Visualizer", &music_visualizer_view, NULL, feed_visualizer, NULL, NULL, 0, true},
+    {"Flappy Ghost", &flappy_bird_view, NULL, feed_flappy, NULL, SCRIPT(script_flappy), false},
+    {"Device List", &device_list_view, setup_device_list, feed_devices, NULL, SCRIPT(script_list), true},
+    {"Channel Activity", &channel_activity_view, NULL, feed_channels, NULL, NULL, 0, true},
+    {"Error Popup", NULL, setup_error_popup, NULL, teardown_error_popup, NULL, 0, false},
+};
+
+#define SIM_CASE_COUNT (sizeof(sim_cases) / sizeof(sim_cases[0]))
+
+static void sim_wait_for_exit(const sim_case_t *c, sim_row_t *row, const char *failure) {
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)SIM_SWITCH_TIMEOUT_MS * 1000;
+    while (display_manager_get_current_view() == c->view && esp_timer_get_time() < deadline_us) {
+        sim_pass(c);
+    }
+
+    View *now = display_manager_get_current_view();
+    if (now == c->view) {
+        fprintf(stderr, "%s %s\n", c->name, failure);
+        host_test_failures++;
+    } else {
+        row->left_to = now ? now->name : "none";
+    }
+}
+
+static void run_case(const sim_case_t *c, sim_row_t *row) {
+    memset(row, 0, sizeof(*row));
+    row->left_to = "-";
+
+    if (c->setup) {
+        c->setup();
+    }
+
+    if (c->view) {
+        display_manager_switch_view(c->view);
+        if (!sim_wait_for_view(c, c->view)) {
+            fprintf(stderr, "%s never became the current view\n", c->name);
+            host_test_failures++;
+            return;
+        }
+        display_manager_get_last_create_stats(&row->create_us, &row->create_bytes);
+    }
+
+    heap_peak = heap_used();
+    sim_run_ms(c, SIM_SETTLE_MS);
+    row->coverage = sim_panel_coverage_pct();
+
+    if (c->leaves_itself) {
+        sim_wait_for_exit(c, row, "never moved on");
+        goto done;
+    }
+
+    for (size_t i = 0; i < c->script_len; i++) {
+        sim_post(&c->script[i]);
+        sim_run_ms(c, SIM_INPUT_MS);
+    }
+
+    if (c->view && display_manager_get_current_view() != c->view) {
+        fprintf(stderr, "%s left during its script\n", c->name);
+        host_test_failures++;
+        return;
+    }
+
+    display_stats_reset();
+    display_stats_set_enabled(true);
+    sim_run_ms(c, SIM_MEASURE_MS);
+    display_stats_set_enabled(false);
+
+    sim_collect_frames(&row->frames);
+
+    if (c->teardown) {
+        c->teardown();
+        sim_run_ms(c, SIM_INPUT_MS);
+    }
+
+    if (c->has_exit) {
+        sim_post(&(sim_input_t)JOY(1));
+        sim_wait_for_exit(c, row, "did not leave on select");
+    }
+
+done:
+    row->heap_peak = heap_peak;
+    row->commands = sim_services_take_commands();
+
+    // A view has to put something on the screen beyond its background
+    if (row->coverage == 0) {
+        fprintf(stderr, "%s left the screen blank\n", c->name);
+        host_test_failures++;
+    }
+}
+
+// Leaves nothing of the views behind, so the heap can be compared between passes
+static uint32_t clear_views(void) {
+    // A switch still waiting in lv_async_call would bring a view back afterwards
+    sim_run_ms(NULL, SIM_INPUT_MS);
+    display_manager_destroy_current_view();
+    display_manager_flush_view_cache();
+    sim_run_ms(NULL, SIM_INPUT_MS);
+    return heap_used();
+}
+
+static void print_report(const sim_row_t *rows, uint32_t baseline) {
+    lv_disp_t *disp = lv_disp_get_default();
+
+    printf("\n%s: %dx%d, LVGL heap %u KB, %u KB used with no view\n", UI_SIM_BOARD, lv_disp_get_hor_res(disp),
+           lv_disp_get_ver_res(disp), (unsigned)(heap_total / 1024), (unsigned)(baseline / 1024));
+    printf("%-16s %7s %6s %5s %6s %7s %7s %6s %7s %6s %4s  %s\n", "View", "cr_us", "cr_KB", "drawn", "frames",
+           "rnd_us", "max_us", "fl_us", "px", "pk_KB", "cmds", "next view");
+
+    for (size_t i = 0; i < SIM_CASE_COUNT; i++) {
+        const sim_row_t *row = &rows[i];
+        printf("%-16s %7lld %6.1f %4u%% %6u %7u %7u %6u %7u %6.1f %4u  %s\n", sim_cases[i].name,
+               (long long)row->create_us, row->create_bytes / 1024.0, row->coverage, row->frames.frames,
+               row->frames.render_avg_us, row->frames.render_max_us, row->frames.flush_avg_us, row->frames.px_avg,
+               row->heap_peak / 1024.0, row->commands, row->left_to);
+    }
+}
+
+static int run_views(void) {
+    static sim_row_t rows[SIM_CASE_COUNT];
+    uint32_t cleared[SIM_PASSES];
+    uint32_t baseline = heap_used();
+
+    // Rows of the last pass are reported, the first warms LVGL's caches
+    for (int pass = 0; pass < SIM_PASSES; pass++) {
+        for (size_t i = 0; i < SIM_CASE_COUNT; i++) {
+            run_case(&sim_cases[i], &rows[i]);
+        }
+        cleared[pass] = clear_views();
+    }
+
+    print_report(rows, baseline);
+    printf("LVGL heap with the views gone: %u bytes after the first pass, %u after the second\n",
+           (unsigned)cleared[0], (unsigned)cleared[1]);
+    CHECK_EQ(cleared[1], cleared[0]);
+    return 0;
+}
+
+// Runs a benchmark requested through ui_benchmark.h the way the LVGL task would
+static void sim_run_benchmark(void) {
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)SIM_BENCH_TIMEOUT_MS * 1000;
+    while (ui_benchmark_is_running()) {
+        if (esp_timer_get_time() > deadline_us) {
+            fprintf(stderr, "benchmark did not finish\n");
+            host_test_failures++;
+            return;
+        }
+        sim_pass(NULL);
+    }
+}
+
+// Time from the switch request to the first frame drawn after the view became current,
+// host time only, waits the sim skipped are left out
+static int64_t sim_switch_us(View *view) {
+    int64_t start_us = esp_timer_get_time();
+    int64_t skipped_us = sim_clock_skipped_us();
+
+    display_manager_switch_view(view);
+    display_stats_reset();
+    display_stats_set_enabled(true);
+
+    int64_t deadline_us = start_us + (int64_t)SIM_SWITCH_TIMEOUT_MS * 1000;
+    bool shown = false;
+    while (esp_timer_get_time() < deadline_us) {
+        sim_pass(NULL);
+        if (display_manager_get_current_view() == view && display_stats_frame_count() > 0) {
+            shown = true;
+            break;
+        }
+    }
+    display_stats_set_enabled(false);
+
+    if (!shown) {
+        fprintf(stderr, "%s was never drawn after a switch\n", view->name);
+        host_test_failures++;
+        return -1;
+    }
+    return esp_timer_get_time() - start_us - (sim_clock_skipped_us() - skipped_us);
+}
+
+// The cached menu views, switched in a circle so every switch leaves one of them
+static const sim_case_t *const switch_cases[] = {&sim_cases[1], &sim_cases[2], &sim_cases[4]};
+
+#define SWITCH_CASE_COUNT (sizeof(switch_cases) / sizeof(switch_cases[0]))
+
+static int run_switch(void) {
+    int64_t cold_us[SWITCH_CASE_COUNT] = {0}, warm_us[SWITCH_CASE_COUNT] = {0};
+    size_t cold_bytes[SWITCH_CASE_COUNT] = {0};
+    uint32_t warm_hits[SWITCH_CASE_COUNT] = {0};
+
+    clear_views();
+
+    // Cold: every view is created, nothing is left in the cache
+    for (size_t i = 0; i < SWITCH_CASE_COUNT; i++) {
+        display_manager_flush_view_cache();
+        if (switch_cases[i]->setup) switch_cases[i]->setup();
+        cold_us[i] = sim_switch_us(switch_cases[i]->view);
+        display_manager_get_last_create_stats(NULL, &cold_bytes[i]);
+        sim_run_ms(NULL, SIM_INPUT_MS);
+    }
+
+    // Warm: the views come back from the cache, create() does not run
+    for (int round = 0; round < SIM_SWITCH_ROUNDS; round++) {
+        for (size_t i = 0; i < SWITCH_CASE_COUNT; i++) {
+            if (switch_cases[i]->setup) switch_cases[i]->setup();
+            int64_t us = sim_switch_us(switch_cases[i]->view);
+            int64_t create_us = 0;
+            display_manager_get_last_create_stats(&create_us, NULL);
+            warm_us[i] += us;
+            warm_hits[i] += create_us == 0;
+            sim_run_ms(NULL, SIM_INPUT_MS);
+        }
+    }
+
+    printf("\n%s: view switch to first frame, %d cached rounds\n", UI_SIM_BOARD, SIM_SWITCH_ROUNDS);
+    printf("%-16s %8s %8s %8s %6s\n", "View", "cold_us", "cold_KB", "warm_us", "hits");
+    for (size_t i = 0; i < SWITCH_CASE_COUNT; i++) {
+        printf("%-16s %8lld %8.1f %8lld %3u/%d\n", switch_cases[i]->name, (long long)cold_us[i],
+               cold_bytes[i] / 1024.0, (long long)(warm_us[i] / SIM_SWITCH_ROUNDS), (unsigned)warm_hits[i],
+               SIM_SWITCH_ROUNDS);
+    }
+    display_manager_print_view_cache_stats();
+
+    // Heap churn: the firmware's stress run, every view opened in turn. Views reached from
+    // the cache allocate some state only on a later visit, so the first run only warms up.
+    uint32_t cleared[SIM_STRESS_RUNS];
+    for (int run = 0; run < SIM_STRESS_RUNS; run++) {
+        CHECK(ui_benchmark_memory_stress(SIM_STRESS_CYCLES));
+        sim_run_benchmark();
+        CHECK(lv_mem_test() == LV_RES_OK);
+        cleared[run] = clear_views();
+    }
+
+    printf("LVGL heap with the views gone after each stress run:");
+    for (int run = 0; run < SIM_STRESS_RUNS; run++) {
+        printf(" %u", (unsigned)cleared[run]);
+    }
+    printf(" bytes\n");
+    CHECK_EQ(cleared[SIM_STRESS_RUNS - 1], cleared[SIM_STRESS_RUNS - 2]);
+    return 0;
+}
+
+// Amplitude frames at the rate the visualizer stream hands them out
+static int64_t stream_next_us = 0;
+
+static bool feed_stream_frame(void) {
+    int64_t now_us = esp_timer_get_time();
+    if (now_us < stream_next_us) {
+        return false;
+    }
+    stream_next_us = now_us + 1000000 / VISUALIZER_OUTPUT_FPS;
+    feed_visualizer();
+    return true;
+}
+
+static void feed_stream(void) {
+    feed_stream_frame();
+}
+
+// The same stream with the whole view redrawn on every frame, as a view of separate bar
+// objects that all move each frame would be
+static void feed_stream_full(void) {
+    if (feed_stream_frame()) {
+        lv_obj_invalidate(music_visualizer_view.root);
+    }
+}
+
+static int run_visualizer(void) {
+    static const sim_case_t runs[] = {
+        {"Dirty strips", &music_visualizer_view, NULL, feed_stream, NULL, NULL, 0, false},
+        {"Whole view", &music_visualizer_view, NULL, feed_stream_full, NULL, NULL, 0, false},
+    };
+    sim_frames_t frames[2];
+
+    display_manager_switch_view(&music_visualizer_view);
+    if (!sim_wait_for_view(NULL, &music_visualizer_view)) {
+        fprintf(stderr, "Visualizer never became the current view\n");
+        host_test_failures++;
+        return 0;
+    }
+    sim_run_ms(&runs[0], SIM_SETTLE_MS);
+
+    for (int i = 0; i < 2; i++) {
+        display_stats_reset();
+        display_stats_set_enabled(true);
+        sim_run_ms(&runs[i], SIM_VISUALIZER_MS);
+        display_stats_set_enabled(false);
+        sim_collect_frames(&frames[i]);
+    }
+
+    uint32_t screen_px = (uint32_t)LV_HOR_RES * LV_VER_RES;
+    printf("\n%s: visualizer fed at %d fps for %d ms\n", UI_SIM_BOARD, VISUALIZER_OUTPUT_FPS, SIM_VISUALIZER_MS);
+    printf("%-14s %6s %5s %7s %7s %6s %7s %6s\n", "Redraw", "frames", "fps", "rnd_us", "max_us", "fl_us", "px",
+           "scr %");
+    for (int i = 0; i < 2; i++) {
+        printf("%-14s %6u %5u %7u %7u %6u %7u %5u%%\n", runs[i].name, frames[i].frames,
+               frames[i].frames * 1000 / SIM_VISUALIZER_MS, frames[i].render_avg_us, frames[i].render_max_us,
+               frames[i].flush_avg_us, frames[i].px_avg, (unsigned)((uint64_t)frames[i].px_avg * 100 / screen_px));
+    }
+
+    // The view prints its own draw and invalidation counts when it closes
+    display_manager_switch_view(&main_menu_view);
+    sim_wait_for_view(NULL, &main_menu_view);
+
+    for (int i = 0; i < 2; i++) {
+        CHECK(frames[i].frames > 0);
+        CHECK(frames[i].frames < DISPLAY_STATS_RING_SIZE);
+    }
+    CHECK(frames[0].px_avg < frames[1].px_avg);
+    return 0;
+}
+
+// Views that are mostly text, with the glyph cache emptied before each
+static const sim_case_t *const text_cases[] = {&sim_cases[1], &sim_cases[2], &sim_cases[5], &sim_cases[8]};
+
+#define TEXT_CASE_COUNT (sizeof(text_cases) / sizeof(text_cases[0]))
+
+static int run_text(void) {
+    printf("\n%s: text views from an empty glyph cache of %u KB\n", UI_SIM_BOARD,
+           (unsigned)(GLYPH_CACHE_BUDGET_BYTES / 1024));
+    printf("%-16s %6s %7s %7s %6s %6s %8s %7s\n", "View", "frames", "rnd_us", "lookups", "hit %", "glyphs",
+           "bytes", "evicted");
+
+    for (size_t i = 0; i < TEXT_CASE_COUNT; i++) {
+        const sim_case_t *c = text_cases[i];
+        if (c->setup) c->setup();
+        display_manager_switch_view(c->view);
+        if (!sim_wait_for_view(c, c->view)) {
+            fprintf(stderr, "%s never became the current view\n", c->name);
+            host_test_failures++;
+            continue;
+        }
+
+        // Nothing is drawn from the cache until the view redraws after the flush
+        lv_draw_sw_glyph_cache_flush();
+        lv_draw_sw_glyph_cache_reset_stats();
+        lv_obj_invalidate(lv_scr_act());
+        display_stats_reset();
+        display_stats_set_enabled(true);
+        sim_run_ms(c, SIM_SETTLE_MS);
+        for (size_t j = 0; j < c->script_len; j++) {
+            sim_post(&c->script[j]);
+            sim_run_ms(c, SIM_INPUT_MS);
+        }
+        display_stats_set_enabled(false);
+
+        sim_frames_t frames;
+        sim_collect_frames(&frames);
+        lv_draw_sw_glyph_cache_stats_t stats;
+        lv_draw_sw_glyph_cache_get_stats(&stats);
+        uint32_t lookups = stats.hits + stats.misses;
+
+        printf("%-16s %6u %7u %7u %5u%% %6u %8u %7u\n", c->name, frames.frames, frames.render_avg_us,
+               (unsigned)lookups, (unsigned)(lookups ? (uint64_t)stats.hits * 100 / lookups : 0),
+               (unsigned)stats.entries, (unsigned)stats.used_bytes, (unsigned)stats.evictions);
+
+        // Every view repeats letters, a cache that never hits is not being used
+        CHECK(stats.max_bytes == 0 || stats.hits > 0);
+    }
+    clear_views();
+
+    // The firmware's own run, canvas frames without the cache, cold and warm
+    CHECK(ui_benchmark_text(SIM_TEXT_FRAMES));
+    sim_run_benchmark();
+    return 0;
+}
+
+static const view_transition_t sim_strategies[] = {
+    VIEW_TRANSITION_INSTANT, VIEW_TRANSITION_SLIDE, VIEW_TRANSITION_CROSSFADE,
+};
+
+#define SIM_STRATEGY_COUNT (sizeof(sim_strategies) / sizeof(sim_strategies[0]))
+
+static int run_transitions(void) {
+    clear_views();
+    display_manager_switch_view(&main_menu_view);
+    if (!sim_wait_for_view(NULL, &main_menu_view)) {
+        fprintf(stderr, "Main Menu never became the current view\n");
+        host_test_failures++;
+        return 0;
+    }
+    sim_run_ms(NULL, SIM_SETTLE_MS);
+
+    // The firmware's own benchmark, its table is the number to compare against the board
+    view_transition_t configured = view_transition_get_strategy();
+    printf("\n%s: ", UI_SIM_BOARD);
+    CHECK(ui_benchmark_transitions());
+    sim_run_benchmark();
+    CHECK_EQ(view_transition_get_strategy(), configured);
+
+    uint32_t plain_us = 0, blend_us = 0;
+    CHECK(view_transition_get_frame_times(&plain_us, &blend_us));
+    CHECK(plain_us > 0 && blend_us >= plain_us);
+
+    // Every strategy has to land on the new view with no transition left running, and an
+    // animated one has to take its duration on the sim clock and draw frames along the way
+    printf("\n%-10s %-10s %8s %8s\n", "Strategy", "Ran as", "Frames", "Sim ms");
+    for (size_t i = 0; i < SIM_STRATEGY_COUNT; i++) {
+        View *target = display_manager_get_current_view() == &main_menu_view ? &options_menu_view : &main_menu_view;
+        view_transition_set_strategy(sim_strategies[i]);
+        display_stats_reset();
+        display_stats_set_enabled(true);
+
+        int64_t start_us = esp_timer_get_time();
+        display_manager_switch_view(target);
+        bool done = false;
+        while (esp_timer_get_time() - start_us < (int64_t)SIM_SWITCH_TIMEOUT_MS * 1000) {
+            sim_pass(NULL);
+            if (display_manager_get_current_view() == target && !view_transition_is_active()) {
+                done = true;
+                break;
+            }
+        }
+        int64_t sim_ms = (esp_timer_get_time() - start_us) / 1000;
+        display_stats_set_enabled(false);
+
+        view_transition_t ran = view_transition_last();
+        printf("%-10s %-10s %8u %8lld\n", view_transition_name(sim_strategies[i]),
+               done ? view_transition_name(ran) : "-", (unsigned)display_stats_frame_count(), (long long)sim_ms);
+        CHECK(done);
+        if (done && ran != VIEW_TRANSITION_INSTANT) {
+            CHECK(sim_ms >= VIEW_TRANSITION_MS);
+            CHECK(display_stats_frame_count() >= VIEW_TRANSITION_MIN_FRAMES);
+        }
+        CHECK(lv_mem_test() == LV_RES_OK);
+        sim_run_ms(NULL, SIM_INPUT_MS);
+    }
+
+    view_transition_set_strategy(configured);
+    clear_views();
+    return 0;
+}
+
+// True when every pixel of the top row has one color from the overlay's palette
+static bool overlay_outlines_screen(void) {
+    static const lv_palette_t palette[] = {
+        LV_PALETTE_RED, LV_PALETTE_GREEN, LV_PALETTE_BLUE, LV_PALETTE_YELLOW, LV_PALETTE_PURPLE,
+    };
+
+    lv_color_t first = sim_panel_get_pixel(0, 0);
+    bool in_palette = false;
+    for (size_t i = 0; i < sizeof(palette) / sizeof(palette[0]); i++) {
+        in_palette |= first.full == lv_palette_main(palette[i]).full;
+    }
+    if (!in_palette) {
+        return false;
+    }
+
+    for (lv_coord_t x = 1; x < LV_HOR_RES; x++) {
+        if (sim_panel_get_pixel(x, 0).full != first.full) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int run_stats(void) {
+    const sim_case_t *c = &sim_cases[9];  // Channel Activity, redrawn as data arrives
+    display_manager_switch_view(c->view);
+    if (!sim_wait_for_view(c, c->view)) {
+        fprintf(stderr, "%s never became the current view\n", c->name);
+        host_test_failures++;
+        return 0;
+    }
+    sim_run_ms(c, SIM_SETTLE_MS);
+
+    // Recorded frames against what actually reached the panel over the same passes
+    display_stats_reset();
+    display_stats_set_enabled(true);
+    sim_panel_reset_stats();
+    sim_run_ms(c, SIM_MEASURE_MS);
+    display_stats_set_enabled(false);
+
+    sim_panel_stats_t panel;
+    sim_panel_get_stats(&panel);
+    uint64_t px = 0, bytes = 0;
+    uint32_t flushes = 0;
+    uint32_t count = display_stats_frame_count();
+    uint32_t screen_px = (uint32_t)LV_HOR_RES * LV_VER_RES;
+
+    for (uint32_t i = 0; i < count; i++) {
+        display_stats_frame_t frame;
+        CHECK(display_stats_get_frame(i, &frame));
+        px += frame.px;
+        bytes += frame.flush_bytes;
+        flushes += frame.flushes;
+        CHECK(frame.px > 0 && frame.px <= screen_px);
+        CHECK(frame.flushes > 0);
+        CHECK(frame.areas >= frame.joined);
+    }
+
+    printf("\n%s: display stats of %s over %d ms\n", UI_SIM_BOARD, c->name, SIM_MEASURE_MS);
+    display_stats_print_summary();
+    display_stats_dump();
+    printf("Panel got %u flushes, %llu px, the frames account for %u flushes, %llu px\n", (unsigned)panel.flushes,
+           (unsigned long long)panel.flushed_px, (unsigned)flushes, (unsigned long long)px);
+
+    CHECK(count > 0 && count < DISPLAY_STATS_RING_SIZE);
+    CHECK_EQ(flushes, panel.flushes);
+    CHECK_EQ(px, panel.flushed_px);
+    CHECK_EQ(bytes, panel.flushed_px * sizeof(lv_color_t));
+
+    // A full redraw with the overlay on outlines the whole screen, and counts for the cost
+    display_stats_set_overlay(true);
+    display_stats_reset();
+    lv_obj_invalidate(lv_scr_act());
+    while (display_stats_frame_count() == 0) {
+        sim_pass(c);
+    }
+    display_stats_set_overlay(false);
+    display_stats_set_enabled(false);
+
+    uint32_t render_ns = 0, flush_ns = 0;
+    CHECK(display_stats_get_cost(&render_ns, &flush_ns));
+    printf("Overlay %s, cost per pixel %u ns drawing, %u ns flushing\n",
+           overlay_outlines_screen() ? "outlines the screen" : "MISSING", (unsigned)render_ns, (unsigned)flush_ns);
+    CHECK(overlay_outlines_screen());
+
+    clear_views();
+    return 0;
+}
+
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} sim_mode_t;
+
+static const sim_mode_t sim_modes[] = {
+    {"views", run_views},
+    {"switch", run_switch},
+    {"visualizer", run_visualizer},
+    {"text", run_text},
+    {"stats", run_stats},
+    {"transitions", run_transitions},
+};
+
+int main(int argc, char **argv) {
+    const char *name = argc > 1 ? argv[1] : "views";
+    const sim_mode_t *mode = NULL;
+    for (size_t i = 0; i < sizeof(sim_modes) / sizeof(sim_modes[0]); i++) {
+        if (strcmp(sim_modes[i].name, name) == 0) {
+            mode = &sim_modes[i];
+        }
+    }
+    if (mode == NULL) {
+        fprintf(stderr, "unknown mode %s\n", name);
+        return 2;
+    }
+
+    // Line by line, so the output up to a trap or sanitizer report is not lost
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    display_manager_init();
+    sim_run_ms(NULL, SIM_INPUT_MS);
+
+    mode->run();
+    printf("Sim time %lld ms, %lld ms of it waits skipped\n", (long long)(esp_timer_get_time() / 1000),
+           (long long)(sim_clock_skipped_us() / 1000));
+
+    return HOST_TEST_RESULT();
+}